@@ -21,5 +21,13 @@
 #define CONFIG_FONT_SIZE 14
 #define CONFIG_FONT_PATH "C:/Windows/Fonts/Arial.ttf"
 #define CONFIG_MAPBOX_ACCESS_TOKEN ""
+#define CONFIG_TILE_HOSTNAME "api.mapbox.com"
+#define CONFIG_TILE_PATH \
+    "/v4/mapbox.satellite/{z}/{x}/{y}{scale}.jpg90?access_token={token}"
+#define CONFIG_TILE_IMAGE_TYPE "JPG"
+#define CONFIG_TILE_SIZE 256
+
+#define CONFIG_MAP_RETAINED_LAYER 1
+#define CONFIG_PERF_LOG 0
 
 #endif
@@ -0,0 +1,177 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <stdio.h> /* snprintf and remove only */
+
+#include "list.h"
+#include "isbelong.h"
+#include "perf.h"
+#include "textarena.h"
+#include "textblob.h"
+#include "map/map.h"
+#include "map/clusters.h"
+#include "map/geodesic.h"
+#include "map/journal.h"
+#include "map/marker.h"
+#include "map/markerexport.h"
+#include "map/markerimport.h"
+#include "map/markerpool.h"
+#include "map/markerstore.h"
+#include "map/markerview.h"
+#include "map/quadtree.h"
+#include "map/searchindex.h"
+#include "map/snapshot.h"
+
+#define BENCH_ZOOM 15
+#define BENCH_AREA_TILES 32 /* markers are spread over 32x32 tiles */
+#define BENCH_IMPORT_RECORD_COUNT 1000000
+#define BENCH_SNAPSHOT_MARKER_COUNT 1000000
+#define BENCH_SNAPSHOT_PATH "bench.snapshot"
+#define BENCH_JOURNAL_EDIT_COUNT 1000000
+#define BENCH_SEARCH_MARKER_COUNT 1000000
+#define BENCH_SEARCH_ADD_COUNT 10000
+#define BENCH_NEAREST_MARKER_COUNT 1000000
+#define BENCH_NEAREST_COUNT 10
+#define BENCH_NEAREST_QUERY_COUNT 10000
+#define BENCH_NEAREST_CHECK_COUNT 20 /* queries compared with a full scan */
+#define BENCH_NEAREST_LATITUDE 62.779147
+#define BENCH_NEAREST_LONGITUDE 40.334442
+#define BENCH_NEAREST_AREA_ZOOM 6 /* markers are spread over a tile of it */
+#define BENCH_STORE_MARKER_COUNT 1000000
+#define BENCH_STORE_AREA_ZOOM 6 /* markers are spread over a tile of it */
+#define BENCH_STORE_PATH "bench.store"
+#define BENCH_STORE_PAN_DISTANCE 24 /* partitions away before going back */
+#define BENCH_STORE_PAN_COUNT 10
+#define BENCH_VIEWS_EDIT_COUNT 1000000
+#define BENCH_VIEWS_PUBLISH_PERIOD 1000 /* edits between views, a frame */
+#define BENCH_VIEWS_READER_COUNT 3
+#define BENCH_EXPORT_MARKER_COUNT 1000000
+#define BENCH_EXPORT_AREA_ZOOM 6 /* markers are spread over a tile of it */
+#define BENCH_EXPORT_PATH "bench.export"
+#define BENCH_DESCRIPTIONS_MARKER_COUNT 200000
+#define BENCH_DESCRIPTIONS_OPEN_COUNT 10000
+
+int bench_marker_index(void);
+int bench_marker_import(void);
+int bench_snapshot(void);
+int bench_journal(void);
+int bench_search(void);
+int bench_nearest(void);
+int bench_store(void);
+int bench_views(void);
+int bench_export(void);
+int bench_descriptions(void);
+
+/*
+    bench_marker_index()
+        fills a MAP_GRID_SIZE x MAP_GRID_SIZE grid of BENCH_ZOOM tiles with
+        10k, 100k and 1M random markers, once through the quadtree, once
+        by the linear scan which the grid used before and once by
+        markerpool_cull(), and logs the times;
+        clustering of the same markers is timed by insertion one by one
+        and by clusters_build(); memory taken per marker by the pool, its
+        names and the index is logged as well
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_marker_import()
+        parses BENCH_IMPORT_RECORD_COUNT generated markers as CSV and as
+        GeoJSON from memory, so the disk is not measured, and logs records
+        per second
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_snapshot()
+        builds BENCH_SNAPSHOT_MARKER_COUNT markers with their index and
+        clusters, saves them into BENCH_SNAPSHOT_PATH, loads them back and
+        fills the grid from the loaded index; logs the time of each step
+        against the rebuild which startup would need without the snapshot,
+        the file is removed afterwards
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_journal()
+        adds BENCH_JOURNAL_EDIT_COUNT markers with a journal next to
+        BENCH_SNAPSHOT_PATH, so it is compacted on the way, and logs the
+        mean and the longest time of an edit and the wait for the last
+        write; then loads the snapshot and replays the journal like the
+        startup does and checks that no marker is lost; files are removed
+        afterwards
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_search()
+        builds the search index of BENCH_SEARCH_MARKER_COUNT markers, adds
+        BENCH_SEARCH_ADD_COUNT more one by one and logs the times; then
+        runs queries from a word prefix which matches every marker to a
+        substring which matches one and logs each time against a linear
+        scan of all names
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_nearest()
+        spreads BENCH_NEAREST_MARKER_COUNT markers over a tile of
+        BENCH_NEAREST_AREA_ZOOM around BENCH_NEAREST_LATITUDE, the default
+        center of the map, and logs the mean and the longest time of
+        BENCH_NEAREST_QUERY_COUNT queries of BENCH_NEAREST_COUNT nearest
+        markers; the first BENCH_NEAREST_CHECK_COUNT queries are checked
+        against a full scan by great-circle distance, which is timed too
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_store()
+        writes BENCH_STORE_MARKER_COUNT markers spread over a tile of
+        BENCH_STORE_AREA_ZOOM into a store at MAP_STORE_ZOOM, opens it and
+        reads the partitions of a MAP_GRID_SIZE x MAP_GRID_SIZE grid of
+        tiles of that zoom in the middle, as the map does; then moves the
+        grid BENCH_STORE_PAN_DISTANCE partitions away and back
+        BENCH_STORE_PAN_COUNT times, loading the column it enters and
+        evicting the one it leaves, and checks after every step that
+        markerpool_pack_texts() keeps texts and descriptions within twice
+        the texts of the loaded markers; logs the times, the bytes read
+        against the size of the whole store and the most texts held while
+        moving, the file is removed afterwards
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_views()
+        runs BENCH_VIEWS_EDIT_COUNT random adds and removes of markers
+        alone, withdrawing the view every BENCH_VIEWS_PUBLISH_PERIOD edits
+        like map_update() without readers and withdrawing and publishing
+        it while BENCH_VIEWS_READER_COUNT threads read the views in a
+        loop, like map_acquire_markers() does for them; readers check that
+        every view is consistent: the live markers match its count and
+        every name matches its position; logs the three edit times and the
+        number of views and markers read
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_export()
+        spreads BENCH_EXPORT_MARKER_COUNT markers with quotes, commas and
+        line breaks in their texts over a tile of BENCH_EXPORT_AREA_ZOOM,
+        removes every eighth one and exports a view of the rest into
+        BENCH_EXPORT_PATH as CSV, GeoJSON and binary, then the markers of
+        a quarter of the tile as CSV; logs the times and the sizes; CSV
+        and GeoJSON files are imported back and every record is checked
+        against its marker, the binary header against the number of
+        markers; files are removed afterwards
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    bench_descriptions()
+        adds BENCH_DESCRIPTIONS_MARKER_COUNT markers with descriptions of
+        up to 1 KiB once into the text arena with their names, as they were
+        kept before, and once into a text blob; logs the times and the
+        memory per marker of both; then reads all descriptions one after
+        another, as the search index does, and those of
+        BENCH_DESCRIPTIONS_OPEN_COUNT random markers, as opening a marker
+        does, through the blob and through a snapshot at
+        BENCH_SNAPSHOT_PATH which they are saved into and loaded from;
+        every description is checked, the file is removed afterwards
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "headless.h"
+#include "options.h"
+#include "perf.h"
+#include "pngwriter.h"
+#include "tilesource.h"
+#include "map/map.h"
+
+#define EXPORT_WORKER_COUNT 8
+#define EXPORT_ROW_WINDOW 3 /* tile rows loaded ahead of the written one */
+
+int export_map(const options_t* options);
+
+/*
+    export_map()
+        writes the area between options->export_begin and
+        options->export_end at options->zoom into options->output_path;
+        tiles are loaded by EXPORT_WORKER_COUNT threads and the image is
+        written band by band, at most EXPORT_ROW_WINDOW rows of tiles are
+        kept in memory whatever the size of the image is
+        initializes and quits SDL itself
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
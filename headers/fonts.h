@@ -0,0 +1,42 @@
+#ifndef FONTS_H
+#define FONTS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+
+typedef struct {
+    char* path;
+    void* data;
+    size_t data_size;
+} font_file_t;
+
+typedef struct {
+    TTF_Font* font;
+    int file; /* index in the list of font_file_t */
+    int size;
+} font_entry_t;
+
+TTF_Font* fonts_get(const char* path, int size);
+void fonts_deinit(void);
+
+/*
+    SDL ttf must be initialized, the registry is not thread safe
+
+    font files are read once and fonts are opened from memory; fonts are
+    few and small, so they are kept open until fonts_deinit() and widgets
+    created again (e.g. the panel) do not parse the file again
+
+    fonts_get()
+        returns font shared by all users of the same path and size, it must
+            not be closed
+        returns NULL on error, call SDL_GetError() for more information
+
+    fonts_deinit()
+        closes all fonts and frees files, must be called before TTF_Quit()
+*/
+
+#endif
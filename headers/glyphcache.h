@@ -0,0 +1,81 @@
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "fonts.h"
+
+#define GLYPHCACHE_ATLAS_SIZE 512
+#define GLYPHCACHE_GLYPH_PADDING 1
+
+typedef struct {
+    Uint32 codepoint;
+    SDL_Rect rect;
+    int advance;
+} glyph_t;
+
+typedef struct {
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    char* font_path;
+    int font_size;
+    int line_skip;
+    SDL_Texture* atlas;
+    int shelf_x, shelf_y, shelf_height;
+    list_t glyphs;
+    Uint32* table;
+    Uint32 table_size;
+    list_t layout;
+    list_t vertices;
+    list_t indices;
+} glyphcache_t;
+
+glyphcache_t* glyphcache_get(SDL_Renderer* renderer,
+                             const char* font_path,
+                             int font_size);
+void glyphcache_deinit(void);
+void glyphcache_measure(glyphcache_t* glyphcache,
+                        const char* text,
+                        int wrap_width,
+                        int* width,
+                        int* height);
+void glyphcache_draw(glyphcache_t* glyphcache,
+                     const char* text,
+                     SDL_Color color,
+                     int x,
+                     int y,
+                     int wrap_width,
+                     const SDL_Rect* clip);
+
+/*
+    SDL ttf must be initialized
+
+    glyphcache_t
+        one cache is shared by all users of the same renderer, font and size;
+        glyphs are rasterized once into the atlas texture and strings are
+        drawn as one batch of textured quads; like fonts of fonts.h, caches
+        are kept until glyphcache_deinit(), so widgets created again (e.g.
+        the panel) do not rasterize their glyphs again
+        glyphs - list of glyph_t
+        table - open addressing hash table of glyph indices + 1 by codepoint
+        layout, vertices, indices - reusable buffers of glyphcache_draw()
+
+    glyphcache_get()
+        returns shared cache on success
+        returns NULL on error, call SDL_GetError() for more information
+
+    glyphcache_deinit()
+        destroys all caches, must be called before their renderers are
+        destroyed and before fonts_deinit()
+
+    glyphcache_measure(), glyphcache_draw()
+        text is UTF-8, lines are broken at '\n' and, if wrap_width > 0,
+        at spaces before the words that do not fit
+        clip may be NULL
+*/
+
+#endif
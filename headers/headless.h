@@ -0,0 +1,35 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_Image.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "fonts.h"
+#include "glyphcache.h"
+#include "http.h"
+#include "options.h"
+#include "perf.h"
+#include "map/map.h"
+
+int headless_init(void);
+void headless_deinit(void);
+int headless_render(const options_t* options);
+
+/*
+    headless_init()
+        initializes SDL with the dummy video driver, SDL image, SDL ttf
+        and http
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    headless_render()
+        renders the map into options->output_path without a window and a GPU:
+        SDL uses the dummy video driver and the software renderer draws into
+        a surface; the image is written when all tiles are loaded
+        initializes and quits SDL, SDL image and SDL ttf itself
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
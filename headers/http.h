@@ -2,7 +2,14 @@
 #define HTTP_H
 
 #include <SDL2/SDL.h>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <unistd.h>
+#endif
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -18,6 +25,7 @@ response_t http_get(const char* hostname, const char* path);
 
 /*
     http_init()
+        does nothing but on Windows
         returns 0 on success
         returns non-0 value on error, call SDL_GetError() for more information
 
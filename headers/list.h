@@ -13,7 +13,12 @@ typedef struct {
 } list_t;
 
 void list_init(list_t* list, size_t allocation_portion_byte);
+void list_init_borrowed(list_t* list,
+                        void* data,
+                        size_t size_byte,
+                        size_t allocation_portion_byte);
 void list_free(list_t* list);
+void list_clear(list_t* list);
 int list_add(list_t* list, const void* data, size_t data_size);
 int list_insert(list_t* list,
                 size_t index_byte,
@@ -23,6 +28,17 @@ void list_erase(list_t* list, size_t index_byte, size_t count_byte);
 void* list_get(const list_t* list, size_t index_byte);
 
 /*
+    list_init_borrowed()
+        the list uses size_byte bytes of data which it does not own, e.g. a
+        mapped file; they are copied into an allocated block when the list
+        grows, items may be changed in place
+
+    list_free()
+        frees nothing but the allocated block
+
+    list_clear()
+        removes all items but keeps the allocated memory
+
     list_add()
         returns 0 on success
         returns non-0 value on error, call SDL_GetError() for more information
@@ -0,0 +1,85 @@
+#ifndef CLUSTERS_H
+#define CLUSTERS_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../list.h"
+#include "marker.h"
+#include "markerpool.h"
+
+#define CLUSTERS_MAX_ZOOM 10 /* markers are drawn one by one above it */
+#define CLUSTERS_LEVEL_COUNT (CLUSTERS_MAX_ZOOM + 1)
+#define CLUSTERS_CELL_SIZE_LOG2 6 /* 64 screen px */
+
+typedef struct {
+    Uint32 cell_x, cell_y;
+    Uint32 count;
+    Uint64 sum_x, sum_y;
+} cluster_t;
+
+typedef struct {
+    cluster_t* table;
+    Uint32 table_size;
+    Uint32 count;
+    Uint8 cell_size_log2;
+    unsigned int is_borrowed : 1;
+} cluster_level_t;
+
+typedef struct {
+    cluster_level_t levels[CLUSTERS_LEVEL_COUNT];
+} clusters_t;
+
+void clusters_init(clusters_t* clusters, Uint8 world_zoom);
+void clusters_free(clusters_t* clusters);
+int clusters_insert(clusters_t* clusters, Uint32 x, Uint32 y);
+void clusters_remove(clusters_t* clusters, Uint32 x, Uint32 y);
+int clusters_build(clusters_t* clusters, const markerpool_t* markers);
+const cluster_t* clusters_get(const clusters_t* clusters,
+                              Uint8 zoom,
+                              Uint32 cell_x,
+                              Uint32 cell_y);
+Uint32 clusters_get_cell_size(const clusters_t* clusters, Uint8 zoom);
+
+/*
+    clusters_t
+        one level per zoom from 0 to CLUSTERS_MAX_ZOOM, markers of a level
+        are grouped by square cells of 1 << CLUSTERS_CELL_SIZE_LOG2 screen
+        pixels of that zoom
+
+    cluster_level_t
+        table - open addressing hash table of clusters by cell, clusters
+            with count 0 are empty slots
+        cell_size_log2 - log2 of the cell size in world pixels
+        is_borrowed - the table is not owned by the level, e.g. it is in a
+            mapped file; it is changed in place and not freed
+
+    cluster_t
+        sum_x, sum_y - sums of marker positions, the cluster is drawn at
+            their mean
+
+    clusters_init()
+        world_zoom - zoom level whose pixels are used as world pixels
+
+    clusters_insert()
+        adds a marker at world position (x, y) to all levels
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    clusters_remove()
+        removes a marker which was added at world position (x, y)
+
+    clusters_build()
+        replaces all levels, they are built by one thread per level
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    clusters_get()
+        returns cluster of the cell, NULL if the cell has no markers
+
+    clusters_get_cell_size()
+        returns cell size of the zoom level in world pixels
+*/
+
+#endif
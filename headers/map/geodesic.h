@@ -0,0 +1,49 @@
+#ifndef GEODESIC_H
+#define GEODESIC_H
+
+#include <SDL2/SDL.h>
+#include <math.h>
+
+#define GEODESIC_EARTH_RADIUS 6371008.8 /* m, mean radius */
+
+typedef struct {
+    double lat, lon;
+    double sin_lat, cos_lat;
+    double world_size;
+} geodesic_origin_t;
+
+void geodesic_init_origin(geodesic_origin_t* origin,
+                          double lat,
+                          double lon,
+                          Uint32 world_size);
+double geodesic_get_distance(void* ptr_origin,
+                             Uint32 x,
+                             Uint32 y,
+                             Uint32 size);
+double geodesic_measure(double lat_a,
+                        double lon_a,
+                        double lat_b,
+                        double lon_b);
+
+/*
+    geodesic_origin_t
+        point which distances are measured from, lat and lon are in radians
+        world_size - size of the Web Mercator world in pixels, where x and
+            y of positions are
+
+    geodesic_init_origin()
+        lat and lon are in degrees
+
+    geodesic_get_distance()
+        quadtree_distance_t of great-circle distances in meters from the
+        origin to a Web Mercator position or square; a square is measured to
+        its nearest point on the sphere, not in pixels, so the scale of the
+        projection, which grows with latitude, does not change the order
+        of distances
+
+    geodesic_measure()
+        returns great-circle distance in meters between two points given in
+        degrees
+*/
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <SDL2/SDL.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#include <stdlib.h>
+#include <stdio.h> /* snprintf and remove only */
+#include <string.h>
+
+#include "../../config.h"
+#include "../list.h"
+#include "../textarena.h"
+#include "../textblob.h"
+#include "clusters.h"
+#include "marker.h"
+#include "markerpool.h"
+#include "quadtree.h"
+#include "snapshot.h"
+
+#define JOURNAL_COMPACTION_SIZE (32*1024*1024) /* bytes of the file */
+#define JOURNAL_ADD 1
+#define JOURNAL_REMOVE 2
+
+typedef struct {
+    Uint64 sequence;
+    Uint32 checksum;
+    Uint32 index;
+    Uint32 x, y;
+    Uint16 name_length, description_length;
+    Uint8 type;
+    Uint8 color;
+    Uint8 padding[2];
+} journal_record_t;
+
+typedef struct {
+#ifdef _WIN32
+    HANDLE file;
+#else
+    int file;
+#endif
+    char* path;
+    char* snapshot_path;
+    Uint32 index_size;
+    Uint8 world_zoom;
+    Uint64 sequence;
+    Uint64 written_sequence;
+    Uint64 file_size;
+    Uint64 compaction_size;
+    list_t pending;
+    list_t writing;
+    SDL_mutex* mutex;
+    SDL_cond* appended;
+    SDL_cond* written;
+    SDL_Thread* writer;
+    unsigned int is_file_open : 1;
+    unsigned int is_closing : 1;
+    unsigned int has_failed : 1;
+} journal_t;
+
+journal_t* journal_open(const char* snapshot_path,
+                        Uint64 snapshot_sequence,
+                        Uint8 world_zoom,
+                        markerpool_t* markers,
+                        textarena_t* texts,
+                        textblob_t* descriptions,
+                        quadtree_t* index,
+                        Uint32* replayed_count);
+void journal_close(journal_t* journal);
+int journal_add(journal_t* journal,
+                Uint32 index,
+                const marker_t* marker,
+                const char* name,
+                const char* description);
+int journal_remove(journal_t* journal, Uint32 index);
+int journal_sync(journal_t* journal);
+
+/*
+    journal file
+        snapshot_path.journal, journal_record_t of every edit followed by
+        the name and the description of added markers; a record whose
+        checksum does not match ends the journal, so a write torn by a
+        crash loses only the records of the last group
+
+    journal_record_t
+        sequence - number of the record, it grows by one from record to
+            record and goes on from the snapshot
+        checksum - of the record with checksum 0 and its texts
+        index - slot index of the added or removed marker, edits are
+            replayed in the same order, so the pool gives the same indexes
+
+    journal_t
+        path - path of the journal file
+        sequence - of the last appended record, written_sequence - of the
+            last record which is written and flushed to the disk
+        pending - records appended by the caller, writing - records which
+            the writer thread writes; both are swapped under mutex, so an
+            edit never waits for the disk
+        writer - thread which writes all pending records at once and
+            flushes the file once for them (group commit); when the file
+            grows past JOURNAL_COMPACTION_SIZE it replays the journal over
+            the snapshot file into its own structures, saves them as the
+            new snapshot and empties the file; the caller keeps appending
+            meanwhile; the file is emptied only after the snapshot is
+            flushed under its name; if the compaction fails, the records
+            stay in the file and it is compacted again after
+            JOURNAL_COMPACTION_SIZE more bytes
+        compaction_size - file size at which the journal is compacted
+        has_failed - a write or a compaction failed, records are not
+            written anymore and edits fail
+
+    journal_open()
+        replays records of the journal file which are newer than
+        snapshot_sequence into markers, texts, descriptions and index, which
+        are the structures of the loaded snapshot, and opens the file for
+        appending; clusters are not replayed, the caller builds them when
+        replayed_count is not 0; a torn tail is cut off
+        world_zoom - see clusters_init()
+        returns pointer to journal_t on success
+        returns NULL on error, call SDL_GetError() for more information
+
+    journal_close()
+        writes pending records and stops the writer thread, journal may be
+        NULL
+
+    journal_add(), journal_remove()
+        append a record of an edit which is already done, O(1)
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    journal_sync()
+        waits until all appended records are written
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
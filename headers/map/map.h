@@ -5,63 +5,454 @@
 #include <SDL2/SDL_Image.h>
 #include <stdlib.h>
 #include <math.h>
-#include <stdio.h> /* sprintf only */
+#include <stdio.h> /* snprintf only */
 #include <string.h>
 
 #include "../../config.h"
 #include "../http.h"
+#include "../glyphcache.h"
 #include "../isbelong.h"
 #include "../list.h"
+#include "../perf.h"
+#include "../textarena.h"
+#include "../textblob.h"
+#include "../tilesource.h"
 #include "../widgets/colorpicker.h"
-#include "../widgets/textarea.h"
+#include "../widgets/labelcache.h"
+#include "clusters.h"
+#include "geodesic.h"
+#include "journal.h"
 #include "marker.h"
+#include "markerexport.h"
+#include "markerimport.h"
+#include "markerpool.h"
+#include "markerstore.h"
+#include "markerview.h"
 #include "panel.h"
+#include "quadtree.h"
+#include "searchindex.h"
+#include "snapshot.h"
 
 #define MAP_GRID_SIZE 9 /* odd number */
 #define MAP_TILE_SIZE 256
 #define MAP_MIN_ZOOM 0
 #define MAP_MAX_ZOOM 19
+#define MAP_ZOOM_ANIMATION_TIME 150 /* ms */
+#define MAP_STORE_ZOOM 12 /* zoom of the partitions of written stores */
+#define MAP_STORE_SPAN_LOG2 1 /* a tile loads at most 2x2 partitions */
+#define MAP_EXPORT_PROGRESS_PERIOD 1000 /* ms between progress logs */
+#define MAP_IMPORT_FRAME_TIME 4 /* ms of a frame spent storing an import */
 
 typedef struct { Uint32 x, y;     } pix_pos_t;
 typedef struct { double lat, lon; } geo_pos_t;
 
 typedef struct {
     Uint32 MAP_TILE_LOADED_EVENT;
+    const tilesource_t* source;
     Uint32 x, y, size;
     Uint8 zoom;
 } tile_t;
 
+typedef struct {
+    Uint32 x, y;
+    list_t handles;
+    unsigned int is_loaded : 1;
+} map_partition_t;
+
+typedef struct {
+    Uint32 MAP_EXPORT_FINISHED_EVENT;
+    char* path;
+    markerexport_format_t format;
+    markerview_reader_t* reader;
+    SDL_Rect area;
+    unsigned int has_area : 1;
+    Uint32 world_size;
+    SDL_atomic_t is_cancelled;
+    SDL_Thread* thread;
+    Uint64 start;
+    Uint32 logged_time;
+    markerexport_progress_t progress;
+    int error;
+} map_export_t;
+
+typedef struct {
+    char* path;
+    SDL_Thread* thread;
+    SDL_mutex* mutex;
+    SDL_cond* stored;
+    const markerimport_part_t* part;
+    list_t positions;
+    Uint32 stored_count;
+    Uint32 record_count;
+    Uint32 imported_count;
+    Uint64 start;
+    unsigned int is_read : 1;
+    unsigned int is_cancelled : 1;
+    int error;
+} map_import_t;
+
+typedef struct {
+    SDL_Texture* texture;
+    Uint8 dirty[MAP_GRID_SIZE][MAP_GRID_SIZE];
+} map_layer_t;
+
 typedef struct {
     SDL_Texture* grid[MAP_GRID_SIZE][MAP_GRID_SIZE];
+    SDL_Texture* backdrop[MAP_GRID_SIZE][MAP_GRID_SIZE];
     Sint8 grid_loading_status[MAP_GRID_SIZE][MAP_GRID_SIZE];
     list_t marker_grid[MAP_GRID_SIZE][MAP_GRID_SIZE];
-    list_t markers;
+    markerpool_t markers;
+    textarena_t marker_texts;
+    textblob_t marker_descriptions;
+    quadtree_t marker_index;
+    clusters_t marker_clusters;
+    searchindex_t marker_search;
+    markerviews_t marker_views;
+    snapshot_t* snapshot;
+    journal_t* journal;
+    markerstore_t* store;
+    list_t store_partitions;
+    Uint32 MAP_PARTITION_LOADED_EVENT;
+    map_export_t* export;
+    Uint32 MAP_EXPORT_FINISHED_EVENT;
+    map_import_t* import;
+    glyphcache_t* cluster_glyphs;
     SDL_Renderer* renderer;
     panel_t* panel;
-    textarea_t* marker_name_hover;
+    labelcache_t* marker_labels;
+    map_layer_t* layer;
     unsigned int is_loaded : 1;
+    unsigned int has_backdrop : 1;
+    unsigned int is_search_built : 1;
+    unsigned int is_partition_loading : 1;
+    unsigned int is_view_stale : 1;
     pix_pos_t center;
     tile_t center_tile;
+    tile_t backdrop_tile;
+    double zoom;
+    double zoom_from;
+    Uint8 zoom_target;
+    Uint32 zoom_start_time;
+    int tile_size;
+    Uint8 zoom_shift;
+    Uint64 fill_start;
+    Uint64 fill_requests;
+    Uint64 fill_bytes;
+    Sint32 hovered_marker;
+    int mouse_x, mouse_y;
+    SDL_Rect mouse_area;
 } map_t;
 
-map_t* map_init(SDL_Renderer* renderer, geo_pos_t map_center, Uint8 zoom);
+map_t* map_init(SDL_Renderer* renderer,
+                const tilesource_t* tilesource,
+                geo_pos_t map_center,
+                Uint8 zoom);
 void map_deinit(map_t* map);
+int map_set_retained(map_t* map, int retained);
+int map_update(map_t* map);
 void map_draw(const map_t* map, SDL_Rect area);
-void map_handle_event(map_t* map,
-                      const SDL_Event* event,
-                      SDL_Renderer* renderer,
-                      SDL_Rect area);
+int map_handle_event(map_t* map,
+                     const SDL_Event* event,
+                     SDL_Renderer* renderer,
+                     SDL_Rect area);
+Sint32 map_pick_marker(const map_t* map,
+                       int x,
+                       int y,
+                       const SDL_Rect* area);
+int map_is_marker_overlapping(const map_t* map, Uint32 x, Uint32 y);
+int map_add_marker(map_t* map,
+                   const marker_t* position,
+                   const char* name,
+                   const char* description,
+                   marker_handle_t* handle);
+int map_remove_marker(map_t* map, marker_handle_t handle);
+int map_import_markers(map_t* map, const char* path);
+int map_import_markers_async(map_t* map, const char* path);
+int map_load_snapshot(map_t* map, const char* path);
+int map_save_snapshot(const map_t* map, const char* path);
+int map_open_journal(map_t* map, const char* snapshot_path);
+int map_write_store(map_t* map, const char* path);
+int map_open_store(map_t* map, const char* path);
+int map_export_markers(map_t* map,
+                       const char* path,
+                       const geo_pos_t* begin,
+                       const geo_pos_t* end);
+int map_find_nearest_markers(const map_t* map,
+                             geo_pos_t position,
+                             Uint32 count,
+                             list_t* result);
+int map_search_markers(map_t* map,
+                       const char* query,
+                       Uint32 max_count,
+                       list_t* result);
+markerview_reader_t* map_acquire_markers(map_t* map);
+void map_release_markers(markerview_reader_t* reader);
+const char* map_get_marker_name(const map_t* map, const marker_t* marker);
+const char* map_get_marker_description(map_t* map, const marker_t* marker);
 
 /*
     SDL, SDL Image (JPG), http must be initialized
 
     map_t
-        marker_grid - 2d array of lists of pointers to marker_t
-        markers - list of marker_t
+        marker_grid - 2d array of lists of slot indexes (Uint32) of markers,
+            filled from marker_index when a tile is loaded
+        markers - pool of marker_t, markers never move
+        marker_texts - names of markers
+        marker_descriptions - descriptions of markers, which are read only
+            when a marker is opened, searched or written; they stay in the
+            snapshot or go to a temporary file, so memory holds only their
+            offsets
+        marker_index - quadtree of marker positions, item index is the
+            slot index of the marker in markers
+        marker_clusters - markers grouped per zoom level, drawn as count
+            badges instead of markers up to CLUSTERS_MAX_ZOOM
+        marker_search - names and descriptions of markers by trigram;
+            built by the first search after the markers are loaded from a
+            snapshot or a journal, then kept up to date by every edit;
+            is_search_built tells if it holds all markers
+        marker_views - views of markers and their texts for other
+            threads; a view is published only when a reader is acquired
+            and is_view_stale tells that markers changed since the last
+            one or that it was withdrawn, map_update() withdraws it, so
+            edits copy chunks only while a reader holds a view
+        snapshot - mapped snapshot file which the markers, marker_texts,
+            marker_descriptions, marker_index and marker_clusters use, NULL
+            if none was loaded
+        journal - journal of marker edits, NULL if it is not open
+        store - directory of the open marker store, NULL if none is open
+        store_partitions - map_partition_t of the partitions of the store
+            which are loaded or being loaded; partitions are loaded one at a
+            time in the spiral order in which tiles are loaded and are
+            evicted when they are more than MAP_GRID_SIZE/2 tiles away from
+            the grid
+        export - export of markers which runs in a thread, NULL if none
+        cluster_glyphs - NULL if the font can not be opened, badges are
+            drawn without counts then
+        marker_labels - NULL if the font can not be opened, labels of
+            hovered markers are not drawn then
+        layer - tiles and markers composed into one texture, NULL if the map
+            is drawn in immediate mode; tile (x, y) is kept in slot
+            (y % MAP_GRID_SIZE, x % MAP_GRID_SIZE), so panning only
+            redraws slots of the tiles that changed
+        backdrop - textures of the previous zoom level, drawn scaled under
+            the grid until all tiles of the current level are loaded
+        zoom - displayed zoom, fractional while zoom animation goes to
+            zoom_target; center_tile.zoom switches to zoom_target and new
+            tiles are requested only when the animation is finished
+        tile_size - screen size of a tile of the tile source;
+            tile_t.zoom is the zoom of requests, which is zoom_shift less
+            than the displayed zoom, tile_t.size stays in the pixels of
+            MAP_MAX_ZOOM with 256 px tiles
+        fill_start, fill_requests, fill_bytes - perf counters at the moment
+            the grid started to load, logged when the viewport is filled
+        hovered_marker - slot index of the marker under the mouse, -1 if
+            none;
+            picked again when the mouse, the map or its zoom changes, so
+            drawing does not search for it
+        mouse_x, mouse_y, mouse_area - the last mouse position and the map
+            area it was in
+
+    map_partition_t
+        x, y - tile of the partition at the zoom of the store
+        handles - marker_handle_t of the markers of the partition, a
+            handle of a marker which was removed by hand is stale
+        is_loaded - 0 while the partition is read by a thread
+
+    map_export_t
+        reader - view of the markers which are exported, acquired by the
+            map and released by the thread
+        area - pixels of the world between the corners, if has_area
+        is_cancelled - set by map_deinit(), the thread stops after the
+            current chunk of markers
+        logged_time - SDL_GetTicks() of the last progress log
+        progress - of the last chunk, written by the thread
+
+    map_import_t
+        thread - parses the file and hands its parts to map_update() one
+            at a time, it waits until the part is stored
+        part - part which map_update() stores, NULL if none; part,
+            is_read, is_cancelled and error are guarded by mutex, stored
+            is signaled when part is stored or the import is cancelled
+        positions - pix_pos_t of the records of part, projected by the
+            thread before it hands the part over
+        stored_count - records of part which are stored, including the
+            overlapping ones
+        record_count - records read, imported_count - markers stored
+        is_read - the thread has finished, error - its result
+        is_cancelled - set by map_deinit() and on an error of storing, the
+            thread stops at the next part
 
     map_init()
+        tilesource must be valid until map_deinit()
+        zoom must not be less than the zoom shift of the tilesource
         returns pointer to map_t on success
         returns NULL on error, call SDL_GetError() for more information
+
+    map_set_retained()
+        switches between retained (non-0) and immediate (0) drawing
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_update()
+        advances zoom animation and withdraws the view of the markers, the
+        next map_acquire_markers() publishes a new one; stores records of
+        a running import for MAP_IMPORT_FRAME_TIME ms; has to be called
+        every frame
+        returns non-0 value while the map is animated or imports and needs
+            to be redrawn
+
+    map_handle_event()
+        the end of an export is logged and the export is freed here;
+        Ctrl+F opens the panel which searches markers and moves the map to
+        the chosen one;
+        files dropped on the window are imported, see
+        map_import_markers_async(), and their names are freed
+        returns non-0 value if the map needs to be redrawn
+
+    map_pick_marker()
+        area - screen area of the map as passed to map_draw()
+        candidates are taken from marker_index, so the cost does not grow
+        with the number of visible markers
+        returns slot index of the topmost (highest slot index) marker under
+            the screen point (x, y), -1 if there is none or markers are not
+            hoverable at the current zoom
+
+    map_is_marker_overlapping()
+        answered by marker_index in O(log N)
+        returns non-0 value if a marker at (x, y) would overlap another one
+
+    map_add_marker()
+        position - x, y and color of the marker, other fields are ignored
+        name and description are copied into marker_texts and
+        marker_descriptions, they must not be longer than
+        CONFIG_MARKER_NAME_MAX and CONFIG_MARKER_DESCRIPTION_MAX;
+        the same overlap rule as for markers created by hand applies, so it
+        serves bulk imports as well
+        handle of the new marker is written to handle if it is not NULL
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_remove_marker()
+        releases name and description of the marker, its slot is reused
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_import_markers()
+        adds markers of a CSV or GeoJSON file, see markerimport.h; records
+        which overlap a marker are skipped like in map_add_marker(), the
+        clusters and the grid are built once for all markers; the number
+        of records per second is logged
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_import_markers_async()
+        imports the file in the same way without blocking the caller: a
+        thread parses it and map_update() stores the records of one part
+        after another for MAP_IMPORT_FRAME_TIME ms a frame, so the map is
+        drawn and handles events meanwhile; stored markers are added to
+        the clusters one by one and the grid is updated after every part;
+        the numbers are logged at the end; one import runs at a time
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_load_snapshot()
+        replaces the markers of a map which never had markers, journal or
+        store by the markers of a snapshot file, see snapshot.h; nothing is
+        parsed, so the time does not depend on the number of markers; a
+        missing file is not an error
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_save_snapshot()
+        writes all markers, their texts, marker_index and marker_clusters
+        into a snapshot file; waits until the journal is written; fails
+        while a store is open, the snapshot would hold loaded markers only
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_open_journal()
+        replays the journal of the snapshot over the markers, see journal.h,
+        then every added and removed marker is appended to it, so edits are
+        kept without rewriting the snapshot; has to be called after
+        map_load_snapshot() with the same path
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_write_store()
+        writes all markers into a marker store file of partitions at
+        MAP_STORE_ZOOM, see markerstore.h
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_open_store()
+        opens a marker store for a map without markers, snapshot, journal
+        or store; only the directory is read at once, the markers of the
+        partitions under the grid are loaded in threads as the map moves
+        and are dropped when it moves away; their texts are packed when
+        no view is held, see markerpool_pack_texts(), so the memory depends
+        on the viewport, not on the size of the store or on the distance
+        the map moved; nothing is loaded while a tile covers more than
+        1 << MAP_STORE_SPAN_LOG2 partitions a side; markers added or
+        removed by hand are not written to the store and searches see
+        loaded markers only
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_export_markers()
+        writes the markers into a CSV, GeoJSON or binary file by the
+        extension of path, see markerexport.h, in a thread while the map
+        keeps working; the markers are the ones of the call, edits made
+        after it are not exported; positions are converted back to
+        latitudes and longitudes; memory does not depend on the number of
+        markers; the progress is logged every MAP_EXPORT_PROGRESS_PERIOD
+        and the end by map_handle_event(); one export runs at a time,
+        map_deinit() stops it; with a store open only the loaded markers
+        are exported
+        begin, end - corners of the area whose markers are exported, NULL
+            for all markers
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_find_nearest_markers()
+        result - list of quadtree_neighbor_t of at most count markers
+            nearest to position by great-circle distance, nearest first;
+            index is the slot index of the marker, distance is in meters
+        marker_index is searched best first, see quadtree_find_nearest(),
+        so the cost grows with count, not with the number of markers
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_search_markers()
+        result - list of slot indexes (Uint32) of markers whose name or
+            description matches query, best first, see searchindex_search()
+        builds marker_search if it is not built, the time is logged
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    map_acquire_markers()
+        publishes the markers if they changed since the last view, so it
+        has to be called by the thread which edits the map; any thread then
+        reads the markers of the view of the returned reader without locks
+        while the map keeps editing them, see markerview_at(); the view is
+        the state at the call, it does not change until
+        map_release_markers(); all readers have to be released before
+        map_deinit()
+        returns pointer to the reader on success
+        returns NULL on error, call SDL_GetError() for more information
+
+    map_release_markers()
+        the thread which reads the view, it may differ from the one which
+        called map_acquire_markers()
+
+    map_get_marker_name()
+        returned string is valid until the next map_add_marker()
+
+    map_get_marker_description()
+        reads the description through a few windows of the file which
+        holds it, see textblob_get()
+        returns string which is valid until the next map_add_marker() or
+            map_get_marker_description()
+        returns NULL on error, call SDL_GetError() for more information
 */
 
 #endif
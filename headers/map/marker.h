@@ -7,9 +7,9 @@
 #define MARKER_PIXEL_SIZE 15 /* odd number */
 
 typedef struct {
-    char* name;
-    char* description;
     Uint32 x, y;
+    Uint32 name;
+    Uint32 description;
     Uint32 color              :  3;
     Uint32 name_length        :  7;
     Uint32 description_length : 11;
@@ -17,12 +17,13 @@ typedef struct {
 
 const Uint8* marker_get_pixels(void);
 const Uint8* marker_get_pixels_hovered(void);
-void marker_cut(list_t* dstlist, const list_t* srclist, const SDL_Rect* area);
 
 /*
-    marker_cut()
-        dstlist - list of marker_t
-        srclist - list of pointers to marker_t
+    marker_t
+        name - offset of the string in the text arena of the map, see
+            map_get_marker_name()
+        description - offset of the string in the description blob of the
+            map, see map_get_marker_description()
 */
 
 #endif
@@ -0,0 +1,96 @@
+#ifndef MARKEREXPORT_H
+#define MARKEREXPORT_H
+
+#include <SDL2/SDL.h>
+#include <stddef.h> /* offsetof only */
+#include <stdlib.h>
+#include <stdio.h> /* snprintf and remove only */
+#include <string.h>
+#include <math.h>
+
+#include "../../config.h"
+#include "../list.h"
+#include "marker.h"
+#include "markerpool.h"
+#include "markerstore.h"
+#include "markerview.h"
+
+#define MARKEREXPORT_BUFFER_SIZE (256*1024) /* bytes written at once */
+#define MARKEREXPORT_VERSION 1
+
+typedef enum {
+    MARKEREXPORT_CSV,
+    MARKEREXPORT_GEOJSON,
+    MARKEREXPORT_BINARY
+} markerexport_format_t;
+
+typedef struct {
+    char magic[8];
+    Uint32 version;
+    Uint32 byte_order;
+    Uint32 record_size;
+    Uint32 world_size;
+    Uint64 marker_count;
+} markerexport_header_t;
+
+typedef struct {
+    Uint32 walked_count;
+    Uint32 slot_count;
+    Uint64 written_count;
+    Uint64 written_size;
+} markerexport_progress_t;
+
+typedef int (*markerexport_callback_t)(void* data,
+                                       const markerexport_progress_t* progress);
+
+markerexport_format_t markerexport_get_format(const char* path);
+int markerexport_write(const char* path,
+                       markerexport_format_t format,
+                       const markerview_t* view,
+                       const SDL_Rect* area,
+                       Uint32 world_size,
+                       markerexport_callback_t callback,
+                       void* data);
+
+/*
+    CSV - header line, then one marker per line: lat,lon,name,description,
+        color with quoted name and description, as markerimport.h reads it
+    GeoJSON - FeatureCollection of Point features, as markerimport.h reads
+        it
+    binary - markerexport_header_t, then markerstore_record_t of every
+        marker followed by its name and description without '\0'; unlike
+        a marker store it is not partitioned, so it is written in one pass
+
+    markerexport_header_t
+        world_size - size of the world in pixels, where x and y of records
+            are
+        marker_count - number of records, written when the file is complete
+
+    markerexport_progress_t
+        walked_count - slots of the view walked of slot_count
+        written_count - markers written, written_size - bytes of the file,
+            the last of them may be still in the buffer
+
+    markerexport_callback_t
+        called after every chunk of the view and once at the end
+        returns non-0 value to stop the export
+
+    markerexport_get_format()
+        returns MARKEREXPORT_GEOJSON for ".geojson" and ".json" files,
+        MARKEREXPORT_BINARY for ".bin" files, MARKEREXPORT_CSV for others
+
+    markerexport_write()
+        writes the markers of the view into a file in the order of slot
+        indexes; markers are converted to latitudes and longitudes on the
+        fly and written through one buffer of MARKEREXPORT_BUFFER_SIZE, so
+        memory does not depend on the number of markers; safe to call from
+        any thread which holds the view
+        area - markers outside of it are skipped, NULL for all markers;
+            chunks are culled by markerpool_cull_chunk()
+        world_size - size of the world in pixels, a power of two
+        the file is removed on error or when the callback stops the export
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef MARKERIMPORT_H
+#define MARKERIMPORT_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../../config.h"
+#include "../list.h"
+#include "../textarena.h"
+#include "../widgets/colorpicker.h"
+
+#define MARKERIMPORT_BLOCK_SIZE (16*1024*1024) /* bytes read at once */
+#define MARKERIMPORT_WORKER_MAX 16
+
+typedef enum {
+    MARKERIMPORT_CSV,
+    MARKERIMPORT_GEOJSON
+} markerimport_format_t;
+
+typedef struct {
+    double lat, lon;
+    Uint32 name, description;
+    Uint16 name_length, description_length;
+    Uint8 color;
+} markerimport_record_t;
+
+typedef struct {
+    list_t records;
+    textarena_t texts;
+    Uint32 invalid_count;
+} markerimport_part_t;
+
+typedef int (*markerimport_callback_t)(void* data,
+                                       const markerimport_part_t* part);
+
+markerimport_format_t markerimport_get_format(const char* path);
+int markerimport_read(const char* path,
+                      markerimport_callback_t callback,
+                      void* data);
+int markerimport_parse(const char* text,
+                       size_t size,
+                       markerimport_format_t format,
+                       markerimport_callback_t callback,
+                       void* data);
+
+/*
+    CSV - one marker per line: lat,lon,name[,description[,color]], fields
+        may be quoted with "" inside quotes for a quote, the first line is
+        skipped if it is not a marker (a header)
+    GeoJSON - FeatureCollection of Point features, name and description
+        are taken from properties of the same names, color from the
+        "color" property (index of the colorpicker color); records without
+        a name are invalid, like markers created by hand
+
+    markerimport_record_t
+        name, description - offsets in texts of the part
+
+    markerimport_part_t
+        records - list of markerimport_record_t in the order of the file
+        invalid_count - number of records which are not markers (bad
+            position or color, empty name, too long texts)
+
+    markerimport_callback_t
+        called by the calling thread for every part in the order of the
+        file, the part is valid only during the call
+        returns non-0 value to stop the import, SDL_GetError() is kept
+
+    markerimport_get_format()
+        returns MARKERIMPORT_GEOJSON for ".geojson" and ".json" files,
+        MARKERIMPORT_CSV for others
+
+    markerimport_read()
+        reads the file block by block of MARKERIMPORT_BLOCK_SIZE, so memory
+        does not depend on the file size; a block is split into parts at
+        record boundaries which are parsed by up to MARKERIMPORT_WORKER_MAX
+        threads, one part per thread, then passed to the callback
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerimport_parse()
+        parses text which is already in memory the same way, text[size]
+        must be a null character
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
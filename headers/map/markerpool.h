@@ -0,0 +1,174 @@
+#ifndef MARKERPOOL_H
+#define MARKERPOOL_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "../list.h"
+#include "../textarena.h"
+#include "../textblob.h"
+#include "marker.h"
+
+#define MARKERPOOL_CHUNK_SIZE_LOG2 12 /* 4096 markers per chunk */
+#define MARKERPOOL_CHUNK_SIZE (1 << MARKERPOOL_CHUNK_SIZE_LOG2)
+#define MARKERPOOL_NONE ((Uint32)-1)
+
+typedef struct {
+    Uint32 index;
+    Uint32 generation;
+} marker_handle_t;
+
+typedef struct {
+    Uint32 generation;
+    union {
+        marker_t marker;
+        Uint32 next_free;
+    };
+} markerpool_slot_t;
+
+typedef struct {
+    markerpool_slot_t slots[MARKERPOOL_CHUNK_SIZE];
+    Uint32 x[MARKERPOOL_CHUNK_SIZE];
+    Uint32 y[MARKERPOOL_CHUNK_SIZE];
+    Uint8 color[MARKERPOOL_CHUNK_SIZE];
+} markerpool_chunk_t;
+
+typedef struct {
+    list_t chunks;
+    Uint32 slot_count;
+    Uint32 count;
+    Uint32 free_slot;
+    Uint32 borrowed_chunk_count;
+    Uint32 shared_slot_count;
+    list_t chunk_flags;
+    list_t retired_chunks;
+} markerpool_t;
+
+void markerpool_init(markerpool_t* markerpool);
+void markerpool_free(markerpool_t* markerpool);
+size_t markerpool_get_memory(const markerpool_t* markerpool);
+int markerpool_add(markerpool_t* markerpool,
+                   const marker_t* marker,
+                   marker_handle_t* handle);
+int markerpool_remove(markerpool_t* markerpool, marker_handle_t handle);
+marker_t* markerpool_get(const markerpool_t* markerpool,
+                         marker_handle_t handle);
+marker_t* markerpool_at(const markerpool_t* markerpool, Uint32 index);
+marker_handle_t markerpool_get_handle(const markerpool_t* markerpool,
+                                      Uint32 index);
+int markerpool_cull(const markerpool_t* markerpool,
+                    const SDL_Rect* area,
+                    list_t* result);
+int markerpool_cull_chunk(const markerpool_chunk_t* chunk,
+                          Uint32 first_index,
+                          Uint32 count,
+                          const SDL_Rect* area,
+                          list_t* result);
+int markerpool_share(markerpool_t* markerpool);
+void markerpool_unshare(markerpool_t* markerpool);
+int markerpool_pack_texts(markerpool_t* markerpool,
+                          textarena_t* texts,
+                          textblob_t* descriptions);
+
+/*
+    markerpool_t
+        markers are kept in chunks of MARKERPOOL_CHUNK_SIZE slots which are
+        never moved, so pointers to markers stay valid until the marker is
+        removed; removed slots are reused through a free list
+        chunks - list of pointers to markerpool_chunk_t
+        slot_count - number of slots ever used, markers have indexes below
+        count - number of markers
+        free_slot - index of the first free slot, MARKERPOOL_NONE if none
+        borrowed_chunk_count - number of the first chunks which the pool
+            does not own, e.g. chunks of a mapped file, they are not freed
+        shared_slot_count - slots below it may be read by other threads,
+            see markerpool_share()
+        chunk_flags - Uint8 per chunk: the chunk is shared, the chunk is an
+            owned copy of a borrowed one
+        retired_chunks - markerpool_chunk_t* of owned chunks which were
+            replaced by copies, their owner takes and frees them
+
+    markerpool_slot_t
+        generation - odd while the slot holds a marker, it changes on every
+            add and remove, so handles of removed markers become stale
+        next_free - index of the next free slot while the slot is free
+
+    markerpool_chunk_t
+        x, y, color - copies of the fields of the markers in slots, kept
+            contiguous so they can be scanned without touching the records;
+            x and y of free slots are MARKERPOOL_NONE, which is outside of
+            any area
+
+    markerpool_free()
+        strings of the markers are not freed
+
+    markerpool_get_memory()
+        returns number of bytes allocated by the pool
+
+    markerpool_add()
+        copies the marker in O(1)
+        handle may be NULL
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerpool_remove()
+        returns 0 on success
+        returns non-0 value if the handle is stale
+
+    markerpool_get()
+        returns NULL if the handle is stale
+
+    markerpool_at()
+        returns marker of the slot index, NULL if the slot is free; markers
+        are iterated by indexes from 0 to slot_count
+
+    markerpool_get_handle()
+        returns handle of the marker in the slot index
+
+    markerpool_cull()
+        adds slot indexes (Uint32) of markers inside the area to result in
+        one pass over x and y of all chunks, 8 or 4 markers at a time with
+        AVX2 or SSE2 when the CPU has them; it serves when most markers are
+        tested anyway, a few markers of a large pool are found faster by
+        quadtree_query()
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerpool_cull_chunk()
+        the same for the first count slots of one chunk, whose first slot
+        has index first_index; slots past count are not read, so it serves
+        the chunks of a view too, see markerview.h
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerpool_share()
+        chunks holding the slots below slot_count become shared: other
+        threads may read those slots through their own copy of the chunk
+        pointers while markers are added and removed; the first write to a
+        shared slot copies its chunk and moves the old one to
+        retired_chunks, a new marker in a slot never used before writes in
+        place; O(number of chunks)
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerpool_unshare()
+        no other thread reads the slots any more, so writes go to the
+        chunks in place again; O(number of shared chunks)
+
+    markerpool_pack_texts()
+        when released strings take more than half of texts or of
+        descriptions, copies the names and the descriptions of the markers
+        into a new arena and a new blob, which replace texts and
+        descriptions, and moves the offsets of the markers; otherwise does
+        nothing; O(bytes of the texts of the markers), so the released
+        space is dropped after at least as many bytes were released; no
+        view may read the markers, texts and descriptions
+        returns 0 on success, markers and texts are unchanged on error
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef MARKERSTORE_H
+#define MARKERSTORE_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <stdio.h> /* remove only */
+#include <string.h>
+
+#include "../../config.h"
+#include "../list.h"
+#include "../textarena.h"
+#include "../textblob.h"
+#include "marker.h"
+#include "markerpool.h"
+
+#define MARKERSTORE_VERSION 1
+
+typedef struct {
+    Uint32 x, y;
+    Uint32 count;
+    Uint32 size;
+    Uint64 offset;
+} markerstore_partition_t;
+
+typedef struct {
+    Uint32 x, y;
+    Uint16 name_length, description_length;
+    Uint8 color;
+    Uint8 padding[3];
+} markerstore_record_t;
+
+typedef struct {
+    char magic[8];
+    Uint32 version;
+    Uint32 byte_order;
+    Uint32 record_size;
+    Uint32 zoom;
+    Uint32 world_size;
+    Uint32 partition_count;
+    Uint64 marker_count;
+} markerstore_header_t;
+
+typedef struct {
+    char* path;
+    Uint8 zoom;
+    Uint32 partition_size;
+    Uint32 partition_count;
+    Uint64 marker_count;
+    markerstore_partition_t* partitions;
+} markerstore_t;
+
+typedef struct {
+    Uint32 count;
+    Uint8* data;
+} markerstore_part_t;
+
+int markerstore_write(const char* path,
+                      Uint8 zoom,
+                      Uint32 world_size,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      textblob_t* descriptions);
+markerstore_t* markerstore_open(const char* path, Uint32 world_size);
+void markerstore_close(markerstore_t* store);
+const markerstore_partition_t* markerstore_find(const markerstore_t* store,
+                                                Uint32 x,
+                                                Uint32 y);
+int markerstore_read(const char* path,
+                     const markerstore_partition_t* partition,
+                     markerstore_part_t* part);
+void markerstore_free_part(markerstore_part_t* part);
+
+/*
+    marker store file
+        markerstore_header_t, then the directory of all non-empty
+        partitions as markerstore_partition_t sorted by y and x, then the
+        partitions; a partition holds the markers inside one tile of the
+        zoom of the store: count markerstore_record_t, then the name and
+        the description of every record one after another, without '\0'
+
+    markerstore_partition_t
+        x, y - tile of the partition at the zoom of the store
+        count - number of markers, size - bytes at offset in the file
+
+    markerstore_record_t
+        x, y - position of the marker in pixels of the world
+
+    markerstore_t
+        path - copy of the path, partitions are read by path, so reads do
+            not share a file and may run in any thread
+        partition_size - size of a partition in pixels of the world
+        partitions - the directory, the only part which is kept in memory
+
+    markerstore_part_t
+        data - records and texts of a partition as in the file
+
+    markerstore_write()
+        writes all markers into a store of partitions at zoom, the time
+        and the memory do not depend on the partitioning, markers are
+        sorted by partition once
+        world_size - size of the world in pixels, a power of two
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerstore_open()
+        reads and checks the header and the directory
+        world_size - the same as the store was written with
+        returns pointer to markerstore_t on success
+        returns NULL on error, call SDL_GetError() for more information
+
+    markerstore_close()
+        store may be NULL
+
+    markerstore_find()
+        binary search in the directory
+        returns partition of the tile (x, y), NULL if it has no markers
+
+    markerstore_read()
+        reads a partition and checks that texts are within the limits of
+        marker_t; safe to call from any thread
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerstore_free_part()
+        part may be the one of a failed markerstore_read()
+*/
+
+#endif
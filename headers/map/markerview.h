@@ -0,0 +1,136 @@
+#ifndef MARKERVIEW_H
+#define MARKERVIEW_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../list.h"
+#include "../textarena.h"
+#include "../textblob.h"
+#include "marker.h"
+#include "markerpool.h"
+
+#define MARKERVIEW_READER_MAX 16
+
+typedef struct {
+    Uint64 epoch;
+    Uint32 slot_count;
+    Uint32 count;
+    const char* texts;
+    textblob_t* descriptions;
+    markerpool_chunk_t** chunks;
+} markerview_t;
+
+typedef struct {
+    SDL_atomic_t is_used;
+    void* view;
+} markerview_reader_t;
+
+typedef struct {
+    void* current;
+    markerview_reader_t readers[MARKERVIEW_READER_MAX];
+    Uint64 epoch;
+    list_t retired;
+} markerviews_t;
+
+void markerviews_init(markerviews_t* views);
+void markerviews_free(markerviews_t* views);
+int markerviews_publish(markerviews_t* views,
+                        markerpool_t* markers,
+                        textarena_t* texts,
+                        textblob_t* descriptions);
+int markerviews_withdraw(markerviews_t* views,
+                         markerpool_t* markers,
+                         textarena_t* texts);
+void markerviews_collect(markerviews_t* views);
+markerview_reader_t* markerviews_acquire(markerviews_t* views);
+void markerviews_release(markerview_reader_t* reader);
+const marker_t* markerview_at(const markerview_t* view, Uint32 index);
+const char* markerview_get_text(const markerview_t* view, Uint32 offset);
+int markerview_read_description(const markerview_t* view,
+                                const marker_t* marker,
+                                char* description);
+
+/*
+    markerview_t
+        immutable state of the markers and their texts at one moment, read
+        by other threads without locks while the owner of the markers goes
+        on editing them
+        epoch - number of the view, it grows by one from view to view
+        slot_count, count - as in markerpool_t at that moment
+        texts - block of the text arena, NULL if it had none
+        descriptions - blob of the descriptions, it only grows, so it is
+            not copied
+        chunks - copy of the chunk pointers of the pool; the pool copies a
+            chunk before it changes a slot which a view may read, see
+            markerpool_share(), so the chunks never change under a reader
+
+    markerview_reader_t
+        is_used - the reader is taken by a thread
+        view - markerview_t which the thread reads, NULL if none; written
+            before the thread reads the view, so the owner never frees a
+            view or a chunk while it is read (hazard pointer)
+
+    markerviews_t
+        current - markerview_t which readers acquire, NULL until the first
+            markerviews_publish() and after markerviews_withdraw(); current
+            and readers[].view are accessed atomically only
+        epoch - of the current view
+        retired - views, chunks and text blocks which are not current any
+            more, each is freed when no reader holds a view of its epoch or
+            older
+
+    markerviews_free()
+        all readers must be released
+
+    markerviews_publish()
+        makes the current state of markers and texts the current view in
+        O(number of chunks); marks them shared, see markerpool_share() and
+        textarena_share(), takes their retired chunks and blocks and frees
+        what no reader needs any more; has to be called by the thread which
+        edits markers and texts, between edits
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerviews_withdraw()
+        drops the current view, so readers acquire nothing until the next
+        markerviews_publish(); frees what no reader needs any more and when
+        no reader holds a view, unshares markers and texts, see
+        markerpool_unshare() and textarena_unshare(); the same thread as
+        markerviews_publish()
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    markerviews_collect()
+        frees what no reader needs any more, the same thread as
+        markerviews_publish()
+
+    markerviews_acquire()
+        takes a reader and pins the current view in it, lock-free; may be
+        called by any thread
+        returns pointer to the reader, its view is valid until
+            markerviews_release()
+        returns NULL on error, call SDL_GetError() for more information
+
+    markerviews_release()
+        gives the reader back; the thread which reads the view, it may
+        differ from the one which called markerviews_acquire()
+
+    markerview_at()
+        returns marker of the slot index as it was when the view was
+            published, NULL if the slot was free; markers are iterated by
+            indexes from 0 to slot_count
+
+    markerview_get_text()
+        returns string of the text arena at offset, see marker_t
+
+    markerview_read_description()
+        copies the description of the marker and '\0' into description,
+        which has room for description_length + 1 bytes; safe to call from
+        any thread which holds the view, see textblob_read()
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
@@ -2,23 +2,29 @@
 #define PANELS_H
 
 #include <SDL2/SDL.h>
-#include <windows.h>
 
 #include "../widgets/editline.h"
 #include "../widgets/editfield.h"
 #include "../widgets/button.h"
 #include "../widgets/colorpicker.h"
+#include "../glyphcache.h"
+#include "../list.h"
+#include "../../config.h"
+#include "markerpool.h"
 
 #define PANEL_INDENT 10
 #define PANEL_EDITFIELD_HEIGHT 160
+#define PANEL_SEARCH_RESULT_MAX 20
+#define PANEL_SEARCH_RESULT_INDENT 4
 
-enum { PANEL_CREATE_MARKER };
+enum { PANEL_CREATE_MARKER, PANEL_SEARCH_MARKER };
 
 typedef struct {
     Sint16 type;
     Sint16 canceled;
     void* map;
     void (*on_executed)(void*);
+    void (*on_changed)(void*);
     const char* (*check)(void*);
 } panel_parameters_t;
 
@@ -31,15 +37,33 @@ typedef struct {
     colorpicker_t colorpicker;
 } panel_create_marker;
 
+typedef struct {
+    marker_handle_t marker;
+    char name[CONFIG_MARKER_NAME_MAX + 1];
+} panel_search_result_t;
+
+typedef struct {
+    panel_parameters_t parameters;
+    editline_t* editline;
+    button_t* button_close;
+    glyphcache_t* glyphcache;
+    list_t results;
+    size_t query_size;
+    Sint32 hovered_result;
+    Sint32 selected_result;
+} panel_search_marker;
+
 typedef union {
     panel_parameters_t parameters;
     panel_create_marker create_marker;
+    panel_search_marker search_marker;
 } panel_t;
 
 panel_t* panel_init(int type,
                     SDL_Renderer* renderer,
                     void* map,
                     void (*on_executed)(void*),
+                    void (*on_changed)(void*),
                     const char* (*check)(void*));
 void panel_deinit(panel_t* panel);
 void panel_draw(const panel_t* panel,
@@ -47,19 +71,34 @@ void panel_draw(const panel_t* panel,
                 int x,
                 int y,
                 int h);
-void panel_handle_event(panel_t* panel,
-                        const SDL_Event* event,
-                        SDL_Renderer* renderer,
-                        int x,
-                        int y,
-                        int h);
+int panel_handle_event(panel_t* panel,
+                       const SDL_Event* event,
+                       int x,
+                       int y,
+                       int h);
 
 /*
     SDL ttf must be initialized
 
+    panel_search_result_t
+        marker - handle of the found marker, it becomes stale when the
+            marker is removed while the panel is open, see markerpool_get()
+
+    panel_search_marker
+        results - list of panel_search_result_t filled by on_changed, at
+            most PANEL_SEARCH_RESULT_MAX
+        query_size - size of the query on_changed was called for
+        selected_result - row of results which on_executed jumps to, -1 if
+            none
+
     panel_init()
+        on_changed - called when the query of PANEL_SEARCH_MARKER is edited,
+            may be NULL for other types
         returns pointer to panel_t on success
         returns NULL on error, call SDL_GetError() for more information
+
+    panel_handle_event()
+        returns non-0 value if the panel needs to be redrawn
 */
 
 #endif
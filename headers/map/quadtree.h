@@ -0,0 +1,121 @@
+#ifndef QUADTREE_H
+#define QUADTREE_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+
+#include "../list.h"
+
+#define QUADTREE_BUCKET_SIZE 32 /* items of a leaf before it is split */
+#define QUADTREE_MERGE_SIZE (QUADTREE_BUCKET_SIZE/2) /* of four leaves */
+
+typedef struct {
+    Uint32 x, y;
+    Uint32 index;
+} quadtree_item_t;
+
+typedef struct {
+    Sint32 children;
+    list_t items;
+} quadtree_node_t;
+
+typedef struct {
+    Uint32 index;
+    double distance;
+} quadtree_neighbor_t;
+
+typedef double (*quadtree_distance_t)(void* data,
+                                      Uint32 x,
+                                      Uint32 y,
+                                      Uint32 size);
+
+typedef struct {
+    list_t nodes;
+    list_t free_children;
+    Uint32 size;
+    Uint32 count;
+} quadtree_t;
+
+int quadtree_init(quadtree_t* quadtree, Uint32 size);
+void quadtree_free(quadtree_t* quadtree);
+size_t quadtree_get_memory(const quadtree_t* quadtree);
+int quadtree_insert(quadtree_t* quadtree, Uint32 x, Uint32 y, Uint32 index);
+int quadtree_remove(quadtree_t* quadtree, Uint32 x, Uint32 y, Uint32 index);
+int quadtree_query(const quadtree_t* quadtree,
+                   const SDL_Rect* area,
+                   list_t* result);
+int quadtree_contains(const quadtree_t* quadtree, const SDL_Rect* area);
+int quadtree_find_nearest(const quadtree_t* quadtree,
+                          Uint32 count,
+                          quadtree_distance_t distance,
+                          void* data,
+                          list_t* result);
+
+/*
+    quadtree_t
+        point region quadtree over the square [0, size) x [0, size)
+        nodes - list of quadtree_node_t, the root is the first one
+        free_children - list of indexes (Sint32) of four consecutive nodes
+            which are not in the tree since they were merged back, splits
+            take them before the nodes list grows
+        count - number of inserted items
+
+    quadtree_node_t
+        children - index of the first of four consecutive child nodes
+            (top left, top right, bottom left, bottom right), -1 for leaves
+        items - list of quadtree_item_t, empty for inner nodes
+
+    quadtree_distance_t
+        returns distance to the item at (x, y) if size is 0, otherwise
+        a distance which is not greater than the one to any point of the
+        square [x, x + size) x [y, y + size); the metric is the caller's,
+        e.g. geodesic
+
+    quadtree_init()
+        size must be a power of two
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    quadtree_free()
+        may be called after failed quadtree_init()
+
+    quadtree_get_memory()
+        returns number of bytes allocated by the tree
+
+    quadtree_insert()
+        index is an arbitrary value which is returned by quadtree_query(),
+        e.g. index of the item in the caller's list
+        leaves are split when they hold more than QUADTREE_BUCKET_SIZE items
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    quadtree_remove()
+        x and y must be the ones the item was inserted with; four leaves
+        which hold at most QUADTREE_MERGE_SIZE items together are merged
+        back into their parent, up to the root, so removed items do not
+        leave empty nodes behind; the size is below QUADTREE_BUCKET_SIZE,
+        so an item added and removed at the border does not split and
+        merge the same leaves again
+        returns 0 on success
+        returns non-0 value if the item is not found
+
+    quadtree_query()
+        adds indexes (Uint32) of items inside the area to result, the cost
+        is O(log N + k) for k items found
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    quadtree_contains()
+        stops at the first item found, the cost is O(log N)
+        returns non-0 value if any item is inside the area
+
+    quadtree_find_nearest()
+        adds count, or all if there are less, items nearest by distance to
+        result as quadtree_neighbor_t, nearest first; nodes and items are
+        visited from a heap ordered by distance, so only nodes which are
+        nearer than the last found item are opened
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../config.h"
+#include "../list.h"
+#include "../textarena.h"
+#include "../textblob.h"
+#include "markerpool.h"
+
+#define SEARCHINDEX_INITIAL_TABLE_SIZE 1024
+#define SEARCHINDEX_WORD_MARK 1 /* byte of word beginnings in trigrams */
+#define SEARCHINDEX_RESULT_MAX 64
+
+typedef struct {
+    Uint32 trigram;
+    Uint32 count;
+    Uint32 capacity;
+    Uint32* postings;
+} searchindex_entry_t;
+
+typedef struct {
+    searchindex_entry_t* table;
+    Uint32 table_size;
+    Uint32 count;
+    Uint32 marker_count;
+    Uint32 removed_count;
+} searchindex_t;
+
+void searchindex_init(searchindex_t* searchindex);
+void searchindex_free(searchindex_t* searchindex);
+int searchindex_add(searchindex_t* searchindex,
+                    Uint32 index,
+                    const char* name,
+                    size_t name_length,
+                    const char* description,
+                    size_t description_length);
+void searchindex_remove(searchindex_t* searchindex);
+int searchindex_build(searchindex_t* searchindex,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      textblob_t* descriptions);
+int searchindex_search(const searchindex_t* searchindex,
+                       const markerpool_t* markers,
+                       const textarena_t* texts,
+                       textblob_t* descriptions,
+                       const char* query,
+                       Uint32 max_count,
+                       list_t* result);
+
+/*
+    searchindex_t
+        inverted index of names and descriptions of markers: every three
+        consecutive bytes of a text (a trigram) and the first one or two
+        bytes of every word, prefixed by SEARCHINDEX_WORD_MARK, lead to the
+        slot indexes of the markers whose text has them; texts are folded
+        to lower case (ASCII and Cyrillic) first
+        table - open addressing hash table of entries by trigram, entries
+            with trigram 0 are empty slots
+        marker_count - number of added markers, removed_count - number of
+            them which are removed, their postings are dropped by the next
+            searchindex_build()
+
+    searchindex_entry_t
+        postings - count slot indexes in an array of capacity, a slot index
+            may be there twice if the slot was reused
+
+    searchindex_add()
+        adds the texts of the marker in slot index
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    searchindex_remove()
+        accounts a removed marker, nothing is searched for it: results are
+        checked against the texts of live markers
+
+    searchindex_build()
+        replaces the index by the one of all markers
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    searchindex_search()
+        query of three or more bytes matches markers which have it anywhere
+        in the name or the description, a shorter one matches beginnings of
+        words; candidates are taken from the shortest postings of the
+        query trigrams and checked against the texts, so the time depends
+        on the number of candidates, not of markers
+        result - list of slot indexes (Uint32) of at most max_count, but not
+            more than SEARCHINDEX_RESULT_MAX, markers, best first: the name
+            is the query, starts with it, has a word which starts with it,
+            has it; then the same for the description; shorter names first
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
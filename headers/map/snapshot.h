@@ -0,0 +1,139 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <SDL2/SDL.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#include <stdlib.h>
+#include <stdio.h> /* snprintf and rename only */
+#include <string.h>
+
+#include "../list.h"
+#include "../textarena.h"
+#include "../textblob.h"
+#include "clusters.h"
+#include "markerpool.h"
+#include "quadtree.h"
+
+#define SNAPSHOT_VERSION 3
+#define SNAPSHOT_ALIGNMENT 64 /* sections begin at multiples of it */
+#define SNAPSHOT_REPLACED_MAX 8 /* files moved aside which may be mapped */
+
+typedef struct {
+    void* data;
+    size_t size;
+    Uint64 journal_sequence;
+} snapshot_t;
+
+typedef struct {
+    Uint64 offset;
+    Uint32 table_size;
+    Uint32 count;
+    Uint32 cell_size_log2;
+    Uint32 padding;
+} snapshot_level_t;
+
+typedef struct {
+    char magic[8];
+    Uint32 version;
+    Uint32 byte_order;
+    Uint32 chunk_size;
+    Uint32 item_size;
+    Uint32 cluster_size;
+    Uint32 level_count;
+    Uint32 slot_count;
+    Uint32 marker_count;
+    Uint32 free_slot;
+    Uint32 chunk_count;
+    Uint64 chunks_offset;
+    Uint64 texts_offset;
+    Uint32 texts_size;
+    Uint32 texts_released_size;
+    Uint64 descriptions_offset;
+    Uint32 descriptions_size;
+    Uint32 descriptions_released_size;
+    Uint64 nodes_offset;
+    Uint64 items_offset;
+    Uint32 node_count;
+    Uint32 item_count;
+    Uint32 index_size;
+    Uint32 index_count;
+    Uint64 journal_sequence;
+    snapshot_level_t levels[CLUSTERS_LEVEL_COUNT];
+} snapshot_header_t;
+
+typedef struct {
+    Sint32 children;
+    Uint32 first_item;
+    Uint32 item_count;
+} snapshot_node_t;
+
+int snapshot_save(const char* path,
+                  const markerpool_t* markers,
+                  const textarena_t* texts,
+                  const textblob_t* descriptions,
+                  const quadtree_t* index,
+                  const clusters_t* clusters,
+                  Uint64 journal_sequence);
+int snapshot_load(const char* path,
+                  snapshot_t** snapshot,
+                  markerpool_t* markers,
+                  textarena_t* texts,
+                  textblob_t* descriptions,
+                  quadtree_t* index,
+                  clusters_t* clusters);
+void snapshot_close(snapshot_t* snapshot);
+
+/*
+    snapshot file
+        snapshot_header_t, then sections at multiples of SNAPSHOT_ALIGNMENT:
+        chunks of the marker pool as they are in memory, strings of the
+        text arena, strings of the description blob, snapshot_node_t of
+        every node of the index, items of the index leaf by leaf and tables
+        of cluster levels; the layout is of the machine which wrote it, the
+        header tells it apart
+
+    snapshot_t
+        data - the file mapped copy-on-write, size - its size
+        journal_sequence - sequence number of the last journal record which
+            the snapshot contains, see journal.h
+
+    snapshot_save()
+        the file is written as path.tmp, flushed and renamed to path, then
+        the directory is flushed, so a failed save keeps the previous
+        snapshot and a successful one survives a crash; Windows does not
+        replace a file which is mapped, so a snapshot which is in use is
+        moved to path.N.old first and removed by a later save once it is
+        not mapped; up to SNAPSHOT_REPLACED_MAX such files are kept
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    snapshot_load()
+        markers, texts, descriptions, index and clusters must be just
+        initialized, index with the size of the saved one; they are
+        replaced by structures which use the mapped file in place, only the
+        nodes of the index and the list of chunks are allocated; slots,
+        free list, offsets of names and descriptions and items of the index
+        are validated first, which reads the pool and the index once, but
+        pages of names are not read and descriptions are apart from names,
+        so their pages are not read until a description is
+        snapshot is set to the mapping which has to be closed by
+        snapshot_close() after the structures are freed, NULL if the file
+        does not exist, then nothing is changed; when only files moved
+        aside by snapshot_save() exist, i.e. after a crash while one was
+        moved, the newest of them is loaded
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    snapshot_close()
+        snapshot may be NULL
+*/
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <stdio.h> /* sscanf only */
+#include <math.h>
+#include <string.h>
+
+#include "tilesource.h"
+#include "map/map.h"
+
+typedef struct {
+    unsigned int headless : 1;
+    unsigned int export : 1;
+    unsigned int bench : 1;
+    unsigned int has_export_markers_area : 1;
+    geo_pos_t center;
+    Uint8 zoom;
+    int width, height;
+    geo_pos_t export_begin, export_end;
+    geo_pos_t export_markers_begin, export_markers_end;
+    tilesource_t tilesource;
+    const char* output_path;
+    const char* import_path;
+    const char* snapshot_path;
+    const char* store_path;
+    const char* write_store_path;
+    const char* export_markers_path;
+} options_t;
+
+int options_parse(options_t* options, int argc, char* argv[]);
+
+/*
+    options_t
+        has to be filled with default values before options_parse()
+
+    options_parse()
+        --headless                render one image without a window
+        --bench                   log marker index, import, snapshot,
+                                  journal, search, nearest markers, store,
+                                  view, export and description timings,
+                                  see bench_marker_index(),
+                                  bench_marker_import(), bench_snapshot(),
+                                  bench_journal(), bench_search(),
+                                  bench_nearest(), bench_store(),
+                                  bench_views(), bench_export() and
+                                  bench_descriptions()
+        --export <lat>,<lon>,<lat>,<lon>
+                                  write the area between two corners at
+                                  --zoom into --output, see export_map()
+        --center <lat>,<lon>      center of the map
+        --zoom <zoom>             zoom level
+        --size <width>x<height>   size of the window or of the image
+        --output <path>           PNG file written in headless mode
+        --import <path>           CSV or GeoJSON file of markers loaded at
+                                  startup, see map_import_markers()
+        --snapshot <path>         markers are loaded from the snapshot
+                                  file and its journal at startup, edits
+                                  are appended to the journal, see
+                                  map_load_snapshot(), map_open_journal()
+        --write-store <path>      markers of --snapshot or --import are
+                                  written into a marker store file, see
+                                  map_write_store()
+        --store <path>            markers are loaded from the store file
+                                  for the area on the screen only,
+                                  instead of --snapshot and --import, see
+                                  map_open_store()
+        --export-markers <path>   markers are written into a CSV, GeoJSON
+                                  or binary file in the background after
+                                  startup, see map_export_markers()
+        --export-markers-area <lat>,<lon>,<lat>,<lon>
+                                  only the markers between two corners
+                                  are written by --export-markers
+        --tile-host <hostname>    tiles are loaded over http from hostname
+        --tile-files              tiles are loaded from local files
+        --tile-path <template>    request or file path, see tilesource_t
+        --tile-token <token>      replaces "{token}" in the path
+        --tile-type <type>        image type of tiles, "JPG" or "PNG"
+        --tile-size <size>        256 or 512, 512 px tiles are requested
+                                  one zoom level lower, "{scale}" of the
+                                  path is replaced by "@2x" for them
+        strings are not copied, argv must be valid while options are used
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h> /* snprintf only */
+
+#include "../config.h"
+
+#define PERF_REPORT_INTERVAL 1000 /* ms */
+
+enum {
+    PERF_FRAMES,
+    PERF_FRAMES_DROPPED,
+    PERF_EVENTS,
+    PERF_EVENTS_COALESCED,
+    PERF_LABEL_RASTERIZATIONS,
+    PERF_TILE_REQUESTS,
+    PERF_TILE_BYTES,
+    PERF_COUNTER_COUNT
+};
+
+void perf_count(int counter, int value);
+Uint64 perf_get_total(int counter);
+Uint64 perf_read(int counter);
+Uint64 perf_now(void);
+double perf_elapsed_ms(Uint64 start);
+void perf_log_time(const char* name, Uint64 start);
+void perf_report(void);
+
+/*
+    perf_count()
+        thread safe, may be called from any thread
+
+    perf_get_total()
+        returns sum of all values reported before the last perf_report()
+
+    perf_read()
+        returns sum of all values counted so far, has to be called from the
+        thread which calls perf_report()
+
+    perf_now()
+        returns timestamp for perf_elapsed_ms()
+
+    perf_log_time()
+        logs time elapsed since start if CONFIG_PERF_LOG is enabled
+
+    perf_report()
+        logs per second rates of all non-zero counters once per
+        PERF_REPORT_INTERVAL if CONFIG_PERF_LOG is enabled
+*/
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define PNGWRITER_BUFFER_SIZE (64*1024)
+
+typedef struct {
+    FILE* file;
+    z_stream stream;
+    Uint8* buffer;
+    Uint32 width, height;
+    Uint32 written_rows;
+} pngwriter_t;
+
+pngwriter_t* pngwriter_open(const char* path, Uint32 width, Uint32 height);
+int pngwriter_write_row(pngwriter_t* pngwriter, const Uint8* row);
+int pngwriter_close(pngwriter_t* pngwriter);
+
+/*
+    pngwriter_t
+        writes 8 bit RGB image row by row, only one compressed buffer is kept
+        in memory, so the size of the image is not limited by memory
+
+    pngwriter_open()
+        returns pointer to pngwriter_t on success
+        returns NULL on error, call SDL_GetError() for more information
+
+    pngwriter_write_row()
+        row - width*3 bytes, R G B
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    pngwriter_close()
+        finishes the file and frees pngwriter, has to be called after error
+        too; the file is not complete if not all rows are written
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+*/
+
+#endif
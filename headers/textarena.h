@@ -0,0 +1,79 @@
+#ifndef TEXTARENA_H
+#define TEXTARENA_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+
+#define TEXTARENA_INITIAL_SIZE 65536
+#define TEXTARENA_EMPTY ((Uint32)-1) /* offset of "" */
+
+typedef struct {
+    char* data;
+    Uint32 size;
+    Uint32 allocated_size;
+    Uint32 released_size;
+    int is_shared;
+    list_t retired_blocks;
+} textarena_t;
+
+void textarena_init(textarena_t* textarena);
+void textarena_init_borrowed(textarena_t* textarena,
+                             char* data,
+                             Uint32 size,
+                             Uint32 released_size);
+void textarena_free(textarena_t* textarena);
+void textarena_clear(textarena_t* textarena);
+int textarena_add(textarena_t* textarena,
+                  const char* text,
+                  size_t length,
+                  Uint32* offset);
+const char* textarena_get(const textarena_t* textarena, Uint32 offset);
+void textarena_release(textarena_t* textarena, size_t length);
+void textarena_share(textarena_t* textarena);
+void textarena_unshare(textarena_t* textarena);
+
+/*
+    textarena_t
+        null terminated strings packed one after another into one block,
+        strings are referenced by 32-bit offsets which stay valid when the
+        block is reallocated; the block doubles when it is full
+        released_size - bytes of strings which are not used any more, they
+        are kept until the arena is freed
+        is_shared - the block is read by other threads, see textarena_share()
+        retired_blocks - char* of owned blocks which were replaced while
+            they were shared, their owner takes and frees them
+
+    textarena_init_borrowed()
+        the arena uses size bytes of strings of data which it does not own,
+        e.g. a mapped file; they are copied when a string is added to a
+        full arena, which a borrowed one always is
+
+    textarena_clear()
+        removes all strings but keeps the allocated memory
+
+    textarena_add()
+        copies length bytes of text, empty strings take no space
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    textarena_get()
+        returns pointer which is valid until the next textarena_add()
+
+    textarena_release()
+        accounts a string of length bytes as unused
+
+    textarena_share()
+        strings are never changed once added, so other threads may read
+        strings of the current block while strings are added; the next
+        growth copies the block instead of reallocating it and moves the
+        old one to retired_blocks; textarena_clear() must not be called
+
+    textarena_unshare()
+        no other thread reads the block any more, so it is reallocated
+        again
+*/
+
+#endif
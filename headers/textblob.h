@@ -0,0 +1,118 @@
+#ifndef TEXTBLOB_H
+#define TEXTBLOB_H
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <stdio.h> /* tmpfile only */
+#include <string.h>
+
+#define TEXTBLOB_EMPTY ((Uint32)-1) /* offset of "" */
+#define TEXTBLOB_BUFFER_SIZE 65536 /* bytes written to the file at once */
+#define TEXTBLOB_WINDOW_SIZE 16384 /* bytes read from the file at once */
+#define TEXTBLOB_WINDOW_COUNT 16
+#define TEXTBLOB_TEXT_MAX (TEXTBLOB_WINDOW_SIZE - 1)
+
+typedef struct {
+    Uint32 offset;
+    Uint32 size;
+    Uint32 used_time;
+    char* data;
+} textblob_window_t;
+
+typedef struct {
+    const char* borrowed;
+    Uint32 borrowed_size;
+    Uint32 file_size;
+    Uint32 size;
+    Uint32 released_size;
+    SDL_RWops* file;
+    char* buffer;
+    textblob_window_t windows[TEXTBLOB_WINDOW_COUNT];
+    Uint32 time;
+    textblob_window_t shared_window;
+    SDL_mutex* mutex;
+} textblob_t;
+
+int textblob_init(textblob_t* textblob);
+void textblob_free(textblob_t* textblob);
+void textblob_borrow(textblob_t* textblob,
+                     const char* data,
+                     Uint32 size,
+                     Uint32 released_size);
+int textblob_add(textblob_t* textblob,
+                 const char* text,
+                 size_t length,
+                 Uint32* offset);
+const char* textblob_get(textblob_t* textblob, Uint32 offset);
+int textblob_read(textblob_t* textblob,
+                  Uint32 offset,
+                  size_t length,
+                  char* text);
+void textblob_release(textblob_t* textblob, size_t length);
+int textblob_write(const textblob_t* textblob, SDL_RWops* file);
+size_t textblob_get_memory(const textblob_t* textblob);
+
+/*
+    textblob_t
+        null terminated strings packed one after another like in
+        textarena_t, but kept out of memory: the first borrowed_size bytes
+        are borrowed, e.g. a mapped file whose pages are read when they are
+        touched, the next file_size bytes are in a temporary file and the
+        rest, less than TEXTBLOB_BUFFER_SIZE, is in buffer until it is
+        written there; so the memory does not depend on the number of
+        strings, for texts which are rarely read, e.g. descriptions
+        size - bytes of all strings, offsets are below it
+        released_size - bytes of strings which are not used any more, they
+            are kept until the blob is freed
+        file - temporary file, created by the first write, removed by
+            textblob_free()
+        windows - the last read parts of the file, up to
+            TEXTBLOB_WINDOW_SIZE bytes each, the least recently used one is
+            read over
+        shared_window - the window of textblob_read()
+        mutex - file, buffer and shared_window are shared with
+            textblob_read()
+
+    textblob_init()
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    textblob_borrow()
+        removes all strings and uses size bytes of strings of data which
+        the blob does not own; strings added later follow them
+
+    textblob_add()
+        copies length bytes of text, at most TEXTBLOB_TEXT_MAX, empty
+        strings take no space
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    textblob_get()
+        reads a string through the windows, so strings which are read one
+        after another, or again, cost one read of the file per window
+        returns pointer which is valid until the next textblob_add() or
+            textblob_get()
+        returns NULL on error, call SDL_GetError() for more information
+
+    textblob_read()
+        copies length bytes of the string at offset and '\0' into text
+        through shared_window; strings are never changed once added, so it
+        may be called by any thread while strings are added
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    textblob_release()
+        accounts a string of length bytes as unused
+
+    textblob_write()
+        writes all size bytes of strings into file, so the data of
+        textblob_borrow() is the same strings at the same offsets
+        returns 0 on success
+        returns non-0 value on error, call SDL_GetError() for more information
+
+    textblob_get_memory()
+        returns number of bytes allocated by the blob, at most
+            TEXTBLOB_BUFFER_SIZE and TEXTBLOB_WINDOW_COUNT + 1 windows
+*/
+
+#endif
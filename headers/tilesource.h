@@ -0,0 +1,65 @@
+#ifndef TILESOURCE_H
+#define TILESOURCE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_Image.h>
+#include <stdlib.h>
+#include <stdio.h> /* snprintf only */
+#include <string.h>
+
+#include "http.h"
+#include "list.h"
+#include "perf.h"
+#include "../config.h"
+
+typedef struct {
+    const char* hostname;
+    const char* path;
+    const char* token;
+    const char* image_type;
+    int tile_size;
+} tilesource_t;
+
+const tilesource_t* tilesource_get_default(void);
+int tilesource_get_zoom_shift(const tilesource_t* tilesource);
+char* tilesource_make_path(const tilesource_t* tilesource,
+                           Uint8 zoom,
+                           Uint32 x,
+                           Uint32 y);
+SDL_Surface* tilesource_load(const tilesource_t* tilesource,
+                             Uint8 zoom,
+                             Uint32 x,
+                             Uint32 y);
+
+/*
+    tilesource_t
+        hostname - NULL if tiles are local files
+        path - template of the request path or of the file path,
+               "{z}", "{x}", "{y}" and "{token}" are replaced, "{scale}"
+               becomes "@2x" for 512 px tiles and "" otherwise
+        image_type - type for IMG_LoadTyped_RW(), e.g. "JPG" or "PNG"
+        tile_size - 256 or 512; a 512 px tile of zoom z - 1 covers the
+                    same ground at the same resolution as four 256 px
+                    tiles of zoom z
+
+    tilesource_get_default()
+        returns source described by CONFIG_TILE_* in config.h
+
+    tilesource_get_zoom_shift()
+        returns log2(tile_size / 256), the difference between the displayed
+        zoom and the zoom of requested tiles
+        returns -1 if tile_size is not supported
+
+    tilesource_make_path()
+        returns path which needs to free on success
+        returns NULL on error, call SDL_GetError() for more information
+
+    tilesource_load()
+        thread safe, http must be initialized for remote sources
+        zoom is the zoom of the requested tile
+        counts PERF_TILE_REQUESTS and PERF_TILE_BYTES
+        returns surface of the tile on success
+        returns NULL on error
+*/
+
+#endif
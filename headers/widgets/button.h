@@ -4,6 +4,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "../fonts.h"
 #include "../isbelong.h"
 #include "../../config.h"
 
@@ -30,17 +31,20 @@ button_t* button_init(const char* text,
                       void* data);
 void button_deinit(button_t* button);
 void button_draw(const button_t* button, SDL_Renderer* renderer, int x, int y);
-void button_handle_event(button_t* button,
-                         const SDL_Event* event,
-                         int x,
-                         int y);
+int button_handle_event(button_t* button,
+                        const SDL_Event* event,
+                        int x,
+                        int y);
 
-/*s
+/*
     SDL ttf must be initialized
 
     button_init()
         returns pointer to button_t on success
         returns NULL on error, call SDL_GetError() for more information
+
+    button_handle_event()
+        returns non-0 value if the button needs to be redrawn
 */
 
 #endif
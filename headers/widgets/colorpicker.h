@@ -17,11 +17,16 @@ void colorpicker_draw(const colorpicker_t* colorpicker,
                       int x,
                       int y,
                       int w);
-void colorpicker_handle_event(colorpicker_t* colorpicker,
-                              const SDL_Event* event,
-                              int x,
-                              int y,
-                              int w);
+int colorpicker_handle_event(colorpicker_t* colorpicker,
+                             const SDL_Event* event,
+                             int x,
+                             int y,
+                             int w);
 SDL_Color colorpicker_get_color(const colorpicker_t* colorpicker);
 
+/*
+    colorpicker_handle_event()
+        returns non-0 value if the colorpicker needs to be redrawn
+*/
+
 #endif
@@ -5,6 +5,7 @@
 #include <SDL2/SDL_ttf.h>
 
 #include "../list.h"
+#include "../glyphcache.h"
 #include "../isbelong.h"
 #include "../../config.h"
 
@@ -12,15 +13,12 @@
 #define EDITFIELD_VERTICAL_INDENT 4
 
 typedef struct {
-    TTF_Font* font;
-    SDL_Texture* hint_texture;
-    SDL_Texture* text_texture;
+    glyphcache_t* glyphcache;
+    char* hint_text;
     list_t text;
     list_t text_characters_sizes;
-    Uint32 hint_texture_width;
-    Uint32 hint_texture_height;
-    Uint32 text_texture_width;
-    Uint32 text_texture_height;
+    int wrap_width;
+    int text_height;
     Uint16 max_text_char_size;
     Uint8 active;
 } editfield_t;
@@ -36,25 +34,28 @@ void editfield_draw(const editfield_t* editfield,
                     int y,
                     int w,
                     int h);
-void editfield_handle_event(editfield_t* editfield,
-                            const SDL_Event* event,
-                            SDL_Renderer* renderer,
-                            int x,
-                            int y,
-                            int w,
-                            int h);
+int editfield_handle_event(editfield_t* editfield,
+                           const SDL_Event* event,
+                           int x,
+                           int y,
+                           int w,
+                           int h);
 const char* editfield_get_text(const editfield_t* editfield);
 
 /*
     SDL ttf must be initialized
 
     editfield_t
+        text is drawn from the shared glyph atlas, only its height is kept
         text - list of char
         text_characters_sizes - list of Uint32
 
     editfield_init()
         returns pointer to editfield_t on success
         returns NULL on error, call SDL_GetError() for more information
+
+    editfield_handle_event()
+        returns non-0 value if the editfield needs to be redrawn
 */
 
 #endif
@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include "../list.h"
+#include "../glyphcache.h"
 #include "../isbelong.h"
 #include "../../config.h"
 
@@ -13,14 +14,11 @@
 #define EDITLINE_VERTICAL_INDENT 3
 
 typedef struct {
-    TTF_Font* font;
-    SDL_Texture* hint_texture;
-    SDL_Texture* text_texture;
+    glyphcache_t* glyphcache;
+    char* hint_text;
     list_t text;
     list_t text_characters_sizes;
-    Uint32 hint_texture_width;
-    Uint32 text_texture_width;
-    Uint32 text_texture_height;
+    int text_width;
     Uint16 max_text_char_size;
     Uint8 active;
 } editline_t;
@@ -34,24 +32,27 @@ void editline_draw(const editline_t* editline,
                    int x,
                    int y,
                    int w);
-void editline_handle_event(editline_t* editline,
-                           const SDL_Event* event,
-                           SDL_Renderer* renderer,
-                           int x,
-                           int y,
-                           int w);
+int editline_handle_event(editline_t* editline,
+                          const SDL_Event* event,
+                          int x,
+                          int y,
+                          int w);
 const char* editline_get_text(const editline_t* editline);
 
 /*
     SDL ttf must be initialized
 
     editline_t
+        text is drawn from the shared glyph atlas, only its width is kept
         text - list of char
         text_characters_sizes - list of Uint32
 
     editline_init()
         returns pointer to editline_t on success
         returns NULL on error, call SDL_GetError() for more information
+
+    editline_handle_event()
+        returns non-0 value if the editline needs to be redrawn
 */
 
 #endif
@@ -0,0 +1,67 @@
+#ifndef LABELCACHE_H
+#define LABELCACHE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../glyphcache.h"
+#include "../perf.h"
+#include "../../config.h"
+
+#define LABELCACHE_CAPACITY 32
+
+typedef struct {
+    const void* key;
+    int wrap_width;
+    char* text;
+    SDL_Texture* texture;
+    int w, h;
+    Uint32 last_use;
+} label_t;
+
+typedef struct {
+    SDL_Renderer* renderer;
+    glyphcache_t* glyphcache;
+    label_t labels[LABELCACHE_CAPACITY];
+    int label_count;
+    Uint32 use_counter;
+} labelcache_t;
+
+labelcache_t* labelcache_init(SDL_Renderer* renderer,
+                              const char* font_path,
+                              int font_size);
+void labelcache_deinit(labelcache_t* labelcache);
+const label_t* labelcache_get(labelcache_t* labelcache,
+                              const void* key,
+                              const char* text,
+                              int wrap_width);
+void labelcache_clear(labelcache_t* labelcache);
+
+/*
+    SDL ttf must be initialized
+
+    label_t
+        texture holds the text with the background and the border,
+        w and h are sizes of the texture
+
+    labelcache_t
+        least recently used labels are replaced when the cache is full,
+        the font is the same for all labels of one cache
+
+    labelcache_init()
+        returns pointer to labelcache_t on success
+        returns NULL on error, call SDL_GetError() for more information
+
+    labelcache_get()
+        key identifies the owner of the label (e.g. a marker), the label
+        is rasterized again only if the text or the wrap_width changed
+        returns the label on success, it is valid until the next call
+        returns NULL on error, call SDL_GetError() for more information
+
+    labelcache_clear()
+        destroys all labels, must be called if keys become invalid
+*/
+
+#endif
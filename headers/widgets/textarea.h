@@ -3,32 +3,36 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <string.h>
+
+#include "../list.h"
+#include "../glyphcache.h"
 #include "../../config.h"
 
 typedef struct {
-    TTF_Font* font;
-    SDL_Texture* text_texture;
+    glyphcache_t* glyphcache;
+    list_t text;
+    int wrap_width;
     int w, h;
 } textarea_t;
 
-textarea_t* textarea_init(void);
+textarea_t* textarea_init(SDL_Renderer* renderer);
 void textarea_deinit(textarea_t* textarea);
-void textarea_draw(const textarea_t* textarea,
-                   SDL_Renderer* renderer,
-                   int x,
-                   int y,
-                   int h);
-void textarea_set_text(textarea_t* textarea,
-                       SDL_Renderer* renderer,
-                       const char* text,
-                       int w);
+void textarea_draw(const textarea_t* textarea, int x, int y, int h);
+void textarea_set_text(textarea_t* textarea, const char* text, int w);
 
 /*
     SDL ttf must be initialized
 
+    textarea_t
+        text - list of char, copy of the last text set
+
     textarea_init()
         returns pointer to textarea_t on success
         returns NULL on error, call SDL_GetError() for more information
+
+    textarea_set_text()
+        does nothing if the text and the width are the same as the last ones
 */
 
 #endif
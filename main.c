@@ -1,10 +1,17 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_Image.h>
 #include <SDL2/SDL_ttf.h>
-#include <windows.h>
 #include <stdlib.h>
 
 #include "headers/http.h"
+#include "headers/bench.h"
+#include "headers/export.h"
+#include "headers/fonts.h"
+#include "headers/glyphcache.h"
+#include "headers/headless.h"
+#include "headers/options.h"
+#include "headers/perf.h"
+#include "headers/tilesource.h"
 #include "headers/map/map.h"
 
 const char   TITLE[7]              = "DS GIS";
@@ -13,45 +20,214 @@ const int    INITIAL_WINDOW_HEIGHT = 400;
 const double INITIAL_LATITUDE      = 62.779147;
 const double INITIAL_LONGITUDE     = 40.334442;
 const Uint8  INITIAL_ZOOM          = 15;
+const int    DEFAULT_REFRESH_RATE  = 60;
+const char   DEFAULT_OUTPUT_PATH[] = "map.png";
 
-int init(SDL_Window** window, SDL_Renderer** renderer, map_t** map);
+int init(const options_t* options,
+         SDL_Window** window,
+         SDL_Renderer** renderer,
+         map_t** map);
 void deinit(SDL_Window* window, SDL_Renderer* renderer, map_t* map);
+double get_frame_budget(SDL_Window* window);
 
 int main(int argc, char* argv[]) {
+    options_t options = {
+        .headless = 0,
+        .export = 0,
+        .bench = 0,
+        .has_export_markers_area = 0,
+        .center = { INITIAL_LATITUDE, INITIAL_LONGITUDE },
+        .zoom = INITIAL_ZOOM,
+        .width = INITIAL_WINDOW_WIDTH,
+        .height = INITIAL_WINDOW_HEIGHT,
+        .tilesource = *tilesource_get_default(),
+        .output_path = DEFAULT_OUTPUT_PATH,
+        .import_path = NULL,
+        .snapshot_path = NULL,
+        .store_path = NULL,
+        .write_store_path = NULL,
+        .export_markers_path = NULL
+    };
+    if (options_parse(&options, argc, argv)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.bench) {
+        int error = bench_marker_index()
+            || bench_marker_import()
+            || bench_snapshot()
+            || bench_journal()
+            || bench_search()
+            || bench_nearest()
+            || bench_store()
+            || bench_views()
+            || bench_export()
+            || bench_descriptions();
+        if (error) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
+        return 0;
+    }
+
+    if (options.export) {
+        if (export_map(&options)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
+        return 0;
+    }
+
+    if (options.headless) {
+        if (headless_render(&options)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
+        return 0;
+    }
+
     SDL_Window* window = NULL;
     SDL_Renderer* renderer = NULL;
     map_t* map = NULL;
-    if (init(&window, &renderer, &map)) {
-        MessageBox(GetActiveWindow(), SDL_GetError(), NULL, MB_OK);
+    Uint64 startup_start = perf_now();
+    if (init(&options, &window, &renderer, &map)) {
+        SDL_ShowSimpleMessageBox(
+            SDL_MESSAGEBOX_ERROR, TITLE, SDL_GetError(), NULL);
         exit(EXIT_FAILURE);
     }
+    perf_log_time("startup", startup_start);
+
+    /* the map is usable without the markers, so the error is only logged */
+    Uint64 snapshot_start = perf_now();
+    if (options.snapshot_path != NULL) {
+        int error = map_load_snapshot(map, options.snapshot_path)
+            || map_open_journal(map, options.snapshot_path);
+        if (error)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        perf_log_time("snapshot loading", snapshot_start);
+    }
+    if (options.import_path != NULL &&
+            map_import_markers(map, options.import_path))
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+    if (options.write_store_path != NULL &&
+            map_write_store(map, options.write_store_path))
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+    if (options.store_path != NULL &&
+            map_open_store(map, options.store_path))
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+    if (options.export_markers_path != NULL) {
+        int has_area = options.has_export_markers_area;
+        int error = map_export_markers(
+            map,
+            options.export_markers_path,
+            has_area ? &options.export_markers_begin : NULL,
+            has_area ? &options.export_markers_end : NULL
+        );
+        if (error)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+    }
 
-    int window_width = INITIAL_WINDOW_WIDTH;
-    int window_height = INITIAL_WINDOW_HEIGHT;
+    int window_width = options.width;
+    int window_height = options.height;
+    double frame_budget = get_frame_budget(window);
+    int quit = 0;
+    int is_animated = 0;
 
-    int event_received_successfully;
+    int event_received_successfully = 1;
     SDL_Event event;
-    while (event_received_successfully = SDL_WaitEvent(&event)) {
+    while (!quit) {
+        /* while the map is animated the loop wakes up every frame */
+        int event_received;
+        if (is_animated) {
+            event_received = SDL_WaitEventTimeout(&event, frame_budget);
+        } else {
+            event_received = SDL_WaitEvent(&event);
+            event_received_successfully = event_received;
+            if (!event_received_successfully)
+                break;
+        }
+
+        Uint64 frame_start = perf_now();
         SDL_Rect map_area = { 0, 0, window_width, window_height };
-        map_handle_event(map, &event, renderer, map_area);
-
-        if (event.type == SDL_QUIT) {
-            break;
-        } else if (event.type == SDL_WINDOWEVENT) {
-            if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-                window_width = event.window.data1;
-                window_height = event.window.data2;
+        int redraw = 0;
+
+        /*
+            drain the queue before drawing, consecutive mouse motions are
+            merged into one event so a fast drag results in one move_to()
+        */
+        SDL_Event motion;
+        int motion_pending = 0;
+        for (; event_received; event_received = SDL_PollEvent(&event)) {
+            perf_count(PERF_EVENTS, 1);
+
+            if (event.type == SDL_MOUSEMOTION) {
+                if (motion_pending &&
+                        motion.motion.state == event.motion.state) {
+                    motion.motion.x = event.motion.x;
+                    motion.motion.y = event.motion.y;
+                    motion.motion.xrel += event.motion.xrel;
+                    motion.motion.yrel += event.motion.yrel;
+                    perf_count(PERF_EVENTS_COALESCED, 1);
+                    continue;
+                }
+                if (motion_pending) {
+                    redraw |=
+                        map_handle_event(map, &motion, renderer, map_area);
+                }
+                motion = event;
+                motion_pending = 1;
+                continue;
+            }
+
+            if (motion_pending) {
+                redraw |= map_handle_event(map, &motion, renderer, map_area);
+                motion_pending = 0;
+            }
+
+            redraw |= map_handle_event(map, &event, renderer, map_area);
+
+            if (event.type == SDL_QUIT) {
+                quit = 1;
+                break;
+            } else if (event.type == SDL_WINDOWEVENT) {
+                /* focus, enter and leave change nothing on the screen */
+                Uint8 window_event = event.window.event;
+                if (window_event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    window_width = event.window.data1;
+                    window_height = event.window.data2;
+                    map_area.w = window_width;
+                    map_area.h = window_height;
+                    frame_budget = get_frame_budget(window);
+                }
+                if (window_event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                        window_event == SDL_WINDOWEVENT_EXPOSED ||
+                        window_event == SDL_WINDOWEVENT_RESTORED)
+                    redraw = 1;
             }
         }
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        SDL_RenderClear(renderer);
-        map_draw(map, map_area);
-        SDL_RenderPresent(renderer);
+        if (motion_pending)
+            redraw |= map_handle_event(map, &motion, renderer, map_area);
+        is_animated = map_update(map);
+        redraw |= is_animated;
+
+        if (!quit && redraw) {
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+            SDL_RenderClear(renderer);
+            map_draw(map, map_area);
+            SDL_RenderPresent(renderer);
+
+            perf_count(PERF_FRAMES, 1);
+            if (perf_elapsed_ms(frame_start) > frame_budget)
+                perf_count(PERF_FRAMES_DROPPED, 1);
+        }
+        perf_report();
     }
 
     if (!event_received_successfully) {
-        MessageBox(GetActiveWindow(), SDL_GetError(), NULL, MB_OK);
+        SDL_ShowSimpleMessageBox(
+            SDL_MESSAGEBOX_ERROR, TITLE, SDL_GetError(), window);
         deinit(window, renderer, map);
         exit(EXIT_FAILURE);
     }
@@ -60,7 +236,10 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
-int init(SDL_Window** window, SDL_Renderer** renderer, map_t** map) {
+int init(const options_t* options,
+         SDL_Window** window,
+         SDL_Renderer** renderer,
+         map_t** map) {
     if (SDL_Init(SDL_INIT_VIDEO))
         return 1;
 
@@ -74,24 +253,27 @@ int init(SDL_Window** window, SDL_Renderer** renderer, map_t** map) {
         SDL_SetError(TTF_GetError());
         IMG_Quit();
         SDL_Quit();
+        return 1;
     }
 
     *window = SDL_CreateWindow(
         TITLE,
         SDL_WINDOWPOS_UNDEFINED,
         SDL_WINDOWPOS_UNDEFINED,
-        INITIAL_WINDOW_WIDTH,
-        INITIAL_WINDOW_HEIGHT,
+        options->width,
+        options->height,
         SDL_WINDOW_MAXIMIZED | SDL_WINDOW_RESIZABLE);
-    if (window == NULL) {
+    if (*window == NULL) {
         TTF_Quit();
         IMG_Quit();
         SDL_Quit();
         return 1;
     }
 
+    /* textures are scaled while zoom is animated */
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
     *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_ACCELERATED);
-    if (renderer == NULL) {
+    if (*renderer == NULL) {
         SDL_DestroyWindow(*window);
         TTF_Quit();
         IMG_Quit();
@@ -108,12 +290,18 @@ int init(SDL_Window** window, SDL_Renderer** renderer, map_t** map) {
         return 1;
     }
 
-    geo_pos_t map_center = { INITIAL_LATITUDE, INITIAL_LONGITUDE };
-    *map = map_init(*renderer, map_center, INITIAL_ZOOM);
+    *map = map_init(
+        *renderer,
+        &options->tilesource,
+        options->center,
+        options->zoom
+    );
     if (*map == NULL) {
         http_deinit();
+        glyphcache_deinit();
         SDL_DestroyRenderer(*renderer);
         SDL_DestroyWindow(*window);
+        fonts_deinit();
         TTF_Quit();
         IMG_Quit();
         SDL_Quit();
@@ -123,11 +311,25 @@ int init(SDL_Window** window, SDL_Renderer** renderer, map_t** map) {
     return 0;
 }
 
+double get_frame_budget(SDL_Window* window) {
+    /* frame which takes longer than one refresh period is counted dropped */
+    SDL_DisplayMode mode;
+    int display = SDL_GetWindowDisplayIndex(window);
+    int refresh_rate = DEFAULT_REFRESH_RATE;
+    int mode_received = display >= 0
+        && !SDL_GetCurrentDisplayMode(display, &mode);
+    if (mode_received && mode.refresh_rate > 0)
+        refresh_rate = mode.refresh_rate;
+    return 1000.0 / refresh_rate;
+}
+
 void deinit(SDL_Window* window, SDL_Renderer* renderer, map_t* map) {
     map_deinit(map);
     http_deinit();
+    glyphcache_deinit();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
+    fonts_deinit();
     TTF_Quit();
     IMG_Quit();
     SDL_Quit();
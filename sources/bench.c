@@ -0,0 +1,1808 @@
+#include "../headers/bench.h"
+
+#define RESULT_LIST_ALLOCATION_PORTION (1024*sizeof(Uint32))
+#define TEXT_LIST_ALLOCATION_PORTION (1024*1024)
+#define HANDLES_LIST_ALLOCATION_PORTION (1024*sizeof(marker_handle_t))
+#define DESCRIPTION_LENGTH_MIN 64
+#define DESCRIPTION_LENGTH_MAX 1023
+#define RANDOM_SEED 2463534242 /* the same sequence on every run */
+#define AREA_SIZE \
+    (BENCH_AREA_TILES * MAP_TILE_SIZE * (1 << MAP_MAX_ZOOM-BENCH_ZOOM))
+
+typedef struct {
+    Uint32 area_x, area_y;
+    Uint32 area_size;
+    int has_color;
+    size_t (*get_description)(Uint32 number, char* description);
+    Uint32 random_state;
+} marker_fixture_t;
+
+typedef struct {
+    markerviews_t* views;
+    SDL_atomic_t* is_stopped;
+    Uint64 view_count;
+    Uint64 marker_count;
+    int has_failed;
+} view_reader_t;
+
+typedef struct {
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    list_t columns[MAP_GRID_SIZE];
+    Uint64 text_size;
+    Uint64 description_size;
+} store_pan_t;
+
+typedef struct {
+    const markerview_t* view;
+    Uint32 world_size;
+    Uint32 index;
+    Uint64 count;
+    int has_failed;
+} export_check_t;
+
+static const Uint32 MARKER_COUNTS[] = { 10000, 100000, 1000000 };
+static const char* const SEARCH_QUERIES[] = {
+    "ma", "marker", "ker 5", "4242", "marker 123456"
+};
+
+static int bench_grid_fill(Uint32 marker_count);
+static void init_marker_fixture(marker_fixture_t* fixture,
+                                Uint32 area_size,
+                                int has_color,
+                                size_t (*get_description)(Uint32, char*));
+static int add_random_markers(marker_fixture_t* fixture,
+                              Uint32 marker_count,
+                              markerpool_t* markers,
+                              textarena_t* texts,
+                              textblob_t* descriptions,
+                              quadtree_t* quadtree);
+static int add_random_marker(marker_fixture_t* fixture,
+                             Uint32 number,
+                             markerpool_t* markers,
+                             textarena_t* texts,
+                             textblob_t* descriptions,
+                             marker_t* marker,
+                             marker_handle_t* handle);
+static void get_random_position(marker_fixture_t* fixture,
+                                Uint32* x,
+                                Uint32* y);
+static int query_grid(const quadtree_t* quadtree,
+                      list_t* result,
+                      size_t* found_count);
+static int bench_clusters(const markerpool_t* markers);
+static int bench_journal_reopen(Uint32 marker_count);
+static int bench_search_query(const searchindex_t* searchindex,
+                              const markerpool_t* markers,
+                              const textarena_t* texts,
+                              textblob_t* descriptions,
+                              const char* query);
+static int check_nearest(const pix_pos_t* positions,
+                         geodesic_origin_t* origin,
+                         const list_t* nearest,
+                         double* scan_time);
+static int read_store_grid(const markerstore_t* store,
+                           Uint32* marker_count,
+                           Uint64* byte_count);
+static int pan_store_grid(const markerstore_t* store,
+                          Uint32* step_count,
+                          Uint32* max_marker_count,
+                          Uint64* max_size);
+static int load_store_column(const markerstore_t* store,
+                             store_pan_t* pan,
+                             Uint32 x,
+                             Uint32 y);
+static void evict_store_column(store_pan_t* pan, Uint32 x);
+static int is_store_packed(const store_pan_t* pan);
+static int run_view_readers(int reader_count,
+                            double* time,
+                            view_reader_t* total);
+static int run_view_edits(markerpool_t* markers,
+                          textarena_t* texts,
+                          textblob_t* descriptions,
+                          markerviews_t* views,
+                          int is_read,
+                          double* time);
+static int read_views(void* ptr_reader); /* SDL_ThreadFunction */
+static int is_view_consistent(const markerview_t* view, Uint64* count);
+static int add_export_markers(markerpool_t* markers,
+                              textarena_t* texts,
+                              textblob_t* descriptions);
+static size_t get_export_description(Uint32 number, char* description);
+static int export_format(const markerview_t* view,
+                         markerexport_format_t format,
+                         const char* extension,
+                         const SDL_Rect* area,
+                         Uint64* count);
+static int save_progress(void* ptr_progress,
+                         const markerexport_progress_t* progress);
+static int check_export(const markerview_t* view, const char* extension);
+static int check_records(void* ptr_check, const markerimport_part_t* part);
+static int check_binary_export(const markerview_t* view);
+static int add_described_markers(markerpool_t* markers,
+                                 textarena_t* texts,
+                                 textblob_t* descriptions);
+static size_t get_description(Uint32 number, char* description);
+static int read_descriptions(const markerpool_t* markers,
+                             textblob_t* descriptions,
+                             double* scan_time,
+                             double* open_time);
+static int check_description(const markerpool_t* markers,
+                             textblob_t* descriptions,
+                             Uint32 index);
+static int bench_import_format(markerimport_format_t format);
+static int generate_import_text(markerimport_format_t format, list_t* text);
+static int count_records(void* ptr_count, const markerimport_part_t* part);
+static Uint32 get_random(Uint32* state);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int bench_marker_index(void) {
+    int count = sizeof(MARKER_COUNTS) / sizeof(MARKER_COUNTS[0]);
+    for (int i = 0; i < count; i++) {
+        if (bench_grid_fill(MARKER_COUNTS[i]))
+            return 1;
+    }
+    return 0;
+}
+
+int bench_marker_import(void) {
+    if (bench_import_format(MARKERIMPORT_CSV))
+        return 1;
+    return bench_import_format(MARKERIMPORT_GEOJSON);
+}
+
+int bench_snapshot(void) {
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    quadtree_t quadtree;
+    clusters_t clusters;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    clusters_init(&clusters, MAP_MAX_ZOOM);
+    int error = quadtree_init(&quadtree, world_size);
+    error = textblob_init(&descriptions) || error;
+
+    /* the rebuild is what startup would cost without the snapshot */
+    marker_fixture_t fixture;
+    init_marker_fixture(&fixture, AREA_SIZE, 0, NULL);
+    Uint64 start = perf_now();
+    if (!error) {
+        error = add_random_markers(
+            &fixture,
+            BENCH_SNAPSHOT_MARKER_COUNT,
+            &markers,
+            &texts,
+            NULL,
+            &quadtree
+        ) || clusters_build(&clusters, &markers);
+    }
+    double rebuild_time = perf_elapsed_ms(start);
+
+    start = perf_now();
+    if (!error) {
+        error = snapshot_save(
+            BENCH_SNAPSHOT_PATH,
+            &markers,
+            &texts,
+            &descriptions,
+            &quadtree,
+            &clusters,
+            0
+        );
+    }
+    double save_time = perf_elapsed_ms(start);
+    quadtree_free(&quadtree);
+    clusters_free(&clusters);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    if (error)
+        return 1;
+
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    clusters_init(&clusters, MAP_MAX_ZOOM);
+    error = quadtree_init(&quadtree, world_size);
+    error = textblob_init(&descriptions) || error;
+    snapshot_t* snapshot = NULL;
+    start = perf_now();
+    if (!error) {
+        error = snapshot_load(
+            BENCH_SNAPSHOT_PATH,
+            &snapshot,
+            &markers,
+            &texts,
+            &descriptions,
+            &quadtree,
+            &clusters
+        );
+    }
+    double load_time = perf_elapsed_ms(start);
+    if (!error && snapshot == NULL) {
+        SDL_SetError("snapshot is not written\n%s()", __func__);
+        error = 1;
+    }
+
+    /* the first queries read the pages of the file they touch */
+    list_t result;
+    list_init(&result, RESULT_LIST_ALLOCATION_PORTION);
+    size_t found_count = 0;
+    start = perf_now();
+    if (!error)
+        error = query_grid(&quadtree, &result, &found_count);
+    double query_time = perf_elapsed_ms(start);
+
+    if (!error) {
+        SDL_Log(
+            "%u markers: rebuilt in %.0f ms, snapshot saved in %.0f ms, "
+            "loaded in %.2f ms, first grid fill %.2f ms (%zu markers)",
+            BENCH_SNAPSHOT_MARKER_COUNT,
+            rebuild_time,
+            save_time,
+            load_time,
+            query_time,
+            found_count
+        );
+    }
+
+    list_free(&result);
+    quadtree_free(&quadtree);
+    clusters_free(&clusters);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    snapshot_close(snapshot);
+    remove(BENCH_SNAPSHOT_PATH);
+    return error;
+}
+
+int bench_journal(void) {
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    quadtree_t quadtree;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    int error = quadtree_init(&quadtree, world_size);
+    error = textblob_init(&descriptions) || error;
+
+    /* edits go through the pool and the index like map_add_marker() */
+    remove(BENCH_SNAPSHOT_PATH);
+    remove(BENCH_SNAPSHOT_PATH ".journal");
+    Uint32 replayed_count;
+    journal_t* journal = NULL;
+    if (!error) {
+        journal = journal_open(
+            BENCH_SNAPSHOT_PATH,
+            0,
+            MAP_MAX_ZOOM,
+            &markers,
+            &texts,
+            &descriptions,
+            &quadtree,
+            &replayed_count
+        );
+        error = journal == NULL;
+    }
+    marker_fixture_t fixture;
+    init_marker_fixture(&fixture, AREA_SIZE, 0, NULL);
+    double edit_max_time = 0;
+    Uint64 start = perf_now();
+    for (Uint32 i = 0; !error && i < BENCH_JOURNAL_EDIT_COUNT; i++) {
+        Uint64 edit_start = perf_now();
+        marker_t marker;
+        marker_handle_t handle;
+        error = add_random_marker(
+            &fixture, i, &markers, &texts, NULL, &marker, &handle)
+            || quadtree_insert(&quadtree, marker.x, marker.y, handle.index)
+            || journal_add(
+                journal,
+                handle.index,
+                &marker,
+                textarena_get(&texts, marker.name),
+                ""
+            );
+        double edit_time = perf_elapsed_ms(edit_start);
+        if (edit_time > edit_max_time)
+            edit_max_time = edit_time;
+    }
+    double edit_time = perf_elapsed_ms(start);
+
+    start = perf_now();
+    if (!error)
+        error = journal_sync(journal);
+    double sync_time = perf_elapsed_ms(start);
+    journal_close(journal);
+    Uint32 marker_count = markers.count;
+    quadtree_free(&quadtree);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+
+    if (!error) {
+        SDL_Log(
+            "journal: %u edits in %.0f ms, %.2f us per edit, %.2f ms at "
+            "most, written %.0f ms after the last one",
+            BENCH_JOURNAL_EDIT_COUNT,
+            edit_time,
+            edit_time * 1000 / BENCH_JOURNAL_EDIT_COUNT,
+            edit_max_time,
+            sync_time
+        );
+        error = bench_journal_reopen(marker_count);
+    }
+    remove(BENCH_SNAPSHOT_PATH);
+    remove(BENCH_SNAPSHOT_PATH ".journal");
+    return error;
+}
+
+int bench_search(void) {
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    quadtree_t quadtree;
+    searchindex_t searchindex;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    searchindex_init(&searchindex);
+    int error = quadtree_init(&quadtree, (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE);
+    error = textblob_init(&descriptions) || error;
+    marker_fixture_t fixture;
+    init_marker_fixture(&fixture, AREA_SIZE, 0, NULL);
+    if (!error) {
+        error = add_random_markers(
+            &fixture,
+            BENCH_SEARCH_MARKER_COUNT,
+            &markers,
+            &texts,
+            NULL,
+            &quadtree
+        );
+    }
+
+    /* the build after a snapshot load against edits of an open map */
+    Uint64 start = perf_now();
+    if (!error)
+        error = searchindex_build(
+            &searchindex, &markers, &texts, &descriptions);
+    double build_time = perf_elapsed_ms(start);
+    start = perf_now();
+    for (Uint32 i = 0; !error && i < BENCH_SEARCH_ADD_COUNT; i++) {
+        char name[32];
+        marker_t marker = {
+            .name_length = snprintf(name, sizeof(name), "added %u", i),
+            .description = TEXTBLOB_EMPTY
+        };
+        marker_handle_t handle;
+        error = textarena_add(&texts, name, marker.name_length, &marker.name)
+            || markerpool_add(&markers, &marker, &handle)
+            || searchindex_add(
+                &searchindex, handle.index, name, marker.name_length, "", 0);
+    }
+    double add_time = perf_elapsed_ms(start);
+    if (!error) {
+        SDL_Log(
+            "search: index of %u markers built in %.0f ms, %.2f us per "
+            "added marker",
+            BENCH_SEARCH_MARKER_COUNT,
+            build_time,
+            add_time * 1000 / BENCH_SEARCH_ADD_COUNT
+        );
+    }
+
+    int count = sizeof(SEARCH_QUERIES) / sizeof(SEARCH_QUERIES[0]);
+    for (int i = 0; !error && i < count; i++) {
+        error = bench_search_query(
+            &searchindex,
+            &markers,
+            &texts,
+            &descriptions,
+            SEARCH_QUERIES[i]
+        );
+    }
+
+    searchindex_free(&searchindex);
+    quadtree_free(&quadtree);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    return error;
+}
+
+int bench_nearest(void) {
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    Uint32 area_size = world_size >> BENCH_NEAREST_AREA_ZOOM;
+    double lat_radian = BENCH_NEAREST_LATITUDE * M_PI/180;
+    double center_x = (BENCH_NEAREST_LONGITUDE + 180)/360 * world_size;
+    double center_y = (1 - asinh(tan(lat_radian))/M_PI) / 2 * world_size;
+
+    /* the area is moved from the middle of the world to the latitude */
+    marker_fixture_t fixture;
+    init_marker_fixture(&fixture, area_size, 0, NULL);
+    fixture.area_x = center_x - area_size/2;
+    fixture.area_y = center_y - area_size/2;
+
+    quadtree_t quadtree;
+    int error = quadtree_init(&quadtree, world_size);
+    pix_pos_t* positions =
+        malloc(BENCH_NEAREST_MARKER_COUNT * sizeof(pix_pos_t));
+    if (positions == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        error = 1;
+    }
+    for (Uint32 i = 0; !error && i < BENCH_NEAREST_MARKER_COUNT; i++) {
+        get_random_position(&fixture, &positions[i].x, &positions[i].y);
+        error = quadtree_insert(
+            &quadtree, positions[i].x, positions[i].y, i);
+    }
+
+    /* queries fall into the middle half of the area in degrees */
+    list_t nearest;
+    list_init(&nearest, BENCH_NEAREST_COUNT * sizeof(quadtree_neighbor_t));
+    double lon_range = 360.0 / (1 << BENCH_NEAREST_AREA_ZOOM) / 2;
+    double lat_range = lon_range * cos(lat_radian);
+    double query_time = 0;
+    double query_max_time = 0;
+    double scan_time = 0;
+    for (Uint32 i = 0; !error && i < BENCH_NEAREST_QUERY_COUNT; i++) {
+        double lat = BENCH_NEAREST_LATITUDE
+            + (get_random(&fixture.random_state) / 4294967296.0 - 0.5)
+                * lat_range;
+        double lon = BENCH_NEAREST_LONGITUDE
+            + (get_random(&fixture.random_state) / 4294967296.0 - 0.5)
+                * lon_range;
+        geodesic_origin_t origin;
+        geodesic_init_origin(&origin, lat, lon, world_size);
+        list_clear(&nearest);
+        Uint64 start = perf_now();
+        error = quadtree_find_nearest(
+            &quadtree,
+            BENCH_NEAREST_COUNT,
+            geodesic_get_distance,
+            &origin,
+            &nearest
+        );
+        double time = perf_elapsed_ms(start);
+        query_time += time;
+        if (time > query_max_time)
+            query_max_time = time;
+        if (!error && i < BENCH_NEAREST_CHECK_COUNT)
+            error = check_nearest(positions, &origin, &nearest, &scan_time);
+    }
+
+    if (!error) {
+        SDL_Log(
+            "nearest: %u of %u markers at %.1f N in %.1f us per query, "
+            "%.1f us at most, full scan %.0f ms",
+            BENCH_NEAREST_COUNT,
+            BENCH_NEAREST_MARKER_COUNT,
+            BENCH_NEAREST_LATITUDE,
+            query_time * 1000 / BENCH_NEAREST_QUERY_COUNT,
+            query_max_time * 1000,
+            scan_time / BENCH_NEAREST_CHECK_COUNT
+        );
+    }
+    list_free(&nearest);
+    free(positions);
+    quadtree_free(&quadtree);
+    return error;
+}
+
+int bench_store(void) {
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    marker_fixture_t fixture;
+    init_marker_fixture(
+        &fixture,
+        world_size >> BENCH_STORE_AREA_ZOOM,
+        1,
+        get_export_description
+    );
+    int error = textblob_init(&descriptions)
+        || add_random_markers(
+            &fixture,
+            BENCH_STORE_MARKER_COUNT,
+            &markers,
+            &texts,
+            &descriptions,
+            NULL
+        );
+
+    Uint64 start = perf_now();
+    if (!error) {
+        error = markerstore_write(
+            BENCH_STORE_PATH,
+            MAP_STORE_ZOOM,
+            world_size,
+            &markers,
+            &texts,
+            &descriptions
+        );
+    }
+    double write_time = perf_elapsed_ms(start);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    if (error)
+        return 1;
+
+    start = perf_now();
+    markerstore_t* store = markerstore_open(BENCH_STORE_PATH, world_size);
+    double open_time = perf_elapsed_ms(start);
+    error = store == NULL;
+
+    /* the first reads come from the page cache which the write filled */
+    Uint32 marker_count = 0;
+    Uint64 byte_count = 0;
+    start = perf_now();
+    if (!error)
+        error = read_store_grid(store, &marker_count, &byte_count);
+    double read_time = perf_elapsed_ms(start);
+
+    Uint32 step_count = 0;
+    Uint32 max_marker_count = 0;
+    Uint64 max_size = 0;
+    start = perf_now();
+    if (!error) {
+        error = pan_store_grid(
+            store, &step_count, &max_marker_count, &max_size);
+    }
+    double pan_time = perf_elapsed_ms(start);
+
+    if (!error) {
+        const markerstore_partition_t* last =
+            &store->partitions[store->partition_count - 1];
+        SDL_Log(
+            "store: %u markers written in %.0f ms, %llu bytes; directory "
+            "of %u partitions opened in %.2f ms, %zu bytes; grid of %u "
+            "markers read in %.2f ms, %llu bytes",
+            BENCH_STORE_MARKER_COUNT,
+            write_time,
+            (unsigned long long)(last->offset + last->size),
+            store->partition_count,
+            open_time,
+            store->partition_count * sizeof(markerstore_partition_t),
+            marker_count,
+            read_time,
+            (unsigned long long)byte_count
+        );
+        SDL_Log(
+            "store: grid moved %u partitions in %.0f ms, at most %u "
+            "markers and %llu bytes of their texts",
+            step_count,
+            pan_time,
+            max_marker_count,
+            (unsigned long long)max_size
+        );
+    }
+    markerstore_close(store);
+    remove(BENCH_STORE_PATH);
+    return error;
+}
+
+int bench_views(void) {
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    double alone_time = 0;
+    int error = textblob_init(&descriptions)
+        || run_view_edits(
+            &markers, &texts, &descriptions, NULL, 0, &alone_time);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+
+    /* copies of shared chunks are timed apart from the readers */
+    double withdrawn_time = 0;
+    double read_time = 0;
+    view_reader_t total = { NULL, NULL, 0, 0, 0 };
+    if (!error)
+        error = run_view_readers(0, &withdrawn_time, &total);
+    if (!error)
+        error = run_view_readers(
+            BENCH_VIEWS_READER_COUNT, &read_time, &total);
+
+    if (!error) {
+        SDL_Log(
+            "views: %u edits in %.0f ms alone, %.0f ms withdrawing the "
+            "view every %u edits, %.0f ms publishing it for %u readers; "
+            "%llu views, %.1f M markers read",
+            BENCH_VIEWS_EDIT_COUNT,
+            alone_time,
+            withdrawn_time,
+            BENCH_VIEWS_PUBLISH_PERIOD,
+            read_time,
+            BENCH_VIEWS_READER_COUNT,
+            (unsigned long long)total.view_count,
+            total.marker_count / 1e6
+        );
+    }
+    return error;
+}
+
+int bench_export(void) {
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    markerviews_t views;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    markerviews_init(&views);
+    int error = textblob_init(&descriptions)
+        || add_export_markers(&markers, &texts, &descriptions)
+        || markerviews_publish(&views, &markers, &texts, &descriptions);
+    markerview_reader_t* reader = NULL;
+    if (!error) {
+        reader = markerviews_acquire(&views);
+        error = reader == NULL;
+    }
+
+    Uint64 count = 0;
+    if (!error) {
+        const markerview_t* view = reader->view;
+        error = export_format(view, MARKEREXPORT_CSV, "csv", NULL, &count)
+            || export_format(
+                view, MARKEREXPORT_GEOJSON, "geojson", NULL, &count)
+            || export_format(view, MARKEREXPORT_BINARY, "bin", NULL, &count);
+
+        /* the middle quarter of the tile */
+        Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+        Uint32 area_size = world_size >> BENCH_EXPORT_AREA_ZOOM;
+        SDL_Rect area = {
+            .x = world_size/2 - area_size/4,
+            .y = world_size/2 - area_size/4,
+            .w = area_size/2,
+            .h = area_size/2
+        };
+        Uint64 area_count = 0;
+        error = error || export_format(
+            view, MARKEREXPORT_CSV, "area.csv", &area, &area_count);
+        for (Uint32 i = 0; !error && i < view->slot_count; i++) {
+            const marker_t* marker = markerview_at(view, i);
+            int is_inside = marker != NULL
+                && marker->x - area.x < (Uint32)area.w
+                && marker->y - area.y < (Uint32)area.h;
+            area_count -= is_inside;
+        }
+        if (!error && area_count) {
+            SDL_SetError("area export does not match the area\n%s()",
+                         __func__);
+            error = 1;
+        }
+
+        error = error
+            || check_export(view, "csv")
+            || check_export(view, "geojson")
+            || check_binary_export(view);
+    }
+
+    const char* const extensions[] = { "csv", "geojson", "bin", "area.csv" };
+    for (int i = 0; i < 4; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "%s.%s", BENCH_EXPORT_PATH, extensions[i]);
+        remove(path);
+    }
+    if (reader != NULL)
+        markerviews_release(reader);
+    markerviews_free(&views);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    return error;
+}
+
+int bench_descriptions(void) {
+    /* descriptions in the arena of names, as they were kept before */
+    markerpool_t markers;
+    textarena_t texts;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    Uint64 start = perf_now();
+    int error = add_described_markers(&markers, &texts, NULL);
+    double arena_time = perf_elapsed_ms(start);
+    size_t arena_memory = markerpool_get_memory(&markers)
+        + texts.allocated_size;
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    if (error)
+        return 1;
+
+    textblob_t descriptions;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    error = textblob_init(&descriptions);
+    start = perf_now();
+    if (!error)
+        error = add_described_markers(&markers, &texts, &descriptions);
+    double blob_time = perf_elapsed_ms(start);
+    size_t blob_memory = markerpool_get_memory(&markers)
+        + texts.allocated_size
+        + textblob_get_memory(&descriptions);
+    if (!error) {
+        SDL_Log(
+            "descriptions: %u markers added in %.0f ms, %.1f bytes per "
+            "marker with descriptions in memory; in %.0f ms, %.1f bytes "
+            "per marker with descriptions in a blob, %.1f times less",
+            BENCH_DESCRIPTIONS_MARKER_COUNT,
+            arena_time,
+            (double)arena_memory / BENCH_DESCRIPTIONS_MARKER_COUNT,
+            blob_time,
+            (double)blob_memory / BENCH_DESCRIPTIONS_MARKER_COUNT,
+            (double)arena_memory / blob_memory
+        );
+    }
+
+    double scan_time = 0;
+    double open_time = 0;
+    if (!error) {
+        error = read_descriptions(
+            &markers, &descriptions, &scan_time, &open_time);
+    }
+    if (!error) {
+        SDL_Log(
+            "descriptions: read from the blob one after another in %.0f "
+            "ms, %.2f us per random marker",
+            scan_time,
+            open_time * 1000 / BENCH_DESCRIPTIONS_OPEN_COUNT
+        );
+    }
+
+    /* the index and the clusters are empty, only texts are compared */
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    quadtree_t quadtree;
+    clusters_t clusters;
+    clusters_init(&clusters, MAP_MAX_ZOOM);
+    error = quadtree_init(&quadtree, world_size) || error;
+    if (!error) {
+        error = snapshot_save(
+            BENCH_SNAPSHOT_PATH,
+            &markers,
+            &texts,
+            &descriptions,
+            &quadtree,
+            &clusters,
+            0
+        );
+    }
+    quadtree_free(&quadtree);
+    clusters_free(&clusters);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    clusters_init(&clusters, MAP_MAX_ZOOM);
+    error = quadtree_init(&quadtree, world_size) || error;
+    error = textblob_init(&descriptions) || error;
+    snapshot_t* snapshot = NULL;
+    if (!error) {
+        error = snapshot_load(
+            BENCH_SNAPSHOT_PATH,
+            &snapshot,
+            &markers,
+            &texts,
+            &descriptions,
+            &quadtree,
+            &clusters
+        );
+    }
+    if (!error && snapshot == NULL) {
+        SDL_SetError("snapshot is not written\n%s()", __func__);
+        error = 1;
+    }
+    if (!error) {
+        error = read_descriptions(
+            &markers, &descriptions, &scan_time, &open_time);
+    }
+    if (!error) {
+        SDL_Log(
+            "descriptions: read from the snapshot one after another in "
+            "%.0f ms, %.2f us per random marker",
+            scan_time,
+            open_time * 1000 / BENCH_DESCRIPTIONS_OPEN_COUNT
+        );
+    }
+
+    quadtree_free(&quadtree);
+    clusters_free(&clusters);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    snapshot_close(snapshot);
+    remove(BENCH_SNAPSHOT_PATH);
+    return error;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int bench_grid_fill(Uint32 marker_count) {
+    Uint32 tile_size = MAP_TILE_SIZE * (1 << MAP_MAX_ZOOM-BENCH_ZOOM);
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+
+    markerpool_t markers;
+    textarena_t texts;
+    list_t result;
+    quadtree_t quadtree;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    list_init(&result, RESULT_LIST_ALLOCATION_PORTION);
+    int error = quadtree_init(&quadtree, world_size);
+
+    marker_fixture_t fixture;
+    init_marker_fixture(&fixture, AREA_SIZE, 0, NULL);
+    Uint64 start = perf_now();
+    if (!error) {
+        error = add_random_markers(
+            &fixture, marker_count, &markers, &texts, NULL, &quadtree);
+    }
+    double build_time = perf_elapsed_ms(start);
+
+    Uint32 grid_begin = world_size/2 - MAP_GRID_SIZE/2 * tile_size;
+    size_t indexed_found = 0;
+    start = perf_now();
+    if (!error)
+        error = query_grid(&quadtree, &result, &indexed_found);
+    double indexed_time = perf_elapsed_ms(start);
+
+    size_t linear_found = 0;
+    start = perf_now();
+    for (int i = 0; !error && i < MAP_GRID_SIZE*MAP_GRID_SIZE; i++) {
+        SDL_Rect tile = {
+            .x = grid_begin + i % MAP_GRID_SIZE * tile_size,
+            .y = grid_begin + i / MAP_GRID_SIZE * tile_size,
+            .w = tile_size,
+            .h = tile_size
+        };
+        list_clear(&result);
+        for (Uint32 k = 0; !error && k < markers.slot_count; k++) {
+            marker_t* marker = markerpool_at(&markers, k);
+            if (is_belong(marker->x, marker->y, &tile))
+                error = list_add(&result, &marker, sizeof(marker_t*));
+        }
+        linear_found += result.size / sizeof(marker_t*);
+    }
+    double linear_time = perf_elapsed_ms(start);
+
+    size_t culled_found = 0;
+    start = perf_now();
+    for (int i = 0; !error && i < MAP_GRID_SIZE*MAP_GRID_SIZE; i++) {
+        SDL_Rect tile = {
+            .x = grid_begin + i % MAP_GRID_SIZE * tile_size,
+            .y = grid_begin + i / MAP_GRID_SIZE * tile_size,
+            .w = tile_size,
+            .h = tile_size
+        };
+        list_clear(&result);
+        error = markerpool_cull(&markers, &tile, &result);
+        culled_found += result.size / sizeof(Uint32);
+    }
+    double culled_time = perf_elapsed_ms(start);
+
+    if (!error) {
+        SDL_Log(
+            "%u markers: index built in %.2f ms, grid filled in %.3f ms "
+            "(%zu markers), linear scan %.2f ms (%zu markers), "
+            "SoA cull %.2f ms (%zu markers)",
+            marker_count,
+            build_time,
+            indexed_time,
+            indexed_found,
+            linear_time,
+            linear_found,
+            culled_time,
+            culled_found
+        );
+
+        /* names are as long as typical ones, descriptions are empty */
+        size_t pool_memory = markerpool_get_memory(&markers);
+        size_t index_memory = quadtree_get_memory(&quadtree);
+        SDL_Log(
+            "%u markers: %.1f bytes per marker in the pool, %.1f in texts, "
+            "%.1f in the index",
+            marker_count,
+            (double)pool_memory / marker_count,
+            (double)texts.allocated_size / marker_count,
+            (double)index_memory / marker_count
+        );
+    }
+
+    if (!error)
+        error = bench_clusters(&markers);
+
+    quadtree_free(&quadtree);
+    list_free(&result);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    return error;
+}
+
+static void init_marker_fixture(marker_fixture_t* fixture,
+                                Uint32 area_size,
+                                int has_color,
+                                size_t (*get_description)(Uint32, char*)) {
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    fixture->area_x = world_size/2 - area_size/2;
+    fixture->area_y = fixture->area_x;
+    fixture->area_size = area_size;
+    fixture->has_color = has_color;
+    fixture->get_description = get_description;
+    fixture->random_state = RANDOM_SEED;
+}
+
+static int add_random_markers(marker_fixture_t* fixture,
+                              Uint32 marker_count,
+                              markerpool_t* markers,
+                              textarena_t* texts,
+                              textblob_t* descriptions,
+                              quadtree_t* quadtree) {
+    int error = 0;
+    for (Uint32 i = 0; !error && i < marker_count; i++) {
+        marker_t marker;
+        marker_handle_t handle;
+        error = add_random_marker(
+            fixture, i, markers, texts, descriptions, &marker, &handle);
+        if (!error && quadtree != NULL)
+            error = quadtree_insert(quadtree, marker.x, marker.y, handle.index);
+    }
+    return error;
+}
+
+static int add_random_marker(marker_fixture_t* fixture,
+                             Uint32 number,
+                             markerpool_t* markers,
+                             textarena_t* texts,
+                             textblob_t* descriptions,
+                             marker_t* marker,
+                             marker_handle_t* handle) {
+    /* without a blob descriptions go into the arena after their names */
+    char name[32];
+    char description[CONFIG_MARKER_DESCRIPTION_MAX + 1];
+    *marker = (marker_t){
+        .color = fixture->has_color ? number % COLORPICKER_COLOR_COUNT : 0,
+        .name_length = snprintf(name, sizeof(name), "marker %u", number),
+        .description_length = fixture->get_description != NULL
+            ? fixture->get_description(number, description) : 0,
+        .description = TEXTBLOB_EMPTY
+    };
+
+    /* without an area the marker tells its number by its position */
+    if (fixture->area_size)
+        get_random_position(fixture, &marker->x, &marker->y);
+    else
+        marker->x = marker->y = number;
+    int error = textarena_add(texts, name, marker->name_length, &marker->name);
+    if (!error && marker->description_length) {
+        error = descriptions != NULL
+            ? textblob_add(
+                descriptions,
+                description,
+                marker->description_length,
+                &marker->description)
+            : textarena_add(
+                texts,
+                description,
+                marker->description_length,
+                &marker->description);
+    }
+    return error || markerpool_add(markers, marker, handle);
+}
+
+static void get_random_position(marker_fixture_t* fixture,
+                                Uint32* x,
+                                Uint32* y) {
+    *x = fixture->area_x
+        + get_random(&fixture->random_state) % fixture->area_size;
+    *y = fixture->area_y
+        + get_random(&fixture->random_state) % fixture->area_size;
+}
+
+static int query_grid(const quadtree_t* quadtree,
+                      list_t* result,
+                      size_t* found_count) {
+    Uint32 tile_size = MAP_TILE_SIZE * (1 << MAP_MAX_ZOOM-BENCH_ZOOM);
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    Uint32 grid_begin = world_size/2 - MAP_GRID_SIZE/2 * tile_size;
+    int error = 0;
+    for (int i = 0; !error && i < MAP_GRID_SIZE*MAP_GRID_SIZE; i++) {
+        SDL_Rect tile = {
+            .x = grid_begin + i % MAP_GRID_SIZE * tile_size,
+            .y = grid_begin + i / MAP_GRID_SIZE * tile_size,
+            .w = tile_size,
+            .h = tile_size
+        };
+        list_clear(result);
+        error = quadtree_query(quadtree, &tile, result);
+        *found_count += result->size / sizeof(Uint32);
+    }
+    return error;
+}
+
+static int bench_clusters(const markerpool_t* markers) {
+    clusters_t clusters;
+    clusters_init(&clusters, MAP_MAX_ZOOM);
+
+    int error = 0;
+    Uint64 start = perf_now();
+    for (Uint32 i = 0; !error && i < markers->slot_count; i++) {
+        marker_t* marker = markerpool_at(markers, i);
+        error = clusters_insert(&clusters, marker->x, marker->y);
+    }
+    double insert_time = perf_elapsed_ms(start);
+
+    start = perf_now();
+    if (!error)
+        error = clusters_build(&clusters, markers);
+    double build_time = perf_elapsed_ms(start);
+
+    if (!error) {
+        SDL_Log(
+            "clusters: inserted in %.2f ms, built in parallel in %.2f ms",
+            insert_time,
+            build_time
+        );
+    }
+
+    clusters_free(&clusters);
+    return error;
+}
+
+static int bench_journal_reopen(Uint32 marker_count) {
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    quadtree_t quadtree;
+    clusters_t clusters;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    clusters_init(&clusters, MAP_MAX_ZOOM);
+    int error = quadtree_init(&quadtree, (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE);
+    error = textblob_init(&descriptions) || error;
+
+    /* the same as the startup: the compacted snapshot, then the journal */
+    snapshot_t* snapshot = NULL;
+    Uint32 replayed_count = 0;
+    Uint64 start = perf_now();
+    if (!error) {
+        error = snapshot_load(
+            BENCH_SNAPSHOT_PATH,
+            &snapshot,
+            &markers,
+            &texts,
+            &descriptions,
+            &quadtree,
+            &clusters
+        );
+    }
+    if (!error) {
+        journal_t* journal = journal_open(
+            BENCH_SNAPSHOT_PATH,
+            snapshot != NULL ? snapshot->journal_sequence : 0,
+            MAP_MAX_ZOOM,
+            &markers,
+            &texts,
+            &descriptions,
+            &quadtree,
+            &replayed_count
+        );
+        error = journal == NULL;
+        journal_close(journal);
+    }
+    double open_time = perf_elapsed_ms(start);
+
+    if (!error && markers.count != marker_count) {
+        SDL_SetError("journal lost markers\n%s()", __func__);
+        error = 1;
+    }
+    if (!error) {
+        SDL_Log(
+            "journal: reopened in %.0f ms, %u markers from the snapshot, "
+            "%u records replayed",
+            open_time,
+            marker_count - replayed_count,
+            replayed_count
+        );
+    }
+
+    quadtree_free(&quadtree);
+    clusters_free(&clusters);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    snapshot_close(snapshot);
+    return error;
+}
+
+static int bench_search_query(const searchindex_t* searchindex,
+                              const markerpool_t* markers,
+                              const textarena_t* texts,
+                              textblob_t* descriptions,
+                              const char* query) {
+    list_t result;
+    list_init(&result, RESULT_LIST_ALLOCATION_PORTION);
+    Uint64 start = perf_now();
+    int error = searchindex_search(
+        searchindex,
+        markers,
+        texts,
+        descriptions,
+        query,
+        SEARCHINDEX_RESULT_MAX,
+        &result
+    );
+    double search_time = perf_elapsed_ms(start);
+
+    /* the scan only finds names with the query, it does not rank them */
+    start = perf_now();
+    Uint32 scan_count = 0;
+    for (Uint32 i = 0; i < markers->slot_count; i++) {
+        const marker_t* marker = markerpool_at(markers, i);
+        if (marker != NULL && strstr(textarena_get(texts, marker->name), query))
+            scan_count++;
+    }
+    double scan_time = perf_elapsed_ms(start);
+
+    if (!error) {
+        SDL_Log(
+            "search: \"%s\" in %.2f ms, %zu best results, "
+            "linear scan %.1f ms, %u matches",
+            query,
+            search_time,
+            result.size / sizeof(Uint32),
+            scan_time,
+            scan_count
+        );
+    }
+    list_free(&result);
+    return error;
+}
+
+static int check_nearest(const pix_pos_t* positions,
+                         geodesic_origin_t* origin,
+                         const list_t* nearest,
+                         double* scan_time) {
+    /* the distances of the best markers, nearest first */
+    double best[BENCH_NEAREST_COUNT];
+    Uint32 best_count = 0;
+    Uint64 start = perf_now();
+    for (Uint32 i = 0; i < BENCH_NEAREST_MARKER_COUNT; i++) {
+        double distance = geodesic_get_distance(
+            origin, positions[i].x, positions[i].y, 0);
+        if (best_count == BENCH_NEAREST_COUNT &&
+                distance >= best[best_count - 1])
+            continue;
+        if (best_count < BENCH_NEAREST_COUNT)
+            best_count++;
+        Uint32 k = best_count - 1;
+        for (; k > 0 && best[k-1] > distance; k--)
+            best[k] = best[k-1];
+        best[k] = distance;
+    }
+    *scan_time += perf_elapsed_ms(start);
+
+    /* markers at the same distance may come in any order */
+    Uint32 count = nearest->size / sizeof(quadtree_neighbor_t);
+    int is_same = count == best_count;
+    for (Uint32 k = 0; is_same && k < count; k++) {
+        const quadtree_neighbor_t* neighbor =
+            list_get(nearest, k * sizeof(quadtree_neighbor_t));
+        is_same = neighbor->distance == best[k];
+    }
+    if (!is_same) {
+        SDL_SetError("nearest markers differ from the full scan\n%s()",
+                     __func__);
+        return 1;
+    }
+    return 0;
+}
+
+static int run_view_readers(int reader_count,
+                            double* time,
+                            view_reader_t* total) {
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    markerviews_t views;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    markerviews_init(&views);
+    SDL_atomic_t is_stopped;
+    SDL_AtomicSet(&is_stopped, 0);
+    view_reader_t readers[BENCH_VIEWS_READER_COUNT];
+    SDL_Thread* threads[BENCH_VIEWS_READER_COUNT];
+    int thread_count = 0;
+    int error = textblob_init(&descriptions);
+    while (!error && thread_count < reader_count) {
+        view_reader_t* reader = &readers[thread_count];
+        *reader = (view_reader_t){ &views, &is_stopped, 0, 0, 0 };
+        threads[thread_count] = SDL_CreateThread(read_views, NULL, reader);
+        if (threads[thread_count] == NULL)
+            error = 1;
+        else
+            thread_count++;
+    }
+
+    /* readers are stopped before the views and the pool are freed */
+    if (!error)
+        error = run_view_edits(
+            &markers, &texts, &descriptions, &views, reader_count > 0, time);
+    SDL_AtomicSet(&is_stopped, 1);
+    for (int i = 0; i < thread_count; i++) {
+        SDL_WaitThread(threads[i], NULL);
+        total->view_count += readers[i].view_count;
+        total->marker_count += readers[i].marker_count;
+        total->has_failed |= readers[i].has_failed;
+    }
+    markerviews_free(&views);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    if (!error && total->has_failed) {
+        SDL_SetError("a view is not consistent\n%s()", __func__);
+        error = 1;
+    }
+    return error;
+}
+
+static int run_view_edits(markerpool_t* markers,
+                          textarena_t* texts,
+                          textblob_t* descriptions,
+                          markerviews_t* views,
+                          int is_read,
+                          double* time) {
+    /* a quarter of the edits removes a random marker */
+    marker_handle_t* handles =
+        malloc(BENCH_VIEWS_EDIT_COUNT * sizeof(marker_handle_t));
+    if (handles == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    marker_fixture_t fixture;
+    init_marker_fixture(&fixture, 0, 0, NULL);
+    Uint32 handle_count = 0;
+    Uint32 random_state = RANDOM_SEED;
+    int error = 0;
+    Uint64 start = perf_now();
+    for (Uint32 i = 0; !error && i < BENCH_VIEWS_EDIT_COUNT; i++) {
+        Uint32 random = get_random(&random_state);
+        if (handle_count && random % 4 == 0) {
+            Uint32 k = random / 4 % handle_count;
+            const marker_t* marker = markerpool_get(markers, handles[k]);
+            textarena_release(texts, marker->name_length);
+            error = markerpool_remove(markers, handles[k]);
+            handles[k] = handles[--handle_count];
+        } else {
+            marker_t marker;
+            error = add_random_marker(
+                &fixture,
+                i,
+                markers,
+                texts,
+                descriptions,
+                &marker,
+                &handles[handle_count]
+            );
+            handle_count++;
+        }
+
+        /* every frame the map withdraws the view, a reader publishes it */
+        if (!error && views != NULL && i % BENCH_VIEWS_PUBLISH_PERIOD == 0) {
+            error = markerviews_withdraw(views, markers, texts) || (is_read
+                && markerviews_publish(views, markers, texts, descriptions));
+        }
+    }
+    *time = perf_elapsed_ms(start);
+    free(handles);
+    return error;
+}
+
+static int read_views(void* ptr_reader) {
+    /* SDL_ThreadFunction */
+    view_reader_t* reader = ptr_reader;
+    while (!SDL_AtomicGet(reader->is_stopped) && !reader->has_failed) {
+        markerview_reader_t* view_reader = markerviews_acquire(reader->views);
+        if (view_reader == NULL) {
+            SDL_Delay(1);
+            continue;
+        }
+        Uint64 count = 0;
+        if (!is_view_consistent(view_reader->view, &count))
+            reader->has_failed = 1;
+        markerviews_release(view_reader);
+        reader->view_count++;
+        reader->marker_count += count;
+    }
+    return 0;
+}
+
+static int is_view_consistent(const markerview_t* view, Uint64* count) {
+    for (Uint32 i = 0; i < view->slot_count; i++) {
+        const marker_t* marker = markerview_at(view, i);
+        if (marker == NULL)
+            continue;
+        char name[32];
+        int name_length = snprintf(name, sizeof(name), "marker %u", marker->x);
+        const char* text = markerview_get_text(view, marker->name);
+        int is_valid = marker->y == marker->x
+            && marker->name_length == name_length
+            && !memcmp(text, name, name_length);
+        if (!is_valid)
+            return 0;
+        (*count)++;
+    }
+    return *count == view->count;
+}
+
+static int read_store_grid(const markerstore_t* store,
+                           Uint32* marker_count,
+                           Uint64* byte_count) {
+    Uint32 center = ((Uint32)1 << store->zoom) / 2;
+    markerstore_part_t part;
+    int error = 0;
+    for (int i = 0; !error && i < MAP_GRID_SIZE*MAP_GRID_SIZE; i++) {
+        const markerstore_partition_t* partition = markerstore_find(
+            store,
+            center - MAP_GRID_SIZE/2 + i % MAP_GRID_SIZE,
+            center - MAP_GRID_SIZE/2 + i / MAP_GRID_SIZE
+        );
+        if (partition == NULL)
+            continue;
+        error = markerstore_read(store->path, partition, &part);
+        *marker_count += part.count;
+        *byte_count += partition->size;
+        markerstore_free_part(&part);
+    }
+    return error;
+}
+
+static int pan_store_grid(const markerstore_t* store,
+                          Uint32* step_count,
+                          Uint32* max_marker_count,
+                          Uint64* max_size) {
+    store_pan_t pan;
+    markerpool_init(&pan.markers);
+    textarena_init(&pan.texts);
+    for (int i = 0; i < MAP_GRID_SIZE; i++)
+        list_init(&pan.columns[i], HANDLES_LIST_ALLOCATION_PORTION);
+    pan.text_size = 0;
+    pan.description_size = 0;
+    int error = textblob_init(&pan.descriptions);
+
+    Uint32 x = ((Uint32)1 << store->zoom) / 2 - MAP_GRID_SIZE/2;
+    Uint32 y = x;
+    for (int i = 0; !error && i < MAP_GRID_SIZE; i++)
+        error = load_store_column(store, &pan, x + i, y);
+
+    /* the grid moves a partition a step, the column it leaves is evicted */
+    Uint32 count = BENCH_STORE_PAN_COUNT * 2 * BENCH_STORE_PAN_DISTANCE;
+    for (Uint32 k = 0; !error && k < count; k++) {
+        if (k / BENCH_STORE_PAN_DISTANCE % 2 == 0) {
+            evict_store_column(&pan, x);
+            x++;
+            error = load_store_column(store, &pan, x + MAP_GRID_SIZE-1, y);
+        } else {
+            evict_store_column(&pan, x + MAP_GRID_SIZE-1);
+            x--;
+            error = load_store_column(store, &pan, x, y);
+        }
+        error = error || markerpool_pack_texts(
+            &pan.markers, &pan.texts, &pan.descriptions);
+        if (!error && !is_store_packed(&pan)) {
+            SDL_SetError("texts grow while the grid moves\n%s()", __func__);
+            error = 1;
+        }
+        Uint64 size = (Uint64)pan.texts.size + pan.descriptions.size;
+        if (size > *max_size)
+            *max_size = size;
+        if (pan.markers.count > *max_marker_count)
+            *max_marker_count = pan.markers.count;
+        (*step_count)++;
+    }
+
+    for (int i = 0; i < MAP_GRID_SIZE; i++)
+        list_free(&pan.columns[i]);
+    markerpool_free(&pan.markers);
+    textarena_free(&pan.texts);
+    textblob_free(&pan.descriptions);
+    return error;
+}
+
+static int load_store_column(const markerstore_t* store,
+                             store_pan_t* pan,
+                             Uint32 x,
+                             Uint32 y) {
+    /* markers are added like the map adds a loaded partition */
+    list_t* handles = &pan->columns[x % MAP_GRID_SIZE];
+    markerstore_part_t part;
+    int error = 0;
+    for (Uint32 i = 0; !error && i < MAP_GRID_SIZE; i++) {
+        const markerstore_partition_t* partition =
+            markerstore_find(store, x, y + i);
+        if (partition == NULL)
+            continue;
+        error = markerstore_read(store->path, partition, &part);
+        const markerstore_record_t* records =
+            (const markerstore_record_t*)part.data;
+        const char* text =
+            (const char*)(part.data + part.count*sizeof(markerstore_record_t));
+        for (Uint32 k = 0; !error && k < part.count; k++) {
+            const markerstore_record_t* record = &records[k];
+            const char* name = text;
+            const char* description = name + record->name_length;
+            text = description + record->description_length;
+
+            marker_t marker = {
+                .x = record->x,
+                .y = record->y,
+                .color = record->color,
+                .name_length = record->name_length,
+                .description_length = record->description_length
+            };
+            marker_handle_t handle;
+            error = textarena_add(
+                    &pan->texts,
+                    name,
+                    record->name_length,
+                    &marker.name
+                )
+                || textblob_add(
+                    &pan->descriptions,
+                    description,
+                    record->description_length,
+                    &marker.description
+                )
+                || markerpool_add(&pan->markers, &marker, &handle)
+                || list_add(handles, &handle, sizeof(marker_handle_t));
+            pan->text_size +=
+                record->name_length ? record->name_length + 1 : 0;
+            pan->description_size += record->description_length
+                ? record->description_length + 1 : 0;
+        }
+        markerstore_free_part(&part);
+    }
+    return error;
+}
+
+static void evict_store_column(store_pan_t* pan, Uint32 x) {
+    list_t* handles = &pan->columns[x % MAP_GRID_SIZE];
+    for (size_t i = 0; i < handles->size; i += sizeof(marker_handle_t)) {
+        marker_handle_t handle = *(marker_handle_t*)list_get(handles, i);
+        const marker_t* marker = markerpool_get(&pan->markers, handle);
+        textarena_release(&pan->texts, marker->name_length);
+        textblob_release(&pan->descriptions, marker->description_length);
+        pan->text_size -=
+            marker->name_length ? marker->name_length + 1 : 0;
+        pan->description_size -= marker->description_length
+            ? marker->description_length + 1 : 0;
+        markerpool_remove(&pan->markers, handle);
+    }
+    list_clear(handles);
+}
+
+static int is_store_packed(const store_pan_t* pan) {
+    /* released texts never take more than the texts of the markers */
+    return pan->texts.size <= 2*pan->text_size
+        && pan->descriptions.size <= 2*pan->description_size;
+}
+
+static int add_export_markers(markerpool_t* markers,
+                              textarena_t* texts,
+                              textblob_t* descriptions) {
+    /* removed slots are reused by the next markers */
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    marker_fixture_t fixture;
+    init_marker_fixture(
+        &fixture,
+        world_size >> BENCH_EXPORT_AREA_ZOOM,
+        1,
+        get_export_description
+    );
+    for (Uint32 i = 0; i < BENCH_EXPORT_MARKER_COUNT; i++) {
+        marker_t marker;
+        marker_handle_t handle;
+        int error = add_random_marker(
+            &fixture, i, markers, texts, descriptions, &marker, &handle);
+        if (error)
+            return 1;
+        if (i % 8 == 7 && markerpool_remove(markers, handle))
+            return 1;
+    }
+    return 0;
+}
+
+static size_t get_export_description(Uint32 number, char* description) {
+    /* texts which have to be quoted and escaped */
+    if (number % 2 == 0)
+        return 0;
+    return snprintf(
+        description,
+        CONFIG_MARKER_DESCRIPTION_MAX + 1,
+        "\"quoted\", \\ %u\r\nsecond line\t",
+        number
+    );
+}
+
+static int export_format(const markerview_t* view,
+                         markerexport_format_t format,
+                         const char* extension,
+                         const SDL_Rect* area,
+                         Uint64* count) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s.%s", BENCH_EXPORT_PATH, extension);
+    markerexport_progress_t progress = { 0 };
+    Uint64 start = perf_now();
+    if (markerexport_write(
+            path,
+            format,
+            view,
+            area,
+            (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE,
+            save_progress,
+            &progress))
+        return 1;
+    double time = perf_elapsed_ms(start);
+    SDL_Log(
+        "export: %llu markers%s written into %s in %.0f ms, %.0f "
+        "markers/s, %llu bytes",
+        (unsigned long long)progress.written_count,
+        area != NULL ? " of an area" : "",
+        path,
+        time,
+        time > 0 ? progress.written_count / time * 1000 : 0,
+        (unsigned long long)progress.written_size
+    );
+    *count = progress.written_count;
+    return 0;
+}
+
+static int save_progress(void* ptr_progress,
+                         const markerexport_progress_t* progress) {
+    /* markerexport_callback_t */
+    markerexport_progress_t* saved = ptr_progress;
+    *saved = *progress;
+    return 0;
+}
+
+static int check_export(const markerview_t* view, const char* extension) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s.%s", BENCH_EXPORT_PATH, extension);
+    export_check_t check = {
+        .view = view,
+        .world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE,
+        .index = 0,
+        .count = 0,
+        .has_failed = 0
+    };
+    if (markerimport_read(path, check_records, &check))
+        return 1;
+    if (check.has_failed || check.count != view->count) {
+        SDL_SetError("%s: exported markers do not match\n%s()",
+                     path, __func__);
+        return 1;
+    }
+    return 0;
+}
+
+static int check_records(void* ptr_check, const markerimport_part_t* part) {
+    /* records come in the order of slot indexes, as they were written */
+    export_check_t* check = ptr_check;
+    const list_t* records = &part->records;
+    for (size_t k = 0; k < records->size; k += sizeof(markerimport_record_t)) {
+        const markerimport_record_t* record = list_get(records, k);
+        const marker_t* marker = NULL;
+        while (marker == NULL && check->index < check->view->slot_count)
+            marker = markerview_at(check->view, check->index++);
+        if (marker == NULL) {
+            check->has_failed = 1;
+            return 0;
+        }
+
+        double lat_radian = record->lat * M_PI/180;
+        Uint32 x = (record->lon + 180)/360 * check->world_size;
+        Uint32 y = (1 - asinh(tan(lat_radian))/M_PI) / 2 * check->world_size;
+        const char* name = textarena_get(&part->texts, record->name);
+        const char* description =
+            textarena_get(&part->texts, record->description);
+        char marker_description[CONFIG_MARKER_DESCRIPTION_MAX + 1];
+        if (markerview_read_description(
+                check->view, marker, marker_description))
+            return 1;
+        int is_same = x == marker->x
+            && y == marker->y
+            && record->color == marker->color
+            && record->name_length == marker->name_length
+            && record->description_length == marker->description_length
+            && !memcmp(name, markerview_get_text(check->view, marker->name),
+                       marker->name_length)
+            && !memcmp(
+                description, marker_description, marker->description_length);
+        if (!is_same)
+            check->has_failed = 1;
+        check->count++;
+    }
+    return 0;
+}
+
+static int check_binary_export(const markerview_t* view) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s.bin", BENCH_EXPORT_PATH);
+    SDL_RWops* file = SDL_RWFromFile(path, "rb");
+    if (file == NULL)
+        return 1;
+    markerexport_header_t header;
+    int is_valid = SDL_RWread(file, &header, sizeof(header), 1) == 1
+        && header.marker_count == view->count
+        && header.record_size == sizeof(markerstore_record_t);
+    SDL_RWclose(file);
+    if (!is_valid) {
+        SDL_SetError("%s: exported markers do not match\n%s()",
+                     path, __func__);
+        return 1;
+    }
+    return 0;
+}
+
+static int add_described_markers(markerpool_t* markers,
+                                 textarena_t* texts,
+                                 textblob_t* descriptions) {
+    /* no area, so the slot index is the number of the marker */
+    marker_fixture_t fixture;
+    init_marker_fixture(&fixture, 0, 0, get_description);
+    return add_random_markers(
+        &fixture,
+        BENCH_DESCRIPTIONS_MARKER_COUNT,
+        markers,
+        texts,
+        descriptions,
+        NULL
+    );
+}
+
+static size_t get_description(Uint32 number, char* description) {
+    /* the same text of DESCRIPTION_LENGTH_MIN or more bytes for a number */
+    size_t length = DESCRIPTION_LENGTH_MIN + (number * 2654435761u >> 16)
+        % (DESCRIPTION_LENGTH_MAX - DESCRIPTION_LENGTH_MIN + 1);
+    size_t k = snprintf(
+        description, length + 1, "description of marker %u:", number);
+    for (; k < length; k++)
+        description[k] = 'a' + (number + k) % 26;
+    description[length] = '\0';
+    return length;
+}
+
+static int read_descriptions(const markerpool_t* markers,
+                             textblob_t* descriptions,
+                             double* scan_time,
+                             double* open_time) {
+    Uint64 start = perf_now();
+    for (Uint32 i = 0; i < markers->slot_count; i++) {
+        if (check_description(markers, descriptions, i))
+            return 1;
+    }
+    *scan_time = perf_elapsed_ms(start);
+
+    Uint32 random_state = RANDOM_SEED;
+    start = perf_now();
+    for (Uint32 k = 0; k < BENCH_DESCRIPTIONS_OPEN_COUNT; k++) {
+        Uint32 index = get_random(&random_state) % markers->slot_count;
+        if (check_description(markers, descriptions, index))
+            return 1;
+    }
+    *open_time = perf_elapsed_ms(start);
+    return 0;
+}
+
+static int check_description(const markerpool_t* markers,
+                             textblob_t* descriptions,
+                             Uint32 index) {
+    /* no marker is removed, so the slot index is the number of the marker */
+    const marker_t* marker = markerpool_at(markers, index);
+    const char* description = textblob_get(descriptions, marker->description);
+    if (description == NULL)
+        return 1;
+    char expected[DESCRIPTION_LENGTH_MAX + 1];
+    size_t length = get_description(index, expected);
+    if (marker->description_length != length ||
+            memcmp(description, expected, length + 1)) {
+        SDL_SetError("description of marker %u does not match\n%s()",
+                     index, __func__);
+        return 1;
+    }
+    return 0;
+}
+
+static int bench_import_format(markerimport_format_t format) {
+    list_t text;
+    list_init(&text, TEXT_LIST_ALLOCATION_PORTION);
+    int error = generate_import_text(format, &text);
+
+    Uint32 count = 0;
+    Uint64 start = perf_now();
+    if (!error) {
+        error = markerimport_parse(
+            text.begin, text.size - 1, format, count_records, &count);
+    }
+    double time = perf_elapsed_ms(start);
+
+    if (!error) {
+        SDL_Log(
+            "%s import: %u records (%.1f MB) parsed in %.2f ms, "
+            "%.0f records/s",
+            format == MARKERIMPORT_CSV ? "CSV" : "GeoJSON",
+            count,
+            text.size / 1e6,
+            time,
+            count / time * 1000
+        );
+    }
+
+    list_free(&text);
+    return error;
+}
+
+static int generate_import_text(markerimport_format_t format, list_t* text) {
+    /* the text is null terminated as markerimport_parse() needs */
+    const char* header = format == MARKERIMPORT_CSV
+        ? "lat,lon,name,description,color\n"
+        : "{\"type\":\"FeatureCollection\",\"features\":[\n";
+    const char* footer = format == MARKERIMPORT_CSV ? "" : "]}\n";
+    if (list_add(text, header, strlen(header)))
+        return 1;
+
+    Uint32 random_state = RANDOM_SEED;
+    for (Uint32 i = 0; i < BENCH_IMPORT_RECORD_COUNT; i++) {
+        char record[256];
+        double lat = (double)get_random(&random_state) / (Uint32)-1 * 120 - 60;
+        double lon = (double)get_random(&random_state) / (Uint32)-1 * 360 - 180;
+        int length;
+        if (format == MARKERIMPORT_CSV) {
+            length = snprintf(
+                record,
+                sizeof(record),
+                "%.6f,%.6f,marker %u,\"imported, %u\",%u\n",
+                lat, lon, i, i, i % COLORPICKER_COLOR_COUNT
+            );
+        } else {
+            length = snprintf(
+                record,
+                sizeof(record),
+                "%s{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\","
+                "\"coordinates\":[%.6f,%.6f]},\"properties\":{\"name\":"
+                "\"marker %u\",\"description\":\"imported, %u\","
+                "\"color\":%u}}\n",
+                i ? "," : "",
+                lon, lat, i, i, i % COLORPICKER_COLOR_COUNT
+            );
+        }
+        if (list_add(text, record, length))
+            return 1;
+    }
+    return list_add(text, footer, strlen(footer) + 1);
+}
+
+static int count_records(void* ptr_count, const markerimport_part_t* part) {
+    Uint32* count = ptr_count;
+    *count += part->records.size / sizeof(markerimport_record_t);
+    return 0;
+}
+
+static Uint32 get_random(Uint32* state) {
+    /* xorshift32 */
+    Uint32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
@@ -0,0 +1,278 @@
+#include "../headers/export.h"
+
+typedef struct {
+    const tilesource_t* tilesource;
+    Uint8 zoom;
+    int tile_size;
+    Uint32 tile_x_begin, tile_y_begin;
+    int columns, rows;
+    SDL_Surface** row_tiles[EXPORT_ROW_WINDOW];
+    int loaded_counts[EXPORT_ROW_WINDOW];
+    int next_tile;
+    int written_rows;
+    int is_cancelled;
+    SDL_mutex* mutex;
+    SDL_cond* tile_loaded;
+    SDL_cond* row_written;
+} export_t;
+
+static int export_tiles(export_t* export,
+                        pngwriter_t* pngwriter,
+                        const SDL_Rect* pixels);
+static int load_tiles_async(void* ptr_export); /* SDL_ThreadFunction */
+static SDL_Surface* load_tile(const export_t* export, int index);
+static int write_row(export_t* export,
+                     pngwriter_t* pngwriter,
+                     Uint8* scanline,
+                     int row,
+                     const SDL_Rect* pixels);
+static void free_row(export_t* export, int row);
+static SDL_Point to_pix(geo_pos_t geo_pos, Uint8 zoom, int tile_size);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int export_map(const options_t* options) {
+    Uint64 start = perf_now();
+
+    /* large tiles are requested at a lower zoom, see map_t */
+    const tilesource_t* tilesource = &options->tilesource;
+    int zoom_shift = tilesource_get_zoom_shift(tilesource);
+    if (zoom_shift < 0 || options->zoom < MAP_MIN_ZOOM + zoom_shift) {
+        SDL_SetError("unsupported tile size\n%s()", __func__);
+        return 1;
+    }
+    Uint8 zoom = options->zoom - zoom_shift;
+    int tile_size = tilesource->tile_size;
+
+    SDL_Point begin = to_pix(options->export_begin, zoom, tile_size);
+    SDL_Point end = to_pix(options->export_end, zoom, tile_size);
+    SDL_Rect pixels = {
+        .x = begin.x < end.x ? begin.x : end.x,
+        .y = begin.y < end.y ? begin.y : end.y,
+        .w = abs(end.x - begin.x),
+        .h = abs(end.y - begin.y)
+    };
+    if (!pixels.w || !pixels.h) {
+        SDL_SetError("export area is empty\n%s()", __func__);
+        return 1;
+    }
+
+    export_t export = {
+        .tilesource = tilesource,
+        .zoom = zoom,
+        .tile_size = tile_size,
+        .tile_x_begin = pixels.x / tile_size,
+        .tile_y_begin = pixels.y / tile_size,
+        .next_tile = 0,
+        .written_rows = 0,
+        .is_cancelled = 0
+    };
+    export.columns = (pixels.x + pixels.w - 1)/tile_size
+        - export.tile_x_begin + 1;
+    export.rows = (pixels.y + pixels.h - 1)/tile_size
+        - export.tile_y_begin + 1;
+
+    if (headless_init())
+        return 1;
+
+    pngwriter_t* pngwriter =
+        pngwriter_open(options->output_path, pixels.w, pixels.h);
+    if (pngwriter == NULL) {
+        headless_deinit();
+        return 1;
+    }
+
+    int error = export_tiles(&export, pngwriter, &pixels);
+    if (pngwriter_close(pngwriter))
+        error = 1;
+    headless_deinit();
+
+    if (!error)
+        perf_log_time("export", start);
+    return error;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int export_tiles(export_t* export,
+                        pngwriter_t* pngwriter,
+                        const SDL_Rect* pixels) {
+    for (int i = 0; i < EXPORT_ROW_WINDOW; i++) {
+        export->row_tiles[i] = calloc(export->columns, sizeof(SDL_Surface*));
+        export->loaded_counts[i] = 0;
+    }
+    Uint8* scanline = malloc(pixels->w * 3);
+    export->mutex = SDL_CreateMutex();
+    export->tile_loaded = SDL_CreateCond();
+    export->row_written = SDL_CreateCond();
+
+    int error = 0;
+    int is_ready = scanline != NULL
+        && export->mutex != NULL
+        && export->tile_loaded != NULL
+        && export->row_written != NULL;
+    for (int i = 0; i < EXPORT_ROW_WINDOW; i++)
+        is_ready = is_ready && export->row_tiles[i] != NULL;
+    if (!is_ready) {
+        SDL_SetError("export initialization failed\n%s()", __func__);
+        error = 1;
+    }
+
+    SDL_Thread* workers[EXPORT_WORKER_COUNT] = { NULL };
+    for (int i = 0; !error && i < EXPORT_WORKER_COUNT; i++) {
+        workers[i] = SDL_CreateThread(load_tiles_async, NULL, export);
+        error = workers[i] == NULL;
+    }
+
+    for (int row = 0; !error && row < export->rows; row++)
+        error = write_row(export, pngwriter, scanline, row, pixels);
+
+    if (export->mutex != NULL) {
+        SDL_LockMutex(export->mutex);
+        export->is_cancelled = 1;
+        SDL_CondBroadcast(export->row_written);
+        SDL_UnlockMutex(export->mutex);
+    }
+    for (int i = 0; i < EXPORT_WORKER_COUNT; i++) {
+        if (workers[i] != NULL)
+            SDL_WaitThread(workers[i], NULL);
+    }
+
+    for (int i = 0; i < EXPORT_ROW_WINDOW; i++) {
+        if (export->row_tiles[i] != NULL)
+            free_row(export, i);
+        free(export->row_tiles[i]);
+    }
+    free(scanline);
+    SDL_DestroyCond(export->row_written);
+    SDL_DestroyCond(export->tile_loaded);
+    SDL_DestroyMutex(export->mutex);
+    return error;
+}
+
+static int load_tiles_async(void* ptr_export) {
+    /* SDL_ThreadFunction */
+    export_t* export = ptr_export;
+    int tile_count = export->columns * export->rows;
+
+    SDL_LockMutex(export->mutex);
+    for (;;) {
+        /* loading goes at most EXPORT_ROW_WINDOW rows ahead of writing */
+        while (!export->is_cancelled && export->next_tile < tile_count
+                && export->next_tile / export->columns
+                    >= export->written_rows + EXPORT_ROW_WINDOW)
+            SDL_CondWait(export->row_written, export->mutex);
+        if (export->is_cancelled || export->next_tile >= tile_count)
+            break;
+        int index = export->next_tile++;
+        SDL_UnlockMutex(export->mutex);
+
+        SDL_Surface* surface = load_tile(export, index);
+
+        SDL_LockMutex(export->mutex);
+        int slot = index / export->columns % EXPORT_ROW_WINDOW;
+        export->row_tiles[slot][index % export->columns] = surface;
+        export->loaded_counts[slot]++;
+        SDL_CondBroadcast(export->tile_loaded);
+    }
+    SDL_UnlockMutex(export->mutex);
+
+    return 0;
+}
+
+static SDL_Surface* load_tile(const export_t* export, int index) {
+    /* the same fetch and decode path as the tiles of the map */
+    SDL_Surface* surface = tilesource_load(
+        export->tilesource,
+        export->zoom,
+        export->tile_x_begin + index % export->columns,
+        export->tile_y_begin + index / export->columns
+    );
+    if (surface == NULL)
+        return NULL;
+
+    int size = export->tile_size;
+    SDL_Surface* tile = SDL_CreateRGBSurfaceWithFormat(
+        0, size, size, 24, SDL_PIXELFORMAT_RGB24);
+    if (tile != NULL) {
+        int is_scaled = surface->w != size || surface->h != size;
+        int error = is_scaled
+            ? SDL_BlitScaled(surface, NULL, tile, NULL)
+            : SDL_BlitSurface(surface, NULL, tile, NULL);
+        if (error) {
+            SDL_FreeSurface(tile);
+            tile = NULL;
+        }
+    }
+    SDL_FreeSurface(surface);
+    return tile;
+}
+
+static int write_row(export_t* export,
+                     pngwriter_t* pngwriter,
+                     Uint8* scanline,
+                     int row,
+                     const SDL_Rect* pixels) {
+    int slot = row % EXPORT_ROW_WINDOW;
+    SDL_LockMutex(export->mutex);
+    while (export->loaded_counts[slot] < export->columns)
+        SDL_CondWait(export->tile_loaded, export->mutex);
+    SDL_UnlockMutex(export->mutex);
+
+    int tile_size = export->tile_size;
+    Sint64 row_y = (Sint64)(export->tile_y_begin + row) * tile_size;
+    Sint64 y_begin = row_y > pixels->y ? row_y : pixels->y;
+    Sint64 y_end = row_y + tile_size;
+    if (y_end > (Sint64)pixels->y + pixels->h)
+        y_end = (Sint64)pixels->y + pixels->h;
+
+    SDL_Surface** tiles = export->row_tiles[slot];
+    int error = 0;
+    for (Sint64 y = y_begin; !error && y < y_end; y++) {
+        int tile_y = y - row_y;
+        for (int x = 0; x < pixels->w; ) {
+            int pixel_x = pixels->x + x;
+            int column = pixel_x/tile_size - export->tile_x_begin;
+            int tile_x = pixel_x % tile_size;
+            int count = tile_size - tile_x;
+            if (count > pixels->w - x)
+                count = pixels->w - x;
+
+            /* tiles which are failed to load are left black */
+            Uint8* destination = scanline + x*3;
+            SDL_Surface* tile = tiles[column];
+            if (tile != NULL) {
+                const Uint8* source =
+                    (Uint8*)tile->pixels + tile_y*tile->pitch + tile_x*3;
+                memcpy(destination, source, count*3);
+            } else {
+                memset(destination, 0, count*3);
+            }
+            x += count;
+        }
+        error = pngwriter_write_row(pngwriter, scanline);
+    }
+
+    SDL_LockMutex(export->mutex);
+    free_row(export, slot);
+    export->written_rows++;
+    SDL_CondBroadcast(export->row_written);
+    SDL_UnlockMutex(export->mutex);
+    return error;
+}
+
+static void free_row(export_t* export, int slot) {
+    for (int i = 0; i < export->columns; i++) {
+        if (export->row_tiles[slot][i] != NULL)
+            SDL_FreeSurface(export->row_tiles[slot][i]);
+        export->row_tiles[slot][i] = NULL;
+    }
+    export->loaded_counts[slot] = 0;
+}
+
+static SDL_Point to_pix(geo_pos_t geo_pos, Uint8 zoom, int tile_size) {
+    double lat_radian = geo_pos.lat * M_PI/180;
+    double x = (geo_pos.lon + 180)/360 * (1<<zoom);
+    double y = (1 - asinh(tan(lat_radian))/M_PI)/2 * (1<<zoom);
+    return (SDL_Point){ x*tile_size, y*tile_size };
+}
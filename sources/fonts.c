@@ -0,0 +1,88 @@
+#include "../headers/fonts.h"
+
+#define FILES_LIST_ALLOCATION_PORTION (4*sizeof(font_file_t))
+#define FONTS_LIST_ALLOCATION_PORTION (8*sizeof(font_entry_t))
+
+static list_t files = { NULL, 0, 0, FILES_LIST_ALLOCATION_PORTION };
+static list_t fonts = { NULL, 0, 0, FONTS_LIST_ALLOCATION_PORTION };
+
+static int load_file(const char* path);
+
+/* ---------------------- header functions definition ---------------------- */
+
+TTF_Font* fonts_get(const char* path, int size) {
+    for (size_t i = 0; i < fonts.size; i += sizeof(font_entry_t)) {
+        font_entry_t* entry = list_get(&fonts, i);
+        font_file_t* file =
+            list_get(&files, entry->file*sizeof(font_file_t));
+        if (entry->size == size && !strcmp(file->path, path))
+            return entry->font;
+    }
+
+    int file_index = load_file(path);
+    if (file_index < 0)
+        return NULL;
+    font_file_t* file = list_get(&files, file_index*sizeof(font_file_t));
+
+    /* the file data outlives the font, so the memory is not copied */
+    SDL_RWops* rw = SDL_RWFromConstMem(file->data, file->data_size);
+    if (rw == NULL)
+        return NULL;
+    TTF_Font* font = TTF_OpenFontRW(rw, 1, size);
+    if (font == NULL) {
+        SDL_SetError("can not open %s\n%s()", path, __func__);
+        return NULL;
+    }
+
+    font_entry_t entry = { font, file_index, size };
+    if (list_add(&fonts, &entry, sizeof(font_entry_t))) {
+        TTF_CloseFont(font);
+        return NULL;
+    }
+    return font;
+}
+
+void fonts_deinit(void) {
+    for (size_t i = 0; i < fonts.size; i += sizeof(font_entry_t)) {
+        font_entry_t* entry = list_get(&fonts, i);
+        TTF_CloseFont(entry->font);
+    }
+    for (size_t i = 0; i < files.size; i += sizeof(font_file_t)) {
+        font_file_t* file = list_get(&files, i);
+        free(file->path);
+        SDL_free(file->data);
+    }
+    list_free(&fonts);
+    list_free(&files);
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int load_file(const char* path) {
+    for (size_t i = 0; i < files.size; i += sizeof(font_file_t)) {
+        font_file_t* file = list_get(&files, i);
+        if (!strcmp(file->path, path))
+            return i / sizeof(font_file_t);
+    }
+
+    font_file_t file;
+    file.data = SDL_LoadFile(path, &file.data_size);
+    if (file.data == NULL) {
+        SDL_SetError("can not open %s\n%s()", path, __func__);
+        return -1;
+    }
+    file.path = malloc(strlen(path) + 1);
+    if (file.path == NULL) {
+        SDL_free(file.data);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return -1;
+    }
+    strcpy(file.path, path);
+
+    if (list_add(&files, &file, sizeof(font_file_t))) {
+        free(file.path);
+        SDL_free(file.data);
+        return -1;
+    }
+    return files.size / sizeof(font_file_t) - 1;
+}
@@ -0,0 +1,484 @@
+#include "../headers/glyphcache.h"
+
+#define CACHES_LIST_ALLOCATION_PORTION (8*sizeof(glyphcache_t*))
+#define GLYPHS_LIST_ALLOCATION_PORTION (128*sizeof(glyph_t))
+#define LAYOUT_LIST_ALLOCATION_PORTION (256*sizeof(placement_t))
+#define VERTICES_LIST_ALLOCATION_PORTION (1024*sizeof(SDL_Vertex))
+#define INDICES_LIST_ALLOCATION_PORTION (1536*sizeof(int))
+#define INITIAL_TABLE_SIZE 256 /* power of 2 */
+
+typedef struct {
+    Uint32 glyph;
+    int x, y;
+} placement_t;
+
+static list_t caches = { NULL, 0, 0, CACHES_LIST_ALLOCATION_PORTION };
+
+static glyphcache_t* create_cache(SDL_Renderer* renderer,
+                                  const char* font_path,
+                                  int font_size);
+static void destroy_cache(glyphcache_t* glyphcache);
+static int clear_atlas(glyphcache_t* glyphcache);
+static Uint32 decode_utf8(const char** text);
+static Uint32 hash_codepoint(Uint32 codepoint);
+static int find_glyph(const glyphcache_t* glyphcache, Uint32 codepoint);
+static int add_glyph(glyphcache_t* glyphcache, Uint32 codepoint);
+static int insert_into_table(glyphcache_t* glyphcache, Uint32 index);
+static int layout_text(glyphcache_t* glyphcache,
+                       const char* text,
+                       int wrap_width,
+                       int* width,
+                       int* height);
+static void render_layout(glyphcache_t* glyphcache,
+                          SDL_Color color,
+                          int x,
+                          int y);
+
+/* ---------------------- header functions definition ---------------------- */
+
+glyphcache_t* glyphcache_get(SDL_Renderer* renderer,
+                             const char* font_path,
+                             int font_size) {
+    for (size_t i = 0; i < caches.size; i += sizeof(glyphcache_t*)) {
+        glyphcache_t* glyphcache = *(glyphcache_t**)list_get(&caches, i);
+        if (glyphcache->renderer != renderer)
+            continue;
+        if (glyphcache->font_size != font_size)
+            continue;
+        if (!strcmp(glyphcache->font_path, font_path))
+            return glyphcache;
+    }
+
+    glyphcache_t* glyphcache = create_cache(renderer, font_path, font_size);
+    if (glyphcache == NULL)
+        return NULL;
+    if (list_add(&caches, &glyphcache, sizeof(glyphcache_t*))) {
+        destroy_cache(glyphcache);
+        return NULL;
+    }
+    return glyphcache;
+}
+
+void glyphcache_deinit(void) {
+    for (size_t i = 0; i < caches.size; i += sizeof(glyphcache_t*))
+        destroy_cache(*(glyphcache_t**)list_get(&caches, i));
+    list_free(&caches);
+}
+
+void glyphcache_measure(glyphcache_t* glyphcache,
+                        const char* text,
+                        int wrap_width,
+                        int* width,
+                        int* height) {
+    int w, h;
+    if (layout_text(glyphcache, text, wrap_width, &w, &h)) {
+        /* atlas is full, glyphs of the text are rasterized again */
+        clear_atlas(glyphcache);
+        layout_text(glyphcache, text, wrap_width, &w, &h);
+    }
+    if (width != NULL)
+        *width = w;
+    if (height != NULL)
+        *height = h;
+}
+
+void glyphcache_draw(glyphcache_t* glyphcache,
+                     const char* text,
+                     SDL_Color color,
+                     int x,
+                     int y,
+                     int wrap_width,
+                     const SDL_Rect* clip) {
+    glyphcache_measure(glyphcache, text, wrap_width, NULL, NULL);
+    if (!glyphcache->layout.size)
+        return;
+
+    SDL_Renderer* renderer = glyphcache->renderer;
+    SDL_Rect previous_clip;
+    SDL_bool is_clip_enabled = SDL_RenderIsClipEnabled(renderer);
+    SDL_RenderGetClipRect(renderer, &previous_clip);
+    if (clip != NULL)
+        SDL_RenderSetClipRect(renderer, clip);
+
+    render_layout(glyphcache, color, x, y);
+
+    if (clip != NULL)
+        SDL_RenderSetClipRect(
+            renderer, is_clip_enabled ? &previous_clip : NULL);
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static glyphcache_t* create_cache(SDL_Renderer* renderer,
+                                  const char* font_path,
+                                  int font_size) {
+    glyphcache_t* glyphcache = malloc(sizeof(glyphcache_t));
+    if (glyphcache == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+
+    glyphcache->renderer = renderer;
+    glyphcache->font_size = font_size;
+    glyphcache->font_path = NULL;
+    glyphcache->atlas = NULL;
+    glyphcache->table = NULL;
+    glyphcache->table_size = INITIAL_TABLE_SIZE;
+    list_init(&glyphcache->glyphs, GLYPHS_LIST_ALLOCATION_PORTION);
+    list_init(&glyphcache->layout, LAYOUT_LIST_ALLOCATION_PORTION);
+    list_init(&glyphcache->vertices, VERTICES_LIST_ALLOCATION_PORTION);
+    list_init(&glyphcache->indices, INDICES_LIST_ALLOCATION_PORTION);
+
+    glyphcache->font = fonts_get(font_path, font_size);
+    if (glyphcache->font == NULL) {
+        destroy_cache(glyphcache);
+        return NULL;
+    }
+    glyphcache->line_skip = TTF_FontLineSkip(glyphcache->font);
+
+    glyphcache->font_path = malloc(strlen(font_path) + 1);
+    glyphcache->table = malloc(INITIAL_TABLE_SIZE * sizeof(Uint32));
+    if (glyphcache->font_path == NULL || glyphcache->table == NULL) {
+        destroy_cache(glyphcache);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+    strcpy(glyphcache->font_path, font_path);
+
+    glyphcache->atlas = SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STATIC,
+        GLYPHCACHE_ATLAS_SIZE,
+        GLYPHCACHE_ATLAS_SIZE
+    );
+    if (glyphcache->atlas == NULL || clear_atlas(glyphcache)) {
+        destroy_cache(glyphcache);
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(glyphcache->atlas, SDL_BLENDMODE_BLEND);
+
+    return glyphcache;
+}
+
+static void destroy_cache(glyphcache_t* glyphcache) {
+    /* the font belongs to fonts.h */
+    if (glyphcache->atlas != NULL)
+        SDL_DestroyTexture(glyphcache->atlas);
+    free(glyphcache->font_path);
+    free(glyphcache->table);
+    list_free(&glyphcache->glyphs);
+    list_free(&glyphcache->layout);
+    list_free(&glyphcache->vertices);
+    list_free(&glyphcache->indices);
+    free(glyphcache);
+}
+
+static int clear_atlas(glyphcache_t* glyphcache) {
+    const int PITCH = GLYPHCACHE_ATLAS_SIZE * 4;
+    void* pixels = calloc(GLYPHCACHE_ATLAS_SIZE, PITCH);
+    if (pixels == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    int error = SDL_UpdateTexture(glyphcache->atlas, NULL, pixels, PITCH);
+    free(pixels);
+    if (error)
+        return 1;
+
+    glyphcache->shelf_x = 0;
+    glyphcache->shelf_y = 0;
+    glyphcache->shelf_height = 0;
+    list_clear(&glyphcache->glyphs);
+    memset(glyphcache->table, 0, glyphcache->table_size * sizeof(Uint32));
+    return 0;
+}
+
+static Uint32 decode_utf8(const char** text) {
+    const Uint8* c = (const Uint8*)*text;
+    Uint32 codepoint;
+    int length;
+
+    if (c[0] < 0x80) {
+        codepoint = c[0];
+        length = 1;
+    } else if ((c[0] & 0xE0) == 0xC0) {
+        codepoint = c[0] & 0x1F;
+        length = 2;
+    } else if ((c[0] & 0xF0) == 0xE0) {
+        codepoint = c[0] & 0x0F;
+        length = 3;
+    } else if ((c[0] & 0xF8) == 0xF0) {
+        codepoint = c[0] & 0x07;
+        length = 4;
+    } else {
+        *text += 1;
+        return 0xFFFD;
+    }
+
+    for (int i = 1; i < length; i++) {
+        if ((c[i] & 0xC0) != 0x80) {
+            *text += i;
+            return 0xFFFD;
+        }
+        codepoint = codepoint << 6 | (c[i] & 0x3F);
+    }
+    *text += length;
+    return codepoint;
+}
+
+static Uint32 hash_codepoint(Uint32 codepoint) {
+    return codepoint * 2654435761u;
+}
+
+static int find_glyph(const glyphcache_t* glyphcache, Uint32 codepoint) {
+    Uint32 mask = glyphcache->table_size - 1;
+    Uint32 h = hash_codepoint(codepoint) & mask;
+    for (; glyphcache->table[h]; h = (h+1) & mask) {
+        Uint32 index = glyphcache->table[h] - 1;
+        glyph_t* glyph = list_get(&glyphcache->glyphs, index*sizeof(glyph_t));
+        if (glyph->codepoint == codepoint)
+            return index;
+    }
+    return -1;
+}
+
+static int add_glyph(glyphcache_t* glyphcache, Uint32 codepoint) {
+    /* the font API of SDL ttf is limited by the basic multilingual plane */
+    Uint16 character = codepoint <= 0xFFFF ? codepoint : '?';
+    glyph_t glyph = { codepoint, { 0, 0, 0, 0 }, 0 };
+    TTF_GlyphMetrics(
+        glyphcache->font, character, NULL, NULL, NULL, NULL, &glyph.advance);
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* surface =
+        TTF_RenderGlyph_Blended(glyphcache->font, character, white);
+    if (surface != NULL
+            && surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        SDL_Surface* converted =
+            SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(surface);
+        surface = converted;
+    }
+
+    if (surface != NULL) {
+        int w = surface->w + GLYPHCACHE_GLYPH_PADDING;
+        int h = surface->h + GLYPHCACHE_GLYPH_PADDING;
+        if (glyphcache->shelf_x + w > GLYPHCACHE_ATLAS_SIZE) {
+            glyphcache->shelf_x = 0;
+            glyphcache->shelf_y += glyphcache->shelf_height;
+            glyphcache->shelf_height = 0;
+        }
+        if (glyphcache->shelf_y + h > GLYPHCACHE_ATLAS_SIZE
+                || w > GLYPHCACHE_ATLAS_SIZE) {
+            SDL_FreeSurface(surface);
+            return -1;
+        }
+
+        glyph.rect = (SDL_Rect){
+            .x = glyphcache->shelf_x,
+            .y = glyphcache->shelf_y,
+            .w = surface->w,
+            .h = surface->h
+        };
+        SDL_UpdateTexture(
+            glyphcache->atlas, &glyph.rect, surface->pixels, surface->pitch);
+        SDL_FreeSurface(surface);
+
+        glyphcache->shelf_x += w;
+        if (h > glyphcache->shelf_height)
+            glyphcache->shelf_height = h;
+    }
+
+    if (list_add(&glyphcache->glyphs, &glyph, sizeof(glyph_t)))
+        return -1;
+    Uint32 index = glyphcache->glyphs.size / sizeof(glyph_t) - 1;
+    if (insert_into_table(glyphcache, index)) {
+        list_erase(&glyphcache->glyphs, index*sizeof(glyph_t), sizeof(glyph_t));
+        return -1;
+    }
+    return index;
+}
+
+static int insert_into_table(glyphcache_t* glyphcache, Uint32 index) {
+    /* load factor is kept below 1/2 */
+    Uint32 glyph_count = glyphcache->glyphs.size / sizeof(glyph_t);
+    if (2*glyph_count > glyphcache->table_size) {
+        Uint32 table_size = 2 * glyphcache->table_size;
+        Uint32* table = calloc(table_size, sizeof(Uint32));
+        if (table == NULL) {
+            SDL_SetError("memory allocation failed\n%s()", __func__);
+            return 1;
+        }
+        free(glyphcache->table);
+        glyphcache->table = table;
+        glyphcache->table_size = table_size;
+        for (Uint32 i = 0; i < index; i++)
+            insert_into_table(glyphcache, i);
+    }
+
+    glyph_t* glyph = list_get(&glyphcache->glyphs, index*sizeof(glyph_t));
+    Uint32 mask = glyphcache->table_size - 1;
+    Uint32 h = hash_codepoint(glyph->codepoint) & mask;
+    while (glyphcache->table[h])
+        h = (h+1) & mask;
+    glyphcache->table[h] = index + 1;
+    return 0;
+}
+
+static int layout_text(glyphcache_t* glyphcache,
+                       const char* text,
+                       int wrap_width,
+                       int* width,
+                       int* height) {
+    list_t* layout = &glyphcache->layout;
+    list_clear(layout);
+
+    int x = 0, y = 0;
+    int max_width = 0;
+    int has_space = 0;
+    int space_x = 0;
+    int word_x = 0;
+    size_t word_begin = 0;
+    int failed = 0;
+
+    while (*text) {
+        Uint32 codepoint = decode_utf8(&text);
+        if (codepoint == '\n') {
+            if (x > max_width)
+                max_width = x;
+            x = 0;
+            y += glyphcache->line_skip;
+            has_space = 0;
+            word_begin = layout->size;
+            continue;
+        }
+
+        int index = find_glyph(glyphcache, codepoint);
+        if (index < 0)
+            index = add_glyph(glyphcache, codepoint);
+        if (index < 0) {
+            failed = 1;
+            continue;
+        }
+        glyph_t* glyph = list_get(&glyphcache->glyphs, index*sizeof(glyph_t));
+
+        int is_overflow = wrap_width > 0 && x > 0
+            && x + glyph->advance > wrap_width;
+        if (is_overflow && codepoint != ' ') {
+            if (has_space) {
+                /* the current word is moved to the next line */
+                if (space_x > max_width)
+                    max_width = space_x;
+                y += glyphcache->line_skip;
+                size_t i = word_begin;
+                for (; i < layout->size; i += sizeof(placement_t)) {
+                    placement_t* placement = list_get(layout, i);
+                    placement->x -= word_x;
+                    placement->y = y;
+                }
+                x -= word_x;
+            } else {
+                if (x > max_width)
+                    max_width = x;
+                y += glyphcache->line_skip;
+                x = 0;
+            }
+            has_space = 0;
+            word_x = 0;
+            word_begin = layout->size;
+        }
+
+        placement_t placement = { index, x, y };
+        if (list_add(layout, &placement, sizeof(placement_t))) {
+            failed = 1;
+            break;
+        }
+        x += glyph->advance;
+
+        if (codepoint == ' ') {
+            has_space = 1;
+            space_x = x - glyph->advance;
+            word_x = x;
+            word_begin = layout->size;
+        }
+    }
+
+    if (x > max_width)
+        max_width = x;
+    *width = max_width;
+    *height = x || y ? y + glyphcache->line_skip : 0;
+    return failed;
+}
+
+static void render_layout(glyphcache_t* glyphcache,
+                          SDL_Color color,
+                          int x,
+                          int y) {
+    list_t* layout = &glyphcache->layout;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    const float ATLAS_SIZE = GLYPHCACHE_ATLAS_SIZE;
+    list_t* vertices = &glyphcache->vertices;
+    list_t* indices = &glyphcache->indices;
+    list_clear(vertices);
+    list_clear(indices);
+
+    for (size_t i = 0; i < layout->size; i += sizeof(placement_t)) {
+        placement_t* placement = list_get(layout, i);
+        glyph_t* glyph = list_get(
+            &glyphcache->glyphs, placement->glyph*sizeof(glyph_t));
+        if (!glyph->rect.w || !glyph->rect.h)
+            continue;
+
+        float x_begin = x + placement->x;
+        float y_begin = y + placement->y;
+        float x_end = x_begin + glyph->rect.w;
+        float y_end = y_begin + glyph->rect.h;
+        float u_begin = glyph->rect.x / ATLAS_SIZE;
+        float v_begin = glyph->rect.y / ATLAS_SIZE;
+        float u_end = (glyph->rect.x + glyph->rect.w) / ATLAS_SIZE;
+        float v_end = (glyph->rect.y + glyph->rect.h) / ATLAS_SIZE;
+
+        int first = vertices->size / sizeof(SDL_Vertex);
+        SDL_Vertex quad[4] = {
+            { { x_begin, y_begin }, color, { u_begin, v_begin } },
+            { { x_end,   y_begin }, color, { u_end,   v_begin } },
+            { { x_begin, y_end   }, color, { u_begin, v_end   } },
+            { { x_end,   y_end   }, color, { u_end,   v_end   } }
+        };
+        int quad_indices[6] =
+            { first, first+1, first+2, first+2, first+1, first+3 };
+        if (list_add(vertices, quad, sizeof(quad)))
+            break;
+        if (list_add(indices, quad_indices, sizeof(quad_indices))) {
+            vertices->size -= sizeof(quad);
+            break;
+        }
+    }
+
+    SDL_RenderGeometry(
+        glyphcache->renderer,
+        glyphcache->atlas,
+        vertices->begin,
+        vertices->size / sizeof(SDL_Vertex),
+        indices->begin,
+        indices->size / sizeof(int)
+    );
+#else
+    SDL_SetTextureColorMod(glyphcache->atlas, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(glyphcache->atlas, color.a);
+    for (size_t i = 0; i < layout->size; i += sizeof(placement_t)) {
+        placement_t* placement = list_get(layout, i);
+        glyph_t* glyph = list_get(
+            &glyphcache->glyphs, placement->glyph*sizeof(glyph_t));
+        SDL_Rect dstrect = {
+            .x = x + placement->x,
+            .y = y + placement->y,
+            .w = glyph->rect.w,
+            .h = glyph->rect.h
+        };
+        SDL_RenderCopy(
+            glyphcache->renderer, glyphcache->atlas, &glyph->rect, &dstrect);
+    }
+#endif
+}
@@ -0,0 +1,137 @@
+#include "../headers/headless.h"
+
+static int render(const options_t* options, SDL_Renderer* renderer);
+static int save_image(SDL_Renderer* renderer,
+                      int width,
+                      int height,
+                      const char* path);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int headless_init(void) {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO))
+        return 1;
+
+    if (!IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG)) {
+        SDL_SetError(IMG_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    if (TTF_Init()) {
+        SDL_SetError(TTF_GetError());
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    if (http_init()) {
+        TTF_Quit();
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    return 0;
+}
+
+void headless_deinit(void) {
+    http_deinit();
+    fonts_deinit();
+    TTF_Quit();
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int headless_render(const options_t* options) {
+    Uint64 start = perf_now();
+    if (headless_init())
+        return 1;
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
+        0,
+        options->width,
+        options->height,
+        32,
+        SDL_PIXELFORMAT_ARGB8888
+    );
+    if (surface == NULL) {
+        headless_deinit();
+        return 1;
+    }
+    SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+    if (renderer == NULL) {
+        SDL_FreeSurface(surface);
+        headless_deinit();
+        return 1;
+    }
+
+    int error = render(options, renderer);
+
+    glyphcache_deinit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    headless_deinit();
+
+    if (!error)
+        perf_log_time("headless rendering", start);
+    return error;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int render(const options_t* options, SDL_Renderer* renderer) {
+    map_t* map = map_init(
+        renderer,
+        &options->tilesource,
+        options->center,
+        options->zoom
+    );
+    if (map == NULL)
+        return 1;
+
+    SDL_Rect area = { 0, 0, options->width, options->height };
+    SDL_Event event;
+    while (!map->is_loaded) {
+        if (!SDL_WaitEvent(&event)) {
+            map_deinit(map);
+            return 1;
+        }
+        map_handle_event(map, &event, renderer, area);
+    }
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    map_draw(map, area);
+    int error = save_image(
+        renderer, options->width, options->height, options->output_path);
+
+    map_deinit(map);
+    return error;
+}
+
+static int save_image(SDL_Renderer* renderer,
+                      int width,
+                      int height,
+                      const char* path) {
+    SDL_Surface* image = SDL_CreateRGBSurfaceWithFormat(
+        0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (image == NULL)
+        return 1;
+
+    int error = SDL_RenderReadPixels(
+        renderer,
+        NULL,
+        image->format->format,
+        image->pixels,
+        image->pitch
+    );
+    if (!error && IMG_SavePNG(image, path)) {
+        SDL_SetError(IMG_GetError());
+        error = 1;
+    }
+
+    SDL_FreeSurface(image);
+    return error;
+}
@@ -1,5 +1,15 @@
 #include "../headers/http.h"
 
+#ifdef _WIN32
+#define SEND_FLAGS 0
+#else
+typedef int SOCKET;
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+#define closesocket close
+#define SEND_FLAGS MSG_NOSIGNAL /* broken connection must not kill us */
+#endif
+
 typedef struct {
     size_t content_total_length;
     size_t content_length;
@@ -16,15 +26,21 @@ static http_response_t parse_response(const char* response, size_t size);
 /* ---------------------- header functions definition ---------------------- */
 
 int http_init(void) {
+#ifdef _WIN32
     WORD version = MAKEWORD(2, 2);
     int error = WSAStartup(version, &(WSADATA){});
     if (error)
         SDL_SetError("windows socket initialization failed");
     return error;
+#else
+    return 0;
+#endif
 }
 
 void http_deinit(void) {
+#ifdef _WIN32
     WSACleanup();
+#endif
 }
 
 response_t http_get(const char* hostname, const char* path) {
@@ -77,13 +93,17 @@ response_t http_get(const char* hostname, const char* path) {
 /* ---------------------- static functions definition ---------------------- */
 
 static SOCKET init_socket(const char* hostname) {
+#ifdef _WIN32
     SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (sock == INVALID_SOCKET)
         return INVALID_SOCKET;
 
+    /* gethostbyname() result is thread local on windows */
     struct hostent* host = gethostbyname(hostname);
-    if (host == NULL)
+    if (host == NULL) {
+        closesocket(sock);
         return INVALID_SOCKET;
+    }
 
     struct sockaddr_in host_address = {
         .sin_family         = AF_INET,
@@ -91,9 +111,30 @@ static SOCKET init_socket(const char* hostname) {
         .sin_addr.s_addr    = *(ULONG*)host->h_addr
     };
 
-    if (connect(sock, (struct sockaddr*)&host_address, sizeof(host_address)))
+    if (connect(sock, (struct sockaddr*)&host_address, sizeof(host_address))) {
+        closesocket(sock);
+        return INVALID_SOCKET;
+    }
+#else
+    /* tiles are loaded from several threads, getaddrinfo() is reentrant */
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* address = NULL;
+    if (getaddrinfo(hostname, "80", &hints, &address))
         return INVALID_SOCKET;
 
+    SOCKET sock = socket(
+        address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (sock != INVALID_SOCKET
+            && connect(sock, address->ai_addr, address->ai_addrlen)) {
+        closesocket(sock);
+        sock = INVALID_SOCKET;
+    }
+    freeaddrinfo(address);
+#endif
+
     return sock;
 }
 
@@ -120,7 +161,7 @@ static char* make_request(const char* hostname, const char* path) {
 }
 
 static int http_send(SOCKET sock, const char* request) {
-    return SOCKET_ERROR == send(sock, request, strlen(request), 0);
+    return SOCKET_ERROR == send(sock, request, strlen(request), SEND_FLAGS);
 }
 
 static size_t http_receive(SOCKET sock, void* buffer, size_t buffer_size) {
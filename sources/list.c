@@ -7,23 +7,43 @@ void list_init(list_t* list, size_t allocation_portion_byte) {
     list->allocation_portion = allocation_portion_byte;
 }
 
+void list_init_borrowed(list_t* list,
+                        void* data,
+                        size_t size_byte,
+                        size_t allocation_portion_byte) {
+    list->begin = data;
+    list->size = size_byte;
+    list->allocated_size = 0;
+    list->allocation_portion = allocation_portion_byte;
+}
+
 void list_free(list_t* list) {
-    free(list->begin);
+    if (list->allocated_size)
+        free(list->begin);
     list->begin = NULL;
     list->size = 0;
     list->allocated_size = 0;
 }
 
+void list_clear(list_t* list) {
+    list->size = 0;
+}
+
 int list_add(list_t* list, const void* data, size_t data_size) {
     if (list->size + data_size > list->allocated_size) {
+        /* borrowed items are copied into the first allocated block */
+        int is_borrowed = !list->allocated_size && list->begin != NULL;
         size_t realloc_size = list->allocated_size;
         while (realloc_size < list->size + data_size)
             realloc_size += list->allocation_portion;
-        void* new_begin = realloc(list->begin, realloc_size);
+        void* new_begin =
+            realloc(is_borrowed ? NULL : list->begin, realloc_size);
         if (new_begin == NULL) {
             SDL_SetError("memory allocation failed\n%s()", __func__);
             return 1;
         }
+        if (is_borrowed)
+            memcpy(new_begin, list->begin, list->size);
         list->begin = new_begin;
         list->allocated_size = realloc_size;
     }
@@ -38,14 +58,19 @@ int list_insert(list_t* list,
                 const void* data,
                 size_t data_size) {
     if (list->size + data_size > list->allocated_size) {
+        /* borrowed items are copied into the first allocated block */
+        int is_borrowed = !list->allocated_size && list->begin != NULL;
         size_t realloc_size = list->allocated_size;
         while (realloc_size < list->size + data_size)
             realloc_size += list->allocation_portion;
-        void* new_begin = realloc(list->begin, realloc_size);
+        void* new_begin =
+            realloc(is_borrowed ? NULL : list->begin, realloc_size);
         if (new_begin == NULL) {
             SDL_SetError("memory allocation failed\n%s()", __func__);
             return 1;
         }
+        if (is_borrowed)
+            memcpy(new_begin, list->begin, list->size);
         list->begin = new_begin;
         list->allocated_size = realloc_size;
     }
@@ -0,0 +1,218 @@
+#include "../../headers/map/clusters.h"
+
+#define INITIAL_TABLE_SIZE 256 /* power of two */
+
+typedef struct {
+    cluster_level_t* level;
+    const markerpool_t* markers;
+} build_t;
+
+static int build_level_async(void* ptr_build); /* SDL_ThreadFunction */
+static int insert_into_level(cluster_level_t* level, Uint32 x, Uint32 y);
+static cluster_t* find_slot(const cluster_level_t* level,
+                            Uint32 cell_x,
+                            Uint32 cell_y);
+static Uint32 get_home_slot(const cluster_level_t* level,
+                            Uint32 cell_x,
+                            Uint32 cell_y);
+static void erase_slot(cluster_level_t* level, Uint32 slot);
+static int grow_table(cluster_level_t* level);
+static void free_level(cluster_level_t* level);
+
+/* ---------------------- header functions definition ---------------------- */
+
+void clusters_init(clusters_t* clusters, Uint8 world_zoom) {
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        cluster_level_t* level = &clusters->levels[zoom];
+        level->table = NULL;
+        level->table_size = 0;
+        level->count = 0;
+        level->cell_size_log2 = CLUSTERS_CELL_SIZE_LOG2 + world_zoom - zoom;
+        level->is_borrowed = 0;
+    }
+}
+
+void clusters_free(clusters_t* clusters) {
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++)
+        free_level(&clusters->levels[zoom]);
+}
+
+int clusters_insert(clusters_t* clusters, Uint32 x, Uint32 y) {
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        if (insert_into_level(&clusters->levels[zoom], x, y))
+            return 1;
+    }
+    return 0;
+}
+
+void clusters_remove(clusters_t* clusters, Uint32 x, Uint32 y) {
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        cluster_level_t* level = &clusters->levels[zoom];
+        if (!level->count)
+            continue;
+        Uint8 shift = level->cell_size_log2;
+        cluster_t* cluster = find_slot(level, x >> shift, y >> shift);
+        if (!cluster->count)
+            continue;
+        cluster->sum_x -= x;
+        cluster->sum_y -= y;
+        if (!--cluster->count)
+            erase_slot(level, cluster - level->table);
+    }
+}
+
+int clusters_build(clusters_t* clusters, const markerpool_t* markers) {
+    build_t builds[CLUSTERS_LEVEL_COUNT];
+    SDL_Thread* threads[CLUSTERS_LEVEL_COUNT];
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        free_level(&clusters->levels[zoom]);
+        builds[zoom].level = &clusters->levels[zoom];
+        builds[zoom].markers = markers;
+        threads[zoom] = SDL_CreateThread(
+            build_level_async, "clusters", &builds[zoom]);
+    }
+
+    /* a level whose thread is not created is built by this thread */
+    int error = 0;
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        int status;
+        if (threads[zoom] != NULL)
+            SDL_WaitThread(threads[zoom], &status);
+        else
+            status = build_level_async(&builds[zoom]);
+        error |= status;
+    }
+
+    if (error) {
+        clusters_free(clusters);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+    }
+    return error;
+}
+
+const cluster_t* clusters_get(const clusters_t* clusters,
+                              Uint8 zoom,
+                              Uint32 cell_x,
+                              Uint32 cell_y) {
+    const cluster_level_t* level = &clusters->levels[zoom];
+    if (!level->count)
+        return NULL;
+    const cluster_t* cluster = find_slot(level, cell_x, cell_y);
+    return cluster->count ? cluster : NULL;
+}
+
+Uint32 clusters_get_cell_size(const clusters_t* clusters, Uint8 zoom) {
+    return (Uint32)1 << clusters->levels[zoom].cell_size_log2;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int build_level_async(void* ptr_build) {
+    /* SDL_ThreadFunction */
+    build_t* build = ptr_build;
+    const markerpool_t* markers = build->markers;
+    for (Uint32 i = 0; i < markers->slot_count; i++) {
+        const marker_t* marker = markerpool_at(markers, i);
+        if (marker == NULL)
+            continue;
+        if (insert_into_level(build->level, marker->x, marker->y))
+            return 1;
+    }
+    return 0;
+}
+
+static int insert_into_level(cluster_level_t* level, Uint32 x, Uint32 y) {
+    /* the table is kept at most half full */
+    if (2*(level->count + 1) > level->table_size && grow_table(level))
+        return 1;
+
+    Uint32 cell_x = x >> level->cell_size_log2;
+    Uint32 cell_y = y >> level->cell_size_log2;
+    cluster_t* cluster = find_slot(level, cell_x, cell_y);
+    if (!cluster->count) {
+        cluster->cell_x = cell_x;
+        cluster->cell_y = cell_y;
+        cluster->sum_x = 0;
+        cluster->sum_y = 0;
+        level->count++;
+    }
+    cluster->count++;
+    cluster->sum_x += x;
+    cluster->sum_y += y;
+    return 0;
+}
+
+static cluster_t* find_slot(const cluster_level_t* level,
+                            Uint32 cell_x,
+                            Uint32 cell_y) {
+    Uint32 mask = level->table_size - 1;
+    Uint32 slot = get_home_slot(level, cell_x, cell_y);
+    for (;; slot = (slot + 1) & mask) {
+        cluster_t* cluster = &level->table[slot];
+        if (!cluster->count)
+            return cluster;
+        if (cluster->cell_x == cell_x && cluster->cell_y == cell_y)
+            return cluster;
+    }
+}
+
+static Uint32 get_home_slot(const cluster_level_t* level,
+                            Uint32 cell_x,
+                            Uint32 cell_y) {
+    Uint32 mask = level->table_size - 1;
+    return (cell_x*2654435761u ^ cell_y*2246822519u) & mask;
+}
+
+static void erase_slot(cluster_level_t* level, Uint32 slot) {
+    /*
+        linear probing without tombstones: following clusters whose home
+        slot is not between the hole and them are moved into the hole
+    */
+    Uint32 mask = level->table_size - 1;
+    Uint32 hole = slot;
+    for (slot = (slot + 1) & mask; level->table[slot].count;
+            slot = (slot + 1) & mask) {
+        cluster_t* cluster = &level->table[slot];
+        Uint32 home = get_home_slot(level, cluster->cell_x, cluster->cell_y);
+        if ((slot - home & mask) >= (slot - hole & mask)) {
+            level->table[hole] = *cluster;
+            hole = slot;
+        }
+    }
+    level->table[hole].count = 0;
+    level->count--;
+}
+
+static int grow_table(cluster_level_t* level) {
+    Uint32 table_size =
+        level->table_size ? 2*level->table_size : INITIAL_TABLE_SIZE;
+    cluster_t* table = calloc(table_size, sizeof(cluster_t));
+    if (table == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+
+    cluster_level_t grown = *level;
+    grown.table = table;
+    grown.table_size = table_size;
+    for (Uint32 i = 0; i < level->table_size; i++) {
+        const cluster_t* cluster = &level->table[i];
+        if (cluster->count)
+            *find_slot(&grown, cluster->cell_x, cluster->cell_y) = *cluster;
+    }
+
+    if (!level->is_borrowed)
+        free(level->table);
+    grown.is_borrowed = 0;
+    *level = grown;
+    return 0;
+}
+
+static void free_level(cluster_level_t* level) {
+    if (!level->is_borrowed)
+        free(level->table);
+    level->is_borrowed = 0;
+    level->table = NULL;
+    level->table_size = 0;
+    level->count = 0;
+}
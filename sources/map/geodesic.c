@@ -0,0 +1,112 @@
+#include "../../headers/map/geodesic.h"
+
+static void to_radians(const geodesic_origin_t* origin,
+                       Uint32 x,
+                       Uint32 y,
+                       double* lat,
+                       double* lon);
+static double get_central_angle(double lat_a,
+                                double cos_lat_a,
+                                double lon_a,
+                                double lat_b,
+                                double lon_b);
+
+/* ---------------------- header functions definition ---------------------- */
+
+void geodesic_init_origin(geodesic_origin_t* origin,
+                          double lat,
+                          double lon,
+                          Uint32 world_size) {
+    origin->lat = lat * M_PI/180;
+    origin->lon = lon * M_PI/180;
+    origin->sin_lat = sin(origin->lat);
+    origin->cos_lat = cos(origin->lat);
+    origin->world_size = world_size;
+}
+
+double geodesic_get_distance(void* ptr_origin,
+                             Uint32 x,
+                             Uint32 y,
+                             Uint32 size) {
+    const geodesic_origin_t* origin = ptr_origin;
+    double lat = origin->lat;
+    double lon = origin->lon;
+    double lat_end, lon_end;
+    to_radians(origin, x, y, &lat_end, &lon_end);
+    if (!size) {
+        double angle =
+            get_central_angle(lat, origin->cos_lat, lon, lat_end, lon_end);
+        return angle * GEODESIC_EARTH_RADIUS;
+    }
+
+    /* y grows to the south, so the top edge is the northern one */
+    double lat_max = lat_end;
+    double lon_begin = lon_end;
+    double lat_min;
+    to_radians(origin, x + size, y + size, &lat_min, &lon_end);
+
+    /*
+        inside the longitudes of the square the nearest point is on the
+        meridian of the origin; outside it is on the nearer edge meridian,
+        where the great circle across it bulges towards the pole, so the
+        latitude is not the one of the origin but the foot of the
+        perpendicular from the origin to the meridian
+    */
+    double nearest_lon = lon;
+    double foot_lat = lat;
+    if (lon < lon_begin || lon > lon_end) {
+        double delta_begin = fabs(remainder(lon - lon_begin, 2*M_PI));
+        double delta_end = fabs(remainder(lon - lon_end, 2*M_PI));
+        double delta = delta_begin < delta_end ? delta_begin : delta_end;
+        nearest_lon = delta_begin < delta_end ? lon_begin : lon_end;
+        foot_lat = atan2(origin->sin_lat, origin->cos_lat * cos(delta));
+    }
+    if (foot_lat >= lat_min && foot_lat <= lat_max) {
+        double angle = get_central_angle(
+            lat, origin->cos_lat, lon, foot_lat, nearest_lon);
+        return angle * GEODESIC_EARTH_RADIUS;
+    }
+
+    /* a foot beyond the pole makes the farther edge the nearer one */
+    double angle_min = get_central_angle(
+        lat, origin->cos_lat, lon, lat_min, nearest_lon);
+    double angle_max = get_central_angle(
+        lat, origin->cos_lat, lon, lat_max, nearest_lon);
+    double angle = angle_min < angle_max ? angle_min : angle_max;
+    return angle * GEODESIC_EARTH_RADIUS;
+}
+
+double geodesic_measure(double lat_a,
+                        double lon_a,
+                        double lat_b,
+                        double lon_b) {
+    lat_a *= M_PI/180;
+    lat_b *= M_PI/180;
+    double angle = get_central_angle(
+        lat_a, cos(lat_a), lon_a * M_PI/180, lat_b, lon_b * M_PI/180);
+    return angle * GEODESIC_EARTH_RADIUS;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static void to_radians(const geodesic_origin_t* origin,
+                       Uint32 x,
+                       Uint32 y,
+                       double* lat,
+                       double* lon) {
+    /* inverse of the Web Mercator projection */
+    *lon = x / origin->world_size * 2*M_PI - M_PI;
+    *lat = atan(sinh(M_PI * (1 - 2*y / origin->world_size)));
+}
+
+static double get_central_angle(double lat_a,
+                                double cos_lat_a,
+                                double lon_a,
+                                double lat_b,
+                                double lon_b) {
+    /* haversine formula, it keeps the precision of short distances */
+    double sin_lat = sin((lat_b - lat_a) / 2);
+    double sin_lon = sin((lon_b - lon_a) / 2);
+    double h = sin_lat*sin_lat + cos_lat_a*cos(lat_b)*sin_lon*sin_lon;
+    return 2 * asin(sqrt(h < 1 ? h : 1));
+}
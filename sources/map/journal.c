@@ -0,0 +1,510 @@
+#include "../../headers/map/journal.h"
+
+#define RECORD_LIST_ALLOCATION_PORTION (64*1024)
+#define RECORD_TEXTS_MAX \
+    (CONFIG_MARKER_NAME_MAX + CONFIG_MARKER_DESCRIPTION_MAX)
+
+static char* get_path(const char* path, const char* suffix);
+static int replay(const char* path,
+                  Uint64 after_sequence,
+                  markerpool_t* markers,
+                  textarena_t* texts,
+                  textblob_t* descriptions,
+                  quadtree_t* index,
+                  Uint64* last_sequence,
+                  Uint64* valid_size,
+                  Uint32* replayed_count);
+static int apply_record(const journal_record_t* record,
+                        const char* record_texts,
+                        markerpool_t* markers,
+                        textarena_t* texts,
+                        textblob_t* descriptions,
+                        quadtree_t* index);
+static Uint32 get_checksum(const journal_record_t* record,
+                           const char* record_texts);
+static int append(journal_t* journal,
+                  journal_record_t* record,
+                  const char* name,
+                  const char* description);
+static int write_async(void* ptr_journal); /* SDL_ThreadFunction */
+static int compact(journal_t* journal);
+static int open_file(journal_t* journal, Uint64 size);
+static void close_file(journal_t* journal);
+static int write_file(journal_t* journal, const void* data, size_t size);
+static int flush_file(journal_t* journal);
+
+/* ---------------------- header functions definition ---------------------- */
+
+journal_t* journal_open(const char* snapshot_path,
+                        Uint64 snapshot_sequence,
+                        Uint8 world_zoom,
+                        markerpool_t* markers,
+                        textarena_t* texts,
+                        textblob_t* descriptions,
+                        quadtree_t* index,
+                        Uint32* replayed_count) {
+    *replayed_count = 0;
+    journal_t* journal = calloc(1, sizeof(journal_t));
+    if (journal == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+    journal->path = get_path(snapshot_path, ".journal");
+    journal->snapshot_path = get_path(snapshot_path, "");
+    journal->index_size = index->size;
+    journal->world_zoom = world_zoom;
+    journal->compaction_size = JOURNAL_COMPACTION_SIZE;
+    list_init(&journal->pending, RECORD_LIST_ALLOCATION_PORTION);
+    list_init(&journal->writing, RECORD_LIST_ALLOCATION_PORTION);
+    journal->mutex = SDL_CreateMutex();
+    journal->appended = SDL_CreateCond();
+    journal->written = SDL_CreateCond();
+    int is_ready = journal->path != NULL
+        && journal->snapshot_path != NULL
+        && journal->mutex != NULL
+        && journal->appended != NULL
+        && journal->written != NULL;
+    if (!is_ready) {
+        SDL_SetError("journal initialization failed\n%s()", __func__);
+        journal_close(journal);
+        return NULL;
+    }
+
+    Uint64 last_sequence = 0;
+    Uint64 valid_size = 0;
+    int error = replay(
+        journal->path,
+        snapshot_sequence,
+        markers,
+        texts,
+        descriptions,
+        index,
+        &last_sequence,
+        &valid_size,
+        replayed_count
+    );
+    if (error) {
+        journal_close(journal);
+        return NULL;
+    }
+    journal->sequence = last_sequence > snapshot_sequence
+        ? last_sequence : snapshot_sequence;
+    journal->written_sequence = journal->sequence;
+
+    /* the torn tail is cut off, so new records follow valid ones */
+    if (open_file(journal, valid_size)) {
+        journal_close(journal);
+        return NULL;
+    }
+    journal->writer = SDL_CreateThread(write_async, NULL, journal);
+    if (journal->writer == NULL) {
+        journal_close(journal);
+        return NULL;
+    }
+    return journal;
+}
+
+void journal_close(journal_t* journal) {
+    if (journal == NULL)
+        return;
+    if (journal->writer != NULL) {
+        SDL_LockMutex(journal->mutex);
+        journal->is_closing = 1;
+        SDL_CondSignal(journal->appended);
+        SDL_UnlockMutex(journal->mutex);
+        SDL_WaitThread(journal->writer, NULL);
+    }
+    close_file(journal);
+    list_free(&journal->pending);
+    list_free(&journal->writing);
+    SDL_DestroyCond(journal->written);
+    SDL_DestroyCond(journal->appended);
+    SDL_DestroyMutex(journal->mutex);
+    free(journal->snapshot_path);
+    free(journal->path);
+    free(journal);
+}
+
+int journal_add(journal_t* journal,
+                Uint32 index,
+                const marker_t* marker,
+                const char* name,
+                const char* description) {
+    journal_record_t record = {
+        .index = index,
+        .x = marker->x,
+        .y = marker->y,
+        .name_length = marker->name_length,
+        .description_length = marker->description_length,
+        .type = JOURNAL_ADD,
+        .color = marker->color
+    };
+    return append(journal, &record, name, description);
+}
+
+int journal_remove(journal_t* journal, Uint32 index) {
+    journal_record_t record = { .index = index, .type = JOURNAL_REMOVE };
+    return append(journal, &record, NULL, NULL);
+}
+
+int journal_sync(journal_t* journal) {
+    SDL_LockMutex(journal->mutex);
+    while (!journal->has_failed
+            && journal->written_sequence != journal->sequence)
+        SDL_CondWait(journal->written, journal->mutex);
+    int has_failed = journal->has_failed;
+    SDL_UnlockMutex(journal->mutex);
+    if (has_failed) {
+        SDL_SetError("journal can not be written\n%s()", __func__);
+        return 1;
+    }
+    return 0;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static char* get_path(const char* path, const char* suffix) {
+    size_t size = strlen(path) + strlen(suffix) + 1;
+    char* result = malloc(size);
+    if (result != NULL)
+        snprintf(result, size, "%s%s", path, suffix);
+    return result;
+}
+
+static int replay(const char* path,
+                  Uint64 after_sequence,
+                  markerpool_t* markers,
+                  textarena_t* texts,
+                  textblob_t* descriptions,
+                  quadtree_t* index,
+                  Uint64* last_sequence,
+                  Uint64* valid_size,
+                  Uint32* replayed_count) {
+    /* a journal which can not be read is created by open_file() */
+    SDL_RWops* file = SDL_RWFromFile(path, "rb");
+    if (file == NULL)
+        return 0;
+
+    char record_texts[RECORD_TEXTS_MAX];
+    journal_record_t record;
+    int error = 0;
+    while (!error && SDL_RWread(file, &record, sizeof(record), 1) == 1) {
+        size_t text_length = record.name_length + record.description_length;
+        int is_valid = record.sequence > *last_sequence
+            && record.name_length <= CONFIG_MARKER_NAME_MAX
+            && record.description_length <= CONFIG_MARKER_DESCRIPTION_MAX
+            && (record.type == JOURNAL_ADD
+                || (record.type == JOURNAL_REMOVE && !text_length));
+        if (is_valid && text_length)
+            is_valid = SDL_RWread(file, record_texts, text_length, 1) == 1;
+        if (!is_valid || get_checksum(&record, record_texts)
+                != record.checksum)
+            break;
+
+        if (record.sequence > after_sequence) {
+            error = apply_record(
+                &record, record_texts, markers, texts, descriptions, index);
+            *replayed_count += !error;
+        }
+        *last_sequence = record.sequence;
+        *valid_size += sizeof(record) + text_length;
+    }
+    SDL_RWclose(file);
+    return error;
+}
+
+static int apply_record(const journal_record_t* record,
+                        const char* record_texts,
+                        markerpool_t* markers,
+                        textarena_t* texts,
+                        textblob_t* descriptions,
+                        quadtree_t* index) {
+    if (record->type == JOURNAL_REMOVE) {
+        marker_t* marker = markerpool_at(markers, record->index);
+        if (marker == NULL) {
+            SDL_SetError("journal does not match the snapshot\n%s()",
+                         __func__);
+            return 1;
+        }
+        quadtree_remove(index, marker->x, marker->y, record->index);
+        textarena_release(texts, marker->name_length);
+        textblob_release(descriptions, marker->description_length);
+        marker_handle_t handle = markerpool_get_handle(markers, record->index);
+        markerpool_remove(markers, handle);
+        return 0;
+    }
+
+    marker_t marker = {
+        .x = record->x,
+        .y = record->y,
+        .color = record->color,
+        .name_length = record->name_length,
+        .description_length = record->description_length
+    };
+    const char* description = record_texts + record->name_length;
+    marker_handle_t handle;
+    int error = textarena_add(
+            texts, record_texts, marker.name_length, &marker.name)
+        || textblob_add(
+            descriptions,
+            description,
+            marker.description_length,
+            &marker.description
+        )
+        || markerpool_add(markers, &marker, &handle);
+    if (error)
+        return 1;
+    if (handle.index != record->index) {
+        SDL_SetError("journal does not match the snapshot\n%s()", __func__);
+        return 1;
+    }
+    return quadtree_insert(index, marker.x, marker.y, handle.index);
+}
+
+static Uint32 get_checksum(const journal_record_t* record,
+                           const char* record_texts) {
+    /* FNV-1a of the record with checksum 0 and of its texts */
+    journal_record_t header = *record;
+    header.checksum = 0;
+    Uint32 checksum = 2166136261u;
+    const Uint8* bytes = (const Uint8*)&header;
+    for (size_t i = 0; i < sizeof(header); i++)
+        checksum = (checksum ^ bytes[i]) * 16777619u;
+    size_t text_length = record->name_length + record->description_length;
+    bytes = (const Uint8*)record_texts;
+    for (size_t i = 0; i < text_length; i++)
+        checksum = (checksum ^ bytes[i]) * 16777619u;
+    return checksum;
+}
+
+static int append(journal_t* journal,
+                  journal_record_t* record,
+                  const char* name,
+                  const char* description) {
+    /* the checksum is taken over one buffer of texts */
+    char record_texts[RECORD_TEXTS_MAX];
+    memcpy(record_texts, name, record->name_length);
+    memcpy(
+        record_texts + record->name_length,
+        description,
+        record->description_length
+    );
+    size_t text_length = record->name_length + record->description_length;
+
+    SDL_LockMutex(journal->mutex);
+    if (journal->has_failed) {
+        SDL_UnlockMutex(journal->mutex);
+        SDL_SetError("journal can not be written\n%s()", __func__);
+        return 1;
+    }
+    record->sequence = journal->sequence + 1;
+    record->checksum = get_checksum(record, record_texts);
+    list_t* pending = &journal->pending;
+    size_t size = pending->size;
+    int error = list_add(pending, record, sizeof(journal_record_t))
+        || (text_length && list_add(pending, record_texts, text_length));
+    if (error) {
+        pending->size = size;
+    } else {
+        journal->sequence++;
+        SDL_CondSignal(journal->appended);
+    }
+    SDL_UnlockMutex(journal->mutex);
+    return error;
+}
+
+static int write_async(void* ptr_journal) {
+    /* SDL_ThreadFunction */
+    journal_t* journal = ptr_journal;
+
+    SDL_LockMutex(journal->mutex);
+    for (;;) {
+        while (!journal->is_closing && !journal->pending.size)
+            SDL_CondWait(journal->appended, journal->mutex);
+        if (!journal->pending.size || journal->has_failed)
+            break;
+
+        /* everything appended so far is one group with one flush */
+        list_t writing = journal->pending;
+        journal->pending = journal->writing;
+        journal->writing = writing;
+        Uint64 sequence = journal->sequence;
+        SDL_UnlockMutex(journal->mutex);
+
+        int error = write_file(journal, writing.begin, writing.size)
+            || flush_file(journal);
+        journal->file_size += writing.size;
+        journal->writing.size = 0;
+        if (!error && journal->file_size >= journal->compaction_size)
+            error = compact(journal);
+
+        SDL_LockMutex(journal->mutex);
+        if (error)
+            journal->has_failed = 1;
+        else
+            journal->written_sequence = sequence;
+        SDL_CondBroadcast(journal->written);
+    }
+    SDL_UnlockMutex(journal->mutex);
+
+    return 0;
+}
+
+static int compact(journal_t* journal) {
+    /* only this thread uses the file, so it is read while it is closed */
+    close_file(journal);
+    markerpool_t markers;
+    textarena_t texts;
+    textblob_t descriptions;
+    quadtree_t index;
+    clusters_t clusters;
+    markerpool_init(&markers);
+    textarena_init(&texts);
+    int error = textblob_init(&descriptions);
+    clusters_init(&clusters, journal->world_zoom);
+    snapshot_t* snapshot = NULL;
+    error = quadtree_init(&index, journal->index_size)
+        || error
+        || snapshot_load(
+            journal->snapshot_path,
+            &snapshot,
+            &markers,
+            &texts,
+            &descriptions,
+            &index,
+            &clusters
+        );
+
+    Uint64 last_sequence = 0;
+    Uint64 valid_size = 0;
+    Uint32 replayed_count = 0;
+    if (!error) {
+        error = replay(
+            journal->path,
+            snapshot != NULL ? snapshot->journal_sequence : 0,
+            &markers,
+            &texts,
+            &descriptions,
+            &index,
+            &last_sequence,
+            &valid_size,
+            &replayed_count
+        );
+    }
+    if (!error)
+        error = clusters_build(&clusters, &markers);
+    if (!error) {
+        error = snapshot_save(
+            journal->snapshot_path,
+            &markers,
+            &texts,
+            &descriptions,
+            &index,
+            &clusters,
+            last_sequence
+        );
+    }
+
+    quadtree_free(&index);
+    clusters_free(&clusters);
+    markerpool_free(&markers);
+    textarena_free(&texts);
+    textblob_free(&descriptions);
+    snapshot_close(snapshot);
+
+    /* a failed compaction is tried again when the journal grows more */
+    if (error) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                     "journal compaction failed: %s", SDL_GetError());
+        journal->compaction_size =
+            journal->file_size + JOURNAL_COMPACTION_SIZE;
+        return open_file(journal, journal->file_size);
+    }
+
+    /* records in the file are in the snapshot now, which is on the disk
+       under its name, see snapshot_save() */
+    journal->compaction_size = JOURNAL_COMPACTION_SIZE;
+    return open_file(journal, 0);
+}
+
+static int open_file(journal_t* journal, Uint64 size) {
+#ifdef _WIN32
+    journal->file = CreateFileA(
+        journal->path,
+        GENERIC_WRITE,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+    if (journal->file == INVALID_HANDLE_VALUE) {
+        SDL_SetError("%s: file can not be opened\n%s()",
+                     journal->path, __func__);
+        return 1;
+    }
+    LARGE_INTEGER position = { .QuadPart = size };
+    if (!SetFilePointerEx(journal->file, position, NULL, FILE_BEGIN) ||
+            !SetEndOfFile(journal->file)) {
+        SDL_SetError("%s: file can not be truncated\n%s()",
+                     journal->path, __func__);
+        CloseHandle(journal->file);
+        return 1;
+    }
+#else
+    journal->file = open(journal->path, O_WRONLY | O_CREAT, 0644);
+    if (journal->file < 0) {
+        SDL_SetError("%s: %s\n%s()", journal->path, strerror(errno), __func__);
+        return 1;
+    }
+    if (ftruncate(journal->file, size) ||
+            lseek(journal->file, size, SEEK_SET) < 0) {
+        SDL_SetError("%s: %s\n%s()", journal->path, strerror(errno), __func__);
+        close(journal->file);
+        return 1;
+    }
+#endif
+    journal->is_file_open = 1;
+    journal->file_size = size;
+    return 0;
+}
+
+static void close_file(journal_t* journal) {
+    if (!journal->is_file_open)
+        return;
+#ifdef _WIN32
+    CloseHandle(journal->file);
+#else
+    close(journal->file);
+#endif
+    journal->is_file_open = 0;
+}
+
+static int write_file(journal_t* journal, const void* data, size_t size) {
+    const Uint8* bytes = data;
+    while (size) {
+#ifdef _WIN32
+        DWORD portion = size < 0x40000000 ? size : 0x40000000;
+        DWORD written;
+        if (!WriteFile(journal->file, bytes, portion, &written, NULL))
+            return 1;
+#else
+        ssize_t written = write(journal->file, bytes, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return 1;
+#endif
+        bytes += written;
+        size -= written;
+    }
+    return 0;
+}
+
+static int flush_file(journal_t* journal) {
+#ifdef _WIN32
+    return !FlushFileBuffers(journal->file);
+#else
+    return fsync(journal->file) != 0;
+#endif
+}
@@ -1,18 +1,56 @@
 #include "../../headers/map/map.h"
 
-#define MARKER_GRID_LIST_ALLOCATION_PORTION (16*sizeof(marker_t*))
-#define MARKERS_LIST_ALLOCATION_PORTION (1024*sizeof(marker_t))
+#define MARKER_GRID_LIST_ALLOCATION_PORTION (16*sizeof(Uint32))
+#define PICK_LIST_ALLOCATION_PORTION (16*sizeof(Uint32))
+#define IMPORT_LIST_ALLOCATION_PORTION (4096*sizeof(pix_pos_t))
+#define PARTITION_LIST_ALLOCATION_PORTION (64*sizeof(map_partition_t))
+#define HANDLE_LIST_ALLOCATION_PORTION (64*sizeof(marker_handle_t))
+
+typedef struct {
+    map_t* map;
+    map_import_t* import;
+} import_t;
+
+typedef struct {
+    Uint32 MAP_PARTITION_LOADED_EVENT;
+    char* path;
+    markerstore_partition_t partition;
+    markerstore_part_t part;
+    int error;
+} partition_request_t;
 
 static pix_pos_t to_pix(geo_pos_t geo_pos);
 static pix_pos_t to_pix_from_mouse(const map_t* map,
                                    int x,
                                    int y,
                                    const SDL_Rect* area);
+static void begin_viewport_fill(map_t* map);
+static void get_spiral_cell(int n, Uint8* i, Uint8* j);
 static void start_tile_loading(map_t* map);
 static int load_tile_async(void* ptr_tile); /* SDL_ThreadFunction */
-static size_t count_digits(Uint32 number);
-static char* generate_request_path(const tile_t* tile);
+static void update_partitions(map_t* map);
+static void start_partition_loading(map_t* map);
+static int start_partition_request(map_t* map,
+                                   const markerstore_partition_t* partition);
+static int load_partition_async(void* ptr_request); /* SDL_ThreadFunction */
+static void add_partition_markers(map_t* map,
+                                  map_partition_t* state,
+                                  const markerstore_part_t* part);
+static void evict_partitions(map_t* map);
+static map_partition_t* find_partition_state(const map_t* map,
+                                             Uint32 x,
+                                             Uint32 y);
+static void free_partition_request(partition_request_t* request);
 static void move_to(map_t* map, pix_pos_t pos);
+static void set_zoom_level(map_t* map, Uint8 zoom);
+static void free_backdrop(map_t* map);
+static double get_zoom_factor(const map_t* map, const tile_t* tile);
+static SDL_Point get_grid_begin(const map_t* map,
+                                const tile_t* tile,
+                                const SDL_Rect* area);
+static SDL_Rect scale_rect(const SDL_Rect* rect,
+                           const SDL_Rect* area,
+                           double factor);
 static void shift_map_grid_data(map_t* map, Sint8 shift_x, Sint8 shift_y);
 static void free_map_grid_item(map_t* map, int i, int j);
 static void copy_map_grid_item(map_t* map,
@@ -21,7 +59,48 @@ static void copy_map_grid_item(map_t* map,
                                int source_i,
                                int source_j);
 static void update_marker_grid_item(map_t* map, int i, int j);
+static void update_marker_grid(map_t* map);
+static marker_t* get_grid_marker(const map_t* map, const list_t* list, int k);
+static int get_marker_cell(const map_t* map,
+                           const marker_t* marker,
+                           int* i,
+                           int* j);
+static SDL_Point get_screen_position(const map_t* map,
+                                     Uint32 x,
+                                     Uint32 y,
+                                     const SDL_Rect* area);
+static int update_hover(map_t* map);
+static void get_layer_slot(const map_t* map,
+                           int i,
+                           int j,
+                           int* slot_i,
+                           int* slot_j);
+static void invalidate_layer_item(map_t* map, int i, int j);
+static void update_layer(const map_t* map);
+static void draw_layer_item(const map_t* map,
+                            int i,
+                            int j,
+                            int slot_i,
+                            int slot_j);
+static void draw_layer(const map_t* map, const SDL_Rect* area);
+static void draw_textures(const map_t* map,
+                          SDL_Texture* const textures[][MAP_GRID_SIZE],
+                          const tile_t* tile,
+                          const SDL_Rect* area);
+static int get_marker_indent(Uint8 zoom);
 static void draw_markers(const map_t* map, const SDL_Rect* area);
+static void draw_grid_markers(const map_t* map,
+                              int i,
+                              int j,
+                              int indent,
+                              double factor,
+                              const SDL_Rect* area);
+static void draw_clusters(const map_t* map, const SDL_Rect* area);
+static void draw_cluster(const map_t* map,
+                         int x,
+                         int y,
+                         Uint32 count,
+                         const SDL_Rect* area);
 static void draw_marker(SDL_Renderer* renderer,
                         int x,
                         int y,
@@ -29,12 +108,40 @@ static void draw_marker(SDL_Renderer* renderer,
                         int indent,
                         const Uint8* pixels,
                         const SDL_Rect* map_area);
+static int store_marker(map_t* map,
+                        const marker_t* position,
+                        const char* name,
+                        size_t name_length,
+                        const char* description,
+                        size_t description_length,
+                        marker_handle_t* handle);
+static void unstore_marker(map_t* map, marker_handle_t handle);
+static void drop_marker_search(map_t* map);
+static int import_part(void* ptr_import, const markerimport_part_t* part);
+static int import_markers_async(void* ptr_import); /* SDL_ThreadFunction */
+static int hand_over_part(void* ptr_import, const markerimport_part_t* part);
+static int project_import_part(map_import_t* import,
+                               const markerimport_part_t* part);
+static int store_import_records(map_t* map,
+                                map_import_t* import,
+                                const markerimport_part_t* part,
+                                double max_time);
+static int continue_import(map_t* map);
+static void finish_import(map_t* map);
+static int export_markers_async(void* ptr_export); /* SDL_ThreadFunction */
+static int on_export_progress(void* data,
+                              const markerexport_progress_t* progress);
+static void finish_export(map_t* map);
 static void on_panel_executed(void* data);
+static void on_panel_changed(void* data);
 static const char* on_panel_check(void* data);
 
 /* ---------------------- header functions definition ---------------------- */
 
-map_t* map_init(SDL_Renderer* renderer, geo_pos_t map_center, Uint8 zoom) {
+map_t* map_init(SDL_Renderer* renderer,
+                const tilesource_t* tilesource,
+                geo_pos_t map_center,
+                Uint8 zoom) {
     map_t* map = malloc(sizeof(map_t));
     if (map == NULL) {
         SDL_SetError("memory allocation failed\n%s()", __func__);
@@ -44,6 +151,7 @@ map_t* map_init(SDL_Renderer* renderer, geo_pos_t map_center, Uint8 zoom) {
     for (int i = 0; i < MAP_GRID_SIZE; i++) {
         for (int j = 0; j < MAP_GRID_SIZE; j++) {
             map->grid[i][j] = NULL;
+            map->backdrop[i][j] = NULL;
             map->grid_loading_status[i][j] = 0;
             list_init(
                 &map->marker_grid[i][j],
@@ -51,45 +159,172 @@ map_t* map_init(SDL_Renderer* renderer, geo_pos_t map_center, Uint8 zoom) {
             );
         }
     }
-    list_init(&map->markers, MARKERS_LIST_ALLOCATION_PORTION);
+    markerpool_init(&map->markers);
+    textarena_init(&map->marker_texts);
+    int error = textblob_init(&map->marker_descriptions);
+    searchindex_init(&map->marker_search);
+    map->is_search_built = 1;
+    markerviews_init(&map->marker_views);
+    map->is_view_stale = 1;
+    map->snapshot = NULL;
+    map->journal = NULL;
+    map->store = NULL;
+    list_init(&map->store_partitions, PARTITION_LIST_ALLOCATION_PORTION);
+    map->is_partition_loading = 0;
+    map->export = NULL;
+    map->import = NULL;
+    Uint32 world_size = (1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+    if (quadtree_init(&map->marker_index, world_size) || error) {
+        quadtree_free(&map->marker_index);
+        textblob_free(&map->marker_descriptions);
+        list_free(&map->store_partitions);
+        free(map);
+        return NULL;
+    }
     map->renderer = renderer;
     map->panel = NULL;
-    map->marker_name_hover = textarea_init();
+    map->marker_labels =
+        labelcache_init(renderer, CONFIG_FONT_PATH, CONFIG_FONT_SIZE);
+    map->layer = NULL;
     map->is_loaded = 0;
+    map->has_backdrop = 0;
+    map->tile_size = tilesource->tile_size;
+    map->zoom_shift = 0;
+    map->hovered_marker = -1;
+    map->mouse_x = 0;
+    map->mouse_y = 0;
+    map->mouse_area = (SDL_Rect){ 0, 0, 0, 0 };
+    clusters_init(&map->marker_clusters, MAP_MAX_ZOOM);
+    map->cluster_glyphs =
+        glyphcache_get(renderer, CONFIG_FONT_PATH, CONFIG_FONT_SIZE);
     map->center = to_pix(map_center);
+    map->center_tile.source = tilesource;
     map->center_tile.MAP_TILE_LOADED_EVENT = SDL_RegisterEvents(1);
-    if (map->center_tile.MAP_TILE_LOADED_EVENT == (Uint32)-1) {
+    map->MAP_EXPORT_FINISHED_EVENT = SDL_RegisterEvents(1);
+    if (map->center_tile.MAP_TILE_LOADED_EVENT == (Uint32)-1 ||
+            map->MAP_EXPORT_FINISHED_EVENT == (Uint32)-1) {
         SDL_SetError("event registration failed\n%s()", __func__);
         map_deinit(map);
         return NULL;
     }
-    map->center_tile.size = MAP_TILE_SIZE * (1 << MAP_MAX_ZOOM-zoom);
+    int zoom_shift = tilesource_get_zoom_shift(tilesource);
+    if (zoom_shift < 0 || zoom < MAP_MIN_ZOOM + zoom_shift) {
+        SDL_SetError("unsupported tile size\n%s()", __func__);
+        map_deinit(map);
+        return NULL;
+    }
+    map->zoom_shift = zoom_shift;
+
+    /* large tiles cover the area of 256 px tiles of the next zoom level */
+    Uint8 grid_zoom = zoom - zoom_shift;
+    map->center_tile.size = MAP_TILE_SIZE * (1 << MAP_MAX_ZOOM-grid_zoom);
     map->center_tile.x = map->center.x / map->center_tile.size;
     map->center_tile.y = map->center.y / map->center_tile.size;
-    map->center_tile.zoom = zoom;
+    map->center_tile.zoom = grid_zoom;
+    map->zoom = zoom;
+    map->zoom_from = zoom;
+    map->zoom_target = zoom;
+    map->zoom_start_time = 0;
 
-    start_tile_loading(map);
+    /* immediate mode is kept if the renderer can not hold the layer */
+    map_set_retained(map, CONFIG_MAP_RETAINED_LAYER);
+
+    begin_viewport_fill(map);
 
     return map;
 }
 
 void map_deinit(map_t* map) {
+    if (map->export != NULL) {
+        SDL_AtomicSet(&map->export->is_cancelled, 1);
+        finish_export(map);
+    }
+    if (map->import != NULL) {
+        SDL_LockMutex(map->import->mutex);
+        map->import->is_cancelled = 1;
+        SDL_CondSignal(map->import->stored);
+        SDL_UnlockMutex(map->import->mutex);
+        finish_import(map);
+    }
+    journal_close(map->journal);
     for (int i = 0; i < MAP_GRID_SIZE; i++) {
         for (int j = 0; j < MAP_GRID_SIZE; j++)
             free_map_grid_item(map, i, j);
     }
-    for (int i = 0; i < map->markers.size; i += sizeof(marker_t)) {
-        marker_t* marker = list_get(&map->markers, i);
-        free(marker->name);
-        free(marker->description);
+    free_backdrop(map);
+    markerpool_free(&map->markers);
+    textarena_free(&map->marker_texts);
+    textblob_free(&map->marker_descriptions);
+    quadtree_free(&map->marker_index);
+    clusters_free(&map->marker_clusters);
+    searchindex_free(&map->marker_search);
+    markerviews_free(&map->marker_views);
+    snapshot_close(map->snapshot);
+    for (size_t k = 0; k < map->store_partitions.size;
+            k += sizeof(map_partition_t)) {
+        map_partition_t* state = list_get(&map->store_partitions, k);
+        list_free(&state->handles);
     }
-    list_free(&map->markers);
+    list_free(&map->store_partitions);
+    markerstore_close(map->store);
     if (map->panel != NULL)
         panel_deinit(map->panel);
-    textarea_deinit(map->marker_name_hover);
+    if (map->marker_labels != NULL)
+        labelcache_deinit(map->marker_labels);
+    map_set_retained(map, 0);
     free(map);
 }
 
+int map_set_retained(map_t* map, int retained) {
+    if (!retained) {
+        if (map->layer != NULL) {
+            SDL_DestroyTexture(map->layer->texture);
+            free(map->layer);
+            map->layer = NULL;
+        }
+        return 0;
+    }
+
+    if (map->layer != NULL)
+        return 0;
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(map->renderer, &info))
+        return 1;
+    if (!(info.flags & SDL_RENDERER_TARGETTEXTURE)) {
+        SDL_SetError("render targets are not supported\n%s()", __func__);
+        return 1;
+    }
+    int layer_size = MAP_GRID_SIZE * map->tile_size;
+    if (info.max_texture_width && info.max_texture_width < layer_size ||
+            info.max_texture_height && info.max_texture_height < layer_size) {
+        SDL_SetError("layer texture is too large\n%s()", __func__);
+        return 1;
+    }
+
+    map_layer_t* layer = malloc(sizeof(map_layer_t));
+    if (layer == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    layer->texture = SDL_CreateTexture(
+        map->renderer,
+        SDL_PIXELFORMAT_RGBA8888,
+        SDL_TEXTUREACCESS_TARGET,
+        layer_size,
+        layer_size
+    );
+    if (layer->texture == NULL) {
+        free(layer);
+        return 1;
+    }
+    SDL_SetTextureBlendMode(layer->texture, SDL_BLENDMODE_BLEND);
+    memset(layer->dirty, 1, sizeof(layer->dirty));
+    map->layer = layer;
+
+    return 0;
+}
+
 void map_draw(const map_t* map, SDL_Rect area) {
     if (map->panel != NULL) {
         panel_draw(map->panel, map->renderer, area.x, area.y, area.h);
@@ -97,55 +332,21 @@ void map_draw(const map_t* map, SDL_Rect area) {
         area.w -= CONFIG_MAP_PANEL_WIDTH;
     }
 
+    /* layer is updated first, render target switch resets the clip rect */
+    if (map->layer != NULL)
+        update_layer(map);
+
     SDL_SetRenderDrawColor(map->renderer, 0, 0, 0, 255);
     SDL_RenderFillRect(map->renderer, &area);
 
-    pix_pos_t grid_begin = {
-        .x = (map->center_tile.x - MAP_GRID_SIZE/2) * map->center_tile.size,
-        .y = (map->center_tile.y - MAP_GRID_SIZE/2) * map->center_tile.size
-    };
-    Uint32 scale = map->center_tile.size / MAP_TILE_SIZE;
-    Sint32 begin_x = area.x + area.w/2 - (map->center.x-grid_begin.x)/scale;
-    Sint32 begin_y = area.y + area.h/2 - (map->center.y-grid_begin.y)/scale;
-
-    for (int i = 0; i < MAP_GRID_SIZE; i++) {
-        for (int j = 0; j < MAP_GRID_SIZE; j++) {
-            if (!map->grid_loading_status[i][j])
-                continue;
-
-            Sint32 x = begin_x + j*MAP_TILE_SIZE;
-            Sint32 y = begin_y + i*MAP_TILE_SIZE;
-            if (x + MAP_TILE_SIZE < area.x || x >= area.x + area.w)
-                continue;
-            if (y + MAP_TILE_SIZE < area.y || y >= area.y + area.h)
-                continue;
-
-            SDL_Rect srcrect = {
-                .x = 0,
-                .y = 0,
-                .w = MAP_TILE_SIZE,
-                .h = MAP_TILE_SIZE
-            };
-
-            if (x < area.x)
-                srcrect.x += area.x - x;
-            if (x + MAP_TILE_SIZE >= area.x + area.w)
-                srcrect.w -= (x + MAP_TILE_SIZE) - (area.x + area.w);
-            if (y < area.y)
-                srcrect.y += area.y - y;
-            if (y + MAP_TILE_SIZE >= area.y + area.h)
-                srcrect.h -= (y + MAP_TILE_SIZE) - (area.y + area.h);
-
-            SDL_Rect dstrect = {
-                .x = x + srcrect.x,
-                .y = y + srcrect.y,
-                .w = srcrect.w - srcrect.x,
-                .h = srcrect.h - srcrect.y
-            };
-
-            SDL_RenderCopy(map->renderer, map->grid[i][j], &srcrect, &dstrect);
-        }
-    }
+    SDL_RenderSetClipRect(map->renderer, &area);
+    if (map->has_backdrop)
+        draw_textures(map, map->backdrop, &map->backdrop_tile, &area);
+    if (map->layer != NULL)
+        draw_layer(map, &area);
+    else
+        draw_textures(map, map->grid, &map->center_tile, &area);
+    SDL_RenderSetClipRect(map->renderer, NULL);
 
     draw_markers(map, &area);
 
@@ -157,8 +358,8 @@ void map_draw(const map_t* map, SDL_Rect area) {
     SDL_Color color = colorpicker_get_color(colorpicker);
     SDL_SetRenderDrawColor(map->renderer, color.r, color.g, color.b, color.a);
 
-    begin_x = area.x + area.w/2 - MARKER_PIXEL_SIZE/2;
-    begin_y = area.y + area.h/2 - MARKER_PIXEL_SIZE/2;
+    Sint32 begin_x = area.x + area.w/2 - MARKER_PIXEL_SIZE/2;
+    Sint32 begin_y = area.y + area.h/2 - MARKER_PIXEL_SIZE/2;
 
     const Uint8* MARKER_PIXELS = marker_get_pixels();
     for (int i = 0; i < MARKER_PIXEL_SIZE; i++) {
@@ -170,42 +371,125 @@ void map_draw(const map_t* map, SDL_Rect area) {
     }
 }
 
-void map_handle_event(map_t* map,
-                      const SDL_Event* event,
-                      SDL_Renderer* renderer,
-                      SDL_Rect area) {
+int map_update(map_t* map) {
+    /* views are published for readers only, see map_acquire_markers() */
+    if (!markerviews_withdraw(
+            &map->marker_views,
+            &map->markers,
+            &map->marker_texts))
+        map->is_view_stale = 1;
+    int is_importing = map->import != NULL && continue_import(map);
+
+    if (map->zoom == map->zoom_target)
+        return is_importing;
+
+    Uint32 elapsed = SDL_GetTicks() - map->zoom_start_time;
+    if (elapsed >= MAP_ZOOM_ANIMATION_TIME) {
+        map->zoom = map->zoom_target;
+        set_zoom_level(map, map->zoom_target);
+        update_hover(map);
+        return 1;
+    }
+
+    /* ease out */
+    double t = (double)elapsed / MAP_ZOOM_ANIMATION_TIME;
+    t = 1 - (1-t)*(1-t);
+    map->zoom = map->zoom_from + (map->zoom_target - map->zoom_from)*t;
+    return 1;
+}
+
+int map_handle_event(map_t* map,
+                     const SDL_Event* event,
+                     SDL_Renderer* renderer,
+                     SDL_Rect area) {
+    int redraw = 0;
     if (map->panel != NULL) {
-        panel_handle_event(map->panel, event, renderer, area.x, area.y, area.h);
+        redraw = panel_handle_event(
+            map->panel, event, area.x, area.y, area.h);
         area.x += CONFIG_MAP_PANEL_WIDTH;
         area.w -= CONFIG_MAP_PANEL_WIDTH;
     }
 
-    if (event->type == map->center_tile.MAP_TILE_LOADED_EVENT) {
+    if (event->type == SDL_RENDER_TARGETS_RESET) {
+        /* content of the target textures is lost */
+        if (map->marker_labels != NULL)
+            labelcache_clear(map->marker_labels);
+        if (map->layer != NULL)
+            memset(map->layer->dirty, 1, sizeof(map->layer->dirty));
+        return 1;
+    }
+
+    else if (event->type == map->center_tile.MAP_TILE_LOADED_EVENT) {
         tile_t* tile = event->user.data1;
         SDL_Surface* surface = event->user.data2;
 
         int i = tile->y - (map->center_tile.y - MAP_GRID_SIZE/2);
         int j = tile->x - (map->center_tile.x - MAP_GRID_SIZE/2);
         SDL_Rect grid = { 0, 0, MAP_GRID_SIZE, MAP_GRID_SIZE };
+        int is_current_zoom = tile->zoom == map->center_tile.zoom;
 
-        if (is_belong(i, j, &grid) && !map->grid_loading_status[i][j]) {
+        if (is_current_zoom && is_belong(i, j, &grid) &&
+                !map->grid_loading_status[i][j]) {
             map->grid_loading_status[i][j] = 1;
             SDL_Texture* texture = NULL;
             if (surface != NULL)
                 texture = SDL_CreateTextureFromSurface(map->renderer, surface);
             map->grid[i][j] = texture;
             update_marker_grid_item(map, i, j);
+            invalidate_layer_item(map, i, j);
+            update_hover(map);
+            redraw = 1;
         }
 
         free(tile);
         SDL_FreeSurface(surface);
         if (!map->is_loaded)
             start_tile_loading(map);
+        if (map->is_loaded && map->has_backdrop) {
+            free_backdrop(map);
+            redraw = 1;
+        }
+    }
+
+    else if (map->store != NULL &&
+            event->type == map->MAP_PARTITION_LOADED_EVENT) {
+        /* a partition evicted while it was read is dropped here */
+        partition_request_t* request = event->user.data1;
+        const markerstore_partition_t* partition = &request->partition;
+        map_partition_t* state =
+            find_partition_state(map, partition->x, partition->y);
+        if (state != NULL && !state->is_loaded) {
+            if (!request->error)
+                add_partition_markers(map, state, &request->part);
+            state->is_loaded = 1;
+            redraw = 1;
+        }
+        free_partition_request(request);
+        map->is_partition_loading = 0;
+        start_partition_loading(map);
+    }
+
+    else if (map->export != NULL &&
+            event->type == map->MAP_EXPORT_FINISHED_EVENT &&
+            event->user.data1 == map->export) {
+        finish_export(map);
+    }
+
+    else if (event->type == SDL_DROPFILE) {
+        /* the map shows what is imported, so the error is only logged */
+        if (map_import_markers_async(map, event->drop.file))
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        SDL_free(event->drop.file);
+        return 1;
     }
 
     else if (event->type == SDL_MOUSEMOTION) {
+        /* hovered marker is picked here and only drawn by map_draw() */
+        map->mouse_x = event->motion.x;
+        map->mouse_y = event->motion.y;
+        map->mouse_area = area;
         if (!is_belong(event->motion.x, event->motion.y, &area))
-            return;
+            return update_hover(map) || redraw;
         if (event->motion.state & SDL_BUTTON_LMASK) {
             pix_pos_t new_center = to_pix_from_mouse(
                 map,
@@ -214,52 +498,581 @@ void map_handle_event(map_t* map,
                 &area
             );
             move_to(map, new_center);
+            update_hover(map);
+            return 1;
         }
+        return update_hover(map) || redraw;
     }
 
     else if (event->type == SDL_MOUSEWHEEL) {
         int mouse_x, mouse_y;
         SDL_GetMouseState(&mouse_x, &mouse_y);
         if (!is_belong(mouse_x, mouse_y, &area))
-            return;
-        Uint8 zoom = map->center_tile.zoom + event->wheel.y;
-        if (zoom < MAP_MIN_ZOOM || zoom > MAP_MAX_ZOOM)
-            return;
-
-        map->center_tile.size = MAP_TILE_SIZE * (1 << MAP_MAX_ZOOM-zoom);
-        map->center_tile.x = map->center.x / map->center_tile.size;
-        map->center_tile.y = map->center.y / map->center_tile.size;
-        map->center_tile.zoom = zoom;
-
-        for (int i = 0; i < MAP_GRID_SIZE; i++) {
-            for (int j = 0; j < MAP_GRID_SIZE; j++)
-                free_map_grid_item(map, i, j);
-        }
-
-        if (!map->is_loaded)
-            return;
-        map->is_loaded = 0;
-        start_tile_loading(map);
+            return redraw;
+        int zoom = map->zoom_target + event->wheel.y;
+        if (zoom < MAP_MIN_ZOOM + map->zoom_shift || zoom > MAP_MAX_ZOOM)
+            return redraw;
+        if (zoom == map->zoom_target)
+            return redraw;
+
+        /* tiles are requested by map_update() when the animation ends */
+        map->zoom_from = map->zoom;
+        map->zoom_target = zoom;
+        map->zoom_start_time = SDL_GetTicks();
+        return 1;
     }
 
     else if (event->type == SDL_MOUSEBUTTONDOWN) {
         if (!is_belong(event->button.x, event->button.y, &area))
-            return;
+            return redraw;
         Uint8 button = event->button.button;
         Uint8 clicks = event->button.clicks;
         if (button == SDL_BUTTON_LEFT && clicks == 2 && map->panel == NULL) {
             pix_pos_t new_center =
                 to_pix_from_mouse(map, event->button.x, event->button.y, &area);
             move_to(map, new_center);
+            update_hover(map);
+            Uint64 panel_start = perf_now();
             map->panel = panel_init(
                 PANEL_CREATE_MARKER,
                 renderer,
                 map,
                 on_panel_executed,
+                NULL,
+                on_panel_check
+            );
+            if (map->panel == NULL)
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                             "%s", SDL_GetError());
+            else
+                perf_log_time("panel opening", panel_start);
+            return 1;
+        }
+    }
+
+    else if (event->type == SDL_KEYDOWN) {
+        SDL_Keycode key = event->key.keysym.sym;
+        Uint16 modifiers = event->key.keysym.mod;
+        if (key == SDLK_f && modifiers & KMOD_CTRL && map->panel == NULL) {
+            Uint64 panel_start = perf_now();
+            map->panel = panel_init(
+                PANEL_SEARCH_MARKER,
+                renderer,
+                map,
+                on_panel_executed,
+                on_panel_changed,
                 on_panel_check
             );
+            if (map->panel == NULL)
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                             "%s", SDL_GetError());
+            else
+                perf_log_time("panel opening", panel_start);
+            return 1;
+        }
+    }
+
+    return redraw;
+}
+
+int map_is_marker_overlapping(const map_t* map, Uint32 x, Uint32 y) {
+    /* markers closer than MARKER_PIXEL_SIZE on the deepest zoom overlap */
+    SDL_Rect area = {
+        .x = (Sint64)x - (MARKER_PIXEL_SIZE-1),
+        .y = (Sint64)y - (MARKER_PIXEL_SIZE-1),
+        .w = 2*MARKER_PIXEL_SIZE - 1,
+        .h = 2*MARKER_PIXEL_SIZE - 1
+    };
+    return quadtree_contains(&map->marker_index, &area);
+}
+
+Sint32 map_pick_marker(const map_t* map,
+                       int x,
+                       int y,
+                       const SDL_Rect* area) {
+    /* markers are hovered only on near zoom levels and without animation */
+    int indent = get_marker_indent(map->center_tile.zoom + map->zoom_shift);
+    if (indent >= 6 || get_zoom_factor(map, &map->center_tile) != 1)
+        return -1;
+    if (!is_belong(x, y, area))
+        return -1;
+
+    /* candidates around the point are tested as they are drawn */
+    pix_pos_t position = to_pix_from_mouse(map, x, y, area);
+    Sint64 radius = (Sint64)(MARKER_PIXEL_SIZE/2 + 1)
+        * (map->center_tile.size / map->tile_size);
+    SDL_Rect world_area = {
+        .x = position.x - radius,
+        .y = position.y - radius,
+        .w = 2*radius + 1,
+        .h = 2*radius + 1
+    };
+    list_t candidates;
+    list_init(&candidates, PICK_LIST_ALLOCATION_PORTION);
+    if (quadtree_query(&map->marker_index, &world_area, &candidates)) {
+        list_free(&candidates);
+        return -1;
+    }
+
+    Sint32 picked_marker = -1;
+    for (int k = 0; k < candidates.size; k += sizeof(Uint32)) {
+        Uint32 index = *(Uint32*)list_get(&candidates, k);
+        if ((Sint32)index <= picked_marker)
+            continue;
+        marker_t* marker = markerpool_at(&map->markers, index);
+        int i, j;
+        if (!get_marker_cell(map, marker, &i, &j))
+            continue;
+        if (!map->grid_loading_status[i][j])
+            continue;
+        SDL_Point center = get_screen_position(map, marker->x, marker->y, area);
+        SDL_Rect marker_area = {
+            .x = center.x - MARKER_PIXEL_SIZE/2,
+            .y = center.y - MARKER_PIXEL_SIZE/2,
+            .w = MARKER_PIXEL_SIZE,
+            .h = MARKER_PIXEL_SIZE
+        };
+        if (is_belong(x, y, &marker_area))
+            picked_marker = index;
+    }
+    list_free(&candidates);
+
+    return picked_marker;
+}
+
+int map_add_marker(map_t* map,
+                   const marker_t* position,
+                   const char* name,
+                   const char* description,
+                   marker_handle_t* handle) {
+    if (map_is_marker_overlapping(map, position->x, position->y)) {
+        SDL_SetError("marker intersects with another marker\n%s()", __func__);
+        return 1;
+    }
+    size_t name_length = strlen(name);
+    size_t description_length = strlen(description);
+    if (name_length > CONFIG_MARKER_NAME_MAX ||
+            description_length > CONFIG_MARKER_DESCRIPTION_MAX) {
+        SDL_SetError("marker text is too long\n%s()", __func__);
+        return 1;
+    }
+
+    marker_handle_t new_handle;
+    int error = store_marker(
+        map,
+        position,
+        name,
+        name_length,
+        description,
+        description_length,
+        &new_handle
+    );
+    if (error)
+        return 1;
+    if (handle != NULL)
+        *handle = new_handle;
+    const marker_t* marker = markerpool_get(&map->markers, new_handle);
+    Uint32 index = new_handle.index;
+
+    /* on error clusters miss the marker until they are built again */
+    clusters_insert(&map->marker_clusters, marker->x, marker->y);
+
+    /* the grid cell is extended instead of being queried again */
+    int i, j;
+    if (!get_marker_cell(map, marker, &i, &j))
+        return 0;
+    if (!map->grid_loading_status[i][j])
+        return 0;
+    /* on error the marker appears when the tile is loaded again */
+    list_add(&map->marker_grid[i][j], &index, sizeof(Uint32));
+    invalidate_layer_item(map, i, j);
+    update_hover(map);
+    return 0;
+}
+
+int map_remove_marker(map_t* map, marker_handle_t handle) {
+    marker_t* marker = markerpool_get(&map->markers, handle);
+    if (marker == NULL) {
+        SDL_SetError("marker does not exist\n%s()", __func__);
+        return 1;
+    }
+    if (map->journal != NULL && journal_remove(map->journal, handle.index))
+        return 1;
+
+    int i, j;
+    if (get_marker_cell(map, marker, &i, &j)) {
+        list_t* list = &map->marker_grid[i][j];
+        for (int k = 0; k < list->size; k += sizeof(Uint32)) {
+            if (*(Uint32*)list_get(list, k) != handle.index)
+                continue;
+            list_erase(list, k, sizeof(Uint32));
+            break;
         }
+        invalidate_layer_item(map, i, j);
+    }
+
+    clusters_remove(&map->marker_clusters, marker->x, marker->y);
+    unstore_marker(map, handle);
+    update_hover(map);
+    return 0;
+}
+
+int map_import_markers(map_t* map, const char* path) {
+    Uint64 start = perf_now();
+    map_import_t import = {
+        .thread = NULL,
+        .record_count = 0,
+        .imported_count = 0
+    };
+    list_init(&import.positions, IMPORT_LIST_ALLOCATION_PORTION);
+    import_t request = { map, &import };
+    int error = markerimport_read(path, import_part, &request);
+    list_free(&import.positions);
+
+    /* markers imported before an error are kept */
+    if (import.imported_count) {
+        if (clusters_build(&map->marker_clusters, &map->markers))
+            error = 1;
+        update_marker_grid(map);
+    }
+
+    double time = perf_elapsed_ms(start);
+    SDL_Log(
+        "%s: %u of %u records imported in %.0f ms, %.0f records/s",
+        path,
+        import.imported_count,
+        import.record_count,
+        time,
+        time > 0 ? import.record_count / time * 1000 : 0
+    );
+    return error;
+}
+
+int map_import_markers_async(map_t* map, const char* path) {
+    if (map->import != NULL) {
+        SDL_SetError("markers are being imported\n%s()", __func__);
+        return 1;
+    }
+
+    map_import_t* import = malloc(sizeof(map_import_t));
+    if (import == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    import->path = malloc(strlen(path) + 1);
+    import->mutex = SDL_CreateMutex();
+    import->stored = SDL_CreateCond();
+    if (import->path == NULL || import->mutex == NULL ||
+            import->stored == NULL) {
+        SDL_DestroyCond(import->stored);
+        SDL_DestroyMutex(import->mutex);
+        free(import->path);
+        free(import);
+        SDL_SetError("import can not be started\n%s()", __func__);
+        return 1;
     }
+    strcpy(import->path, path);
+    import->part = NULL;
+    list_init(&import->positions, IMPORT_LIST_ALLOCATION_PORTION);
+    import->stored_count = 0;
+    import->record_count = 0;
+    import->imported_count = 0;
+    import->start = perf_now();
+    import->is_read = 0;
+    import->is_cancelled = 0;
+    import->error = 0;
+
+    import->thread = SDL_CreateThread(import_markers_async, "import", import);
+    if (import->thread == NULL) {
+        SDL_DestroyCond(import->stored);
+        SDL_DestroyMutex(import->mutex);
+        free(import->path);
+        free(import);
+        return 1;
+    }
+    map->import = import;
+    return 0;
+}
+
+int map_load_snapshot(map_t* map, const char* path) {
+    /* slots of removed markers may be read through a view */
+    int has_markers = map->markers.slot_count
+        || map->snapshot != NULL
+        || map->journal != NULL
+        || map->store != NULL;
+    if (has_markers) {
+        SDL_SetError("snapshot is loaded into a map with markers\n%s()",
+                     __func__);
+        return 1;
+    }
+    Uint64 start = perf_now();
+    if (snapshot_load(
+            path,
+            &map->snapshot,
+            &map->markers,
+            &map->marker_texts,
+            &map->marker_descriptions,
+            &map->marker_index,
+            &map->marker_clusters))
+        return 1;
+    if (map->snapshot == NULL)
+        return 0;
+    map->is_view_stale = 1;
+    drop_marker_search(map);
+    update_marker_grid(map);
+    SDL_Log(
+        "%s: %u markers loaded in %.1f ms",
+        path,
+        map->markers.count,
+        perf_elapsed_ms(start)
+    );
+    return 0;
+}
+
+int map_save_snapshot(const map_t* map, const char* path) {
+    if (map->store != NULL) {
+        SDL_SetError("snapshot of a map with a store\n%s()", __func__);
+        return 1;
+    }
+
+    /* the snapshot tells which journal records it already holds */
+    Uint64 journal_sequence = 0;
+    if (map->journal != NULL) {
+        if (journal_sync(map->journal))
+            return 1;
+        journal_sequence = map->journal->sequence;
+    } else if (map->snapshot != NULL) {
+        journal_sequence = map->snapshot->journal_sequence;
+    }
+    return snapshot_save(
+        path,
+        &map->markers,
+        &map->marker_texts,
+        &map->marker_descriptions,
+        &map->marker_index,
+        &map->marker_clusters,
+        journal_sequence
+    );
+}
+
+int map_open_journal(map_t* map, const char* snapshot_path) {
+    if (map->journal != NULL || map->store != NULL) {
+        SDL_SetError("journal or store is already open\n%s()", __func__);
+        return 1;
+    }
+    Uint64 start = perf_now();
+    Uint32 replayed_count = 0;
+    map->journal = journal_open(
+        snapshot_path,
+        map->snapshot != NULL ? map->snapshot->journal_sequence : 0,
+        MAP_MAX_ZOOM,
+        &map->markers,
+        &map->marker_texts,
+        &map->marker_descriptions,
+        &map->marker_index,
+        &replayed_count
+    );
+    int error = map->journal == NULL;
+
+    /* records replayed before an error are kept like imported markers */
+    if (replayed_count) {
+        map->is_view_stale = 1;
+        if (clusters_build(&map->marker_clusters, &map->markers))
+            error = 1;
+        drop_marker_search(map);
+        update_marker_grid(map);
+        SDL_Log(
+            "%s: %u journal records replayed in %.1f ms",
+            snapshot_path,
+            replayed_count,
+            perf_elapsed_ms(start)
+        );
+    }
+    return error;
+}
+
+int map_write_store(map_t* map, const char* path) {
+    Uint64 start = perf_now();
+    if (markerstore_write(
+            path,
+            MAP_STORE_ZOOM,
+            map->marker_index.size,
+            &map->markers,
+            &map->marker_texts,
+            &map->marker_descriptions))
+        return 1;
+    SDL_Log(
+        "%s: %u markers written in %.0f ms",
+        path,
+        map->markers.count,
+        perf_elapsed_ms(start)
+    );
+    return 0;
+}
+
+int map_open_store(map_t* map, const char* path) {
+    int has_markers = map->markers.count
+        || map->snapshot != NULL
+        || map->journal != NULL
+        || map->store != NULL;
+    if (has_markers) {
+        SDL_SetError("store is opened for a map with markers\n%s()",
+                     __func__);
+        return 1;
+    }
+    Uint32 event_type = SDL_RegisterEvents(1);
+    if (event_type == (Uint32)-1) {
+        SDL_SetError("event registration failed\n%s()", __func__);
+        return 1;
+    }
+    Uint64 start = perf_now();
+    map->store = markerstore_open(path, map->marker_index.size);
+    if (map->store == NULL)
+        return 1;
+    map->MAP_PARTITION_LOADED_EVENT = event_type;
+    SDL_Log(
+        "%s: directory of %u partitions, %llu markers read in %.2f ms",
+        path,
+        map->store->partition_count,
+        (unsigned long long)map->store->marker_count,
+        perf_elapsed_ms(start)
+    );
+    start_partition_loading(map);
+    return 0;
+}
+
+int map_export_markers(map_t* map,
+                       const char* path,
+                       const geo_pos_t* begin,
+                       const geo_pos_t* end) {
+    if (map->export != NULL) {
+        SDL_SetError("markers are being exported\n%s()", __func__);
+        return 1;
+    }
+
+    map_export_t* export = malloc(sizeof(map_export_t));
+    if (export == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    export->path = malloc(strlen(path) + 1);
+    if (export->path == NULL) {
+        free(export);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    strcpy(export->path, path);
+    export->MAP_EXPORT_FINISHED_EVENT = map->MAP_EXPORT_FINISHED_EVENT;
+    export->format = markerexport_get_format(path);
+    export->has_area = begin != NULL && end != NULL;
+    if (export->has_area) {
+        pix_pos_t a = to_pix(*begin);
+        pix_pos_t b = to_pix(*end);
+        export->area = (SDL_Rect){
+            .x = a.x < b.x ? a.x : b.x,
+            .y = a.y < b.y ? a.y : b.y,
+            .w = abs((int)b.x - (int)a.x) + 1,
+            .h = abs((int)b.y - (int)a.y) + 1
+        };
+    }
+    export->world_size = map->marker_index.size;
+    SDL_AtomicSet(&export->is_cancelled, 0);
+    export->start = perf_now();
+    export->logged_time = SDL_GetTicks();
+    export->progress = (markerexport_progress_t){ 0 };
+    export->error = 0;
+
+    /* edits made before the call are exported */
+    export->reader = map_acquire_markers(map);
+    if (export->reader == NULL) {
+        free(export->path);
+        free(export);
+        return 1;
+    }
+    export->thread = SDL_CreateThread(export_markers_async, "export", export);
+    if (export->thread == NULL) {
+        markerviews_release(export->reader);
+        free(export->path);
+        free(export);
+        return 1;
+    }
+    map->export = export;
+    return 0;
+}
+
+int map_find_nearest_markers(const map_t* map,
+                             geo_pos_t position,
+                             Uint32 count,
+                             list_t* result) {
+    geodesic_origin_t origin;
+    geodesic_init_origin(
+        &origin,
+        position.lat,
+        position.lon,
+        map->marker_index.size
+    );
+    return quadtree_find_nearest(
+        &map->marker_index,
+        count,
+        geodesic_get_distance,
+        &origin,
+        result
+    );
+}
+
+int map_search_markers(map_t* map,
+                       const char* query,
+                       Uint32 max_count,
+                       list_t* result) {
+    if (!map->is_search_built) {
+        Uint64 start = perf_now();
+        if (searchindex_build(
+                &map->marker_search,
+                &map->markers,
+                &map->marker_texts,
+                &map->marker_descriptions))
+            return 1;
+        map->is_search_built = 1;
+        SDL_Log(
+            "search index of %u markers built in %.0f ms",
+            map->markers.count,
+            perf_elapsed_ms(start)
+        );
+    }
+    return searchindex_search(
+        &map->marker_search,
+        &map->markers,
+        &map->marker_texts,
+        &map->marker_descriptions,
+        query,
+        max_count,
+        result
+    );
+}
+
+markerview_reader_t* map_acquire_markers(map_t* map) {
+    if (map->is_view_stale) {
+        if (markerviews_publish(
+                &map->marker_views,
+                &map->markers,
+                &map->marker_texts,
+                &map->marker_descriptions))
+            return NULL;
+        map->is_view_stale = 0;
+    }
+    return markerviews_acquire(&map->marker_views);
+}
+
+void map_release_markers(markerview_reader_t* reader) {
+    markerviews_release(reader);
+}
+
+const char* map_get_marker_name(const map_t* map, const marker_t* marker) {
+    return textarena_get(&map->marker_texts, marker->name);
+}
+
+const char* map_get_marker_description(map_t* map, const marker_t* marker) {
+    return textblob_get(&map->marker_descriptions, marker->description);
 }
 
 /* ---------------------- static functions definition ---------------------- */
@@ -277,54 +1090,71 @@ static pix_pos_t to_pix_from_mouse(const map_t* map,
                                    const SDL_Rect* area) {
     Sint32 delta_x = x - (area->x + area->w/2);
     Sint32 delta_y = y - (area->y + area->h/2);
-    Sint32 scale = map->center_tile.size / MAP_TILE_SIZE;
+    double scale = (double)map->center_tile.size / map->tile_size
+        / get_zoom_factor(map, &map->center_tile);
     return (pix_pos_t){
         .x = map->center.x + delta_x*scale,
         .y = map->center.y + delta_y*scale
     };
 }
 
-static void start_tile_loading(map_t* map) {
-    Uint8 i = MAP_GRID_SIZE/2;
-    Uint8 j = i;
-    Uint8 found = 0;
-
-    if (!map->grid_loading_status[i][j])
-        found = 1;
-
-    /* spiral */
-    for (Uint8 size = 3; !found && size <= MAP_GRID_SIZE; size += 2) {
-        for (Uint8 k = 1; !found && k < size; k++) {
-            i = (MAP_GRID_SIZE-size)/2;
-            j = i + k;
-            if (!map->grid_loading_status[i][j])
-                found = 1;
-        }
-
-        for (Uint8 k = 1; !found && k < size; k++) {
-            i = (MAP_GRID_SIZE-size)/2 + k;
-            j = (MAP_GRID_SIZE-size)/2 + size - 1;
-            if (!map->grid_loading_status[i][j])
-                found = 1;
-        }
+static void begin_viewport_fill(map_t* map) {
+    map->is_loaded = 0;
+    map->fill_start = perf_now();
+    map->fill_requests = perf_read(PERF_TILE_REQUESTS);
+    map->fill_bytes = perf_read(PERF_TILE_BYTES);
+    start_tile_loading(map);
+}
 
-        for (Uint8 k = size-1; !found && k > 0; k--) {
-            i = (MAP_GRID_SIZE-size)/2 + size - 1;
-            j = i - (size-k);
-            if (!map->grid_loading_status[i][j])
-                found = 1;
-        }
+static void get_spiral_cell(int n, Uint8* i, Uint8* j) {
+    /* n-th cell of the spiral from the center: top, right, bottom, left */
+    int ring = 0;
+    while ((2*ring + 1) * (2*ring + 1) <= n)
+        ring++;
+    if (!ring) {
+        *i = MAP_GRID_SIZE/2;
+        *j = MAP_GRID_SIZE/2;
+        return;
+    }
+    int size = 2*ring + 1;
+    int begin = MAP_GRID_SIZE/2 - ring;
+    int k = n - (size-2) * (size-2);
+    int side = k / (size-1);
+    int t = k % (size-1);
+    if (side == 0) {
+        *i = begin;
+        *j = begin + 1 + t;
+    } else if (side == 1) {
+        *i = begin + 1 + t;
+        *j = begin + size - 1;
+    } else if (side == 2) {
+        *i = begin + size - 1;
+        *j = begin + size - 2 - t;
+    } else {
+        *i = begin + size - 2 - t;
+        *j = begin;
+    }
+}
 
-        for (Uint8 k = size-1; !found && k > 0; k--) {
-            i = (MAP_GRID_SIZE-size)/2 + k - 1;
-            j = (MAP_GRID_SIZE-size)/2;
-            if (!map->grid_loading_status[i][j])
-                found = 1;
-        }
+static void start_tile_loading(map_t* map) {
+    Uint8 i, j;
+    int found = 0;
+    for (int n = 0; !found && n < MAP_GRID_SIZE*MAP_GRID_SIZE; n++) {
+        get_spiral_cell(n, &i, &j);
+        found = !map->grid_loading_status[i][j];
     }
 
     if (!found) {
         map->is_loaded = 1;
+#if CONFIG_PERF_LOG
+        SDL_Log(
+            "viewport fill: %llu requests, %llu bytes, %.2f ms",
+            (unsigned long long)
+                (perf_read(PERF_TILE_REQUESTS) - map->fill_requests),
+            (unsigned long long)(perf_read(PERF_TILE_BYTES) - map->fill_bytes),
+            perf_elapsed_ms(map->fill_start)
+        );
+#endif
         return;
     }
 
@@ -342,19 +1172,8 @@ static void start_tile_loading(map_t* map) {
 static int load_tile_async(void* ptr_tile) {
     /* SDL_ThreadFunction */
     tile_t* tile = ptr_tile;
-    SDL_Surface* surface = NULL;
-
-    char* path = generate_request_path(tile);
-    if (path != NULL) {
-        response_t response = http_get("api.mapbox.com", path);
-        if (response.size) {
-            SDL_RWops* rw = SDL_RWFromMem(response.data, response.size);
-            surface = IMG_LoadTyped_RW(rw, 0, "JPG");
-            SDL_RWclose(rw);
-        }
-        free(response.data);
-        free(path);
-    }
+    SDL_Surface* surface =
+        tilesource_load(tile->source, tile->zoom, tile->x, tile->y);
 
     SDL_Event event;
     memset(&event, 0, sizeof(SDL_Event));
@@ -366,28 +1185,249 @@ static int load_tile_async(void* ptr_tile) {
     return 0;
 }
 
-static size_t count_digits(Uint32 number) {
-    size_t count = 0;
-    for (; number; number /= 10)
-        count++;
-    return count;
+static void update_partitions(map_t* map) {
+    if (map->store == NULL)
+        return;
+    evict_partitions(map);
+    start_partition_loading(map);
+}
+
+static void start_partition_loading(map_t* map) {
+    if (map->store == NULL || map->is_partition_loading)
+        return;
+
+    /* a tile larger than the span would load too many markers at once */
+    const markerstore_t* store = map->store;
+    Uint64 tile_size = map->center_tile.size;
+    if (tile_size > (Uint64)store->partition_size << MAP_STORE_SPAN_LOG2)
+        return;
+
+    /* partitions under the grid in the order in which tiles are loaded */
+    Sint64 tile_count = map->marker_index.size / tile_size;
+    for (int n = 0; n < MAP_GRID_SIZE*MAP_GRID_SIZE; n++) {
+        Uint8 i, j;
+        get_spiral_cell(n, &i, &j);
+        Sint64 tile_x = (Sint64)map->center_tile.x - MAP_GRID_SIZE/2 + j;
+        Sint64 tile_y = (Sint64)map->center_tile.y - MAP_GRID_SIZE/2 + i;
+        if (tile_x < 0 || tile_y < 0 ||
+                tile_x >= tile_count || tile_y >= tile_count)
+            continue;
+        Uint32 x_begin = tile_x * tile_size / store->partition_size;
+        Uint32 y_begin = tile_y * tile_size / store->partition_size;
+        Uint32 x_end = ((tile_x+1) * tile_size - 1) / store->partition_size;
+        Uint32 y_end = ((tile_y+1) * tile_size - 1) / store->partition_size;
+        for (Uint32 y = y_begin; y <= y_end; y++) {
+            for (Uint32 x = x_begin; x <= x_end; x++) {
+                const markerstore_partition_t* partition =
+                    markerstore_find(store, x, y);
+                if (partition == NULL || find_partition_state(map, x, y))
+                    continue;
+                if (start_partition_request(map, partition))
+                    SDL_LogError(
+                        SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+                return;
+            }
+        }
+    }
+}
+
+static int start_partition_request(map_t* map,
+                                   const markerstore_partition_t* partition) {
+    /* the state is added on error too, so the partition is not retried */
+    map_partition_t state = {
+        .x = partition->x,
+        .y = partition->y,
+        .is_loaded = 1
+    };
+    list_init(&state.handles, HANDLE_LIST_ALLOCATION_PORTION);
+    if (list_add(&map->store_partitions, &state, sizeof(map_partition_t)))
+        return 1;
+    map_partition_t* added = list_get(
+        &map->store_partitions,
+        map->store_partitions.size - sizeof(map_partition_t)
+    );
+
+    partition_request_t* request = malloc(sizeof(partition_request_t));
+    if (request == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    request->MAP_PARTITION_LOADED_EVENT = map->MAP_PARTITION_LOADED_EVENT;
+    request->partition = *partition;
+    request->part.count = 0;
+    request->part.data = NULL;
+    request->error = 0;
+    request->path = malloc(strlen(map->store->path) + 1);
+    if (request->path == NULL) {
+        free_partition_request(request);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    strcpy(request->path, map->store->path);
+
+    SDL_Thread* thread =
+        SDL_CreateThread(load_partition_async, NULL, request);
+    if (thread == NULL) {
+        free_partition_request(request);
+        return 1;
+    }
+    SDL_DetachThread(thread);
+    added->is_loaded = 0;
+    map->is_partition_loading = 1;
+    return 0;
 }
 
-static char* generate_request_path(const tile_t* tile) {
-    static const char* path_base =
-        "/v4/mapbox.satellite/%d/%d/%d.jpg90?access_token=%s";
-    const char* token = CONFIG_MAPBOX_ACCESS_TOKEN;
+static int load_partition_async(void* ptr_request) {
+    /* SDL_ThreadFunction */
+    partition_request_t* request = ptr_request;
+    request->error = markerstore_read(
+        request->path, &request->partition, &request->part);
+
+    /* the error message of SDL is kept per thread */
+    if (request->error)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+
+    SDL_Event event;
+    memset(&event, 0, sizeof(SDL_Event));
+    event.type = request->MAP_PARTITION_LOADED_EVENT;
+    event.user.data1 = request;
+    SDL_PushEvent(&event);
 
-    size_t path_lenght =
-        strlen(path_base)-8 +
-        count_digits(tile->zoom) +
-        count_digits(tile->x) +
-        count_digits(tile->y) +
-        strlen(token);
-    char* path = malloc(path_lenght+1);
-    if (path != NULL)
-        sprintf(path, path_base, tile->zoom, tile->x, tile->y, token);
-    return path;
+    return 0;
+}
+
+static void add_partition_markers(map_t* map,
+                                  map_partition_t* state,
+                                  const markerstore_part_t* part) {
+    const markerstore_record_t* records =
+        (const markerstore_record_t*)part->data;
+    const char* text =
+        (const char*)(part->data + part->count*sizeof(markerstore_record_t));
+    for (Uint32 k = 0; k < part->count; k++) {
+        const markerstore_record_t* record = &records[k];
+        const char* name = text;
+        const char* description = name + record->name_length;
+        text = description + record->description_length;
+
+        /* markers of the store were checked for overlaps when added */
+        marker_t position = {
+            .x = record->x,
+            .y = record->y,
+            .color = record->color
+        };
+        marker_handle_t handle;
+        int error = store_marker(
+            map,
+            &position,
+            name,
+            record->name_length,
+            description,
+            record->description_length,
+            &handle
+        );
+        if (error) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+            break;
+        }
+        /* on error clusters miss the marker until they are built again */
+        clusters_insert(&map->marker_clusters, position.x, position.y);
+        /* on error the marker stays until the map is closed */
+        list_add(&state->handles, &handle, sizeof(marker_handle_t));
+    }
+
+    /* only the cells which the partition touches are queried again */
+    Sint64 size = map->store->partition_size;
+    for (int i = 0; i < MAP_GRID_SIZE; i++) {
+        for (int j = 0; j < MAP_GRID_SIZE; j++) {
+            if (!map->grid_loading_status[i][j])
+                continue;
+            Sint64 tile_x = (Sint64)map->center_tile.x - MAP_GRID_SIZE/2 + j;
+            Sint64 tile_y = (Sint64)map->center_tile.y - MAP_GRID_SIZE/2 + i;
+            if (tile_x < 0 || tile_y < 0)
+                continue;
+            Sint64 x = tile_x * map->center_tile.size / size;
+            Sint64 y = tile_y * map->center_tile.size / size;
+            Sint64 x_end = ((tile_x+1) * map->center_tile.size - 1) / size;
+            Sint64 y_end = ((tile_y+1) * map->center_tile.size - 1) / size;
+            if (state->x < x || state->x > x_end ||
+                    state->y < y || state->y > y_end)
+                continue;
+            update_marker_grid_item(map, i, j);
+            invalidate_layer_item(map, i, j);
+        }
+    }
+    update_hover(map);
+}
+
+static void evict_partitions(map_t* map) {
+    /* the grid with MAP_GRID_SIZE/2 more tiles on every side is kept */
+    Sint64 tile_size = map->center_tile.size;
+    Sint64 x_begin =
+        ((Sint64)map->center_tile.x - MAP_GRID_SIZE/2*2) * tile_size;
+    Sint64 y_begin =
+        ((Sint64)map->center_tile.y - MAP_GRID_SIZE/2*2) * tile_size;
+    Sint64 x_end =
+        ((Sint64)map->center_tile.x + MAP_GRID_SIZE/2*2 + 1) * tile_size;
+    Sint64 y_end =
+        ((Sint64)map->center_tile.y + MAP_GRID_SIZE/2*2 + 1) * tile_size;
+
+    Sint64 size = map->store->partition_size;
+    list_t* states = &map->store_partitions;
+    size_t k = 0;
+    while (k < states->size) {
+        map_partition_t* state = list_get(states, k);
+        int is_near = (state->x+1) * size > x_begin
+            && state->x * size < x_end
+            && (state->y+1) * size > y_begin
+            && state->y * size < y_end;
+        if (is_near) {
+            k += sizeof(map_partition_t);
+            continue;
+        }
+
+        /* evicted partitions are outside the grid, its cells are kept */
+        list_t* handles = &state->handles;
+        for (size_t l = 0; l < handles->size; l += sizeof(marker_handle_t)) {
+            marker_handle_t handle = *(marker_handle_t*)list_get(handles, l);
+            const marker_t* marker = markerpool_get(&map->markers, handle);
+            if (marker == NULL)
+                continue;
+            clusters_remove(&map->marker_clusters, marker->x, marker->y);
+            unstore_marker(map, handle);
+        }
+        list_free(handles);
+        list_erase(states, k, sizeof(map_partition_t));
+    }
+
+    /* released texts are dropped only while no view reads them */
+    markerviews_t* views = &map->marker_views;
+    if (SDL_AtomicGetPtr(&views->current) != NULL || views->retired.size)
+        return;
+    int error = markerpool_pack_texts(
+        &map->markers,
+        &map->marker_texts,
+        &map->marker_descriptions
+    );
+    if (error)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+}
+
+static map_partition_t* find_partition_state(const map_t* map,
+                                             Uint32 x,
+                                             Uint32 y) {
+    const list_t* states = &map->store_partitions;
+    for (size_t k = 0; k < states->size; k += sizeof(map_partition_t)) {
+        map_partition_t* state = list_get(states, k);
+        if (state->x == x && state->y == y)
+            return state;
+    }
+    return NULL;
+}
+
+static void free_partition_request(partition_request_t* request) {
+    markerstore_free_part(&request->part);
+    free(request->path);
+    free(request);
 }
 
 static void move_to(map_t* map, pix_pos_t pos) {
@@ -410,8 +1450,98 @@ static void move_to(map_t* map, pix_pos_t pos) {
         map->center_tile.x - tile_x,
         map->center_tile.y - tile_y
     );
+    int is_moved = tile_x != map->center_tile.x
+        || tile_y != map->center_tile.y;
     map->center_tile.x = tile_x;
     map->center_tile.y = tile_y;
+    if (is_moved)
+        update_partitions(map);
+}
+
+static void set_zoom_level(map_t* map, Uint8 zoom) {
+    Uint8 grid_zoom = zoom - map->zoom_shift;
+    if (grid_zoom == map->center_tile.zoom)
+        return;
+
+    /*
+        the old grid stays visible until the new one is loaded, a partially
+        loaded grid does not replace a backdrop of an earlier level
+    */
+    if (map->is_loaded || !map->has_backdrop) {
+        free_backdrop(map);
+        for (int i = 0; i < MAP_GRID_SIZE; i++) {
+            for (int j = 0; j < MAP_GRID_SIZE; j++) {
+                map->backdrop[i][j] = map->grid[i][j];
+                map->grid[i][j] = NULL;
+            }
+        }
+        map->backdrop_tile = map->center_tile;
+        map->has_backdrop = 1;
+    }
+
+    map->center_tile.size = MAP_TILE_SIZE * (1 << MAP_MAX_ZOOM-grid_zoom);
+    map->center_tile.x = map->center.x / map->center_tile.size;
+    map->center_tile.y = map->center.y / map->center_tile.size;
+    map->center_tile.zoom = grid_zoom;
+
+    for (int i = 0; i < MAP_GRID_SIZE; i++) {
+        for (int j = 0; j < MAP_GRID_SIZE; j++)
+            free_map_grid_item(map, i, j);
+    }
+    update_partitions(map);
+
+    if (!map->is_loaded)
+        return;
+    begin_viewport_fill(map);
+}
+
+static void free_backdrop(map_t* map) {
+    for (int i = 0; i < MAP_GRID_SIZE; i++) {
+        for (int j = 0; j < MAP_GRID_SIZE; j++) {
+            SDL_DestroyTexture(map->backdrop[i][j]);
+            map->backdrop[i][j] = NULL;
+        }
+    }
+    map->has_backdrop = 0;
+}
+
+static double get_zoom_factor(const map_t* map, const tile_t* tile) {
+    /* screen size of a texture pixel of the tile's zoom level */
+    return exp2(map->zoom - (tile->zoom + map->zoom_shift));
+}
+
+static SDL_Point get_grid_begin(const map_t* map,
+                                const tile_t* tile,
+                                const SDL_Rect* area) {
+    /* unscaled screen position of the top left tile of the tile's grid */
+    pix_pos_t grid_begin = {
+        .x = (tile->x - MAP_GRID_SIZE/2) * tile->size,
+        .y = (tile->y - MAP_GRID_SIZE/2) * tile->size
+    };
+    Uint32 scale = tile->size / map->tile_size;
+    return (SDL_Point){
+        .x = area->x + area->w/2 - (map->center.x - grid_begin.x)/scale,
+        .y = area->y + area->h/2 - (map->center.y - grid_begin.y)/scale
+    };
+}
+
+static SDL_Rect scale_rect(const SDL_Rect* rect,
+                           const SDL_Rect* area,
+                           double factor) {
+    if (factor == 1)
+        return *rect;
+
+    /*
+        scaled around the area center, edges are rounded independently of
+        the rect size so neighbouring rects stay seamless
+    */
+    double center_x = area->x + area->w/2;
+    double center_y = area->y + area->h/2;
+    int x_begin = floor(center_x + (rect->x - center_x)*factor);
+    int y_begin = floor(center_y + (rect->y - center_y)*factor);
+    int x_end = floor(center_x + (rect->x + rect->w - center_x)*factor);
+    int y_end = floor(center_y + (rect->y + rect->h - center_y)*factor);
+    return (SDL_Rect){ x_begin, y_begin, x_end - x_begin, y_end - y_begin };
 }
 
 static void shift_map_grid_data(map_t* map, Sint8 shift_x, Sint8 shift_y) {
@@ -470,11 +1600,11 @@ static void shift_map_grid_data(map_t* map, Sint8 shift_x, Sint8 shift_y) {
 
     if (!map->is_loaded)
         return;
-    map->is_loaded = 0;
-    start_tile_loading(map);
+    begin_viewport_fill(map);
 }
 
 static void free_map_grid_item(map_t* map, int i, int j) {
+    invalidate_layer_item(map, i, j);
     SDL_DestroyTexture(map->grid[i][j]);
     map->grid[i][j] = NULL;
     map->grid_loading_status[i][j] = 0;
@@ -501,122 +1631,461 @@ static void copy_map_grid_item(map_t* map,
 }
 
 static void update_marker_grid_item(map_t* map, int i, int j) {
-    list_free(&map->marker_grid[i][j]);
-    marker_cut(&map->marker_grid[i][j], &map->markers, &(SDL_Rect){
+    list_clear(&map->marker_grid[i][j]);
+    quadtree_query(&map->marker_index, &(SDL_Rect){
         .x = (map->center_tile.x - MAP_GRID_SIZE/2 + j) * map->center_tile.size,
         .y = (map->center_tile.y - MAP_GRID_SIZE/2 + i) * map->center_tile.size,
         .w = map->center_tile.size,
         .h = map->center_tile.size
-    });
+    }, &map->marker_grid[i][j]);
 }
 
-static void draw_markers(const map_t* map, const SDL_Rect* area) {
-    pix_pos_t grid_begin = {
-        .x = (map->center_tile.x - MAP_GRID_SIZE/2) * map->center_tile.size,
-        .y = (map->center_tile.y - MAP_GRID_SIZE/2) * map->center_tile.size
+static void update_marker_grid(map_t* map) {
+    for (int i = 0; i < MAP_GRID_SIZE; i++) {
+        for (int j = 0; j < MAP_GRID_SIZE; j++) {
+            if (!map->grid_loading_status[i][j])
+                continue;
+            update_marker_grid_item(map, i, j);
+            invalidate_layer_item(map, i, j);
+        }
+    }
+    update_hover(map);
+}
+
+static marker_t* get_grid_marker(const map_t* map, const list_t* list, int k) {
+    return markerpool_at(&map->markers, *(Uint32*)list_get(list, k));
+}
+
+static int get_marker_cell(const map_t* map,
+                           const marker_t* marker,
+                           int* i,
+                           int* j) {
+    Uint32 tile_x = marker->x / map->center_tile.size;
+    Uint32 tile_y = marker->y / map->center_tile.size;
+    *i = (Sint64)tile_y - (map->center_tile.y - MAP_GRID_SIZE/2);
+    *j = (Sint64)tile_x - (map->center_tile.x - MAP_GRID_SIZE/2);
+    SDL_Rect grid = { 0, 0, MAP_GRID_SIZE, MAP_GRID_SIZE };
+    return is_belong(*i, *j, &grid);
+}
+
+static SDL_Point get_screen_position(const map_t* map,
+                                     Uint32 x,
+                                     Uint32 y,
+                                     const SDL_Rect* area) {
+    /* unscaled screen position of the world position */
+    SDL_Point begin = get_grid_begin(map, &map->center_tile, area);
+    Uint32 scale = map->center_tile.size / map->tile_size;
+    Sint64 grid_x =
+        ((Sint64)map->center_tile.x - MAP_GRID_SIZE/2) * map->center_tile.size;
+    Sint64 grid_y =
+        ((Sint64)map->center_tile.y - MAP_GRID_SIZE/2) * map->center_tile.size;
+    return (SDL_Point){
+        .x = begin.x + (x - grid_x)/scale,
+        .y = begin.y + (y - grid_y)/scale
     };
-    Uint32 scale = map->center_tile.size / MAP_TILE_SIZE;
-    Sint32 begin_x = area->x + area->w/2 - (map->center.x-grid_begin.x)/scale;
-    Sint32 begin_y = area->y + area->h/2 - (map->center.y-grid_begin.y)/scale;
-    int mouse_x, mouse_y;
-    SDL_GetMouseState(&mouse_x, &mouse_y);
+}
+
+static int update_hover(map_t* map) {
+    Sint32 hovered_marker = map_pick_marker(
+        map, map->mouse_x, map->mouse_y, &map->mouse_area);
+    int is_changed = hovered_marker != map->hovered_marker;
+    map->hovered_marker = hovered_marker;
+    return is_changed;
+}
+
+static void get_layer_slot(const map_t* map,
+                           int i,
+                           int j,
+                           int* slot_i,
+                           int* slot_j) {
+    /* tile numbers of the grid edges may be negative at low zoom levels */
+    Sint64 tile_x = (Sint64)map->center_tile.x - MAP_GRID_SIZE/2 + j;
+    Sint64 tile_y = (Sint64)map->center_tile.y - MAP_GRID_SIZE/2 + i;
+    *slot_i = (tile_y % MAP_GRID_SIZE + MAP_GRID_SIZE) % MAP_GRID_SIZE;
+    *slot_j = (tile_x % MAP_GRID_SIZE + MAP_GRID_SIZE) % MAP_GRID_SIZE;
+}
 
-    const marker_t* hovered_marker = NULL;
-    int hovered_marker_x, hovered_marker_y;
+static void invalidate_layer_item(map_t* map, int i, int j) {
+    if (map->layer == NULL)
+        return;
+
+    /* markers of a tile overlap the neighbouring tiles */
+    for (int ni = i-1; ni <= i+1; ni++) {
+        for (int nj = j-1; nj <= j+1; nj++) {
+            if (ni < 0 || ni >= MAP_GRID_SIZE || nj < 0 || nj >= MAP_GRID_SIZE)
+                continue;
+            int slot_i, slot_j;
+            get_layer_slot(map, ni, nj, &slot_i, &slot_j);
+            map->layer->dirty[slot_i][slot_j] = 1;
+        }
+    }
+}
+
+static void update_layer(const map_t* map) {
+    map_layer_t* layer = map->layer;
+    SDL_Texture* target = SDL_GetRenderTarget(map->renderer);
+    int target_changed = 0;
 
     for (int i = 0; i < MAP_GRID_SIZE; i++) {
         for (int j = 0; j < MAP_GRID_SIZE; j++) {
-            if (!map->grid_loading_status[i][j])
+            int slot_i, slot_j;
+            get_layer_slot(map, i, j, &slot_i, &slot_j);
+            if (!layer->dirty[slot_i][slot_j])
                 continue;
-            const list_t* list = &map->marker_grid[i][j];
-            for (int k = 0; k < list->size; k += sizeof(marker_t*)) {
-                marker_t* marker = *(marker_t**)list_get(list, k);
+            if (!target_changed) {
+                SDL_SetRenderTarget(map->renderer, layer->texture);
+                target_changed = 1;
+            }
+            draw_layer_item(map, i, j, slot_i, slot_j);
+            layer->dirty[slot_i][slot_j] = 0;
+        }
+    }
+
+    if (target_changed)
+        SDL_SetRenderTarget(map->renderer, target);
+}
+
+static void draw_layer_item(const map_t* map,
+                            int i,
+                            int j,
+                            int slot_i,
+                            int slot_j) {
+    int tile_size = map->tile_size;
+    SDL_Rect slot_area = {
+        .x = slot_j * tile_size,
+        .y = slot_i * tile_size,
+        .w = tile_size,
+        .h = tile_size
+    };
+    /* empty slots are transparent, so the backdrop is seen through */
+    SDL_SetRenderDrawColor(map->renderer, 0, 0, 0, 0);
+    SDL_RenderFillRect(map->renderer, &slot_area);
+    if (map->grid_loading_status[i][j])
+        SDL_RenderCopy(map->renderer, map->grid[i][j], NULL, &slot_area);
+
+    /* clusters are drawn over the layer instead of markers */
+    if (map->center_tile.zoom + map->zoom_shift <= CLUSTERS_MAX_ZOOM)
+        return;
 
-                Sint32 x = begin_x + j*MAP_TILE_SIZE
-                    + (marker->x % map->center_tile.size)/scale
+    /* pixel position of the tile relative to the world origin */
+    Sint64 tile_x =
+        ((Sint64)map->center_tile.x - MAP_GRID_SIZE/2 + j) * tile_size;
+    Sint64 tile_y =
+        ((Sint64)map->center_tile.y - MAP_GRID_SIZE/2 + i) * tile_size;
+    Uint32 scale = map->center_tile.size / tile_size;
+    int indent = get_marker_indent(map->center_tile.zoom + map->zoom_shift);
+
+    for (int ni = i-1; ni <= i+1; ni++) {
+        for (int nj = j-1; nj <= j+1; nj++) {
+            if (ni < 0 || ni >= MAP_GRID_SIZE || nj < 0 || nj >= MAP_GRID_SIZE)
+                continue;
+            if (!map->grid_loading_status[ni][nj])
+                continue;
+            const list_t* list = &map->marker_grid[ni][nj];
+            for (int k = 0; k < list->size; k += sizeof(Uint32)) {
+                marker_t* marker = get_grid_marker(map, list, k);
+                Sint32 x = slot_area.x + (marker->x/scale - tile_x)
                     - MARKER_PIXEL_SIZE/2;
-                Sint32 y = begin_y + i*MAP_TILE_SIZE
-                    + (marker->y % map->center_tile.size)/scale
+                Sint32 y = slot_area.y + (marker->y/scale - tile_y)
                     - MARKER_PIXEL_SIZE/2;
-                if (x + MARKER_PIXEL_SIZE < area->x || x >= area->x + area->w)
+                if (x + MARKER_PIXEL_SIZE <= slot_area.x)
                     continue;
-                if (y + MARKER_PIXEL_SIZE < area->y || y >= area->y + area->h)
+                if (x >= slot_area.x + slot_area.w)
+                    continue;
+                if (y + MARKER_PIXEL_SIZE <= slot_area.y)
+                    continue;
+                if (y >= slot_area.y + slot_area.h)
                     continue;
-                SDL_Rect marker_area =
-                    { x, y, MARKER_PIXEL_SIZE, MARKER_PIXEL_SIZE };
-
-                int indent;
-                if (map->center_tile.zoom >= 17)
-                    indent = 0;
-                else if (map->center_tile.zoom >= 15)
-                    indent = 5;
-                else if (map->center_tile.zoom >= 13)
-                    indent = 6;
-                else if (map->center_tile.zoom >= MAP_MIN_ZOOM)
-                    indent = 7;
-
-                const Uint8* MARKER_PIXELS = marker_get_pixels();
-                if (hovered_marker == NULL && indent < 6 &&
-                        is_belong(mouse_x, mouse_y, &marker_area)) {
-                    if (indent == 0)
-                        MARKER_PIXELS = marker_get_pixels_hovered();
-                    else if (indent == 5)
-                        indent = 0;
-                    hovered_marker = marker;
-                    hovered_marker_x = x + MARKER_PIXEL_SIZE/2;
-                    hovered_marker_y = y + MARKER_PIXEL_SIZE/2;
-                }
-
                 draw_marker(
                     map->renderer,
                     x,
                     y,
                     marker->color,
                     indent,
-                    MARKER_PIXELS,
-                    area
+                    marker_get_pixels(),
+                    &slot_area
                 );
             }
         }
     }
+}
+
+static void draw_layer(const map_t* map, const SDL_Rect* area) {
+    SDL_Point begin = get_grid_begin(map, &map->center_tile, area);
+    double factor = get_zoom_factor(map, &map->center_tile);
+    int slot_i, slot_j;
+    get_layer_slot(map, 0, 0, &slot_i, &slot_j);
+    int tile_size = map->tile_size;
+
+    /*
+        the grid begins at slot (slot_i, slot_j) and wraps around the layer
+        edges, so it is copied by at most four pieces
+    */
+    for (int pi = 0; pi < 2; pi++) {
+        int rows = pi ? slot_i : MAP_GRID_SIZE - slot_i;
+        int grid_row = pi ? MAP_GRID_SIZE - slot_i : 0;
+        int layer_row = pi ? 0 : slot_i;
+        for (int pj = 0; pj < 2; pj++) {
+            int columns = pj ? slot_j : MAP_GRID_SIZE - slot_j;
+            int grid_column = pj ? MAP_GRID_SIZE - slot_j : 0;
+            int layer_column = pj ? 0 : slot_j;
+            if (!rows || !columns)
+                continue;
+
+            SDL_Rect srcrect = {
+                .x = layer_column * tile_size,
+                .y = layer_row * tile_size,
+                .w = columns * tile_size,
+                .h = rows * tile_size
+            };
+            SDL_Rect dstrect = {
+                .x = begin.x + grid_column*tile_size,
+                .y = begin.y + grid_row*tile_size,
+                .w = srcrect.w,
+                .h = srcrect.h
+            };
+            dstrect = scale_rect(&dstrect, area, factor);
+            SDL_Texture* texture = map->layer->texture;
+            SDL_RenderCopy(map->renderer, texture, &srcrect, &dstrect);
+        }
+    }
+}
+
+static void draw_textures(const map_t* map,
+                          SDL_Texture* const textures[][MAP_GRID_SIZE],
+                          const tile_t* tile,
+                          const SDL_Rect* area) {
+    SDL_Point begin = get_grid_begin(map, tile, area);
+    double factor = get_zoom_factor(map, tile);
 
-    if (hovered_marker == NULL)
+    for (int i = 0; i < MAP_GRID_SIZE; i++) {
+        for (int j = 0; j < MAP_GRID_SIZE; j++) {
+            if (textures[i][j] == NULL)
+                continue;
+
+            SDL_Rect dstrect = {
+                .x = begin.x + j*map->tile_size,
+                .y = begin.y + i*map->tile_size,
+                .w = map->tile_size,
+                .h = map->tile_size
+            };
+            dstrect = scale_rect(&dstrect, area, factor);
+            if (dstrect.x + dstrect.w < area->x)
+                continue;
+            if (dstrect.x >= area->x + area->w)
+                continue;
+            if (dstrect.y + dstrect.h < area->y)
+                continue;
+            if (dstrect.y >= area->y + area->h)
+                continue;
+
+            SDL_RenderCopy(map->renderer, textures[i][j], NULL, &dstrect);
+        }
+    }
+}
+
+static int get_marker_indent(Uint8 zoom) {
+    /* markers are drawn smaller on distant zoom levels */
+    if (zoom >= 17)
+        return 0;
+    if (zoom >= 15)
+        return 5;
+    if (zoom >= 13)
+        return 6;
+    return 7;
+}
+
+static void draw_markers(const map_t* map, const SDL_Rect* area) {
+    if (map->center_tile.zoom + map->zoom_shift <= CLUSTERS_MAX_ZOOM) {
+        draw_clusters(map, area);
+        return;
+    }
+
+    double factor = get_zoom_factor(map, &map->center_tile);
+    int indent = get_marker_indent(map->center_tile.zoom + map->zoom_shift);
+    int is_hovered = map->hovered_marker >= 0 && indent < 6 && factor == 1;
+
+    /* the layer already holds the markers except the hovered one */
+    if (map->layer == NULL) {
+        for (int i = 0; i < MAP_GRID_SIZE; i++) {
+            for (int j = 0; j < MAP_GRID_SIZE; j++)
+                draw_grid_markers(map, i, j, indent, factor, area);
+        }
+    }
+
+    if (!is_hovered)
         return;
-    textarea_set_text(
-        map->marker_name_hover,
+
+    /* hovered marker is drawn over the others */
+    const marker_t* hovered_marker =
+        markerpool_at(&map->markers, map->hovered_marker);
+    SDL_Point position = get_screen_position(
+        map, hovered_marker->x, hovered_marker->y, area);
+    draw_marker(
         map->renderer,
-        hovered_marker->name,
+        position.x - MARKER_PIXEL_SIZE/2,
+        position.y - MARKER_PIXEL_SIZE/2,
+        hovered_marker->color,
+        0,
+        indent == 0 ? marker_get_pixels_hovered() : marker_get_pixels(),
+        area
+    );
+
+    if (map->marker_labels == NULL)
+        return;
+
+    /* the label is rasterized only when a marker is hovered first time */
+    const label_t* label = labelcache_get(
+        map->marker_labels,
+        hovered_marker,
+        map_get_marker_name(map, hovered_marker),
         CONFIG_MARKER_NAME_MAX_WIDTH
     );
+    if (label == NULL)
+        return;
     SDL_Rect name_area = {
-        .x = hovered_marker_x + MARKER_PIXEL_SIZE/2 + CONFIG_MARKER_NAME_INDENT,
-        .y = hovered_marker_y
+        .x = position.x + MARKER_PIXEL_SIZE/2 + CONFIG_MARKER_NAME_INDENT,
+        .y = position.y
             - MARKER_PIXEL_SIZE/2
             - CONFIG_MARKER_NAME_INDENT
-            - map->marker_name_hover->h
-            - 2*CONFIG_MARKER_NAME_VERTICAL_INDENT,
-        .w = map->marker_name_hover->w + 2*CONFIG_MARKER_NAME_HORIZONTAL_INDENT,
-        .h = map->marker_name_hover->h + 2*CONFIG_MARKER_NAME_VERTICAL_INDENT
+            - label->h,
+        .w = label->w,
+        .h = label->h
     };
     int name_x_end = name_area.x + name_area.w;
     int map_x_end = area->x + area->w;
     if (name_x_end + CONFIG_MARKER_NAME_INDENT > map_x_end)
         name_area.x -= name_x_end + CONFIG_MARKER_NAME_INDENT - map_x_end;
     if (name_area.y < area->y) {
-        name_area.y = hovered_marker_y
+        name_area.y = position.y
             + MARKER_PIXEL_SIZE/2
             + CONFIG_MARKER_NAME_INDENT;
     }
+    SDL_RenderCopy(map->renderer, label->texture, NULL, &name_area);
+}
+
+static void draw_grid_markers(const map_t* map,
+                              int i,
+                              int j,
+                              int indent,
+                              double factor,
+                              const SDL_Rect* area) {
+    if (!map->grid_loading_status[i][j])
+        return;
+
+    const list_t* list = &map->marker_grid[i][j];
+    for (int k = 0; k < list->size; k += sizeof(Uint32)) {
+        Uint32 index = *(Uint32*)list_get(list, k);
+        if ((Sint32)index == map->hovered_marker && indent < 6 && factor == 1)
+            continue;
+        marker_t* marker = markerpool_at(&map->markers, index);
+
+        SDL_Point point = get_screen_position(map, marker->x, marker->y, area);
+        SDL_Rect position = { point.x, point.y };
+        position = scale_rect(&position, area, factor);
+        Sint32 x = position.x - MARKER_PIXEL_SIZE/2;
+        Sint32 y = position.y - MARKER_PIXEL_SIZE/2;
+        if (x + MARKER_PIXEL_SIZE < area->x || x >= area->x + area->w)
+            continue;
+        if (y + MARKER_PIXEL_SIZE < area->y || y >= area->y + area->h)
+            continue;
+        draw_marker(
+            map->renderer,
+            x,
+            y,
+            marker->color,
+            indent,
+            marker_get_pixels(),
+            area
+        );
+    }
+}
+
+static void draw_clusters(const map_t* map, const SDL_Rect* area) {
+    Uint8 zoom = map->center_tile.zoom + map->zoom_shift;
+    double factor = get_zoom_factor(map, &map->center_tile);
+    double scale = (double)map->center_tile.size / map->tile_size / factor;
+    Uint32 cell_size = clusters_get_cell_size(&map->marker_clusters, zoom);
+    Sint64 world_size = (Sint64)(1 << MAP_MAX_ZOOM) * MAP_TILE_SIZE;
+
+    /*
+        only cells of the area are looked up, whatever the number of markers
+        is; one more cell around it holds clusters whose badges reach in
+    */
+    Sint64 x_begin = map->center.x - area->w/2*scale - cell_size;
+    Sint64 y_begin = map->center.y - area->h/2*scale - cell_size;
+    Sint64 x_end = map->center.x + area->w/2*scale + cell_size;
+    Sint64 y_end = map->center.y + area->h/2*scale + cell_size;
+    if (x_begin < 0)
+        x_begin = 0;
+    if (y_begin < 0)
+        y_begin = 0;
+    if (x_end > world_size)
+        x_end = world_size;
+    if (y_end > world_size)
+        y_end = world_size;
+
+    SDL_RenderSetClipRect(map->renderer, area);
+    Sint64 cell_y_begin = y_begin / cell_size;
+    Sint64 cell_x_begin = x_begin / cell_size;
+    for (Sint64 cell_y = cell_y_begin; cell_y*cell_size < y_end; cell_y++) {
+        for (Sint64 cell_x = cell_x_begin; cell_x*cell_size < x_end; cell_x++) {
+            const cluster_t* cluster = clusters_get(
+                &map->marker_clusters, zoom, cell_x, cell_y);
+            if (cluster == NULL)
+                continue;
+            SDL_Point center = get_screen_position(
+                map,
+                cluster->sum_x / cluster->count,
+                cluster->sum_y / cluster->count,
+                area
+            );
+            SDL_Rect position = { center.x, center.y };
+            position = scale_rect(&position, area, factor);
+            draw_cluster(map, position.x, position.y, cluster->count, area);
+        }
+    }
+    SDL_RenderSetClipRect(map->renderer, NULL);
+}
+
+static void draw_cluster(const map_t* map,
+                         int x,
+                         int y,
+                         Uint32 count,
+                         const SDL_Rect* area) {
+    char text[16];
+    snprintf(text, sizeof(text), "%u", count);
+    int text_w = 0;
+    int text_h = 0;
+    if (map->cluster_glyphs != NULL)
+        glyphcache_measure(map->cluster_glyphs, text, 0, &text_w, &text_h);
+
+    /* badge looks like a marker label with the count of markers */
+    SDL_Rect badge = {
+        .w = text_w + 2*CONFIG_MARKER_NAME_HORIZONTAL_INDENT,
+        .h = text_h + 2*CONFIG_MARKER_NAME_VERTICAL_INDENT
+    };
+    if (badge.w < MARKER_PIXEL_SIZE)
+        badge.w = MARKER_PIXEL_SIZE;
+    if (badge.h < MARKER_PIXEL_SIZE)
+        badge.h = MARKER_PIXEL_SIZE;
+    badge.x = x - badge.w/2;
+    badge.y = y - badge.h/2;
+
     SDL_SetRenderDrawColor(map->renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(map->renderer, &name_area);
+    SDL_RenderFillRect(map->renderer, &badge);
     SDL_SetRenderDrawColor(map->renderer, CONFIG_COLOR_BORDER);
-    SDL_RenderDrawRect(map->renderer, &name_area);
-    textarea_draw(
-        map->marker_name_hover,
-        map->renderer,
-        name_area.x + CONFIG_MARKER_NAME_HORIZONTAL_INDENT,
-        name_area.y + CONFIG_MARKER_NAME_VERTICAL_INDENT,
-        map->marker_name_hover->h
+    SDL_RenderDrawRect(map->renderer, &badge);
+    if (map->cluster_glyphs == NULL)
+        return;
+    glyphcache_draw(
+        map->cluster_glyphs,
+        text,
+        (SDL_Color){ CONFIG_COLOR_TEXT },
+        badge.x + (badge.w - text_w)/2,
+        badge.y + (badge.h - text_h)/2,
+        0,
+        area
     );
 }
 
@@ -648,6 +2117,326 @@ static void draw_marker(SDL_Renderer* renderer,
     }
 }
 
+static int store_marker(map_t* map,
+                        const marker_t* position,
+                        const char* name,
+                        size_t name_length,
+                        const char* description,
+                        size_t description_length,
+                        marker_handle_t* handle) {
+    /* adds the marker to markers, marker_index and marker_search only */
+    marker_t marker = {
+        .x = position->x,
+        .y = position->y,
+        .color = position->color,
+        .name_length = name_length,
+        .description_length = description_length
+    };
+    textarena_t* texts = &map->marker_texts;
+    textblob_t* descriptions = &map->marker_descriptions;
+    if (textarena_add(texts, name, name_length, &marker.name))
+        return 1;
+    if (textblob_add(
+            descriptions,
+            description,
+            description_length,
+            &marker.description)) {
+        textarena_release(texts, name_length);
+        return 1;
+    }
+
+    /* a marker which is not indexed or journaled would be lost */
+    int error = markerpool_add(&map->markers, &marker, handle);
+    if (!error) {
+        error = quadtree_insert(
+            &map->marker_index, marker.x, marker.y, handle->index);
+        if (error)
+            markerpool_remove(&map->markers, *handle);
+    }
+    if (!error && map->journal != NULL) {
+        error = journal_add(
+            map->journal, handle->index, &marker, name, description);
+        if (error) {
+            quadtree_remove(
+                &map->marker_index, marker.x, marker.y, handle->index);
+            markerpool_remove(&map->markers, *handle);
+        }
+    }
+    if (error) {
+        textarena_release(texts, name_length);
+        textblob_release(descriptions, description_length);
+        return 1;
+    }
+    map->is_view_stale = 1;
+
+    /* on error the index is built again by the next search */
+    if (map->is_search_built) {
+        error = searchindex_add(
+            &map->marker_search,
+            handle->index,
+            name,
+            name_length,
+            description,
+            description_length
+        );
+        if (error)
+            drop_marker_search(map);
+    }
+    return 0;
+}
+
+static void unstore_marker(map_t* map, marker_handle_t handle) {
+    /* removes the marker from markers, marker_index and marker_search */
+    marker_t* marker = markerpool_get(&map->markers, handle);
+    quadtree_remove(&map->marker_index, marker->x, marker->y, handle.index);
+
+    /* postings of removed markers are dropped when the index is rebuilt */
+    if (map->is_search_built) {
+        searchindex_t* search = &map->marker_search;
+        searchindex_remove(search);
+        if (search->removed_count > search->marker_count / 2)
+            drop_marker_search(map);
+    }
+
+    textarena_release(&map->marker_texts, marker->name_length);
+    textblob_release(&map->marker_descriptions, marker->description_length);
+    markerpool_remove(&map->markers, handle);
+    map->is_view_stale = 1;
+}
+
+static void drop_marker_search(map_t* map) {
+    searchindex_free(&map->marker_search);
+    searchindex_init(&map->marker_search);
+    map->is_search_built = 0;
+}
+
+static int import_part(void* ptr_import, const markerimport_part_t* part) {
+    /* markerimport_callback_t of map_import_markers() */
+    import_t* request = ptr_import;
+    return project_import_part(request->import, part)
+        || store_import_records(request->map, request->import, part, 0);
+}
+
+static int import_markers_async(void* ptr_import) {
+    /* SDL_ThreadFunction */
+    map_import_t* import = ptr_import;
+    int error = markerimport_read(import->path, hand_over_part, import);
+
+    /* the error message of SDL is kept per thread */
+    SDL_LockMutex(import->mutex);
+    if (error && !import->is_cancelled)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+    import->error = error;
+    import->is_read = 1;
+    SDL_UnlockMutex(import->mutex);
+    return error;
+}
+
+static int hand_over_part(void* ptr_import, const markerimport_part_t* part) {
+    /* markerimport_callback_t, the part is valid until it is stored */
+    map_import_t* import = ptr_import;
+    if (project_import_part(import, part))
+        return 1;
+
+    SDL_LockMutex(import->mutex);
+    import->part = part;
+    while (import->part != NULL && !import->is_cancelled)
+        SDL_CondWait(import->stored, import->mutex);
+    int is_cancelled = import->is_cancelled;
+    import->part = NULL;
+    SDL_UnlockMutex(import->mutex);
+    if (is_cancelled)
+        SDL_SetError("import is cancelled\n%s()", __func__);
+    return is_cancelled;
+}
+
+static int project_import_part(map_import_t* import,
+                               const markerimport_part_t* part) {
+    /* positions of the part are projected in one batch */
+    const list_t* records = &part->records;
+    Uint32 record_count = records->size / sizeof(markerimport_record_t);
+    import->record_count += record_count + part->invalid_count;
+    import->stored_count = 0;
+    list_clear(&import->positions);
+    for (Uint32 k = 0; k < record_count; k++) {
+        const markerimport_record_t* record =
+            list_get(records, k * sizeof(markerimport_record_t));
+        pix_pos_t position = to_pix((geo_pos_t){ record->lat, record->lon });
+        if (list_add(&import->positions, &position, sizeof(pix_pos_t)))
+            return 1;
+    }
+    return 0;
+}
+
+static int store_import_records(map_t* map,
+                                map_import_t* import,
+                                const markerimport_part_t* part,
+                                double max_time) {
+    /* stores records of the part until max_time ms pass, 0 is no limit */
+    Uint64 start = perf_now();
+    const list_t* records = &part->records;
+    Uint32 record_count = records->size / sizeof(markerimport_record_t);
+    while (import->stored_count < record_count) {
+        if (max_time && import->stored_count % 64 == 0 &&
+                perf_elapsed_ms(start) >= max_time)
+            break;
+        Uint32 k = import->stored_count++;
+        const markerimport_record_t* record =
+            list_get(records, k * sizeof(markerimport_record_t));
+        const pix_pos_t* position =
+            list_get(&import->positions, k * sizeof(pix_pos_t));
+        if (map_is_marker_overlapping(map, position->x, position->y))
+            continue;
+        marker_t marker = {
+            .x = position->x,
+            .y = position->y,
+            .color = record->color
+        };
+        marker_handle_t handle;
+        int error = store_marker(
+            map,
+            &marker,
+            textarena_get(&part->texts, record->name),
+            record->name_length,
+            textarena_get(&part->texts, record->description),
+            record->description_length,
+            &handle
+        );
+        if (error)
+            return 1;
+        import->imported_count++;
+
+        /* a synchronous import builds the clusters once at the end */
+        if (import->thread != NULL)
+            clusters_insert(&map->marker_clusters, marker.x, marker.y);
+    }
+    return 0;
+}
+
+static int continue_import(map_t* map) {
+    map_import_t* import = map->import;
+    SDL_LockMutex(import->mutex);
+    const markerimport_part_t* part = import->part;
+    int is_read = import->is_read;
+    SDL_UnlockMutex(import->mutex);
+    if (part == NULL) {
+        if (is_read)
+            finish_import(map);
+        return 1;
+    }
+
+    /* the thread waits for the part, so it is read without the mutex */
+    Uint32 imported_count = import->imported_count;
+    int error = store_import_records(
+        map, import, part, MAP_IMPORT_FRAME_TIME);
+    Uint32 record_count = part->records.size / sizeof(markerimport_record_t);
+    if (error || import->stored_count == record_count) {
+        if (import->imported_count != imported_count) {
+            update_marker_grid(map);
+            update_hover(map);
+        }
+        SDL_LockMutex(import->mutex);
+        if (error) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+            import->is_cancelled = 1;
+        }
+        import->part = NULL;
+        SDL_CondSignal(import->stored);
+        SDL_UnlockMutex(import->mutex);
+    }
+    return 1;
+}
+
+static void finish_import(map_t* map) {
+    map_import_t* import = map->import;
+    SDL_WaitThread(import->thread, NULL);
+    if (!import->error) {
+        double time = perf_elapsed_ms(import->start);
+        SDL_Log(
+            "%s: %u of %u records imported in %.0f ms, %.0f records/s",
+            import->path,
+            import->imported_count,
+            import->record_count,
+            time,
+            time > 0 ? import->record_count / time * 1000 : 0
+        );
+    }
+    SDL_DestroyCond(import->stored);
+    SDL_DestroyMutex(import->mutex);
+    list_free(&import->positions);
+    free(import->path);
+    free(import);
+    map->import = NULL;
+}
+
+static int export_markers_async(void* ptr_export) {
+    /* SDL_ThreadFunction */
+    map_export_t* export = ptr_export;
+    const markerview_t* view = export->reader->view;
+    export->error = markerexport_write(
+        export->path,
+        export->format,
+        view,
+        export->has_area ? &export->area : NULL,
+        export->world_size,
+        on_export_progress,
+        export
+    );
+
+    /* the error message of SDL is kept per thread */
+    if (export->error)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+    markerviews_release(export->reader);
+
+    SDL_Event event;
+    memset(&event, 0, sizeof(SDL_Event));
+    event.type = export->MAP_EXPORT_FINISHED_EVENT;
+    event.user.data1 = export;
+    SDL_PushEvent(&event);
+    return export->error;
+}
+
+static int on_export_progress(void* data,
+                              const markerexport_progress_t* progress) {
+    /* markerexport_callback_t */
+    map_export_t* export = data;
+    export->progress = *progress;
+    Uint32 time = SDL_GetTicks();
+    if (time - export->logged_time >= MAP_EXPORT_PROGRESS_PERIOD) {
+        export->logged_time = time;
+        SDL_Log(
+            "%s: %.0f%% of markers walked, %llu written, %llu bytes",
+            export->path,
+            progress->slot_count
+                ? 100.0 * progress->walked_count / progress->slot_count
+                : 100.0,
+            (unsigned long long)progress->written_count,
+            (unsigned long long)progress->written_size
+        );
+    }
+    return SDL_AtomicGet(&export->is_cancelled);
+}
+
+static void finish_export(map_t* map) {
+    map_export_t* export = map->export;
+    SDL_WaitThread(export->thread, NULL);
+    if (!export->error) {
+        double time = perf_elapsed_ms(export->start);
+        SDL_Log(
+            "%s: %llu markers exported in %.0f ms, %.0f markers/s, "
+            "%llu bytes",
+            export->path,
+            (unsigned long long)export->progress.written_count,
+            time,
+            time > 0 ? export->progress.written_count / time * 1000 : 0,
+            (unsigned long long)export->progress.written_size
+        );
+    }
+    free(export->path);
+    free(export);
+    map->export = NULL;
+}
+
 static void on_panel_executed(void* data) {
     panel_t* panel = data;
     map_t* map = panel->parameters.map;
@@ -658,44 +2447,77 @@ static void on_panel_executed(void* data) {
         return;
     }
 
+    /* the search panel stays open, so other results can be visited */
+    if (panel->parameters.type == PANEL_SEARCH_MARKER) {
+        const list_t* results = &panel->search_marker.results;
+        const panel_search_result_t* result = list_get(
+            results,
+            panel->search_marker.selected_result
+                * sizeof(panel_search_result_t)
+        );
+        const marker_t* marker = markerpool_get(&map->markers, result->marker);
+        if (marker != NULL) {
+            move_to(map, (pix_pos_t){ marker->x, marker->y });
+            update_hover(map);
+        }
+        return;
+    }
+
     if (panel->parameters.type == PANEL_CREATE_MARKER) {
         const char* name = editline_get_text(panel->create_marker.editline);
         const char* description =
             editfield_get_text(panel->create_marker.editfield);
 
-        marker_t marker = {
-            .name = NULL,
-            .description = NULL,
+        /* on error the marker is not created, the panel is closed anyway */
+        marker_t position = {
             .x = map->center.x,
             .y = map->center.y,
-            .color = panel->create_marker.colorpicker.color,
-            .name_length = strlen(name),
-            .description_length = strlen(description)
+            .color = panel->create_marker.colorpicker.color
         };
-        marker.name = malloc(marker.name_length + 1);
-        marker.description = malloc(marker.description_length + 1);
-        if (marker.name == NULL || marker.description == NULL) {
-            free(marker.name);
-            free(marker.description);
-            panel_deinit(map->panel);
-            map->panel = NULL;
-            return;
-        }
-        strcpy(marker.name, name);
-        strcpy(marker.description, description);
-        list_add(&map->markers, &marker, sizeof(marker_t));
-
-        Uint32 tile_x = marker.x / map->center_tile.size;
-        Uint32 tile_y = marker.y / map->center_tile.size;
-        int i = tile_y - (map->center_tile.y - MAP_GRID_SIZE/2);
-        int j = tile_x - (map->center_tile.x - MAP_GRID_SIZE/2);
-        update_marker_grid_item(map, i, j);
+        map_add_marker(map, &position, name, description, NULL);
     }
 
     panel_deinit(map->panel);
     map->panel = NULL;
 }
 
+static void on_panel_changed(void* data) {
+    panel_t* panel = data;
+    map_t* map = panel->parameters.map;
+    list_t* results = &panel->search_marker.results;
+    list_clear(results);
+
+    const char* query = editline_get_text(panel->search_marker.editline);
+    list_t indexes;
+    list_init(&indexes, PANEL_SEARCH_RESULT_MAX * sizeof(Uint32));
+    Uint64 start = perf_now();
+    if (map_search_markers(map, query, PANEL_SEARCH_RESULT_MAX, &indexes)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        list_free(&indexes);
+        return;
+    }
+    perf_log_time("marker search", start);
+
+    /* names are copied, the panel may outlive the markers */
+    for (int k = 0; k < indexes.size; k += sizeof(Uint32)) {
+        panel_search_result_t result;
+        Uint32 index = *(Uint32*)list_get(&indexes, k);
+        const marker_t* marker = markerpool_at(&map->markers, index);
+        if (marker == NULL)
+            continue;
+        result.marker = markerpool_get_handle(&map->markers, index);
+        memcpy(
+            result.name,
+            textarena_get(&map->marker_texts, marker->name),
+            marker->name_length
+        );
+        result.name[marker->name_length] = '\0';
+        if (list_add(results, &result, sizeof(panel_search_result_t)))
+            break;
+    }
+    list_free(&indexes);
+}
+
 static const char* on_panel_check(void* data) {
     panel_t* panel = data;
     map_t* map = panel->parameters.map;
@@ -705,19 +2527,8 @@ static const char* on_panel_check(void* data) {
         if (!strlen(name))
             return "Empty marker name";
 
-        Sint32 new_marker_x = map->center.x;
-        Sint32 new_marker_y = map->center.y;
-        for (int i = 0; i < map->markers.size; i += sizeof(marker_t)) {
-            marker_t* marker = list_get(&map->markers, i);
-            int delta_x = new_marker_x - marker->x;
-            int delta_y = new_marker_y - marker->y;
-            if (delta_x < 0)
-                delta_x = -delta_x;
-            if (delta_y < 0)
-                delta_y = -delta_y;
-            if (delta_x < MARKER_PIXEL_SIZE && delta_y < MARKER_PIXEL_SIZE)
-                return "New marker intersects with another marker";
-        }
+        if (map_is_marker_overlapping(map, map->center.x, map->center.y))
+            return "New marker intersects with another marker";
     }
 
     return NULL;
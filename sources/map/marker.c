@@ -46,11 +46,3 @@ const Uint8* marker_get_pixels(void) {
 const Uint8* marker_get_pixels_hovered(void) {
     return MARKER_PIXELS_HOVERED;
 }
-
-void marker_cut(list_t* dstlist, const list_t* srclist, const SDL_Rect* area) {
-    for (int i = 0; i < srclist->size; i += sizeof(marker_t)) {
-        marker_t* marker = list_get(srclist, i);
-        if (is_belong(marker->x, marker->y, area))
-            list_add(dstlist, &marker, sizeof(marker_t*));
-    }
-}
@@ -0,0 +1,353 @@
+#include "../../headers/map/markerexport.h"
+
+#define MAGIC "DSGISEXP"
+#define BYTE_ORDER_MARK 0x01020304
+#define INDEX_LIST_ALLOCATION_PORTION (MARKERPOOL_CHUNK_SIZE*sizeof(Uint32))
+#define NUMBER_MAX_LENGTH 63
+#define COORDINATE_DIGITS 7 /* decimals of degrees, about 1 cm */
+#define CSV_HEADER "lat,lon,name,description,color\n"
+#define GEOJSON_BEGIN "{\"type\":\"FeatureCollection\",\"features\":[\n"
+#define GEOJSON_END "\n]}\n"
+#define FEATURE_BEGIN \
+    "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":["
+#define FEATURE_NAME "]},\"properties\":{\"name\":"
+#define FEATURE_DESCRIPTION ",\"description\":"
+
+typedef struct {
+    SDL_RWops* file;
+    markerexport_format_t format;
+    Uint32 world_size;
+    char* buffer;
+    size_t size;
+    markerexport_progress_t progress;
+} export_t;
+
+static int write_begin(export_t* export);
+static int write_markers(export_t* export,
+                         const markerview_t* view,
+                         const SDL_Rect* area,
+                         markerexport_callback_t callback,
+                         void* data);
+static int write_end(export_t* export);
+static int write_marker(export_t* export,
+                        const markerview_t* view,
+                        const marker_t* marker);
+static int write_csv_text(export_t* export, const char* text, size_t length);
+static int write_json_text(export_t* export, const char* text, size_t length);
+static int put(export_t* export, const void* data, size_t size);
+static int flush(export_t* export);
+static int format_coordinate(double degrees, char* text);
+static void to_geo(Uint32 world_size,
+                   Uint32 x,
+                   Uint32 y,
+                   double* lat,
+                   double* lon);
+
+/* ---------------------- header functions definition ---------------------- */
+
+markerexport_format_t markerexport_get_format(const char* path) {
+    const char* extension = strrchr(path, '.');
+    if (extension == NULL)
+        return MARKEREXPORT_CSV;
+    if (!SDL_strcasecmp(extension, ".geojson"))
+        return MARKEREXPORT_GEOJSON;
+    if (!SDL_strcasecmp(extension, ".json"))
+        return MARKEREXPORT_GEOJSON;
+    if (!SDL_strcasecmp(extension, ".bin"))
+        return MARKEREXPORT_BINARY;
+    return MARKEREXPORT_CSV;
+}
+
+int markerexport_write(const char* path,
+                       markerexport_format_t format,
+                       const markerview_t* view,
+                       const SDL_Rect* area,
+                       Uint32 world_size,
+                       markerexport_callback_t callback,
+                       void* data) {
+    export_t export = {
+        .format = format,
+        .world_size = world_size,
+        .size = 0,
+        .progress = { 0, view->slot_count, 0, 0 }
+    };
+    export.buffer = malloc(MARKEREXPORT_BUFFER_SIZE);
+    if (export.buffer == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    export.file = SDL_RWFromFile(path, "wb");
+    if (export.file == NULL) {
+        free(export.buffer);
+        return 1;
+    }
+
+    int error = write_begin(&export)
+        || write_markers(&export, view, area, callback, data)
+        || write_end(&export);
+    if (SDL_RWclose(export.file))
+        error = 1;
+    if (error)
+        remove(path);
+    free(export.buffer);
+    return error;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int write_begin(export_t* export) {
+    if (export->format == MARKEREXPORT_CSV)
+        return put(export, CSV_HEADER, strlen(CSV_HEADER));
+    if (export->format == MARKEREXPORT_GEOJSON)
+        return put(export, GEOJSON_BEGIN, strlen(GEOJSON_BEGIN));
+
+    /* the number of markers is written over the header at the end */
+    markerexport_header_t header = {
+        .version = MARKEREXPORT_VERSION,
+        .byte_order = BYTE_ORDER_MARK,
+        .record_size = sizeof(markerstore_record_t),
+        .world_size = export->world_size,
+        .marker_count = 0
+    };
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+    return put(export, &header, sizeof(header));
+}
+
+static int write_markers(export_t* export,
+                         const markerview_t* view,
+                         const SDL_Rect* area,
+                         markerexport_callback_t callback,
+                         void* data) {
+    /* at most one chunk of slot indexes is kept */
+    list_t indexes;
+    list_init(&indexes, INDEX_LIST_ALLOCATION_PORTION);
+    int error = 0;
+    for (Uint32 i = 0; !error && i < view->slot_count;
+            i += MARKERPOOL_CHUNK_SIZE) {
+        Uint32 count = view->slot_count - i;
+        if (count > MARKERPOOL_CHUNK_SIZE)
+            count = MARKERPOOL_CHUNK_SIZE;
+
+        if (area != NULL) {
+            list_clear(&indexes);
+            error = markerpool_cull_chunk(
+                view->chunks[i >> MARKERPOOL_CHUNK_SIZE_LOG2],
+                i,
+                count,
+                area,
+                &indexes
+            );
+            for (size_t k = 0; !error && k < indexes.size;
+                    k += sizeof(Uint32)) {
+                Uint32 index = *(Uint32*)list_get(&indexes, k);
+                error = write_marker(export, view, markerview_at(view, index));
+            }
+        } else {
+            for (Uint32 j = i; !error && j < i + count; j++) {
+                const marker_t* marker = markerview_at(view, j);
+                if (marker != NULL)
+                    error = write_marker(export, view, marker);
+            }
+        }
+
+        export->progress.walked_count = i + count;
+        if (!error && callback(data, &export->progress)) {
+            SDL_SetError("export is stopped\n%s()", __func__);
+            error = 1;
+        }
+    }
+    list_free(&indexes);
+
+    /* a view without slots still reports the end */
+    if (!error && !view->slot_count && callback(data, &export->progress)) {
+        SDL_SetError("export is stopped\n%s()", __func__);
+        error = 1;
+    }
+    return error;
+}
+
+static int write_end(export_t* export) {
+    int error = export->format == MARKEREXPORT_GEOJSON
+        && put(export, GEOJSON_END, strlen(GEOJSON_END));
+    if (error || flush(export))
+        return 1;
+    if (export->format != MARKEREXPORT_BINARY)
+        return 0;
+
+    Uint64 count = export->progress.written_count;
+    error = SDL_RWseek(
+            export->file,
+            offsetof(markerexport_header_t, marker_count),
+            RW_SEEK_SET
+        ) < 0
+        || SDL_RWwrite(export->file, &count, sizeof(count), 1) != 1;
+    if (error)
+        SDL_SetError("export can not be written\n%s()", __func__);
+    return error;
+}
+
+static int write_marker(export_t* export,
+                        const markerview_t* view,
+                        const marker_t* marker) {
+    const char* name = markerview_get_text(view, marker->name);
+    char description[CONFIG_MARKER_DESCRIPTION_MAX + 1];
+    if (markerview_read_description(view, marker, description))
+        return 1;
+    int error;
+    if (export->format == MARKEREXPORT_BINARY) {
+        markerstore_record_t record = {
+            .x = marker->x,
+            .y = marker->y,
+            .name_length = marker->name_length,
+            .description_length = marker->description_length,
+            .color = marker->color
+        };
+        error = put(export, &record, sizeof(record))
+            || put(export, name, marker->name_length)
+            || put(export, description, marker->description_length);
+    } else {
+        double lat, lon;
+        to_geo(export->world_size, marker->x, marker->y, &lat, &lon);
+        char number[NUMBER_MAX_LENGTH + 1];
+        if (export->format == MARKEREXPORT_CSV) {
+            int length = format_coordinate(lat, number);
+            number[length++] = ',';
+            length += format_coordinate(lon, number + length);
+            number[length++] = ',';
+            error = put(export, number, length)
+                || write_csv_text(export, name, marker->name_length)
+                || put(export, ",", 1)
+                || write_csv_text(
+                    export, description, marker->description_length);
+            length = snprintf(number, sizeof(number), ",%u\n", marker->color);
+            error = error || put(export, number, length);
+        } else {
+            /* GeoJSON positions are [lon, lat] */
+            int length = format_coordinate(lon, number);
+            number[length++] = ',';
+            length += format_coordinate(lat, number + length);
+            error = export->progress.written_count && put(export, ",\n", 2)
+                || put(export, FEATURE_BEGIN, strlen(FEATURE_BEGIN))
+                || put(export, number, length)
+                || put(export, FEATURE_NAME, strlen(FEATURE_NAME))
+                || write_json_text(export, name, marker->name_length)
+                || put(export, FEATURE_DESCRIPTION, strlen(FEATURE_DESCRIPTION))
+                || write_json_text(
+                    export, description, marker->description_length);
+            length = snprintf(number, sizeof(number), ",\"color\":%u}}",
+                              marker->color);
+            error = error || put(export, number, length);
+        }
+    }
+    export->progress.written_count++;
+    return error;
+}
+
+static int write_csv_text(export_t* export, const char* text, size_t length) {
+    /* fields are quoted, a quote inside is doubled */
+    if (put(export, "\"", 1))
+        return 1;
+    size_t begin = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != '"')
+            continue;
+        if (put(export, text + begin, i+1 - begin))
+            return 1;
+        begin = i;
+    }
+    return put(export, text + begin, length - begin) || put(export, "\"", 1);
+}
+
+static int write_json_text(export_t* export, const char* text, size_t length) {
+    if (put(export, "\"", 1))
+        return 1;
+    size_t begin = 0;
+    for (size_t i = 0; i < length; i++) {
+        Uint8 c = text[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        char escape[7];
+        int escape_length = 2;
+        escape[0] = '\\';
+        if (c == '"' || c == '\\')
+            escape[1] = c;
+        else if (c == '\n')
+            escape[1] = 'n';
+        else if (c == '\r')
+            escape[1] = 'r';
+        else if (c == '\t')
+            escape[1] = 't';
+        else
+            escape_length = snprintf(escape, sizeof(escape), "\\u%04x", c);
+        if (put(export, text + begin, i - begin))
+            return 1;
+        if (put(export, escape, escape_length))
+            return 1;
+        begin = i+1;
+    }
+    return put(export, text + begin, length - begin) || put(export, "\"", 1);
+}
+
+static int put(export_t* export, const void* data, size_t size) {
+    export->progress.written_size += size;
+    while (size) {
+        size_t free_size = MARKEREXPORT_BUFFER_SIZE - export->size;
+        size_t copied_size = size < free_size ? size : free_size;
+        memcpy(export->buffer + export->size, data, copied_size);
+        export->size += copied_size;
+        data = (const char*)data + copied_size;
+        size -= copied_size;
+        if (export->size == MARKEREXPORT_BUFFER_SIZE && flush(export))
+            return 1;
+    }
+    return 0;
+}
+
+static int flush(export_t* export) {
+    if (!export->size)
+        return 0;
+    if (SDL_RWwrite(export->file, export->buffer, export->size, 1) != 1) {
+        SDL_SetError("export can not be written\n%s()", __func__);
+        return 1;
+    }
+    export->size = 0;
+    return 0;
+}
+
+static int format_coordinate(double degrees, char* text) {
+    /* returns number of characters written, as "%.7f" but without printf */
+    Sint64 scale = 1;
+    for (int i = 0; i < COORDINATE_DIGITS; i++)
+        scale *= 10;
+    Sint64 value = llround(degrees * scale);
+    int length = 0;
+    if (value < 0) {
+        text[length++] = '-';
+        value = -value;
+    }
+
+    char digits[24];
+    int digit_count = 0;
+    do {
+        digits[digit_count++] = '0' + value % 10;
+        value /= 10;
+    } while (value || digit_count <= COORDINATE_DIGITS);
+    while (digit_count) {
+        if (digit_count == COORDINATE_DIGITS)
+            text[length++] = '.';
+        text[length++] = digits[--digit_count];
+    }
+    return length;
+}
+
+static void to_geo(Uint32 world_size,
+                   Uint32 x,
+                   Uint32 y,
+                   double* lat,
+                   double* lon) {
+    /* the middle of the pixel, so importing gives the same pixel back */
+    double world_x = (x + 0.5) / world_size;
+    double world_y = (y + 0.5) / world_size;
+    *lon = world_x*360 - 180;
+    *lat = atan(sinh(M_PI * (1 - 2*world_y))) * 180/M_PI;
+}
@@ -0,0 +1,799 @@
+#include "../../headers/map/markerimport.h"
+
+#define RECORDS_LIST_ALLOCATION_PORTION (4096*sizeof(markerimport_record_t))
+#define MIN_JOB_SIZE 65536 /* smaller blocks are not split between threads */
+#define FEATURE_DEPTH 2 /* features are objects of the array of the root */
+#define NUMBER_MAX_LENGTH 63
+#define ERROR_MAX_LENGTH 255
+
+typedef struct {
+    int depth;
+    unsigned int is_quoted : 1;
+    unsigned int is_escaped : 1;
+} scan_state_t;
+
+typedef struct {
+    markerimport_format_t format;
+    const char* begin;
+    const char* end;
+    scan_state_t state;
+    int is_header_allowed;
+    markerimport_part_t* part;
+    char error[ERROR_MAX_LENGTH + 1]; /* SDL_GetError() of the worker */
+} job_t;
+
+typedef struct {
+    markerimport_format_t format;
+    scan_state_t state;
+    int is_first_block;
+    int worker_count;
+    markerimport_part_t parts[MARKERIMPORT_WORKER_MAX];
+    markerimport_callback_t callback;
+    void* data;
+} import_t;
+
+static void init_import(import_t* import,
+                        markerimport_format_t format,
+                        markerimport_callback_t callback,
+                        void* data);
+static void free_import(import_t* import);
+static int parse_block(import_t* import,
+                       const char* text,
+                       size_t size,
+                       int is_last,
+                       size_t* parsed_size);
+static size_t split_block(import_t* import,
+                          const char* text,
+                          size_t size,
+                          int is_last,
+                          job_t* jobs,
+                          int* job_count);
+static int scan(markerimport_format_t format, scan_state_t* state, char c);
+static int parse_job_async(void* ptr_job); /* SDL_ThreadFunction */
+static int parse_csv(job_t* job);
+static int parse_csv_record(job_t* job,
+                            const char* begin,
+                            const char* end,
+                            int is_header_allowed);
+static int read_csv_field(const char** cursor,
+                          const char* end,
+                          char* buffer,
+                          size_t buffer_size,
+                          size_t* length);
+static int parse_geojson(job_t* job);
+static int parse_feature(job_t* job, const char* begin, const char* end);
+static void find_members(const char* object,
+                         const char* end,
+                         const char* const* keys,
+                         const char** values,
+                         int count);
+static const char* skip_space(const char* c, const char* end);
+static const char* skip_value(const char* c, const char* end);
+static int is_string(const char* value, const char* end, const char* text);
+static int read_string(const char* value,
+                       const char* end,
+                       char* buffer,
+                       size_t buffer_size,
+                       size_t* length);
+static int read_code_point(const char** c, const char* end, Uint32* code);
+static int read_hex(const char* c, const char* end, Uint32* code);
+static int encode_utf8(Uint32 code, char* utf8);
+static int read_coordinates(const char* value,
+                            const char* end,
+                            double* lat,
+                            double* lon);
+static int parse_number(const char* text, double* number);
+static int parse_color(const char* text, Uint8* color);
+static int add_record(markerimport_part_t* part,
+                      double lat,
+                      double lon,
+                      const char* name,
+                      size_t name_length,
+                      const char* description,
+                      size_t description_length,
+                      Uint8 color);
+
+/* ---------------------- header functions definition ---------------------- */
+
+markerimport_format_t markerimport_get_format(const char* path) {
+    const char* extension = strrchr(path, '.');
+    if (extension == NULL)
+        return MARKERIMPORT_CSV;
+    if (!SDL_strcasecmp(extension, ".geojson"))
+        return MARKERIMPORT_GEOJSON;
+    if (!SDL_strcasecmp(extension, ".json"))
+        return MARKERIMPORT_GEOJSON;
+    return MARKERIMPORT_CSV;
+}
+
+int markerimport_read(const char* path,
+                      markerimport_callback_t callback,
+                      void* data) {
+    SDL_RWops* file = SDL_RWFromFile(path, "rb");
+    if (file == NULL)
+        return 1;
+    char* block = malloc(MARKERIMPORT_BLOCK_SIZE + 1);
+    if (block == NULL) {
+        SDL_RWclose(file);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+
+    import_t import;
+    init_import(&import, markerimport_get_format(path), callback, data);
+
+    /* the incomplete record at the end of a block begins the next one */
+    size_t size = 0;
+    int is_last = 0;
+    int error = 0;
+    while (!error && !is_last) {
+        size_t free_size = MARKERIMPORT_BLOCK_SIZE - size;
+        size_t read_size = SDL_RWread(file, block + size, 1, free_size);
+        is_last = read_size < free_size;
+        size += read_size;
+        block[size] = '\0';
+
+        size_t parsed_size;
+        error = parse_block(&import, block, size, is_last, &parsed_size);
+        if (!error && !is_last && parsed_size == 0) {
+            SDL_SetError("%s: record is too long\n%s()", path, __func__);
+            error = 1;
+        }
+        memmove(block, block + parsed_size, size - parsed_size);
+        size -= parsed_size;
+    }
+
+    free_import(&import);
+    free(block);
+    SDL_RWclose(file);
+    return error;
+}
+
+int markerimport_parse(const char* text,
+                       size_t size,
+                       markerimport_format_t format,
+                       markerimport_callback_t callback,
+                       void* data) {
+    import_t import;
+    init_import(&import, format, callback, data);
+    size_t parsed_size;
+    int error = parse_block(&import, text, size, 1, &parsed_size);
+    free_import(&import);
+    return error;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static void init_import(import_t* import,
+                        markerimport_format_t format,
+                        markerimport_callback_t callback,
+                        void* data) {
+    import->format = format;
+    import->state = (scan_state_t){ 0 };
+    import->is_first_block = 1;
+    import->worker_count = SDL_GetCPUCount();
+    if (import->worker_count < 1)
+        import->worker_count = 1;
+    if (import->worker_count > MARKERIMPORT_WORKER_MAX)
+        import->worker_count = MARKERIMPORT_WORKER_MAX;
+    for (int i = 0; i < MARKERIMPORT_WORKER_MAX; i++) {
+        list_init(&import->parts[i].records, RECORDS_LIST_ALLOCATION_PORTION);
+        textarena_init(&import->parts[i].texts);
+        import->parts[i].invalid_count = 0;
+    }
+    import->callback = callback;
+    import->data = data;
+}
+
+static void free_import(import_t* import) {
+    for (int i = 0; i < MARKERIMPORT_WORKER_MAX; i++) {
+        list_free(&import->parts[i].records);
+        textarena_free(&import->parts[i].texts);
+    }
+}
+
+static int parse_block(import_t* import,
+                       const char* text,
+                       size_t size,
+                       int is_last,
+                       size_t* parsed_size) {
+    /* byte order mark of UTF-8 files */
+    size_t offset = 0;
+    if (import->is_first_block && size >= 3 && !memcmp(text, "\xEF\xBB\xBF", 3))
+        offset = 3;
+
+    job_t jobs[MARKERIMPORT_WORKER_MAX];
+    int job_count;
+    *parsed_size = offset + split_block(
+        import, text + offset, size - offset, is_last, jobs, &job_count);
+    if (job_count)
+        jobs[0].is_header_allowed = import->is_first_block;
+    if (job_count)
+        import->is_first_block = 0;
+
+    /* the first job is parsed by this thread, the others by new threads */
+    SDL_Thread* threads[MARKERIMPORT_WORKER_MAX];
+    for (int i = 0; i < job_count; i++) {
+        markerimport_part_t* part = &import->parts[i];
+        list_clear(&part->records);
+        textarena_clear(&part->texts);
+        part->invalid_count = 0;
+        jobs[i].part = part;
+    }
+    for (int i = 1; i < job_count; i++)
+        threads[i] = SDL_CreateThread(parse_job_async, "import", &jobs[i]);
+    int error = job_count ? parse_job_async(&jobs[0]) : 0;
+
+    /* a job whose thread is not created is parsed by this thread */
+    for (int i = 1; i < job_count; i++) {
+        int status;
+        if (threads[i] != NULL)
+            SDL_WaitThread(threads[i], &status);
+        else
+            status = parse_job_async(&jobs[i]);
+        error |= status;
+    }
+
+    /* errors are per thread, the one of the first failed job is reported */
+    if (error) {
+        for (int i = 0; i < job_count; i++) {
+            if (jobs[i].error[0]) {
+                SDL_SetError("%s", jobs[i].error);
+                break;
+            }
+        }
+        return 1;
+    }
+
+    for (int i = 0; i < job_count; i++) {
+        if (import->callback(import->data, &import->parts[i]))
+            return 1;
+    }
+    return 0;
+}
+
+static size_t split_block(import_t* import,
+                          const char* text,
+                          size_t size,
+                          int is_last,
+                          job_t* jobs,
+                          int* job_count) {
+    size_t job_size = size / import->worker_count;
+    if (job_size < MIN_JOB_SIZE)
+        job_size = MIN_JOB_SIZE;
+
+    /* jobs begin at record boundaries, so the scan goes through all text */
+    scan_state_t state = import->state;
+    scan_state_t job_state = state;
+    scan_state_t record_end_state = state;
+    size_t job_begin = 0;
+    size_t record_end = 0;
+    *job_count = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (!scan(import->format, &state, text[i]))
+            continue;
+        record_end = i + 1;
+        record_end_state = state;
+        if (record_end - job_begin < job_size)
+            continue;
+        if (*job_count == import->worker_count - 1)
+            continue;
+        jobs[(*job_count)++] = (job_t){
+            .format = import->format,
+            .begin = text + job_begin,
+            .end = text + record_end,
+            .state = job_state,
+            .is_header_allowed = 0
+        };
+        job_begin = record_end;
+        job_state = state;
+    }
+
+    /* the last record of a file may not be terminated */
+    if (is_last) {
+        record_end = size;
+        record_end_state = state;
+    }
+    if (record_end > job_begin) {
+        jobs[(*job_count)++] = (job_t){
+            .format = import->format,
+            .begin = text + job_begin,
+            .end = text + record_end,
+            .state = job_state,
+            .is_header_allowed = 0
+        };
+    }
+    import->state = record_end_state;
+    return record_end;
+}
+
+static int scan(markerimport_format_t format, scan_state_t* state, char c) {
+    /* returns non-0 value if a record ends with c */
+    if (format == MARKERIMPORT_CSV) {
+        if (c == '"')
+            state->is_quoted = !state->is_quoted;
+        return c == '\n' && !state->is_quoted;
+    }
+
+    if (state->is_quoted) {
+        if (state->is_escaped)
+            state->is_escaped = 0;
+        else if (c == '\\')
+            state->is_escaped = 1;
+        else if (c == '"')
+            state->is_quoted = 0;
+        return 0;
+    }
+    if (c == '"') {
+        state->is_quoted = 1;
+    } else if (c == '{' || c == '[') {
+        state->depth++;
+    } else if (c == '}' || c == ']') {
+        state->depth--;
+        return c == '}' && state->depth == FEATURE_DEPTH;
+    }
+    return 0;
+}
+
+static int parse_job_async(void* ptr_job) {
+    job_t* job = ptr_job;
+    job->error[0] = '\0';
+    int error = job->format == MARKERIMPORT_CSV
+        ? parse_csv(job)
+        : parse_geojson(job);
+    if (error)
+        SDL_strlcpy(job->error, SDL_GetError(), sizeof(job->error));
+    return error;
+}
+
+static int parse_csv(job_t* job) {
+    int is_header_allowed = job->is_header_allowed;
+    const char* record = job->begin;
+    while (record < job->end) {
+        scan_state_t state = { 0 };
+        const char* record_end = record;
+        while (record_end < job->end &&
+                !scan(MARKERIMPORT_CSV, &state, *record_end))
+            record_end++;
+        if (parse_csv_record(job, record, record_end, is_header_allowed))
+            return 1;
+        is_header_allowed = 0;
+        record = record_end + 1;
+    }
+    return 0;
+}
+
+static int parse_csv_record(job_t* job,
+                            const char* begin,
+                            const char* end,
+                            int is_header_allowed) {
+    if (end > begin && end[-1] == '\r')
+        end--;
+    if (begin == end)
+        return 0;
+
+    char lat[NUMBER_MAX_LENGTH + 1];
+    char lon[NUMBER_MAX_LENGTH + 1];
+    char name[CONFIG_MARKER_NAME_MAX + 1];
+    char description[CONFIG_MARKER_DESCRIPTION_MAX + 1];
+    char color[NUMBER_MAX_LENGTH + 1];
+    size_t lat_length, lon_length, name_length, description_length;
+    size_t color_length;
+    const char* cursor = begin;
+    int is_too_long =
+        read_csv_field(&cursor, end, lat, sizeof(lat), &lat_length)
+        | read_csv_field(&cursor, end, lon, sizeof(lon), &lon_length)
+        | read_csv_field(&cursor, end, name, sizeof(name), &name_length)
+        | read_csv_field(
+            &cursor, end, description, sizeof(description), &description_length)
+        | read_csv_field(&cursor, end, color, sizeof(color), &color_length);
+
+    double lat_value, lon_value;
+    int is_position =
+        !parse_number(lat, &lat_value) && !parse_number(lon, &lon_value);
+    if (!is_position && is_header_allowed)
+        return 0;
+
+    Uint8 color_value = 0;
+    int is_valid = is_position && !is_too_long && name_length
+        && fabs(lat_value) <= 85 && fabs(lon_value) <= 180
+        && (!color_length || !parse_color(color, &color_value));
+    if (!is_valid) {
+        job->part->invalid_count++;
+        return 0;
+    }
+    return add_record(
+        job->part,
+        lat_value,
+        lon_value,
+        name,
+        name_length,
+        description,
+        description_length,
+        color_value
+    );
+}
+
+static int read_csv_field(const char** cursor,
+                          const char* end,
+                          char* buffer,
+                          size_t buffer_size,
+                          size_t* length) {
+    /* returns non-0 value if the field does not fit into the buffer */
+    const char* c = *cursor;
+    int is_quoted = c < end && *c == '"';
+    if (is_quoted)
+        c++;
+    int is_too_long = 0;
+    *length = 0;
+    for (; c < end; c++) {
+        if (is_quoted && *c == '"') {
+            /* "" is a quote inside of a quoted field */
+            if (c+1 >= end || c[1] != '"') {
+                is_quoted = 0;
+                continue;
+            }
+            c++;
+        } else if (!is_quoted && *c == ',') {
+            break;
+        }
+        if (*length + 1 < buffer_size)
+            buffer[(*length)++] = *c;
+        else
+            is_too_long = 1;
+    }
+    buffer[*length] = '\0';
+    *cursor = c < end ? c+1 : end;
+    return is_too_long;
+}
+
+static int parse_geojson(job_t* job) {
+    scan_state_t state = job->state;
+    const char* feature = NULL;
+    for (const char* c = job->begin; c < job->end; c++) {
+        int is_object_begin =
+            !state.is_quoted && *c == '{' && state.depth == FEATURE_DEPTH;
+        if (is_object_begin)
+            feature = c;
+        if (!scan(MARKERIMPORT_GEOJSON, &state, *c) || feature == NULL)
+            continue;
+        if (parse_feature(job, feature, c+1))
+            return 1;
+        feature = NULL;
+    }
+    return 0;
+}
+
+static int parse_feature(job_t* job, const char* begin, const char* end) {
+    const char* const feature_keys[] = { "type", "geometry", "properties" };
+    const char* feature[3];
+    find_members(begin, end, feature_keys, feature, 3);
+
+    /* other objects of the same depth are not features, e.g. crs */
+    if (!is_string(feature[0], end, "Feature"))
+        return 0;
+
+    const char* const geometry_keys[] = { "type", "coordinates" };
+    const char* geometry[2];
+    find_members(feature[1], end, geometry_keys, geometry, 2);
+    double lat, lon;
+    int is_valid = is_string(geometry[0], end, "Point")
+        && !read_coordinates(geometry[1], end, &lat, &lon)
+        && fabs(lat) <= 85 && fabs(lon) <= 180;
+
+    /* properties may be null or lack any of the members */
+    const char* const property_keys[] = { "name", "description", "color" };
+    const char* properties[3];
+    find_members(feature[2], end, property_keys, properties, 3);
+    char name[CONFIG_MARKER_NAME_MAX + 1];
+    char description[CONFIG_MARKER_DESCRIPTION_MAX + 1];
+    size_t name_length = 0;
+    size_t description_length = 0;
+    Uint8 color = 0;
+    name[0] = '\0';
+    description[0] = '\0';
+    if (is_valid) {
+        /* markers created by hand need a name too */
+        is_valid = properties[0] != NULL && !read_string(
+            properties[0], end, name, sizeof(name), &name_length)
+            && name_length;
+    }
+    if (is_valid && properties[1] != NULL) {
+        is_valid = !read_string(
+            properties[1],
+            end,
+            description,
+            sizeof(description),
+            &description_length
+        );
+    }
+    if (is_valid && properties[2] != NULL) {
+        char number[NUMBER_MAX_LENGTH + 1];
+        size_t number_length = skip_value(properties[2], end) - properties[2];
+        is_valid = number_length <= NUMBER_MAX_LENGTH;
+        if (is_valid) {
+            memcpy(number, properties[2], number_length);
+            number[number_length] = '\0';
+            is_valid = !parse_color(number, &color);
+        }
+    }
+
+    if (!is_valid) {
+        job->part->invalid_count++;
+        return 0;
+    }
+    return add_record(
+        job->part,
+        lat,
+        lon,
+        name,
+        name_length,
+        description,
+        description_length,
+        color
+    );
+}
+
+static void find_members(const char* object,
+                         const char* end,
+                         const char* const* keys,
+                         const char** values,
+                         int count) {
+    /* the object is walked once, values of missing keys are NULL */
+    for (int i = 0; i < count; i++)
+        values[i] = NULL;
+    if (object == NULL)
+        return;
+    const char* c = skip_space(object, end);
+    if (c >= end || *c != '{')
+        return;
+    c++;
+
+    for (;;) {
+        c = skip_space(c, end);
+        if (c >= end || *c != '"')
+            return;
+        const char* name = c + 1;
+        c = skip_value(c, end);
+        size_t name_length = c - 1 - name;
+        c = skip_space(c, end);
+        if (c >= end || *c != ':')
+            return;
+        c = skip_space(c+1, end);
+        for (int i = 0; i < count; i++) {
+            int is_key = strlen(keys[i]) == name_length
+                && !memcmp(name, keys[i], name_length);
+            if (is_key)
+                values[i] = c;
+        }
+        c = skip_space(skip_value(c, end), end);
+        if (c >= end || *c != ',')
+            return;
+        c++;
+    }
+}
+
+static const char* skip_space(const char* c, const char* end) {
+    while (c < end && (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r'))
+        c++;
+    return c;
+}
+
+static const char* skip_value(const char* c, const char* end) {
+    if (c < end && *c == '"') {
+        for (c++; c < end; c++) {
+            if (*c == '\\')
+                c++;
+            else if (*c == '"')
+                return c+1;
+        }
+        return end;
+    }
+
+    /* objects and arrays end where the scanner is back at depth 0 */
+    if (c < end && (*c == '{' || *c == '[')) {
+        scan_state_t state = { 0 };
+        for (; c < end; c++) {
+            scan(MARKERIMPORT_GEOJSON, &state, *c);
+            if (!state.is_quoted && state.depth == 0)
+                return c+1;
+        }
+        return end;
+    }
+
+    /* numbers and literals */
+    while (c < end && *c != ',' && *c != '}' && *c != ']' &&
+            *c != ' ' && *c != '\t' && *c != '\n' && *c != '\r')
+        c++;
+    return c;
+}
+
+static int is_string(const char* value, const char* end, const char* text) {
+    if (value == NULL)
+        return 0;
+    size_t length = strlen(text);
+    return (size_t)(end - value) >= length + 2
+        && value[0] == '"'
+        && !memcmp(value + 1, text, length)
+        && value[length + 1] == '"';
+}
+
+static int read_string(const char* value,
+                       const char* end,
+                       char* buffer,
+                       size_t buffer_size,
+                       size_t* length) {
+    /* returns non-0 value if the string is invalid or too long */
+    *length = 0;
+    buffer[0] = '\0';
+    if (value >= end)
+        return 1;
+    if (*value != '"') /* null is an empty string */
+        return end - value < 4 || memcmp(value, "null", 4);
+
+    for (const char* c = value + 1; c < end; c++) {
+        if (*c == '"') {
+            buffer[*length] = '\0';
+            return 0;
+        }
+
+        char utf8[4] = { *c };
+        int utf8_length = 1;
+        if (*c == '\\') {
+            c++;
+            if (c >= end)
+                return 1;
+            switch (*c) {
+                case 'b': utf8[0] = '\b'; break;
+                case 'f': utf8[0] = '\f'; break;
+                case 'n': utf8[0] = '\n'; break;
+                case 'r': utf8[0] = '\r'; break;
+                case 't': utf8[0] = '\t'; break;
+                case 'u': {
+                    Uint32 code;
+                    if (read_code_point(&c, end, &code))
+                        return 1;
+                    utf8_length = encode_utf8(code, utf8);
+                    break;
+                }
+                default: utf8[0] = *c; /* quote, backslash and slash */
+            }
+        }
+
+        if (*length + utf8_length >= buffer_size)
+            return 1;
+        memcpy(buffer + *length, utf8, utf8_length);
+        *length += utf8_length;
+    }
+    return 1;
+}
+
+static int read_code_point(const char** c, const char* end, Uint32* code) {
+    /* c points to 'u' of \uXXXX, it is moved to the last digit */
+    if (read_hex(*c + 1, end, code))
+        return 1;
+    *c += 4;
+    if (*code < 0xD800 || *code > 0xDFFF)
+        return 0;
+
+    /* characters out of the basic plane are pairs of surrogates */
+    Uint32 low;
+    if (*code > 0xDBFF || end - *c < 7 || (*c)[1] != '\\' || (*c)[2] != 'u')
+        return 1;
+    if (read_hex(*c + 3, end, &low) || low < 0xDC00 || low > 0xDFFF)
+        return 1;
+    *code = 0x10000 + ((*code - 0xD800) << 10) + (low - 0xDC00);
+    *c += 6;
+    return 0;
+}
+
+static int read_hex(const char* c, const char* end, Uint32* code) {
+    if (end - c < 4)
+        return 1;
+    *code = 0;
+    for (int i = 0; i < 4; i++) {
+        char digit = c[i];
+        *code <<= 4;
+        if (digit >= '0' && digit <= '9')
+            *code |= digit - '0';
+        else if (digit >= 'a' && digit <= 'f')
+            *code |= digit - 'a' + 10;
+        else if (digit >= 'A' && digit <= 'F')
+            *code |= digit - 'A' + 10;
+        else
+            return 1;
+    }
+    return 0;
+}
+
+static int encode_utf8(Uint32 code, char* utf8) {
+    /* returns number of bytes written */
+    if (code < 0x80) {
+        utf8[0] = code;
+        return 1;
+    }
+    if (code < 0x800) {
+        utf8[0] = 0xC0 | code >> 6;
+        utf8[1] = 0x80 | (code & 0x3F);
+        return 2;
+    }
+    if (code < 0x10000) {
+        utf8[0] = 0xE0 | code >> 12;
+        utf8[1] = 0x80 | (code >> 6 & 0x3F);
+        utf8[2] = 0x80 | (code & 0x3F);
+        return 3;
+    }
+    utf8[0] = 0xF0 | code >> 18;
+    utf8[1] = 0x80 | (code >> 12 & 0x3F);
+    utf8[2] = 0x80 | (code >> 6 & 0x3F);
+    utf8[3] = 0x80 | (code & 0x3F);
+    return 4;
+}
+
+static int read_coordinates(const char* value,
+                            const char* end,
+                            double* lat,
+                            double* lon) {
+    /* GeoJSON positions are [lon, lat], altitude is ignored */
+    if (value == NULL || value >= end || *value != '[')
+        return 1;
+    char* number_end;
+    const char* c = skip_space(value + 1, end);
+    *lon = strtod(c, &number_end);
+    if (number_end == c)
+        return 1;
+    c = skip_space(number_end, end);
+    if (c >= end || *c != ',')
+        return 1;
+    c = skip_space(c+1, end);
+    *lat = strtod(c, &number_end);
+    return number_end == c;
+}
+
+static int parse_number(const char* text, double* number) {
+    /* returns non-0 value if text is not a number */
+    char* number_end;
+    *number = strtod(text, &number_end);
+    if (number_end == text)
+        return 1;
+    while (*number_end == ' ' || *number_end == '\t')
+        number_end++;
+    return *number_end != '\0';
+}
+
+static int parse_color(const char* text, Uint8* color) {
+    /* returns non-0 value if text is not an index of a colorpicker color */
+    double number;
+    if (parse_number(text, &number))
+        return 1;
+    if (number < 0 || number >= COLORPICKER_COLOR_COUNT)
+        return 1;
+    if (number != floor(number))
+        return 1;
+    *color = number;
+    return 0;
+}
+
+static int add_record(markerimport_part_t* part,
+                      double lat,
+                      double lon,
+                      const char* name,
+                      size_t name_length,
+                      const char* description,
+                      size_t description_length,
+                      Uint8 color) {
+    markerimport_record_t record = {
+        .lat = lat,
+        .lon = lon,
+        .name_length = name_length,
+        .description_length = description_length,
+        .color = color
+    };
+    textarena_t* texts = &part->texts;
+    if (textarena_add(texts, name, name_length, &record.name))
+        return 1;
+    if (textarena_add(texts, description, description_length,
+                      &record.description))
+        return 1;
+    return list_add(&part->records, &record, sizeof(markerimport_record_t));
+}
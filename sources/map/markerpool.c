@@ -0,0 +1,512 @@
+#include "../../headers/map/markerpool.h"
+
+#define CHUNKS_LIST_ALLOCATION_PORTION (64*sizeof(markerpool_chunk_t*))
+#define FLAGS_LIST_ALLOCATION_PORTION 256
+#define CHUNK_SHARED 1
+#define CHUNK_COPIED 2 /* owned copy, even among the borrowed chunks */
+
+typedef int (*cull_function_t)(const Uint32* x,
+                               const Uint32* y,
+                               Uint32 count,
+                               Uint32 first_index,
+                               Uint32 area_x,
+                               Uint32 area_y,
+                               Uint32 area_w,
+                               Uint32 area_h,
+                               list_t* result);
+
+static markerpool_chunk_t* get_chunk(const markerpool_t* markerpool,
+                                     Uint32 index);
+static markerpool_slot_t* get_slot(const markerpool_t* markerpool,
+                                   Uint32 index);
+static void set_position(markerpool_t* markerpool,
+                         Uint32 index,
+                         const marker_t* marker);
+static int prepare_slot_write(markerpool_t* markerpool, Uint32 index);
+static cull_function_t get_cull_function(void);
+static int cull_scalar(const Uint32* x,
+                       const Uint32* y,
+                       Uint32 count,
+                       Uint32 first_index,
+                       Uint32 area_x,
+                       Uint32 area_y,
+                       Uint32 area_w,
+                       Uint32 area_h,
+                       list_t* result);
+#if defined(__x86_64__) || defined(__i386__)
+static int add_mask(Uint32 mask, Uint32 first_index, list_t* result);
+static int cull_sse2(const Uint32* x,
+                     const Uint32* y,
+                     Uint32 count,
+                     Uint32 first_index,
+                     Uint32 area_x,
+                     Uint32 area_y,
+                     Uint32 area_w,
+                     Uint32 area_h,
+                     list_t* result);
+static int cull_avx2(const Uint32* x,
+                     const Uint32* y,
+                     Uint32 count,
+                     Uint32 first_index,
+                     Uint32 area_x,
+                     Uint32 area_y,
+                     Uint32 area_w,
+                     Uint32 area_h,
+                     list_t* result);
+#endif
+
+/* ---------------------- header functions definition ---------------------- */
+
+void markerpool_init(markerpool_t* markerpool) {
+    list_init(&markerpool->chunks, CHUNKS_LIST_ALLOCATION_PORTION);
+    markerpool->slot_count = 0;
+    markerpool->count = 0;
+    markerpool->free_slot = MARKERPOOL_NONE;
+    markerpool->borrowed_chunk_count = 0;
+    markerpool->shared_slot_count = 0;
+    list_init(&markerpool->chunk_flags, FLAGS_LIST_ALLOCATION_PORTION);
+    list_init(
+        &markerpool->retired_chunks,
+        CHUNKS_LIST_ALLOCATION_PORTION
+    );
+}
+
+void markerpool_free(markerpool_t* markerpool) {
+    list_t* chunks = &markerpool->chunks;
+    const Uint8* flags = markerpool->chunk_flags.begin;
+    size_t flag_count = markerpool->chunk_flags.size;
+    size_t chunk_count = chunks->size / sizeof(markerpool_chunk_t*);
+    for (size_t i = 0; i < chunk_count; i++) {
+        int is_owned = i >= markerpool->borrowed_chunk_count
+            || i < flag_count && flags[i] & CHUNK_COPIED;
+        if (is_owned)
+            free(*(markerpool_chunk_t**)list_get(
+                chunks, i * sizeof(markerpool_chunk_t*)));
+    }
+    list_t* retired = &markerpool->retired_chunks;
+    for (size_t i = 0; i < retired->size; i += sizeof(markerpool_chunk_t*))
+        free(*(markerpool_chunk_t**)list_get(retired, i));
+    list_free(chunks);
+    list_free(&markerpool->chunk_flags);
+    list_free(retired);
+    markerpool->slot_count = 0;
+    markerpool->count = 0;
+    markerpool->free_slot = MARKERPOOL_NONE;
+    markerpool->borrowed_chunk_count = 0;
+    markerpool->shared_slot_count = 0;
+}
+
+size_t markerpool_get_memory(const markerpool_t* markerpool) {
+    size_t chunk_count = markerpool->chunks.size / sizeof(markerpool_chunk_t*);
+    return markerpool->chunks.allocated_size
+        + chunk_count * sizeof(markerpool_chunk_t);
+}
+
+int markerpool_add(markerpool_t* markerpool,
+                   const marker_t* marker,
+                   marker_handle_t* handle) {
+    Uint32 index = markerpool->free_slot;
+    markerpool_slot_t* slot;
+    if (index != MARKERPOOL_NONE) {
+        if (prepare_slot_write(markerpool, index))
+            return 1;
+        slot = get_slot(markerpool, index);
+        markerpool->free_slot = slot->next_free;
+    } else {
+        index = markerpool->slot_count;
+        if (index == MARKERPOOL_NONE) {
+            SDL_SetError("too many markers\n%s()", __func__);
+            return 1;
+        }
+
+        /* a new chunk is added when the last one is full */
+        list_t* chunks = &markerpool->chunks;
+        if (index % MARKERPOOL_CHUNK_SIZE == 0) {
+            markerpool_chunk_t* chunk = malloc(sizeof(markerpool_chunk_t));
+            if (chunk == NULL) {
+                SDL_SetError("memory allocation failed\n%s()", __func__);
+                return 1;
+            }
+
+            /* slots past slot_count are never found by markerpool_cull() */
+            memset(chunk->x, 0xff, sizeof(chunk->x));
+            memset(chunk->y, 0xff, sizeof(chunk->y));
+            if (list_add(chunks, &chunk, sizeof(markerpool_chunk_t*))) {
+                free(chunk);
+                return 1;
+            }
+        }
+        slot = get_slot(markerpool, index);
+        slot->generation = 0;
+        markerpool->slot_count++;
+    }
+
+    slot->marker = *marker;
+    slot->generation++;
+    set_position(markerpool, index, marker);
+    markerpool->count++;
+    if (handle != NULL)
+        *handle = (marker_handle_t){ index, slot->generation };
+    return 0;
+}
+
+int markerpool_remove(markerpool_t* markerpool, marker_handle_t handle) {
+    if (markerpool_get(markerpool, handle) == NULL)
+        return 1;
+    if (prepare_slot_write(markerpool, handle.index))
+        return 1;
+
+    markerpool_slot_t* slot = get_slot(markerpool, handle.index);
+    slot->generation++;
+    slot->next_free = markerpool->free_slot;
+    set_position(markerpool, handle.index, NULL);
+    markerpool->free_slot = handle.index;
+    markerpool->count--;
+    return 0;
+}
+
+marker_t* markerpool_get(const markerpool_t* markerpool,
+                         marker_handle_t handle) {
+    if (handle.index >= markerpool->slot_count)
+        return NULL;
+    markerpool_slot_t* slot = get_slot(markerpool, handle.index);
+    if (slot->generation != handle.generation || !(slot->generation & 1))
+        return NULL;
+    return &slot->marker;
+}
+
+marker_t* markerpool_at(const markerpool_t* markerpool, Uint32 index) {
+    if (index >= markerpool->slot_count)
+        return NULL;
+    markerpool_slot_t* slot = get_slot(markerpool, index);
+    return slot->generation & 1 ? &slot->marker : NULL;
+}
+
+marker_handle_t markerpool_get_handle(const markerpool_t* markerpool,
+                                      Uint32 index) {
+    return (marker_handle_t){ index, get_slot(markerpool, index)->generation };
+}
+
+int markerpool_cull(const markerpool_t* markerpool,
+                    const SDL_Rect* area,
+                    list_t* result) {
+    for (Uint32 i = 0; i < markerpool->slot_count; i += MARKERPOOL_CHUNK_SIZE) {
+        Uint32 count = markerpool->slot_count - i;
+        if (count > MARKERPOOL_CHUNK_SIZE)
+            count = MARKERPOOL_CHUNK_SIZE;
+        if (markerpool_cull_chunk(get_chunk(markerpool, i), i, count,
+                                  area, result))
+            return 1;
+    }
+    return 0;
+}
+
+int markerpool_cull_chunk(const markerpool_chunk_t* chunk,
+                          Uint32 first_index,
+                          Uint32 count,
+                          const SDL_Rect* area,
+                          list_t* result) {
+    /* positions are unsigned, so the area is clipped at 0 */
+    Sint64 area_x = area->x;
+    Sint64 area_y = area->y;
+    Sint64 area_w = area->w + (area_x < 0 ? area_x : 0);
+    Sint64 area_h = area->h + (area_y < 0 ? area_y : 0);
+    if (area_w <= 0 || area_h <= 0)
+        return 0;
+    if (area_x < 0)
+        area_x = 0;
+    if (area_y < 0)
+        area_y = 0;
+
+    cull_function_t cull = get_cull_function();
+    return cull(
+        chunk->x,
+        chunk->y,
+        count,
+        first_index,
+        area_x,
+        area_y,
+        area_w,
+        area_h,
+        result
+    );
+}
+
+int markerpool_share(markerpool_t* markerpool) {
+    /* flags of chunks added since the last call are appended */
+    list_t* flags = &markerpool->chunk_flags;
+    size_t chunk_count =
+        markerpool->chunks.size / sizeof(markerpool_chunk_t*);
+    Uint8 flag = 0;
+    while (flags->size < chunk_count) {
+        if (list_add(flags, &flag, sizeof(Uint8)))
+            return 1;
+    }
+    size_t shared_count = (markerpool->slot_count + MARKERPOOL_CHUNK_SIZE-1)
+        >> MARKERPOOL_CHUNK_SIZE_LOG2;
+    for (size_t i = 0; i < shared_count; i++)
+        *(Uint8*)list_get(flags, i) |= CHUNK_SHARED;
+    markerpool->shared_slot_count = markerpool->slot_count;
+    return 0;
+}
+
+void markerpool_unshare(markerpool_t* markerpool) {
+    size_t shared_count =
+        (markerpool->shared_slot_count + MARKERPOOL_CHUNK_SIZE-1)
+            >> MARKERPOOL_CHUNK_SIZE_LOG2;
+    for (size_t i = 0; i < shared_count; i++)
+        *(Uint8*)list_get(&markerpool->chunk_flags, i) &= ~CHUNK_SHARED;
+    markerpool->shared_slot_count = 0;
+}
+
+int markerpool_pack_texts(markerpool_t* markerpool,
+                          textarena_t* texts,
+                          textblob_t* descriptions) {
+    int is_wasted = texts->released_size > texts->size / 2
+        || descriptions->released_size > descriptions->size / 2;
+    if (!is_wasted)
+        return 0;
+
+    /* offsets of the markers are moved only once every text is copied */
+    textarena_t packed_texts;
+    textblob_t packed_descriptions;
+    textarena_init(&packed_texts);
+    int error = textblob_init(&packed_descriptions);
+    Uint32* offsets = malloc(markerpool->slot_count * 2 * sizeof(Uint32));
+    char* description = malloc(TEXTBLOB_TEXT_MAX + 1);
+    if (!error && ((offsets == NULL && markerpool->slot_count) ||
+            description == NULL)) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        error = 1;
+    }
+    for (Uint32 i = 0; !error && i < markerpool->slot_count; i++) {
+        const marker_t* marker = markerpool_at(markerpool, i);
+        if (marker == NULL)
+            continue;
+        error = textarena_add(
+                &packed_texts,
+                textarena_get(texts, marker->name),
+                marker->name_length,
+                &offsets[2*i]
+            )
+            || textblob_read(
+                descriptions,
+                marker->description,
+                marker->description_length,
+                description
+            )
+            || textblob_add(
+                &packed_descriptions,
+                description,
+                marker->description_length,
+                &offsets[2*i + 1]
+            );
+    }
+    free(description);
+    if (error) {
+        free(offsets);
+        textarena_free(&packed_texts);
+        textblob_free(&packed_descriptions);
+        return 1;
+    }
+
+    for (Uint32 i = 0; i < markerpool->slot_count; i++) {
+        marker_t* marker = markerpool_at(markerpool, i);
+        if (marker == NULL)
+            continue;
+        marker->name = offsets[2*i];
+        marker->description = offsets[2*i + 1];
+    }
+    free(offsets);
+    textarena_free(texts);
+    *texts = packed_texts;
+    textblob_free(descriptions);
+    *descriptions = packed_descriptions;
+    return 0;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static markerpool_chunk_t* get_chunk(const markerpool_t* markerpool,
+                                     Uint32 index) {
+    return *(markerpool_chunk_t**)list_get(
+        &markerpool->chunks,
+        (index >> MARKERPOOL_CHUNK_SIZE_LOG2) * sizeof(markerpool_chunk_t*)
+    );
+}
+
+static markerpool_slot_t* get_slot(const markerpool_t* markerpool,
+                                   Uint32 index) {
+    markerpool_chunk_t* chunk = get_chunk(markerpool, index);
+    return &chunk->slots[index & MARKERPOOL_CHUNK_SIZE-1];
+}
+
+static void set_position(markerpool_t* markerpool,
+                         Uint32 index,
+                         const marker_t* marker) {
+    markerpool_chunk_t* chunk = get_chunk(markerpool, index);
+    index &= MARKERPOOL_CHUNK_SIZE-1;
+    chunk->x[index] = marker != NULL ? marker->x : MARKERPOOL_NONE;
+    chunk->y[index] = marker != NULL ? marker->y : MARKERPOOL_NONE;
+    chunk->color[index] = marker != NULL ? marker->color : 0;
+}
+
+static int prepare_slot_write(markerpool_t* markerpool, Uint32 index) {
+    /* readers keep the old chunk, the pool goes on with a private copy */
+    if (index >= markerpool->shared_slot_count)
+        return 0;
+    size_t chunk_index = index >> MARKERPOOL_CHUNK_SIZE_LOG2;
+    Uint8* flag = list_get(&markerpool->chunk_flags, chunk_index);
+    if (!(*flag & CHUNK_SHARED))
+        return 0;
+
+    markerpool_chunk_t** chunk = list_get(
+        &markerpool->chunks, chunk_index * sizeof(markerpool_chunk_t*));
+    markerpool_chunk_t* copy = malloc(sizeof(markerpool_chunk_t));
+    if (copy == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    int is_owned = chunk_index >= markerpool->borrowed_chunk_count
+        || *flag & CHUNK_COPIED;
+    if (is_owned && list_add(
+            &markerpool->retired_chunks,
+            chunk,
+            sizeof(markerpool_chunk_t*))) {
+        free(copy);
+        return 1;
+    }
+    memcpy(copy, *chunk, sizeof(markerpool_chunk_t));
+    *chunk = copy;
+    *flag = CHUNK_COPIED;
+    return 0;
+}
+
+static cull_function_t get_cull_function(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (SDL_HasAVX2())
+        return cull_avx2;
+    if (SDL_HasSSE2())
+        return cull_sse2;
+#endif
+    return cull_scalar;
+}
+
+static int cull_scalar(const Uint32* x,
+                       const Uint32* y,
+                       Uint32 count,
+                       Uint32 first_index,
+                       Uint32 area_x,
+                       Uint32 area_y,
+                       Uint32 area_w,
+                       Uint32 area_h,
+                       list_t* result) {
+    /* positions left of the area wrap around and fail the same comparison */
+    for (Uint32 i = 0; i < count; i++) {
+        if (x[i] - area_x >= area_w || y[i] - area_y >= area_h)
+            continue;
+        Uint32 index = first_index + i;
+        if (list_add(result, &index, sizeof(Uint32)))
+            return 1;
+    }
+    return 0;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static int add_mask(Uint32 mask, Uint32 first_index, list_t* result) {
+    while (mask) {
+        Uint32 index = first_index + __builtin_ctz(mask);
+        if (list_add(result, &index, sizeof(Uint32)))
+            return 1;
+        mask &= mask - 1;
+    }
+    return 0;
+}
+
+__attribute__((target("sse2")))
+static int cull_sse2(const Uint32* x,
+                     const Uint32* y,
+                     Uint32 count,
+                     Uint32 first_index,
+                     Uint32 area_x,
+                     Uint32 area_y,
+                     Uint32 area_w,
+                     Uint32 area_h,
+                     list_t* result) {
+    /* SSE2 compares signed values only, so the sign bit is flipped first */
+    __m128i sign = _mm_set1_epi32(0x80000000);
+    __m128i begin_x = _mm_set1_epi32(area_x);
+    __m128i begin_y = _mm_set1_epi32(area_y);
+    __m128i end_x = _mm_set1_epi32(area_w ^ 0x80000000);
+    __m128i end_y = _mm_set1_epi32(area_h ^ 0x80000000);
+
+    Uint32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i offset_x = _mm_sub_epi32(
+            _mm_loadu_si128((const __m128i*)(x + i)), begin_x);
+        __m128i offset_y = _mm_sub_epi32(
+            _mm_loadu_si128((const __m128i*)(y + i)), begin_y);
+        __m128i inside = _mm_and_si128(
+            _mm_cmplt_epi32(_mm_xor_si128(offset_x, sign), end_x),
+            _mm_cmplt_epi32(_mm_xor_si128(offset_y, sign), end_y)
+        );
+        Uint32 mask = _mm_movemask_ps(_mm_castsi128_ps(inside));
+        if (mask && add_mask(mask, first_index + i, result))
+            return 1;
+    }
+    return cull_scalar(
+        x + i,
+        y + i,
+        count - i,
+        first_index + i,
+        area_x,
+        area_y,
+        area_w,
+        area_h,
+        result
+    );
+}
+
+__attribute__((target("avx2")))
+static int cull_avx2(const Uint32* x,
+                     const Uint32* y,
+                     Uint32 count,
+                     Uint32 first_index,
+                     Uint32 area_x,
+                     Uint32 area_y,
+                     Uint32 area_w,
+                     Uint32 area_h,
+                     list_t* result) {
+    /* offset < size for unsigned values is min(offset, size-1) == offset */
+    __m256i begin_x = _mm256_set1_epi32(area_x);
+    __m256i begin_y = _mm256_set1_epi32(area_y);
+    __m256i last_x = _mm256_set1_epi32(area_w - 1);
+    __m256i last_y = _mm256_set1_epi32(area_h - 1);
+
+    Uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i offset_x = _mm256_sub_epi32(
+            _mm256_loadu_si256((const __m256i*)(x + i)), begin_x);
+        __m256i offset_y = _mm256_sub_epi32(
+            _mm256_loadu_si256((const __m256i*)(y + i)), begin_y);
+        __m256i inside = _mm256_and_si256(
+            _mm256_cmpeq_epi32(_mm256_min_epu32(offset_x, last_x), offset_x),
+            _mm256_cmpeq_epi32(_mm256_min_epu32(offset_y, last_y), offset_y)
+        );
+        Uint32 mask = _mm256_movemask_ps(_mm256_castsi256_ps(inside));
+        if (mask && add_mask(mask, first_index + i, result))
+            return 1;
+    }
+    return cull_scalar(
+        x + i,
+        y + i,
+        count - i,
+        first_index + i,
+        area_x,
+        area_y,
+        area_w,
+        area_h,
+        result
+    );
+}
+#endif
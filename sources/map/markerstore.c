@@ -0,0 +1,345 @@
+#include "../../headers/map/markerstore.h"
+
+#define MAGIC "DSGISPRT"
+#define BYTE_ORDER_MARK 0x01020304
+#define BUFFER_LIST_ALLOCATION_PORTION (64*1024)
+
+typedef struct {
+    Uint64 key;
+    Uint32 index;
+} sorted_marker_t;
+
+static Uint64 get_key(Uint32 x, Uint32 y);
+static int compare_sorted_markers(const void* a, const void* b);
+static int write_file(SDL_RWops* file,
+                      const markerstore_header_t* header,
+                      const markerstore_partition_t* partitions,
+                      const sorted_marker_t* sorted,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      textblob_t* descriptions);
+static int is_directory_valid(const markerstore_t* store, Sint64 file_size);
+static int is_part_valid(const markerstore_partition_t* partition,
+                         const markerstore_part_t* part);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int markerstore_write(const char* path,
+                      Uint8 zoom,
+                      Uint32 world_size,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      textblob_t* descriptions) {
+    Uint32 partition_size = world_size >> zoom;
+    if (!partition_size) {
+        SDL_SetError("zoom of the store is too deep\n%s()", __func__);
+        return 1;
+    }
+
+    /* markers of a partition are written in the order of slot indexes */
+    sorted_marker_t* sorted =
+        malloc((size_t)markers->count * sizeof(sorted_marker_t) + 1);
+    if (sorted == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    Uint32 count = 0;
+    for (Uint32 i = 0; i < markers->slot_count; i++) {
+        const marker_t* marker = markerpool_at(markers, i);
+        if (marker == NULL)
+            continue;
+        sorted[count].key = get_key(
+            marker->x / partition_size, marker->y / partition_size);
+        sorted[count].index = i;
+        count++;
+    }
+    qsort(sorted, count, sizeof(sorted_marker_t), compare_sorted_markers);
+
+    Uint32 partition_count = 0;
+    for (Uint32 i = 0; i < count; i++) {
+        if (!i || sorted[i].key != sorted[i-1].key)
+            partition_count++;
+    }
+    markerstore_partition_t* partitions =
+        malloc((size_t)partition_count * sizeof(markerstore_partition_t) + 1);
+    if (partitions == NULL) {
+        free(sorted);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+
+    /* partitions follow the directory in its order */
+    Uint64 offset = sizeof(markerstore_header_t)
+        + (Uint64)partition_count * sizeof(markerstore_partition_t);
+    markerstore_partition_t* partition = partitions - 1;
+    for (Uint32 i = 0; i < count; i++) {
+        if (!i || sorted[i].key != sorted[i-1].key) {
+            if (i)
+                offset += partition->size;
+            partition++;
+            partition->x = sorted[i].key & 0xFFFFFFFF;
+            partition->y = sorted[i].key >> 32;
+            partition->count = 0;
+            partition->size = 0;
+            partition->offset = offset;
+        }
+        const marker_t* marker = markerpool_at(markers, sorted[i].index);
+        partition->count++;
+        partition->size += sizeof(markerstore_record_t)
+            + marker->name_length + marker->description_length;
+    }
+
+    markerstore_header_t header = {
+        .version = MARKERSTORE_VERSION,
+        .byte_order = BYTE_ORDER_MARK,
+        .record_size = sizeof(markerstore_record_t),
+        .zoom = zoom,
+        .world_size = world_size,
+        .partition_count = partition_count,
+        .marker_count = count
+    };
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+
+    int error = 1;
+    SDL_RWops* file = SDL_RWFromFile(path, "wb");
+    if (file != NULL) {
+        error = write_file(
+            file, &header, partitions, sorted, markers, texts, descriptions);
+        if (SDL_RWclose(file))
+            error = 1;
+        if (error)
+            remove(path);
+    }
+    free(partitions);
+    free(sorted);
+    return error;
+}
+
+markerstore_t* markerstore_open(const char* path, Uint32 world_size) {
+    SDL_RWops* file = SDL_RWFromFile(path, "rb");
+    if (file == NULL)
+        return NULL;
+    Sint64 file_size = SDL_RWsize(file);
+
+    markerstore_header_t header;
+    int is_valid = SDL_RWread(file, &header, sizeof(header), 1) == 1
+        && !memcmp(header.magic, MAGIC, sizeof(header.magic))
+        && header.version == MARKERSTORE_VERSION
+        && header.byte_order == BYTE_ORDER_MARK
+        && header.record_size == sizeof(markerstore_record_t)
+        && header.world_size == world_size
+        && header.zoom < 32
+        && world_size >> header.zoom
+        && (Uint64)header.partition_count * sizeof(markerstore_partition_t)
+            <= (Uint64)file_size - sizeof(header);
+    if (!is_valid) {
+        SDL_RWclose(file);
+        SDL_SetError("%s: store is damaged or of another version\n%s()",
+                     path, __func__);
+        return NULL;
+    }
+
+    markerstore_t* store = malloc(sizeof(markerstore_t));
+    if (store == NULL) {
+        SDL_RWclose(file);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+    store->zoom = header.zoom;
+    store->partition_size = world_size >> header.zoom;
+    store->partition_count = header.partition_count;
+    store->marker_count = header.marker_count;
+    size_t directory_size =
+        (size_t)header.partition_count * sizeof(markerstore_partition_t);
+    store->partitions = malloc(directory_size + 1);
+    store->path = malloc(strlen(path) + 1);
+    if (store->partitions == NULL || store->path == NULL) {
+        SDL_RWclose(file);
+        markerstore_close(store);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+    strcpy(store->path, path);
+
+    is_valid = !directory_size
+        || SDL_RWread(file, store->partitions, directory_size, 1) == 1;
+    SDL_RWclose(file);
+    if (!is_valid || !is_directory_valid(store, file_size)) {
+        markerstore_close(store);
+        SDL_SetError("%s: directory of the store is damaged\n%s()",
+                     path, __func__);
+        return NULL;
+    }
+    return store;
+}
+
+void markerstore_close(markerstore_t* store) {
+    if (store == NULL)
+        return;
+    free(store->partitions);
+    free(store->path);
+    free(store);
+}
+
+const markerstore_partition_t* markerstore_find(const markerstore_t* store,
+                                                Uint32 x,
+                                                Uint32 y) {
+    Uint64 key = get_key(x, y);
+    Uint32 begin = 0;
+    Uint32 end = store->partition_count;
+    while (begin < end) {
+        Uint32 middle = begin + (end - begin) / 2;
+        const markerstore_partition_t* partition = &store->partitions[middle];
+        Uint64 middle_key = get_key(partition->x, partition->y);
+        if (middle_key == key)
+            return partition;
+        if (middle_key < key)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+    return NULL;
+}
+
+int markerstore_read(const char* path,
+                     const markerstore_partition_t* partition,
+                     markerstore_part_t* part) {
+    part->count = 0;
+    part->data = malloc(partition->size + 1);
+    if (part->data == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    SDL_RWops* file = SDL_RWFromFile(path, "rb");
+    if (file == NULL)
+        return 1;
+    int error = SDL_RWseek(file, partition->offset, RW_SEEK_SET) < 0
+        || partition->size
+            && SDL_RWread(file, part->data, partition->size, 1) != 1;
+    SDL_RWclose(file);
+    if (error) {
+        SDL_SetError("%s: partition can not be read\n%s()", path, __func__);
+        return 1;
+    }
+    part->count = partition->count;
+    if (!is_part_valid(partition, part)) {
+        part->count = 0;
+        SDL_SetError("%s: partition is damaged\n%s()", path, __func__);
+        return 1;
+    }
+    return 0;
+}
+
+void markerstore_free_part(markerstore_part_t* part) {
+    free(part->data);
+    part->data = NULL;
+    part->count = 0;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static Uint64 get_key(Uint32 x, Uint32 y) {
+    /* rows of partitions, so a row of the grid is read forward */
+    return (Uint64)y << 32 | x;
+}
+
+static int compare_sorted_markers(const void* a, const void* b) {
+    const sorted_marker_t* marker_a = a;
+    const sorted_marker_t* marker_b = b;
+    if (marker_a->key != marker_b->key)
+        return marker_a->key < marker_b->key ? -1 : 1;
+    return marker_a->index < marker_b->index ? -1 : 1;
+}
+
+static int write_file(SDL_RWops* file,
+                      const markerstore_header_t* header,
+                      const markerstore_partition_t* partitions,
+                      const sorted_marker_t* sorted,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      textblob_t* descriptions) {
+    size_t directory_size =
+        (size_t)header->partition_count * sizeof(markerstore_partition_t);
+    int error = SDL_RWwrite(file, header, sizeof(*header), 1) != 1
+        || directory_size
+            && SDL_RWwrite(file, partitions, directory_size, 1) != 1;
+
+    /* a partition is composed in memory and written at once */
+    list_t buffer;
+    list_init(&buffer, BUFFER_LIST_ALLOCATION_PORTION);
+    Uint32 first = 0;
+    for (Uint32 p = 0; !error && p < header->partition_count; p++) {
+        const markerstore_partition_t* partition = &partitions[p];
+        list_clear(&buffer);
+        for (Uint32 i = first; !error && i < first + partition->count; i++) {
+            const marker_t* marker = markerpool_at(markers, sorted[i].index);
+            markerstore_record_t record = {
+                .x = marker->x,
+                .y = marker->y,
+                .name_length = marker->name_length,
+                .description_length = marker->description_length,
+                .color = marker->color
+            };
+            error = list_add(&buffer, &record, sizeof(record));
+        }
+        for (Uint32 i = first; !error && i < first + partition->count; i++) {
+            const marker_t* marker = markerpool_at(markers, sorted[i].index);
+            const char* description =
+                textblob_get(descriptions, marker->description);
+            error = description == NULL || list_add(
+                &buffer,
+                textarena_get(texts, marker->name),
+                marker->name_length
+            ) || list_add(&buffer, description, marker->description_length);
+        }
+        if (!error)
+            error = SDL_RWwrite(file, buffer.begin, buffer.size, 1) != 1;
+        first += partition->count;
+    }
+    list_free(&buffer);
+
+    if (error)
+        SDL_SetError("store can not be written\n%s()", __func__);
+    return error;
+}
+
+static int is_directory_valid(const markerstore_t* store, Sint64 file_size) {
+    /* partitions are sorted, inside the world and inside the file */
+    Uint64 data_offset = sizeof(markerstore_header_t)
+        + (Uint64)store->partition_count * sizeof(markerstore_partition_t);
+    Uint64 tile_count = (Uint64)1 << store->zoom;
+    for (Uint32 i = 0; i < store->partition_count; i++) {
+        const markerstore_partition_t* partition = &store->partitions[i];
+        int is_valid = partition->x < tile_count
+            && partition->y < tile_count
+            && partition->offset >= data_offset
+            && partition->offset <= (Uint64)file_size
+            && partition->size <= (Uint64)file_size - partition->offset
+            && (Uint64)partition->count * sizeof(markerstore_record_t)
+                <= partition->size;
+        if (is_valid && i) {
+            const markerstore_partition_t* previous = partition - 1;
+            is_valid = get_key(previous->x, previous->y)
+                < get_key(partition->x, partition->y);
+        }
+        if (!is_valid)
+            return 0;
+    }
+    return 1;
+}
+
+static int is_part_valid(const markerstore_partition_t* partition,
+                         const markerstore_part_t* part) {
+    /* texts of the records fill the rest of the partition exactly */
+    const markerstore_record_t* records =
+        (const markerstore_record_t*)part->data;
+    Uint64 size = (Uint64)part->count * sizeof(markerstore_record_t);
+    for (Uint32 i = 0; i < part->count; i++) {
+        const markerstore_record_t* record = &records[i];
+        if (record->name_length > CONFIG_MARKER_NAME_MAX ||
+                record->description_length > CONFIG_MARKER_DESCRIPTION_MAX)
+            return 0;
+        size += record->name_length + record->description_length;
+    }
+    return size == partition->size;
+}
@@ -0,0 +1,233 @@
+#include "../../headers/map/markerview.h"
+
+#define RETIRED_LIST_ALLOCATION_PORTION (64*sizeof(retired_t))
+
+typedef struct {
+    void* pointer;
+    Uint64 epoch; /* the newest view which may read it */
+    int is_view;
+} retired_t;
+
+static int retire_list(markerviews_t* views, list_t* pointers);
+static Uint64 get_oldest_epoch(markerviews_t* views);
+static const retired_t* find_retired_view(const markerviews_t* views,
+                                          const void* view);
+
+/* ---------------------- header functions definition ---------------------- */
+
+void markerviews_init(markerviews_t* views) {
+    views->current = NULL;
+    for (int i = 0; i < MARKERVIEW_READER_MAX; i++) {
+        SDL_AtomicSet(&views->readers[i].is_used, 0);
+        views->readers[i].view = NULL;
+    }
+    views->epoch = 0;
+    list_init(&views->retired, RETIRED_LIST_ALLOCATION_PORTION);
+}
+
+void markerviews_free(markerviews_t* views) {
+    /* views, chunks and blocks are all single allocations */
+    list_t* retired = &views->retired;
+    for (size_t k = 0; k < retired->size; k += sizeof(retired_t))
+        free(((retired_t*)list_get(retired, k))->pointer);
+    list_free(retired);
+    free(SDL_AtomicSetPtr(&views->current, NULL));
+    views->epoch = 0;
+}
+
+int markerviews_publish(markerviews_t* views,
+                        markerpool_t* markers,
+                        textarena_t* texts,
+                        textblob_t* descriptions) {
+    /* what was replaced since the last view is read up to that view */
+    if (retire_list(views, &markers->retired_chunks))
+        return 1;
+    if (retire_list(views, &texts->retired_blocks))
+        return 1;
+
+    size_t chunk_count = (markers->slot_count + MARKERPOOL_CHUNK_SIZE-1)
+        >> MARKERPOOL_CHUNK_SIZE_LOG2;
+    size_t chunks_size = chunk_count * sizeof(markerpool_chunk_t*);
+    markerview_t* view = malloc(sizeof(markerview_t) + chunks_size);
+    if (view == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    if (markerpool_share(markers)) {
+        free(view);
+        return 1;
+    }
+    textarena_share(texts);
+    view->epoch = views->epoch + 1;
+    view->slot_count = markers->slot_count;
+    view->count = markers->count;
+    view->texts = texts->data;
+    view->descriptions = descriptions;
+    view->chunks = (markerpool_chunk_t**)(view + 1);
+    if (chunks_size)
+        memcpy(view->chunks, markers->chunks.begin, chunks_size);
+
+    /* on error the old view is leaked rather than freed under a reader */
+    markerview_t* old_view = views->current;
+    retired_t item = { old_view, views->epoch, 1 };
+    if (old_view != NULL &&
+            list_add(&views->retired, &item, sizeof(retired_t))) {
+        free(view);
+        return 1;
+    }
+    views->epoch = view->epoch;
+    SDL_AtomicSetPtr(&views->current, view);
+    markerviews_collect(views);
+    return 0;
+}
+
+int markerviews_withdraw(markerviews_t* views,
+                         markerpool_t* markers,
+                         textarena_t* texts) {
+    /* what was replaced since the last view is read up to that view */
+    if (retire_list(views, &markers->retired_chunks))
+        return 1;
+    if (retire_list(views, &texts->retired_blocks))
+        return 1;
+    markerview_t* view = views->current;
+    retired_t item = { view, views->epoch, 1 };
+    if (view != NULL && list_add(&views->retired, &item, sizeof(retired_t)))
+        return 1;
+    SDL_AtomicSetPtr(&views->current, NULL);
+    markerviews_collect(views);
+
+    /* once nothing can be read, edits do not copy chunks and blocks */
+    if (!views->retired.size) {
+        markerpool_unshare(markers);
+        textarena_unshare(texts);
+    }
+    return 0;
+}
+
+void markerviews_collect(markerviews_t* views) {
+    list_t* retired = &views->retired;
+    if (!retired->size)
+        return;
+    Uint64 oldest_epoch = get_oldest_epoch(views);
+    size_t kept_size = 0;
+    for (size_t k = 0; k < retired->size; k += sizeof(retired_t)) {
+        retired_t* item = list_get(retired, k);
+        if (item->epoch < oldest_epoch) {
+            free(item->pointer);
+            continue;
+        }
+        memmove(list_get(retired, kept_size), item, sizeof(retired_t));
+        kept_size += sizeof(retired_t);
+    }
+    retired->size = kept_size;
+}
+
+markerview_reader_t* markerviews_acquire(markerviews_t* views) {
+    markerview_reader_t* reader = NULL;
+    for (int i = 0; reader == NULL && i < MARKERVIEW_READER_MAX; i++) {
+        if (SDL_AtomicCAS(&views->readers[i].is_used, 0, 1))
+            reader = &views->readers[i];
+    }
+    if (reader == NULL) {
+        SDL_SetError("all readers are taken\n%s()", __func__);
+        return NULL;
+    }
+
+    /*
+        the view is pinned first and checked to be current after, so the
+        owner either sees the pin or has not replaced the view yet
+    */
+    void* view;
+    do {
+        view = SDL_AtomicGetPtr(&views->current);
+        SDL_AtomicSetPtr(&reader->view, view);
+    } while (SDL_AtomicGetPtr(&views->current) != view);
+
+    if (view == NULL) {
+        SDL_AtomicSet(&reader->is_used, 0);
+        SDL_SetError("markers are not published yet\n%s()", __func__);
+        return NULL;
+    }
+    return reader;
+}
+
+void markerviews_release(markerview_reader_t* reader) {
+    SDL_AtomicSetPtr(&reader->view, NULL);
+    SDL_AtomicSet(&reader->is_used, 0);
+}
+
+const marker_t* markerview_at(const markerview_t* view, Uint32 index) {
+    if (index >= view->slot_count)
+        return NULL;
+    const markerpool_chunk_t* chunk =
+        view->chunks[index >> MARKERPOOL_CHUNK_SIZE_LOG2];
+    const markerpool_slot_t* slot =
+        &chunk->slots[index & MARKERPOOL_CHUNK_SIZE-1];
+    return slot->generation & 1 ? &slot->marker : NULL;
+}
+
+const char* markerview_get_text(const markerview_t* view, Uint32 offset) {
+    if (offset == TEXTARENA_EMPTY)
+        return "";
+    return view->texts + offset;
+}
+
+int markerview_read_description(const markerview_t* view,
+                                const marker_t* marker,
+                                char* description) {
+    return textblob_read(
+        view->descriptions,
+        marker->description,
+        marker->description_length,
+        description
+    );
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int retire_list(markerviews_t* views, list_t* pointers) {
+    /* pointers which are retired are taken out of the list one by one */
+    while (pointers->size) {
+        size_t last = pointers->size - sizeof(void*);
+        retired_t item = {
+            .pointer = *(void**)list_get(pointers, last),
+            .epoch = views->epoch,
+            .is_view = 0
+        };
+        if (list_add(&views->retired, &item, sizeof(retired_t)))
+            return 1;
+        pointers->size = last;
+    }
+    return 0;
+}
+
+static Uint64 get_oldest_epoch(markerviews_t* views) {
+    /*
+        a pin may hold a view which was freed before the reader checked it,
+        so pins are matched against live views and never dereferenced; a
+        pin of no live view is dropped by its reader
+    */
+    /* what was retired at the epoch of a withdrawn view is free to go */
+    const void* current = views->current;
+    Uint64 oldest_epoch = current != NULL ? views->epoch : views->epoch + 1;
+    for (int i = 0; i < MARKERVIEW_READER_MAX; i++) {
+        const void* view = SDL_AtomicGetPtr(&views->readers[i].view);
+        if (view == NULL || view == current)
+            continue;
+        const retired_t* item = find_retired_view(views, view);
+        if (item != NULL && item->epoch < oldest_epoch)
+            oldest_epoch = item->epoch;
+    }
+    return oldest_epoch;
+}
+
+static const retired_t* find_retired_view(const markerviews_t* views,
+                                          const void* view) {
+    const list_t* retired = &views->retired;
+    for (size_t k = 0; k < retired->size; k += sizeof(retired_t)) {
+        const retired_t* item = list_get(retired, k);
+        if (item->is_view && item->pointer == view)
+            return item;
+    }
+    return NULL;
+}
@@ -9,13 +9,31 @@ static void draw_create_marker(const panel_t* panel,
                                int x,
                                int y,
                                int h);
-static void handle_event_create_marker(panel_t* panel,
-                                       const SDL_Event* event,
-                                       SDL_Renderer* renderer,
-                                       int x,
-                                       int y,
-                                       int h);
+static int handle_event_create_marker(panel_t* panel,
+                                      const SDL_Event* event,
+                                      int x,
+                                      int y,
+                                      int h);
 static void create_marker_on_create_clicked(void* data);
+static int init_search_marker(panel_t* panel, SDL_Renderer* renderer);
+static void deinit_search_marker(panel_t* panel);
+static void draw_search_marker(const panel_t* panel,
+                               SDL_Renderer* renderer,
+                               int x,
+                               int y,
+                               int h);
+static int handle_event_search_marker(panel_t* panel,
+                                      const SDL_Event* event,
+                                      int x,
+                                      int y,
+                                      int h);
+static int get_search_result_count(const panel_t* panel, int h);
+static Sint32 get_search_result_at(const panel_t* panel,
+                                   int mouse_x,
+                                   int mouse_y,
+                                   int x,
+                                   int y,
+                                   int h);
 
 /* ---------------------- header functions definition ---------------------- */
 
@@ -23,6 +41,7 @@ panel_t* panel_init(int type,
                     SDL_Renderer* renderer,
                     void* map,
                     void (*on_executed)(void*),
+                    void (*on_changed)(void*),
                     const char* (*check)(void*)) {
     panel_t* panel = malloc(sizeof(panel_t));
     if (panel == NULL) {
@@ -34,10 +53,18 @@ panel_t* panel_init(int type,
     panel->parameters.canceled = 0;
     panel->parameters.map = map;
     panel->parameters.on_executed = on_executed;
+    panel->parameters.on_changed = on_changed;
     panel->parameters.check = check;
 
+    int error = 0;
     if (type == PANEL_CREATE_MARKER)
         init_create_marker(panel, renderer);
+    else if (type == PANEL_SEARCH_MARKER)
+        error = init_search_marker(panel, renderer);
+    if (error) {
+        free(panel);
+        return NULL;
+    }
 
     return panel;
 }
@@ -45,6 +72,8 @@ panel_t* panel_init(int type,
 void panel_deinit(panel_t* panel) {
     if (panel->parameters.type == PANEL_CREATE_MARKER)
         deinit_create_marker(panel);
+    else if (panel->parameters.type == PANEL_SEARCH_MARKER)
+        deinit_search_marker(panel);
     free(panel);
 }
 
@@ -55,16 +84,20 @@ void panel_draw(const panel_t* panel,
                 int h) {
     if (panel->parameters.type == PANEL_CREATE_MARKER)
         draw_create_marker(panel, renderer, x, y, h);
+    else if (panel->parameters.type == PANEL_SEARCH_MARKER)
+        draw_search_marker(panel, renderer, x, y, h);
 }
 
-void panel_handle_event(panel_t* panel,
-                        const SDL_Event* event,
-                        SDL_Renderer* renderer,
-                        int x,
-                        int y,
-                        int h) {
+int panel_handle_event(panel_t* panel,
+                       const SDL_Event* event,
+                       int x,
+                       int y,
+                       int h) {
     if (panel->parameters.type == PANEL_CREATE_MARKER)
-        handle_event_create_marker(panel, event, renderer, x, y, h);
+        return handle_event_create_marker(panel, event, x, y, h);
+    if (panel->parameters.type == PANEL_SEARCH_MARKER)
+        return handle_event_search_marker(panel, event, x, y, h);
+    return 0;
 }
 
 /* ---------------------- static functions definition ---------------------- */
@@ -118,7 +151,7 @@ static void draw_create_marker(const panel_t* panel,
     int editfield_y =
         colorpicker_y + CONFIG_COLORPICKER_HEIGHT + 2*PANEL_INDENT;
     int editfield_h = PANEL_EDITFIELD_HEIGHT;
-    int editfield_text_h = editfield->text_texture_height;
+    int editfield_text_h = editfield->text_height;
     if (editfield_text_h + 2*EDITFIELD_VERTICAL_INDENT > editfield_h)
         editfield_h = editfield_text_h + 2*EDITFIELD_VERTICAL_INDENT;
     int editfield_max_h =
@@ -138,12 +171,11 @@ static void draw_create_marker(const panel_t* panel,
     button_draw(button_cancel, renderer, button_cancel_x, button_cancel_y);
 }
 
-static void handle_event_create_marker(panel_t* panel,
-                                       const SDL_Event* event,
-                                       SDL_Renderer* renderer,
-                                       int x,
-                                       int y,
-                                       int h) {
+static int handle_event_create_marker(panel_t* panel,
+                                      const SDL_Event* event,
+                                      int x,
+                                      int y,
+                                      int h) {
     x += PANEL_INDENT;
     int w = CONFIG_MAP_PANEL_WIDTH - 2*PANEL_INDENT;
 
@@ -159,7 +191,7 @@ static void handle_event_create_marker(panel_t* panel,
     int editfield_y =
         colorpicker_y + CONFIG_COLORPICKER_HEIGHT + 2*PANEL_INDENT;
     int editfield_h = PANEL_EDITFIELD_HEIGHT;
-    int editfield_text_h = editfield->text_texture_height;
+    int editfield_text_h = editfield->text_height;
     if (editfield_text_h + 2*EDITFIELD_VERTICAL_INDENT > editfield_h)
         editfield_h = editfield_text_h + 2*EDITFIELD_VERTICAL_INDENT;
     int editfield_max_h =
@@ -172,12 +204,23 @@ static void handle_event_create_marker(panel_t* panel,
     int button_cancel_y = button_create_y;
     int button_cancel_x = button_create_x - CONFIG_BUTTON_WIDTH - PANEL_INDENT;
 
-    editline_handle_event(editline, event, renderer, x, editline_y, w);
-    colorpicker_handle_event(colorpicker, event, x, colorpicker_y, w);
-    editfield_handle_event(
-        editfield, event, renderer, x, editfield_y, w, editfield_h);
-    button_handle_event(button_create, event, button_create_x, button_create_y);
-    button_handle_event(button_cancel, event, button_cancel_x, button_cancel_y);
+    int redraw = 0;
+    redraw |= editline_handle_event(editline, event, x, editline_y, w);
+    redraw |= colorpicker_handle_event(
+        colorpicker, event, x, colorpicker_y, w);
+    redraw |= editfield_handle_event(
+        editfield, event, x, editfield_y, w, editfield_h);
+
+    /* a click may free the panel, so nothing is handled after it */
+    int is_create_clicked = event->type == SDL_MOUSEBUTTONUP &&
+        button_create->status == BUTTON_STATUS_DOWN;
+    redraw |= button_handle_event(
+        button_create, event, button_create_x, button_create_y);
+    if (is_create_clicked)
+        return 1;
+    redraw |= button_handle_event(
+        button_cancel, event, button_cancel_x, button_cancel_y);
+    return redraw;
 }
 
 static void create_marker_on_create_clicked(void* data) {
@@ -186,5 +229,217 @@ static void create_marker_on_create_clicked(void* data) {
     if (error_message == NULL)
         panel->parameters.on_executed(panel);
     else
-        MessageBox(GetActiveWindow(), error_message, NULL, MB_OK);
+        SDL_ShowSimpleMessageBox(
+            SDL_MESSAGEBOX_ERROR, "Error", error_message, NULL);
+}
+
+static int init_search_marker(panel_t* panel, SDL_Renderer* renderer) {
+    panel->search_marker.editline =
+        editline_init("name or description", renderer, CONFIG_MARKER_NAME_MAX);
+    panel->search_marker.button_close =
+        button_init("Close", renderer, cancel, panel);
+    panel->search_marker.glyphcache =
+        glyphcache_get(renderer, CONFIG_FONT_PATH, CONFIG_FONT_SIZE);
+    int is_ready = panel->search_marker.editline != NULL
+        && panel->search_marker.button_close != NULL
+        && panel->search_marker.glyphcache != NULL;
+    if (!is_ready) {
+        if (panel->search_marker.editline != NULL)
+            editline_deinit(panel->search_marker.editline);
+        if (panel->search_marker.button_close != NULL)
+            button_deinit(panel->search_marker.button_close);
+        return 1;
+    }
+
+    /* the query is typed right after the panel is opened */
+    panel->search_marker.editline->active = 1;
+    list_init(
+        &panel->search_marker.results,
+        PANEL_SEARCH_RESULT_MAX * sizeof(panel_search_result_t)
+    );
+    panel->search_marker.query_size = 1;
+    panel->search_marker.hovered_result = -1;
+    panel->search_marker.selected_result = -1;
+    return 0;
+}
+
+static void deinit_search_marker(panel_t* panel) {
+    editline_deinit(panel->search_marker.editline);
+    button_deinit(panel->search_marker.button_close);
+    list_free(&panel->search_marker.results);
+}
+
+static void draw_search_marker(const panel_t* panel,
+                               SDL_Renderer* renderer,
+                               int x,
+                               int y,
+                               int h) {
+    x += PANEL_INDENT;
+    int w = CONFIG_MAP_PANEL_WIDTH - 2*PANEL_INDENT;
+
+    const editline_t* editline = panel->search_marker.editline;
+    const button_t* button_close = panel->search_marker.button_close;
+    glyphcache_t* glyphcache = panel->search_marker.glyphcache;
+    const list_t* results = &panel->search_marker.results;
+
+    int editline_y = y + PANEL_INDENT;
+    int editline_w = w - CONFIG_BUTTON_WIDTH - PANEL_INDENT;
+    int button_close_x = x + w - CONFIG_BUTTON_WIDTH;
+    int button_close_y =
+        editline_y + (CONFIG_EDITLINE_HEIGHT - CONFIG_BUTTON_HEIGHT)/2;
+    int results_y = editline_y + CONFIG_EDITLINE_HEIGHT + PANEL_INDENT;
+    int results_h = y + h - PANEL_INDENT - results_y;
+
+    editline_draw(editline, renderer, x, editline_y, editline_w);
+    button_draw(button_close, renderer, button_close_x, button_close_y);
+
+    int row_h = glyphcache->line_skip + 2*PANEL_SEARCH_RESULT_INDENT;
+    SDL_Rect clip = {
+        .x = x + EDITLINE_HORIZONTAL_INDENT,
+        .y = results_y,
+        .w = w - 2*EDITLINE_HORIZONTAL_INDENT,
+        .h = results_h
+    };
+    if (!results->size && editline->text.size > 1) {
+        glyphcache_draw(
+            glyphcache,
+            "Nothing found",
+            (SDL_Color){ CONFIG_COLOR_BORDER },
+            clip.x,
+            results_y + PANEL_SEARCH_RESULT_INDENT,
+            0,
+            &clip
+        );
+        return;
+    }
+
+    int count = get_search_result_count(panel, results_h);
+    for (int k = 0; k < count; k++) {
+        const panel_search_result_t* result =
+            list_get(results, k * sizeof(panel_search_result_t));
+        int row_y = results_y + k*row_h;
+        if (k == panel->search_marker.hovered_result) {
+            SDL_SetRenderDrawColor(renderer, BUTTON_COLOR_CONTAINS_MOUSE);
+            SDL_Rect row = { x, row_y, w, row_h };
+            SDL_RenderFillRect(renderer, &row);
+        }
+        SDL_Color color = { CONFIG_COLOR_TEXT };
+        if (k == panel->search_marker.selected_result)
+            color = (SDL_Color){ CONFIG_COLOR_ACTIVE };
+        glyphcache_draw(
+            glyphcache,
+            result->name,
+            color,
+            clip.x,
+            row_y + PANEL_SEARCH_RESULT_INDENT,
+            0,
+            &clip
+        );
+    }
+}
+
+static int handle_event_search_marker(panel_t* panel,
+                                      const SDL_Event* event,
+                                      int x,
+                                      int y,
+                                      int h) {
+    x += PANEL_INDENT;
+    int w = CONFIG_MAP_PANEL_WIDTH - 2*PANEL_INDENT;
+
+    editline_t* editline = panel->search_marker.editline;
+    button_t* button_close = panel->search_marker.button_close;
+    panel_search_marker* search_marker = &panel->search_marker;
+
+    int editline_y = y + PANEL_INDENT;
+    int editline_w = w - CONFIG_BUTTON_WIDTH - PANEL_INDENT;
+    int button_close_x = x + w - CONFIG_BUTTON_WIDTH;
+    int button_close_y =
+        editline_y + (CONFIG_EDITLINE_HEIGHT - CONFIG_BUTTON_HEIGHT)/2;
+    int results_y = editline_y + CONFIG_EDITLINE_HEIGHT + PANEL_INDENT;
+    int results_h = y + h - PANEL_INDENT - results_y;
+
+    /* Enter jumps to the best result and the query stays editable */
+    if (event->type == SDL_KEYDOWN && editline->active) {
+        SDL_Keycode key = event->key.keysym.sym;
+        if (key == SDLK_RETURN || key == SDLK_KP_ENTER) {
+            if (!search_marker->results.size)
+                return 0;
+            search_marker->selected_result = 0;
+            panel->parameters.on_executed(panel);
+            return 1;
+        }
+        if (key == SDLK_ESCAPE) {
+            cancel(panel);
+            return 1;
+        }
+    }
+
+    int redraw = editline_handle_event(
+        editline, event, x, editline_y, editline_w);
+
+    /* every typed or erased character changes the size of the query */
+    if (editline->text.size != search_marker->query_size) {
+        search_marker->query_size = editline->text.size;
+        search_marker->hovered_result = -1;
+        search_marker->selected_result = -1;
+        panel->parameters.on_changed(panel);
+        redraw = 1;
+    }
+
+    if (event->type == SDL_MOUSEMOTION) {
+        Sint32 row = get_search_result_at(
+            panel, event->motion.x, event->motion.y, x, results_y, results_h);
+        if (row != search_marker->hovered_result) {
+            search_marker->hovered_result = row;
+            redraw = 1;
+        }
+    }
+
+    else if (event->type == SDL_MOUSEBUTTONDOWN &&
+             event->button.button == SDL_BUTTON_LEFT) {
+        Sint32 row = get_search_result_at(
+            panel, event->button.x, event->button.y, x, results_y, results_h);
+        if (row >= 0) {
+            search_marker->selected_result = row;
+            panel->parameters.on_executed(panel);
+            redraw = 1;
+        }
+    }
+
+    /* the close button is the last one, the panel is freed when clicked */
+    redraw |= button_handle_event(
+        button_close, event, button_close_x, button_close_y);
+    return redraw;
+}
+
+static int get_search_result_count(const panel_t* panel, int h) {
+    /* rows which do not fit into the panel are not shown */
+    int row_h =
+        panel->search_marker.glyphcache->line_skip
+        + 2*PANEL_SEARCH_RESULT_INDENT;
+    int count =
+        panel->search_marker.results.size / sizeof(panel_search_result_t);
+    int fit_count = h > 0 ? h / row_h : 0;
+    return count < fit_count ? count : fit_count;
+}
+
+static Sint32 get_search_result_at(const panel_t* panel,
+                                   int mouse_x,
+                                   int mouse_y,
+                                   int x,
+                                   int y,
+                                   int h) {
+    int row_h =
+        panel->search_marker.glyphcache->line_skip
+        + 2*PANEL_SEARCH_RESULT_INDENT;
+    int count = get_search_result_count(panel, h);
+    SDL_Rect area = {
+        .x = x,
+        .y = y,
+        .w = CONFIG_MAP_PANEL_WIDTH - 2*PANEL_INDENT,
+        .h = count * row_h
+    };
+    if (!is_belong(mouse_x, mouse_y, &area))
+        return -1;
+    return (mouse_y - y) / row_h;
 }
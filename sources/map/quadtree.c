@@ -0,0 +1,503 @@
+#include "../../headers/map/quadtree.h"
+
+#define NODES_LIST_ALLOCATION_PORTION (256*sizeof(quadtree_node_t))
+#define ITEMS_LIST_ALLOCATION_PORTION (8*sizeof(quadtree_item_t))
+#define FREE_CHILDREN_LIST_ALLOCATION_PORTION (64*sizeof(Sint32))
+#define DEPTH_MAX 33 /* nodes from the root to a leaf of one pixel */
+#define HEAP_LIST_ALLOCATION_PORTION (256*sizeof(heap_entry_t))
+
+typedef struct {
+    double distance;
+    Uint32 x, y;
+    Uint32 size; /* 0 for items */
+    Uint32 index; /* of the node, or of the item if size is 0 */
+} heap_entry_t;
+
+static quadtree_node_t* get_node(const quadtree_t* quadtree, Sint32 index);
+static quadtree_node_t* find_leaf(const quadtree_t* quadtree,
+                                  Uint32 x,
+                                  Uint32 y,
+                                  Sint32* index,
+                                  Uint32* node_x,
+                                  Uint32* node_y,
+                                  Uint32* node_size);
+static int get_quadrant(Uint32 x,
+                        Uint32 y,
+                        Uint32* node_x,
+                        Uint32* node_y,
+                        Uint32 half_size);
+static int split_node(quadtree_t* quadtree,
+                      Sint32 index,
+                      Uint32 node_x,
+                      Uint32 node_y,
+                      Uint32 node_size);
+static Sint32 add_children(quadtree_t* quadtree);
+static int merge_children(quadtree_t* quadtree, Sint32 index);
+static int query_node(const quadtree_t* quadtree,
+                      Sint32 index,
+                      Uint32 node_x,
+                      Uint32 node_y,
+                      Uint32 node_size,
+                      const SDL_Rect* area,
+                      list_t* result);
+static int is_node_outside(Uint32 node_x,
+                           Uint32 node_y,
+                           Uint32 node_size,
+                           const SDL_Rect* area);
+static int contains_node(const quadtree_t* quadtree,
+                         Sint32 index,
+                         Uint32 node_x,
+                         Uint32 node_y,
+                         Uint32 node_size,
+                         const SDL_Rect* area);
+static int push_heap_entry(list_t* heap, const heap_entry_t* entry);
+static heap_entry_t pop_heap_entry(list_t* heap);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int quadtree_init(quadtree_t* quadtree, Uint32 size) {
+    list_init(&quadtree->nodes, NODES_LIST_ALLOCATION_PORTION);
+    list_init(&quadtree->free_children, FREE_CHILDREN_LIST_ALLOCATION_PORTION);
+    quadtree->size = size;
+    quadtree->count = 0;
+
+    quadtree_node_t root = { .children = -1 };
+    list_init(&root.items, ITEMS_LIST_ALLOCATION_PORTION);
+    return list_add(&quadtree->nodes, &root, sizeof(quadtree_node_t));
+}
+
+void quadtree_free(quadtree_t* quadtree) {
+    for (int i = 0; i < quadtree->nodes.size; i += sizeof(quadtree_node_t)) {
+        quadtree_node_t* node = list_get(&quadtree->nodes, i);
+        list_free(&node->items);
+    }
+    list_free(&quadtree->nodes);
+    list_free(&quadtree->free_children);
+    quadtree->count = 0;
+}
+
+size_t quadtree_get_memory(const quadtree_t* quadtree) {
+    size_t memory =
+        quadtree->nodes.allocated_size + quadtree->free_children.allocated_size;
+    for (int i = 0; i < quadtree->nodes.size; i += sizeof(quadtree_node_t)) {
+        quadtree_node_t* node = list_get(&quadtree->nodes, i);
+        memory += node->items.allocated_size;
+    }
+    return memory;
+}
+
+int quadtree_insert(quadtree_t* quadtree, Uint32 x, Uint32 y, Uint32 index) {
+    if (x >= quadtree->size || y >= quadtree->size) {
+        SDL_SetError("position is out of the tree\n%s()", __func__);
+        return 1;
+    }
+
+    Sint32 node_index;
+    Uint32 node_x, node_y, node_size;
+    quadtree_node_t* node = find_leaf(
+        quadtree, x, y, &node_index, &node_x, &node_y, &node_size);
+
+    quadtree_item_t item = { x, y, index };
+    if (list_add(&node->items, &item, sizeof(quadtree_item_t)))
+        return 1;
+    quadtree->count++;
+
+    /* a leaf of one pixel holds all items of the same position */
+    size_t item_count = node->items.size / sizeof(quadtree_item_t);
+    if (item_count <= QUADTREE_BUCKET_SIZE || node_size == 1)
+        return 0;
+    return split_node(quadtree, node_index, node_x, node_y, node_size);
+}
+
+int quadtree_remove(quadtree_t* quadtree, Uint32 x, Uint32 y, Uint32 index) {
+    if (x >= quadtree->size || y >= quadtree->size)
+        return 1;
+
+    /* the path is kept, so the parents are merged back from the leaf up */
+    Sint32 path[DEPTH_MAX];
+    int depth = 0;
+    Uint32 node_x = 0, node_y = 0, node_size = quadtree->size;
+    path[0] = 0;
+    quadtree_node_t* node = get_node(quadtree, 0);
+    while (node->children >= 0) {
+        node_size /= 2;
+        path[depth + 1] = node->children
+            + get_quadrant(x, y, &node_x, &node_y, node_size);
+        node = get_node(quadtree, path[++depth]);
+    }
+
+    /* order of items in a leaf does not matter, the last one fills the gap */
+    list_t* items = &node->items;
+    int is_found = 0;
+    for (int i = 0; i < items->size; i += sizeof(quadtree_item_t)) {
+        quadtree_item_t* item = list_get(items, i);
+        if (item->index != index || item->x != x || item->y != y)
+            continue;
+        items->size -= sizeof(quadtree_item_t);
+        *item = *(quadtree_item_t*)list_get(items, items->size);
+        quadtree->count--;
+        is_found = 1;
+        break;
+    }
+    if (!is_found)
+        return 1;
+
+    while (depth > 0 && !merge_children(quadtree, path[depth - 1]))
+        depth--;
+    return 0;
+}
+
+int quadtree_query(const quadtree_t* quadtree,
+                   const SDL_Rect* area,
+                   list_t* result) {
+    if (area->w <= 0 || area->h <= 0)
+        return 0;
+    return query_node(quadtree, 0, 0, 0, quadtree->size, area, result);
+}
+
+int quadtree_contains(const quadtree_t* quadtree, const SDL_Rect* area) {
+    if (area->w <= 0 || area->h <= 0)
+        return 0;
+    return contains_node(quadtree, 0, 0, 0, quadtree->size, area);
+}
+
+int quadtree_find_nearest(const quadtree_t* quadtree,
+                          Uint32 count,
+                          quadtree_distance_t distance,
+                          void* data,
+                          list_t* result) {
+    list_t heap;
+    list_init(&heap, HEAP_LIST_ALLOCATION_PORTION);
+    heap_entry_t root = {
+        .distance = 0,
+        .x = 0,
+        .y = 0,
+        .size = quadtree->size,
+        .index = 0
+    };
+    int error = push_heap_entry(&heap, &root);
+
+    /* an item on top is nearer than everything which is not opened yet */
+    Uint32 found_count = 0;
+    while (!error && found_count < count && heap.size) {
+        heap_entry_t entry = pop_heap_entry(&heap);
+        if (!entry.size) {
+            quadtree_neighbor_t neighbor = { entry.index, entry.distance };
+            error = list_add(result, &neighbor, sizeof(quadtree_neighbor_t));
+            found_count++;
+            continue;
+        }
+
+        const quadtree_node_t* node = get_node(quadtree, entry.index);
+        const list_t* items = &node->items;
+        for (int i = 0; !error && i < items->size;
+                i += sizeof(quadtree_item_t)) {
+            const quadtree_item_t* item = list_get(items, i);
+            heap_entry_t item_entry = {
+                .distance = distance(data, item->x, item->y, 0),
+                .x = item->x,
+                .y = item->y,
+                .size = 0,
+                .index = item->index
+            };
+            error = push_heap_entry(&heap, &item_entry);
+        }
+        if (node->children < 0)
+            continue;
+
+        Uint32 half_size = entry.size / 2;
+        for (int i = 0; !error && i < 4; i++) {
+            heap_entry_t child = {
+                .x = entry.x + (i & 1 ? half_size : 0),
+                .y = entry.y + (i & 2 ? half_size : 0),
+                .size = half_size,
+                .index = node->children + i
+            };
+            child.distance = distance(data, child.x, child.y, child.size);
+            error = push_heap_entry(&heap, &child);
+        }
+    }
+
+    list_free(&heap);
+    return error;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static quadtree_node_t* get_node(const quadtree_t* quadtree, Sint32 index) {
+    return list_get(&quadtree->nodes, index * sizeof(quadtree_node_t));
+}
+
+static quadtree_node_t* find_leaf(const quadtree_t* quadtree,
+                                  Uint32 x,
+                                  Uint32 y,
+                                  Sint32* index,
+                                  Uint32* node_x,
+                                  Uint32* node_y,
+                                  Uint32* node_size) {
+    *index = 0;
+    *node_x = 0;
+    *node_y = 0;
+    *node_size = quadtree->size;
+    quadtree_node_t* node = get_node(quadtree, *index);
+    while (node->children >= 0) {
+        *node_size /= 2;
+        *index = node->children
+            + get_quadrant(x, y, node_x, node_y, *node_size);
+        node = get_node(quadtree, *index);
+    }
+    return node;
+}
+
+static int get_quadrant(Uint32 x,
+                        Uint32 y,
+                        Uint32* node_x,
+                        Uint32* node_y,
+                        Uint32 half_size) {
+    /* moves the node position to the quadrant which holds (x, y) */
+    int quadrant = 0;
+    if (x >= *node_x + half_size) {
+        *node_x += half_size;
+        quadrant += 1;
+    }
+    if (y >= *node_y + half_size) {
+        *node_y += half_size;
+        quadrant += 2;
+    }
+    return quadrant;
+}
+
+static int split_node(quadtree_t* quadtree,
+                      Sint32 index,
+                      Uint32 node_x,
+                      Uint32 node_y,
+                      Uint32 node_size) {
+    Sint32 children = add_children(quadtree);
+    if (children < 0)
+        return 1;
+
+    /* the nodes list may be reallocated, so the node is taken after it */
+    quadtree_node_t* node = get_node(quadtree, index);
+    list_t items = node->items;
+    node->children = children;
+    list_init(&node->items, ITEMS_LIST_ALLOCATION_PORTION);
+
+    Uint32 half_size = node_size / 2;
+    int error = 0;
+    for (int i = 0; i < items.size; i += sizeof(quadtree_item_t)) {
+        quadtree_item_t* item = list_get(&items, i);
+        Uint32 child_x = node_x;
+        Uint32 child_y = node_y;
+        int quadrant =
+            get_quadrant(item->x, item->y, &child_x, &child_y, half_size);
+        quadtree_node_t* child = get_node(quadtree, children + quadrant);
+        if (list_add(&child->items, item, sizeof(quadtree_item_t))) {
+            quadtree->count--;
+            error = 1;
+        }
+    }
+    list_free(&items);
+
+    /* all items may fall into one quadrant, then it is split again */
+    for (int i = 0; !error && i < 4; i++) {
+        quadtree_node_t* child = get_node(quadtree, children + i);
+        size_t item_count = child->items.size / sizeof(quadtree_item_t);
+        if (item_count <= QUADTREE_BUCKET_SIZE || half_size == 1)
+            continue;
+        error = split_node(
+            quadtree,
+            children + i,
+            node_x + (i & 1 ? half_size : 0),
+            node_y + (i & 2 ? half_size : 0),
+            half_size
+        );
+    }
+
+    return error;
+}
+
+static Sint32 add_children(quadtree_t* quadtree) {
+    /* returns index of four empty leaves, -1 on error */
+    list_t* free_children = &quadtree->free_children;
+    if (free_children->size) {
+        free_children->size -= sizeof(Sint32);
+        return *(Sint32*)list_get(free_children, free_children->size);
+    }
+
+    Sint32 children = quadtree->nodes.size / sizeof(quadtree_node_t);
+    for (int i = 0; i < 4; i++) {
+        quadtree_node_t child = { .children = -1 };
+        list_init(&child.items, ITEMS_LIST_ALLOCATION_PORTION);
+        if (list_add(&quadtree->nodes, &child, sizeof(quadtree_node_t))) {
+            quadtree->nodes.size = children * sizeof(quadtree_node_t);
+            return -1;
+        }
+    }
+    return children;
+}
+
+static int merge_children(quadtree_t* quadtree, Sint32 index) {
+    /* returns non-0 value if the children are kept */
+    Sint32 children = get_node(quadtree, index)->children;
+    size_t size = 0;
+    for (int i = 0; i < 4; i++) {
+        quadtree_node_t* child = get_node(quadtree, children + i);
+        if (child->children >= 0)
+            return 1;
+        size += child->items.size;
+    }
+    if (size > QUADTREE_MERGE_SIZE * sizeof(quadtree_item_t))
+        return 1;
+
+    /* the free list grows first, so a failure leaves the tree as it was */
+    if (list_add(&quadtree->free_children, &children, sizeof(Sint32)))
+        return 1;
+    list_t items;
+    list_init(&items, ITEMS_LIST_ALLOCATION_PORTION);
+    for (int i = 0; i < 4; i++) {
+        quadtree_node_t* child = get_node(quadtree, children + i);
+        if (child->items.size &&
+                list_add(&items, child->items.begin, child->items.size)) {
+            list_free(&items);
+            quadtree->free_children.size -= sizeof(Sint32);
+            return 1;
+        }
+    }
+    for (int i = 0; i < 4; i++)
+        list_free(&get_node(quadtree, children + i)->items);
+
+    quadtree_node_t* node = get_node(quadtree, index);
+    list_free(&node->items);
+    node->items = items;
+    node->children = -1;
+    return 0;
+}
+
+static int query_node(const quadtree_t* quadtree,
+                      Sint32 index,
+                      Uint32 node_x,
+                      Uint32 node_y,
+                      Uint32 node_size,
+                      const SDL_Rect* area,
+                      list_t* result) {
+    if (is_node_outside(node_x, node_y, node_size, area))
+        return 0;
+    Sint64 area_x_end = (Sint64)area->x + area->w;
+    Sint64 area_y_end = (Sint64)area->y + area->h;
+
+    const quadtree_node_t* node = get_node(quadtree, index);
+    if (node->children < 0) {
+        for (int i = 0; i < node->items.size; i += sizeof(quadtree_item_t)) {
+            const quadtree_item_t* item = list_get(&node->items, i);
+            if ((Sint64)item->x < area->x || item->x >= area_x_end)
+                continue;
+            if ((Sint64)item->y < area->y || item->y >= area_y_end)
+                continue;
+            if (list_add(result, &item->index, sizeof(Uint32)))
+                return 1;
+        }
+        return 0;
+    }
+
+    Uint32 half_size = node_size / 2;
+    for (int i = 0; i < 4; i++) {
+        int error = query_node(
+            quadtree,
+            node->children + i,
+            node_x + (i & 1 ? half_size : 0),
+            node_y + (i & 2 ? half_size : 0),
+            half_size,
+            area,
+            result
+        );
+        if (error)
+            return 1;
+    }
+    return 0;
+}
+
+static int is_node_outside(Uint32 node_x,
+                           Uint32 node_y,
+                           Uint32 node_size,
+                           const SDL_Rect* area) {
+    Sint64 area_x_end = (Sint64)area->x + area->w;
+    Sint64 area_y_end = (Sint64)area->y + area->h;
+    if (node_x >= area_x_end || (Sint64)node_x + node_size <= area->x)
+        return 1;
+    if (node_y >= area_y_end || (Sint64)node_y + node_size <= area->y)
+        return 1;
+    return 0;
+}
+
+static int contains_node(const quadtree_t* quadtree,
+                         Sint32 index,
+                         Uint32 node_x,
+                         Uint32 node_y,
+                         Uint32 node_size,
+                         const SDL_Rect* area) {
+    if (is_node_outside(node_x, node_y, node_size, area))
+        return 0;
+
+    const quadtree_node_t* node = get_node(quadtree, index);
+    if (node->children < 0) {
+        for (int i = 0; i < node->items.size; i += sizeof(quadtree_item_t)) {
+            const quadtree_item_t* item = list_get(&node->items, i);
+            if (!is_node_outside(item->x, item->y, 1, area))
+                return 1;
+        }
+        return 0;
+    }
+
+    Uint32 half_size = node_size / 2;
+    for (int i = 0; i < 4; i++) {
+        int is_found = contains_node(
+            quadtree,
+            node->children + i,
+            node_x + (i & 1 ? half_size : 0),
+            node_y + (i & 2 ? half_size : 0),
+            half_size,
+            area
+        );
+        if (is_found)
+            return 1;
+    }
+    return 0;
+}
+
+static int push_heap_entry(list_t* heap, const heap_entry_t* entry) {
+    /* binary min-heap by distance, the entry goes up from the end */
+    if (list_add(heap, entry, sizeof(heap_entry_t)))
+        return 1;
+    heap_entry_t* entries = (heap_entry_t*)heap->begin;
+    size_t i = heap->size / sizeof(heap_entry_t) - 1;
+    while (i > 0 && entries[(i-1) / 2].distance > entry->distance) {
+        entries[i] = entries[(i-1) / 2];
+        i = (i-1) / 2;
+    }
+    entries[i] = *entry;
+    return 0;
+}
+
+static heap_entry_t pop_heap_entry(list_t* heap) {
+    /* the last entry goes down from the top */
+    heap_entry_t* entries = (heap_entry_t*)heap->begin;
+    heap_entry_t top = entries[0];
+    heap->size -= sizeof(heap_entry_t);
+    size_t count = heap->size / sizeof(heap_entry_t);
+    if (!count)
+        return top;
+    heap_entry_t last = entries[count];
+    size_t i = 0;
+    while (2*i + 1 < count) {
+        size_t child = 2*i + 1;
+        if (child + 1 < count &&
+                entries[child + 1].distance < entries[child].distance)
+            child++;
+        if (entries[child].distance >= last.distance)
+            break;
+        entries[i] = entries[child];
+        i = child;
+    }
+    entries[i] = last;
+    return top;
+}
@@ -0,0 +1,405 @@
+#include "../../headers/map/searchindex.h"
+
+#define POSTINGS_INITIAL_CAPACITY 4
+#define TEXT_MAX CONFIG_MARKER_DESCRIPTION_MAX
+#define SCORE_NONE ((Uint32)-1)
+
+typedef struct {
+    Uint32 index;
+    Uint32 score;
+} candidate_t;
+
+static size_t fold(const char* text, size_t length, Uint8* folded);
+static int is_word_byte(Uint8 byte);
+static int is_word_start(const Uint8* text, size_t i);
+static Uint32 get_trigram(Uint8 a, Uint8 b, Uint8 c);
+static int add_text(searchindex_t* searchindex,
+                    Uint32 index,
+                    const Uint8* text,
+                    size_t length);
+static int add_posting(searchindex_t* searchindex,
+                       Uint32 trigram,
+                       Uint32 index);
+static searchindex_entry_t* find_entry(const searchindex_t* searchindex,
+                                       Uint32 trigram);
+static int grow_table(searchindex_t* searchindex);
+static const searchindex_entry_t* get_candidates(
+    const searchindex_t* searchindex,
+    const Uint8* query,
+    size_t query_length);
+static int get_score(const marker_t* marker,
+                     const textarena_t* texts,
+                     textblob_t* descriptions,
+                     const Uint8* query,
+                     size_t query_length,
+                     Uint32* score);
+static int get_match(const Uint8* text,
+                     size_t length,
+                     const Uint8* query,
+                     size_t query_length);
+static void add_candidate(candidate_t* best,
+                          Uint32* best_count,
+                          Uint32 max_count,
+                          candidate_t candidate);
+
+/* ---------------------- header functions definition ---------------------- */
+
+void searchindex_init(searchindex_t* searchindex) {
+    searchindex->table = NULL;
+    searchindex->table_size = 0;
+    searchindex->count = 0;
+    searchindex->marker_count = 0;
+    searchindex->removed_count = 0;
+}
+
+void searchindex_free(searchindex_t* searchindex) {
+    for (Uint32 i = 0; i < searchindex->table_size; i++)
+        free(searchindex->table[i].postings);
+    free(searchindex->table);
+    searchindex_init(searchindex);
+}
+
+int searchindex_add(searchindex_t* searchindex,
+                    Uint32 index,
+                    const char* name,
+                    size_t name_length,
+                    const char* description,
+                    size_t description_length) {
+    Uint8 folded[TEXT_MAX];
+    if (name_length > TEXT_MAX || description_length > TEXT_MAX) {
+        SDL_SetError("marker text is too long\n%s()", __func__);
+        return 1;
+    }
+    size_t length = fold(name, name_length, folded);
+    if (add_text(searchindex, index, folded, length))
+        return 1;
+    length = fold(description, description_length, folded);
+    if (add_text(searchindex, index, folded, length))
+        return 1;
+    searchindex->marker_count++;
+    return 0;
+}
+
+void searchindex_remove(searchindex_t* searchindex) {
+    searchindex->removed_count++;
+}
+
+int searchindex_build(searchindex_t* searchindex,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      textblob_t* descriptions) {
+    searchindex_free(searchindex);
+    for (Uint32 i = 0; i < markers->slot_count; i++) {
+        const marker_t* marker = markerpool_at(markers, i);
+        if (marker == NULL)
+            continue;
+        const char* description =
+            textblob_get(descriptions, marker->description);
+        if (description == NULL)
+            return 1;
+        int error = searchindex_add(
+            searchindex,
+            i,
+            textarena_get(texts, marker->name),
+            marker->name_length,
+            description,
+            marker->description_length
+        );
+        if (error)
+            return 1;
+    }
+    return 0;
+}
+
+int searchindex_search(const searchindex_t* searchindex,
+                       const markerpool_t* markers,
+                       const textarena_t* texts,
+                       textblob_t* descriptions,
+                       const char* query,
+                       Uint32 max_count,
+                       list_t* result) {
+    size_t query_length = strlen(query);
+    if (!query_length || query_length > TEXT_MAX)
+        return 0;
+    Uint8 folded_query[TEXT_MAX];
+    query_length = fold(query, query_length, folded_query);
+    const searchindex_entry_t* entry =
+        get_candidates(searchindex, folded_query, query_length);
+    if (entry == NULL)
+        return 0;
+
+    if (max_count > SEARCHINDEX_RESULT_MAX)
+        max_count = SEARCHINDEX_RESULT_MAX;
+    candidate_t best[SEARCHINDEX_RESULT_MAX];
+    Uint32 best_count = 0;
+    for (Uint32 i = 0; i < entry->count; i++) {
+        Uint32 index = entry->postings[i];
+        const marker_t* marker = markerpool_at(markers, index);
+        if (marker == NULL)
+            continue;
+
+        /* texts are not folded for a marker which can not beat the last */
+        if (best_count == max_count) {
+            const candidate_t* last = &best[best_count - 1];
+            Uint32 score_min = marker->name_length == query_length
+                ? marker->name_length : 1 << 16 | marker->name_length;
+            if (score_min > last->score ||
+                    score_min == last->score && index > last->index)
+                continue;
+        }
+        Uint32 score;
+        int error = get_score(
+            marker, texts, descriptions, folded_query, query_length, &score);
+        if (error)
+            return 1;
+        if (score == SCORE_NONE)
+            continue;
+        candidate_t candidate = { .index = index, .score = score };
+        add_candidate(best, &best_count, max_count, candidate);
+    }
+
+    for (Uint32 i = 0; i < best_count; i++) {
+        if (list_add(result, &best[i].index, sizeof(Uint32)))
+            return 1;
+    }
+    return 0;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static size_t fold(const char* text, size_t length, Uint8* folded) {
+    /* ASCII and Cyrillic of two byte UTF-8, the length does not change */
+    const Uint8* bytes = (const Uint8*)text;
+    for (size_t i = 0; i < length; i++) {
+        Uint8 byte = bytes[i];
+        if (byte >= 'A' && byte <= 'Z') {
+            folded[i] = byte + ('a' - 'A');
+            continue;
+        }
+        folded[i] = byte;
+        if (byte != 0xD0 || i + 1 >= length)
+            continue;
+        Uint8 next = bytes[++i];
+        if (next >= 0x80 && next <= 0x8F) { /* U+0400..U+040F */
+            folded[i-1] = 0xD1;
+            folded[i] = next + 0x10;
+        } else if (next >= 0x90 && next <= 0x9F) { /* U+0410..U+041F */
+            folded[i] = next + 0x20;
+        } else if (next >= 0xA0 && next <= 0xAF) { /* U+0420..U+042F */
+            folded[i-1] = 0xD1;
+            folded[i] = next - 0x20;
+        } else {
+            folded[i] = next;
+        }
+    }
+    return length;
+}
+
+static int is_word_byte(Uint8 byte) {
+    /* bytes of UTF-8 sequences are letters */
+    return byte >= 0x80
+        || (byte >= 'a' && byte <= 'z')
+        || (byte >= 'A' && byte <= 'Z')
+        || (byte >= '0' && byte <= '9');
+}
+
+static int is_word_start(const Uint8* text, size_t i) {
+    return is_word_byte(text[i]) && (i == 0 || !is_word_byte(text[i-1]));
+}
+
+static Uint32 get_trigram(Uint8 a, Uint8 b, Uint8 c) {
+    return (Uint32)a << 16 | (Uint32)b << 8 | c;
+}
+
+static int add_text(searchindex_t* searchindex,
+                    Uint32 index,
+                    const Uint8* text,
+                    size_t length) {
+    const Uint8 mark = SEARCHINDEX_WORD_MARK;
+    int error = 0;
+    for (size_t i = 0; !error && i < length; i++) {
+        if (i + 2 < length) {
+            error = add_posting(
+                searchindex, get_trigram(text[i], text[i+1], text[i+2]), index);
+        }
+        if (error || !is_word_start(text, i))
+            continue;
+        error = add_posting(
+            searchindex, get_trigram(mark, mark, text[i]), index);
+        if (!error && i + 1 < length) {
+            error = add_posting(
+                searchindex, get_trigram(mark, text[i], text[i+1]), index);
+        }
+    }
+    return error;
+}
+
+static int add_posting(searchindex_t* searchindex,
+                       Uint32 trigram,
+                       Uint32 index) {
+    if (2*(searchindex->count + 1) > searchindex->table_size) {
+        if (grow_table(searchindex))
+            return 1;
+    }
+    searchindex_entry_t* entry = find_entry(searchindex, trigram);
+    if (!entry->trigram) {
+        entry->trigram = trigram;
+        searchindex->count++;
+    }
+
+    /* texts of one marker are added at once, so a repeat is the last one */
+    if (entry->count && entry->postings[entry->count - 1] == index)
+        return 0;
+    if (entry->count == entry->capacity) {
+        Uint32 capacity = entry->capacity
+            ? 2*entry->capacity : POSTINGS_INITIAL_CAPACITY;
+        Uint32* postings =
+            realloc(entry->postings, capacity * sizeof(Uint32));
+        if (postings == NULL) {
+            SDL_SetError("memory allocation failed\n%s()", __func__);
+            return 1;
+        }
+        entry->postings = postings;
+        entry->capacity = capacity;
+    }
+    entry->postings[entry->count++] = index;
+    return 0;
+}
+
+static searchindex_entry_t* find_entry(const searchindex_t* searchindex,
+                                       Uint32 trigram) {
+    Uint32 mask = searchindex->table_size - 1;
+    Uint32 slot = trigram * 2654435761u & mask;
+    while (searchindex->table[slot].trigram &&
+            searchindex->table[slot].trigram != trigram)
+        slot = slot + 1 & mask;
+    return &searchindex->table[slot];
+}
+
+static int grow_table(searchindex_t* searchindex) {
+    Uint32 table_size = searchindex->table_size
+        ? 2*searchindex->table_size : SEARCHINDEX_INITIAL_TABLE_SIZE;
+    searchindex_t grown = *searchindex;
+    grown.table = calloc(table_size, sizeof(searchindex_entry_t));
+    if (grown.table == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    grown.table_size = table_size;
+    for (Uint32 i = 0; i < searchindex->table_size; i++) {
+        const searchindex_entry_t* entry = &searchindex->table[i];
+        if (entry->trigram)
+            *find_entry(&grown, entry->trigram) = *entry;
+    }
+    free(searchindex->table);
+    *searchindex = grown;
+    return 0;
+}
+
+static const searchindex_entry_t* get_candidates(
+    const searchindex_t* searchindex,
+    const Uint8* query,
+    size_t query_length) {
+    if (!searchindex->count)
+        return NULL;
+
+    /* short queries are looked up by the beginnings of words */
+    const Uint8 mark = SEARCHINDEX_WORD_MARK;
+    if (query_length < 3) {
+        Uint32 trigram = query_length == 1
+            ? get_trigram(mark, mark, query[0])
+            : get_trigram(mark, query[0], query[1]);
+        const searchindex_entry_t* entry = find_entry(searchindex, trigram);
+        return entry->trigram ? entry : NULL;
+    }
+
+    /* every marker which has the query has all its trigrams */
+    const searchindex_entry_t* shortest = NULL;
+    for (size_t i = 0; i + 2 < query_length; i++) {
+        Uint32 trigram = get_trigram(query[i], query[i+1], query[i+2]);
+        const searchindex_entry_t* entry = find_entry(searchindex, trigram);
+        if (!entry->trigram)
+            return NULL;
+        if (shortest == NULL || entry->count < shortest->count)
+            shortest = entry;
+    }
+    return shortest;
+}
+
+static int get_score(const marker_t* marker,
+                     const textarena_t* texts,
+                     textblob_t* descriptions,
+                     const Uint8* query,
+                     size_t query_length,
+                     Uint32* score) {
+    /* rank of the match in the high bits, the name length in the low ones */
+    Uint8 folded[TEXT_MAX];
+    size_t length = fold(
+        textarena_get(texts, marker->name), marker->name_length, folded);
+    int match = get_match(folded, length, query, query_length);
+    if (match) {
+        *score = (Uint32)(4 - match) << 16 | marker->name_length;
+        return 0;
+    }
+
+    /* the description is read only for markers whose name does not match */
+    const char* description = textblob_get(descriptions, marker->description);
+    if (description == NULL)
+        return 1;
+    length = fold(description, marker->description_length, folded);
+    match = get_match(folded, length, query, query_length);
+    *score = match
+        ? (Uint32)(8 - match) << 16 | marker->name_length : SCORE_NONE;
+    return 0;
+}
+
+static int get_match(const Uint8* text,
+                     size_t length,
+                     const Uint8* query,
+                     size_t query_length) {
+    /*
+        4 - the text is the query, 3 - starts with it, 2 - has a word which
+        starts with it, 1 - has it (only queries of three or more bytes)
+    */
+    if (query_length > length)
+        return 0;
+    if (!memcmp(text, query, query_length))
+        return query_length == length ? 4 : 3;
+    int has_query = 0;
+    for (size_t i = 1; i + query_length <= length; i++) {
+        if (text[i] != query[0] || memcmp(text + i, query, query_length))
+            continue;
+        if (is_word_start(text, i))
+            return 2;
+        has_query = 1;
+    }
+    return has_query && query_length >= 3;
+}
+
+static void add_candidate(candidate_t* best,
+                          Uint32* best_count,
+                          Uint32 max_count,
+                          candidate_t candidate) {
+    /* best is sorted by score, then by slot index */
+    Uint32 count = *best_count;
+    for (Uint32 i = 0; i < count; i++) {
+        if (best[i].index == candidate.index)
+            return;
+    }
+    Uint32 position = count;
+    while (position > 0 && (best[position-1].score > candidate.score
+            || (best[position-1].score == candidate.score
+                && best[position-1].index > candidate.index)))
+        position--;
+    if (position >= max_count)
+        return;
+    if (count == max_count)
+        count--;
+    memmove(
+        best + position + 1,
+        best + position,
+        (count - position) * sizeof(candidate_t)
+    );
+    best[position] = candidate;
+    *best_count = count + 1;
+}
@@ -0,0 +1,834 @@
+#include "../../headers/map/snapshot.h"
+
+#define MAGIC "DSGISMRK"
+#define BYTE_ORDER_MARK 0x01020304
+#define ORDER_LIST_ALLOCATION_PORTION (1024*sizeof(Sint32))
+#define STACK_LIST_ALLOCATION_PORTION (256*sizeof(square_t))
+
+typedef struct {
+    Uint32 node;
+    Uint32 x, y;
+    Uint32 size;
+} square_t;
+
+static int map_file(const char* path, snapshot_t* snapshot, int* is_missing);
+static int map_replaced_file(const char* path,
+                             snapshot_t* snapshot,
+                             int* is_missing);
+static void unmap_file(snapshot_t* snapshot);
+static int is_valid(const snapshot_t* snapshot,
+                    const quadtree_t* index,
+                    const clusters_t* clusters);
+static int is_section_valid(const snapshot_t* snapshot,
+                            Uint64 offset,
+                            Uint64 size);
+static int is_pool_valid(const snapshot_t* snapshot);
+static int is_text_valid(Uint32 offset,
+                         Uint32 length,
+                         Uint32 size,
+                         Uint32 empty_offset);
+static int is_tree_valid(const snapshot_t* snapshot);
+static const markerpool_chunk_t* get_chunk(const snapshot_t* snapshot,
+                                           Uint32 index);
+static Uint64 get_aligned(Uint64 offset);
+static int get_node_order(const quadtree_t* index, list_t* order);
+static int write_section(SDL_RWops* file,
+                         const void* data,
+                         size_t size,
+                         Uint64* position);
+static int write_padding(SDL_RWops* file, Uint64* position);
+static int write_file(SDL_RWops* file,
+                      const snapshot_header_t* header,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      const textblob_t* descriptions,
+                      const quadtree_t* index,
+                      const list_t* order,
+                      const clusters_t* clusters);
+static int flush_file(const char* path);
+#ifndef _WIN32
+static int flush_directory(const char* path);
+#endif
+static int rename_file(const char* from, const char* to);
+static char* get_replaced_path(const char* path, int index);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int snapshot_save(const char* path,
+                  const markerpool_t* markers,
+                  const textarena_t* texts,
+                  const textblob_t* descriptions,
+                  const quadtree_t* index,
+                  const clusters_t* clusters,
+                  Uint64 journal_sequence) {
+    snapshot_header_t header = {
+        .version = SNAPSHOT_VERSION,
+        .byte_order = BYTE_ORDER_MARK,
+        .chunk_size = sizeof(markerpool_chunk_t),
+        .item_size = sizeof(quadtree_item_t),
+        .cluster_size = sizeof(cluster_t),
+        .level_count = CLUSTERS_LEVEL_COUNT,
+        .slot_count = markers->slot_count,
+        .marker_count = markers->count,
+        .free_slot = markers->free_slot,
+        .chunk_count = markers->chunks.size / sizeof(markerpool_chunk_t*),
+        .texts_size = texts->size,
+        .texts_released_size = texts->released_size,
+        .descriptions_size = descriptions->size,
+        .descriptions_released_size = descriptions->released_size,
+        .node_count = 0,
+        .item_count = 0,
+        .index_size = index->size,
+        .index_count = index->count,
+        .journal_sequence = journal_sequence
+    };
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+
+    /* nodes merged back are not in the tree, so they are not written */
+    list_t order;
+    list_init(&order, ORDER_LIST_ALLOCATION_PORTION);
+    if (get_node_order(index, &order)) {
+        list_free(&order);
+        return 1;
+    }
+    header.node_count = order.size / sizeof(Sint32);
+    for (Uint32 i = 0; i < header.node_count; i++) {
+        const quadtree_node_t* node = list_get(
+            &index->nodes,
+            *(Sint32*)list_get(&order, i * sizeof(Sint32))
+                * sizeof(quadtree_node_t)
+        );
+        header.item_count += node->items.size / sizeof(quadtree_item_t);
+    }
+
+    /* offsets of the sections in the order they are written */
+    Uint64 offset = get_aligned(sizeof(snapshot_header_t));
+    header.chunks_offset = offset;
+    offset += (Uint64)header.chunk_count * sizeof(markerpool_chunk_t);
+    header.texts_offset = offset = get_aligned(offset);
+    offset += header.texts_size;
+    header.descriptions_offset = offset = get_aligned(offset);
+    offset += header.descriptions_size;
+    header.nodes_offset = offset = get_aligned(offset);
+    offset += (Uint64)header.node_count * sizeof(snapshot_node_t);
+    header.items_offset = offset = get_aligned(offset);
+    offset += (Uint64)header.item_count * sizeof(quadtree_item_t);
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        const cluster_level_t* level = &clusters->levels[zoom];
+        snapshot_level_t* saved_level = &header.levels[zoom];
+        saved_level->offset = offset = get_aligned(offset);
+        saved_level->table_size = level->table_size;
+        saved_level->count = level->count;
+        saved_level->cell_size_log2 = level->cell_size_log2;
+        offset += (Uint64)level->table_size * sizeof(cluster_t);
+    }
+
+    size_t path_size = strlen(path) + sizeof(".tmp");
+    char* temporary_path = malloc(path_size);
+    if (temporary_path == NULL) {
+        list_free(&order);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    snprintf(temporary_path, path_size, "%s.tmp", path);
+    SDL_RWops* file = SDL_RWFromFile(temporary_path, "wb");
+    if (file == NULL) {
+        list_free(&order);
+        free(temporary_path);
+        return 1;
+    }
+
+    int error = write_file(
+        file, &header, markers, texts, descriptions, index, &order, clusters);
+    list_free(&order);
+    if (SDL_RWclose(file))
+        error = 1;
+
+    /* the data are on the disk before they replace the previous snapshot
+       and the new name is before the caller drops what it holds */
+    if (!error)
+        error = flush_file(temporary_path) || rename_file(temporary_path, path);
+    if (error)
+        remove(temporary_path);
+    free(temporary_path);
+    return error;
+}
+
+int snapshot_load(const char* path,
+                  snapshot_t** snapshot,
+                  markerpool_t* markers,
+                  textarena_t* texts,
+                  textblob_t* descriptions,
+                  quadtree_t* index,
+                  clusters_t* clusters) {
+    *snapshot = NULL;
+    snapshot_t* new_snapshot = malloc(sizeof(snapshot_t));
+    if (new_snapshot == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    int is_missing = 0;
+    int error = map_file(path, new_snapshot, &is_missing);
+    if (error && is_missing)
+        error = map_replaced_file(path, new_snapshot, &is_missing);
+    if (error) {
+        free(new_snapshot);
+        return !is_missing;
+    }
+    if (!is_valid(new_snapshot, index, clusters)) {
+        SDL_SetError("%s: snapshot is damaged or of another version\n%s()",
+                     path, __func__);
+        snapshot_close(new_snapshot);
+        return 1;
+    }
+    Uint8* data = new_snapshot->data;
+    const snapshot_header_t* header = new_snapshot->data;
+    new_snapshot->journal_sequence = header->journal_sequence;
+
+    /* the chunks and the nodes are the only things built on load */
+    list_t chunks;
+    list_init(&chunks, markers->chunks.allocation_portion);
+    for (Uint32 i = 0; !error && i < header->chunk_count; i++) {
+        markerpool_chunk_t* chunk = (markerpool_chunk_t*)(
+            data + header->chunks_offset + i * sizeof(markerpool_chunk_t));
+        error = list_add(&chunks, &chunk, sizeof(markerpool_chunk_t*));
+    }
+
+    /* the root of the just initialized index tells the portion of items */
+    const quadtree_node_t* root = list_get(&index->nodes, 0);
+    size_t items_portion = root->items.allocation_portion;
+    list_t nodes;
+    list_init(&nodes, index->nodes.allocation_portion);
+    const snapshot_node_t* saved_nodes =
+        (const snapshot_node_t*)(data + header->nodes_offset);
+    quadtree_item_t* items = (quadtree_item_t*)(data + header->items_offset);
+    for (Uint32 i = 0; !error && i < header->node_count; i++) {
+        quadtree_node_t node = { .children = saved_nodes[i].children };
+        Uint32 item_count = saved_nodes[i].item_count;
+        list_init_borrowed(
+            &node.items,
+            item_count ? items + saved_nodes[i].first_item : NULL,
+            item_count * sizeof(quadtree_item_t),
+            items_portion
+        );
+        error = list_add(&nodes, &node, sizeof(quadtree_node_t));
+    }
+    if (error) {
+        list_free(&chunks);
+        list_free(&nodes);
+        snapshot_close(new_snapshot);
+        return 1;
+    }
+
+    markerpool_free(markers);
+    markers->chunks = chunks;
+    markers->slot_count = header->slot_count;
+    markers->count = header->marker_count;
+    markers->free_slot = header->free_slot;
+    markers->borrowed_chunk_count = header->chunk_count;
+
+    textarena_free(texts);
+    textarena_init_borrowed(
+        texts,
+        (char*)data + header->texts_offset,
+        header->texts_size,
+        header->texts_released_size
+    );
+    textblob_borrow(
+        descriptions,
+        (char*)data + header->descriptions_offset,
+        header->descriptions_size,
+        header->descriptions_released_size
+    );
+
+    quadtree_free(index);
+    index->nodes = nodes;
+    index->count = header->index_count;
+
+    clusters_free(clusters);
+    for (int zoom = 0; zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        const snapshot_level_t* saved_level = &header->levels[zoom];
+        cluster_level_t* level = &clusters->levels[zoom];
+        level->table = saved_level->table_size
+            ? (cluster_t*)(data + saved_level->offset) : NULL;
+        level->table_size = saved_level->table_size;
+        level->count = saved_level->count;
+        level->is_borrowed = saved_level->table_size != 0;
+    }
+
+    *snapshot = new_snapshot;
+    return 0;
+}
+
+void snapshot_close(snapshot_t* snapshot) {
+    if (snapshot == NULL)
+        return;
+    unmap_file(snapshot);
+    free(snapshot);
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int map_file(const char* path, snapshot_t* snapshot, int* is_missing) {
+    /* private mapping, so structures may be changed in place */
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        DWORD error = GetLastError();
+        *is_missing =
+            error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND;
+        SDL_SetError("%s: file can not be opened\n%s()", path, __func__);
+        return 1;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart >= sizeof(Uint64))
+        mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        SDL_SetError("%s: file can not be mapped\n%s()", path, __func__);
+        return 1;
+    }
+    snapshot->data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    snapshot->size = size.QuadPart;
+    CloseHandle(mapping);
+    if (snapshot->data == NULL) {
+        SDL_SetError("%s: file can not be mapped\n%s()", path, __func__);
+        return 1;
+    }
+    return 0;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        *is_missing = errno == ENOENT;
+        SDL_SetError("%s: %s\n%s()", path, strerror(errno), __func__);
+        return 1;
+    }
+    struct stat status;
+    if (fstat(file, &status) || status.st_size < sizeof(Uint64)) {
+        close(file);
+        SDL_SetError("%s: file can not be mapped\n%s()", path, __func__);
+        return 1;
+    }
+    snapshot->size = status.st_size;
+    snapshot->data = mmap(
+        NULL,
+        snapshot->size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE,
+        file,
+        0
+    );
+    close(file);
+    if (snapshot->data == MAP_FAILED) {
+        SDL_SetError("%s: %s\n%s()", path, strerror(errno), __func__);
+        return 1;
+    }
+    return 0;
+#endif
+}
+
+static int map_replaced_file(const char* path,
+                             snapshot_t* snapshot,
+                             int* is_missing) {
+    /* a crash between the moves of rename_file() leaves only the previous
+       snapshot aside, the journal still has all records after it */
+    int is_found = 0;
+    for (int i = 0; i < SNAPSHOT_REPLACED_MAX; i++) {
+        char* replaced_path = get_replaced_path(path, i);
+        snapshot_t replaced;
+        int is_replaced_missing = 0;
+        int error = replaced_path == NULL
+            || map_file(replaced_path, &replaced, &is_replaced_missing);
+        free(replaced_path);
+        if (error && !is_replaced_missing) {
+            if (is_found)
+                unmap_file(snapshot);
+            *is_missing = 0;
+            return 1;
+        }
+        if (error)
+            continue;
+        const snapshot_header_t* header = replaced.data;
+        const snapshot_header_t* found_header = snapshot->data;
+        int is_newer = replaced.size >= sizeof(snapshot_header_t)
+            && (!is_found
+                || header->journal_sequence > found_header->journal_sequence);
+        if (!is_newer) {
+            unmap_file(&replaced);
+            continue;
+        }
+        if (is_found)
+            unmap_file(snapshot);
+        *snapshot = replaced;
+        is_found = 1;
+    }
+    *is_missing = !is_found;
+    return !is_found;
+}
+
+static void unmap_file(snapshot_t* snapshot) {
+#ifdef _WIN32
+    UnmapViewOfFile(snapshot->data);
+#else
+    munmap(snapshot->data, snapshot->size);
+#endif
+}
+
+static int is_valid(const snapshot_t* snapshot,
+                    const quadtree_t* index,
+                    const clusters_t* clusters) {
+    if (snapshot->size < sizeof(snapshot_header_t))
+        return 0;
+    const snapshot_header_t* header = snapshot->data;
+    int is_layout_valid = !memcmp(header->magic, MAGIC, sizeof(header->magic))
+        && header->version == SNAPSHOT_VERSION
+        && header->byte_order == BYTE_ORDER_MARK
+        && header->chunk_size == sizeof(markerpool_chunk_t)
+        && header->item_size == sizeof(quadtree_item_t)
+        && header->cluster_size == sizeof(cluster_t)
+        && header->level_count == CLUSTERS_LEVEL_COUNT
+        && header->index_size == index->size;
+    if (!is_layout_valid)
+        return 0;
+
+    Uint64 slot_capacity = (Uint64)header->chunk_count * MARKERPOOL_CHUNK_SIZE;
+    int is_header_valid = header->slot_count <= slot_capacity
+        && header->marker_count <= header->slot_count
+        && (header->free_slot < header->slot_count
+            || header->free_slot == MARKERPOOL_NONE)
+        && header->texts_released_size <= header->texts_size
+        && header->descriptions_released_size <= header->descriptions_size
+        && header->index_count <= header->item_count
+        && header->node_count > 0
+        && is_section_valid(
+            snapshot,
+            header->chunks_offset,
+            (Uint64)header->chunk_count * sizeof(markerpool_chunk_t))
+        && is_section_valid(
+            snapshot, header->texts_offset, header->texts_size)
+        && is_section_valid(
+            snapshot,
+            header->descriptions_offset,
+            header->descriptions_size)
+        && is_section_valid(
+            snapshot,
+            header->nodes_offset,
+            (Uint64)header->node_count * sizeof(snapshot_node_t))
+        && is_section_valid(
+            snapshot,
+            header->items_offset,
+            (Uint64)header->item_count * sizeof(quadtree_item_t));
+    for (int zoom = 0; is_header_valid && zoom < CLUSTERS_LEVEL_COUNT;
+            zoom++) {
+        const snapshot_level_t* level = &header->levels[zoom];
+        is_header_valid = (level->table_size & level->table_size-1) == 0
+            && 2*level->count <= level->table_size
+            && level->cell_size_log2 == clusters->levels[zoom].cell_size_log2
+            && is_section_valid(
+                snapshot,
+                level->offset,
+                (Uint64)level->table_size * sizeof(cluster_t));
+    }
+
+    /* a broken tree would be walked out of the file */
+    const snapshot_node_t* nodes =
+        (const snapshot_node_t*)((Uint8*)snapshot->data + header->nodes_offset);
+    for (Uint32 i = 0; is_header_valid && i < header->node_count; i++) {
+        const snapshot_node_t* node = &nodes[i];
+        is_header_valid = (node->children < 0
+                || (node->children > i
+                    && (Uint64)node->children + 4 <= header->node_count))
+            && (Uint64)node->first_item + node->item_count
+                <= header->item_count;
+    }
+    return is_header_valid
+        && is_pool_valid(snapshot)
+        && is_tree_valid(snapshot);
+}
+
+static int is_section_valid(const snapshot_t* snapshot,
+                            Uint64 offset,
+                            Uint64 size) {
+    return offset % SNAPSHOT_ALIGNMENT == 0
+        && offset <= snapshot->size
+        && size <= snapshot->size - offset;
+}
+
+static int is_pool_valid(const snapshot_t* snapshot) {
+    /* markers are used as they are, so every slot is checked once */
+    const snapshot_header_t* header = snapshot->data;
+    const char* texts = (const char*)snapshot->data + header->texts_offset;
+    const char* descriptions =
+        (const char*)snapshot->data + header->descriptions_offset;
+
+    /* the last strings end inside of the sections, so all of them do */
+    if (header->texts_size && texts[header->texts_size - 1] != '\0')
+        return 0;
+    Uint32 last_description = header->descriptions_size - 1;
+    if (header->descriptions_size && descriptions[last_description] != '\0')
+        return 0;
+
+    Uint32 marker_count = 0;
+    for (Uint32 i = 0; i < header->slot_count; i++) {
+        const markerpool_chunk_t* chunk = get_chunk(snapshot, i);
+        Uint32 k = i & (MARKERPOOL_CHUNK_SIZE - 1);
+        const markerpool_slot_t* slot = &chunk->slots[k];
+        if (!(slot->generation & 1)) {
+            int is_free_slot_valid = (slot->next_free < header->slot_count
+                    || slot->next_free == MARKERPOOL_NONE)
+                && chunk->x[k] == MARKERPOOL_NONE
+                && chunk->y[k] == MARKERPOOL_NONE;
+            if (!is_free_slot_valid)
+                return 0;
+            continue;
+        }
+
+        const marker_t* marker = &slot->marker;
+        int is_marker_valid = marker->x < header->index_size
+            && marker->y < header->index_size
+            && chunk->x[k] == marker->x
+            && chunk->y[k] == marker->y
+            && chunk->color[k] == marker->color
+            && is_text_valid(
+                marker->name,
+                marker->name_length,
+                header->texts_size,
+                TEXTARENA_EMPTY)
+            && is_text_valid(
+                marker->description,
+                marker->description_length,
+                header->descriptions_size,
+                TEXTBLOB_EMPTY);
+        if (!is_marker_valid)
+            return 0;
+        marker_count++;
+    }
+    if (marker_count != header->marker_count)
+        return 0;
+
+    /* the free list goes through all free slots once and ends */
+    Uint32 free_count = 0;
+    Uint32 index = header->free_slot;
+    while (index != MARKERPOOL_NONE) {
+        const markerpool_slot_t* slot = &get_chunk(snapshot, index)
+            ->slots[index & (MARKERPOOL_CHUNK_SIZE - 1)];
+        if (slot->generation & 1 || free_count == header->slot_count)
+            return 0;
+        free_count++;
+        index = slot->next_free;
+    }
+    return free_count == header->slot_count - header->marker_count;
+}
+
+static int is_text_valid(Uint32 offset,
+                         Uint32 length,
+                         Uint32 size,
+                         Uint32 empty_offset) {
+    /* the '\0' after the string is inside of the section too */
+    if (!length && offset == empty_offset)
+        return 1;
+    return (Uint64)offset + length < size;
+}
+
+static int is_tree_valid(const snapshot_t* snapshot) {
+    /*
+        nodes are walked from the root with their squares, so every item
+        is inside of its node and refers to a marker at its position; a
+        node reached twice would be walked over and over
+    */
+    const snapshot_header_t* header = snapshot->data;
+    const snapshot_node_t* nodes =
+        (const snapshot_node_t*)((Uint8*)snapshot->data + header->nodes_offset);
+    const quadtree_item_t* items =
+        (const quadtree_item_t*)((Uint8*)snapshot->data + header->items_offset);
+    list_t stack;
+    list_init(&stack, STACK_LIST_ALLOCATION_PORTION);
+    square_t root = { 0, 0, 0, header->index_size };
+    int error = list_add(&stack, &root, sizeof(square_t));
+    Uint32 node_count = 0;
+    Uint64 item_count = 0;
+    while (!error && stack.size) {
+        stack.size -= sizeof(square_t);
+        square_t square = *(square_t*)list_get(&stack, stack.size);
+        const snapshot_node_t* node = &nodes[square.node];
+        int is_inner = node->children >= 0;
+        error = ++node_count > header->node_count
+            || (is_inner && (node->item_count || square.size == 1));
+        item_count += node->item_count;
+
+        for (Uint32 i = 0; !error && i < node->item_count; i++) {
+            const quadtree_item_t* item = &items[node->first_item + i];
+            error = item->x < square.x || item->x - square.x >= square.size
+                || item->y < square.y || item->y - square.y >= square.size
+                || item->index >= header->slot_count;
+            if (error)
+                break;
+            const markerpool_chunk_t* chunk = get_chunk(snapshot, item->index);
+            Uint32 k = item->index & (MARKERPOOL_CHUNK_SIZE - 1);
+            error = !(chunk->slots[k].generation & 1)
+                || chunk->x[k] != item->x
+                || chunk->y[k] != item->y;
+        }
+
+        Uint32 half_size = square.size / 2;
+        for (int k = 0; !error && is_inner && k < 4; k++) {
+            square_t child = {
+                .node = node->children + k,
+                .x = square.x + (k & 1 ? half_size : 0),
+                .y = square.y + (k & 2 ? half_size : 0),
+                .size = half_size
+            };
+            error = list_add(&stack, &child, sizeof(square_t));
+        }
+    }
+    list_free(&stack);
+    return !error && item_count == header->index_count;
+}
+
+static const markerpool_chunk_t* get_chunk(const snapshot_t* snapshot,
+                                           Uint32 index) {
+    /* returns chunk of the slot index */
+    const snapshot_header_t* header = snapshot->data;
+    return (const markerpool_chunk_t*)(
+        (const Uint8*)snapshot->data + header->chunks_offset
+        + (index >> MARKERPOOL_CHUNK_SIZE_LOG2) * sizeof(markerpool_chunk_t));
+}
+
+static Uint64 get_aligned(Uint64 offset) {
+    return (offset + SNAPSHOT_ALIGNMENT-1) / SNAPSHOT_ALIGNMENT
+        * SNAPSHOT_ALIGNMENT;
+}
+
+static int get_node_order(const quadtree_t* index, list_t* order) {
+    /* breadth first, so children follow their parent as is_valid() wants */
+    Sint32 root = 0;
+    if (list_add(order, &root, sizeof(Sint32)))
+        return 1;
+    for (size_t i = 0; i < order->size; i += sizeof(Sint32)) {
+        Sint32 node_index = *(Sint32*)list_get(order, i);
+        const quadtree_node_t* node = list_get(
+            &index->nodes, node_index * sizeof(quadtree_node_t));
+        for (Sint32 k = 0; node->children >= 0 && k < 4; k++) {
+            Sint32 child = node->children + k;
+            if (list_add(order, &child, sizeof(Sint32)))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+static int write_section(SDL_RWops* file,
+                         const void* data,
+                         size_t size,
+                         Uint64* position) {
+    if (size && SDL_RWwrite(file, data, size, 1) != 1)
+        return 1;
+    *position += size;
+    return 0;
+}
+
+static int write_padding(SDL_RWops* file, Uint64* position) {
+    static const Uint8 zeros[SNAPSHOT_ALIGNMENT] = { 0 };
+    return write_section(
+        file, zeros, get_aligned(*position) - *position, position);
+}
+
+static int write_file(SDL_RWops* file,
+                      const snapshot_header_t* header,
+                      const markerpool_t* markers,
+                      const textarena_t* texts,
+                      const textblob_t* descriptions,
+                      const quadtree_t* index,
+                      const list_t* order,
+                      const clusters_t* clusters) {
+    Uint64 position = 0;
+    int error = write_section(
+        file, header, sizeof(snapshot_header_t), &position);
+
+    error |= write_padding(file, &position);
+    for (Uint32 i = 0; !error && i < header->chunk_count; i++) {
+        const markerpool_chunk_t* chunk = *(markerpool_chunk_t**)list_get(
+            &markers->chunks, i * sizeof(markerpool_chunk_t*));
+        error = write_section(
+            file, chunk, sizeof(markerpool_chunk_t), &position);
+    }
+
+    error |= write_padding(file, &position);
+    error |= write_section(file, texts->data, texts->size, &position);
+    error |= write_padding(file, &position);
+    if (!error && textblob_write(descriptions, file))
+        error = 1;
+    position += descriptions->size;
+
+    /*
+        nodes are renumbered in the order, where the children of every next
+        inner node are the next four; items of the nodes are written one
+        after another in the same order
+    */
+    error |= write_padding(file, &position);
+    Uint32 first_item = 0;
+    Sint32 children = 1;
+    for (Uint32 i = 0; !error && i < header->node_count; i++) {
+        const quadtree_node_t* node = list_get(
+            &index->nodes,
+            *(Sint32*)list_get(order, i * sizeof(Sint32))
+                * sizeof(quadtree_node_t)
+        );
+        snapshot_node_t saved_node = {
+            .children = node->children >= 0 ? children : -1,
+            .first_item = first_item,
+            .item_count = node->items.size / sizeof(quadtree_item_t)
+        };
+        if (node->children >= 0)
+            children += 4;
+        first_item += saved_node.item_count;
+        error = write_section(
+            file, &saved_node, sizeof(snapshot_node_t), &position);
+    }
+    error |= write_padding(file, &position);
+    for (Uint32 i = 0; !error && i < header->node_count; i++) {
+        const quadtree_node_t* node = list_get(
+            &index->nodes,
+            *(Sint32*)list_get(order, i * sizeof(Sint32))
+                * sizeof(quadtree_node_t)
+        );
+        error = write_section(
+            file, node->items.begin, node->items.size, &position);
+    }
+
+    for (int zoom = 0; !error && zoom < CLUSTERS_LEVEL_COUNT; zoom++) {
+        const cluster_level_t* level = &clusters->levels[zoom];
+        error = write_padding(file, &position) || write_section(
+            file,
+            level->table,
+            level->table_size * sizeof(cluster_t),
+            &position
+        );
+    }
+
+    if (error)
+        SDL_SetError("snapshot can not be written\n%s()", __func__);
+    return error;
+}
+
+static int flush_file(const char* path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path,
+        GENERIC_WRITE,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+    int error = file == INVALID_HANDLE_VALUE || !FlushFileBuffers(file);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    if (error)
+        SDL_SetError("%s: file can not be flushed\n%s()", path, __func__);
+    return error;
+#else
+    int file = open(path, O_RDONLY);
+    int error = file < 0 || fsync(file);
+    if (error)
+        SDL_SetError("%s: %s\n%s()", path, strerror(errno), __func__);
+    if (file >= 0)
+        close(file);
+    return error;
+#endif
+}
+
+#ifndef _WIN32
+static int flush_directory(const char* path) {
+    const char* slash = strrchr(path, '/');
+    size_t length = slash == NULL ? 0 : slash == path ? 1 : slash - path;
+    char* directory = malloc(length + sizeof("."));
+    if (directory == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    if (length) {
+        memcpy(directory, path, length);
+        directory[length] = '\0';
+    } else {
+        strcpy(directory, ".");
+    }
+
+    /* file systems which can not flush a directory tell it by EINVAL */
+    int file = open(directory, O_RDONLY);
+    int error = file < 0 || (fsync(file) && errno != EINVAL);
+    if (error)
+        SDL_SetError("%s: %s\n%s()", directory, strerror(errno), __func__);
+    if (file >= 0)
+        close(file);
+    free(directory);
+    return error;
+}
+#endif
+
+static int rename_file(const char* from, const char* to) {
+#ifdef _WIN32
+    /* a mapped snapshot can not be replaced but it can be renamed, so it
+       is moved aside, files moved aside before are removed once they are
+       not mapped anymore */
+    int free_index = -1;
+    for (int i = SNAPSHOT_REPLACED_MAX - 1; i >= 0; i--) {
+        char* replaced_path = get_replaced_path(to, i);
+        if (replaced_path == NULL)
+            return 1;
+        if (DeleteFileA(replaced_path)
+                || GetLastError() == ERROR_FILE_NOT_FOUND)
+            free_index = i;
+        free(replaced_path);
+    }
+
+    DWORD flags = MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH;
+    int is_replaced = MoveFileExA(from, to, flags);
+    if (!is_replaced && free_index >= 0) {
+        char* replaced_path = get_replaced_path(to, free_index);
+        if (replaced_path == NULL)
+            return 1;
+        if (MoveFileExA(to, replaced_path, MOVEFILE_WRITE_THROUGH)) {
+            is_replaced = MoveFileExA(from, to, flags);
+            if (!is_replaced)
+                MoveFileExA(replaced_path, to, MOVEFILE_WRITE_THROUGH);
+        }
+        free(replaced_path);
+    }
+    if (!is_replaced) {
+        SDL_SetError("%s: file can not be replaced\n%s()", to, __func__);
+        return 1;
+    }
+#else
+    if (rename(from, to)) {
+        SDL_SetError("%s: %s\n%s()", to, strerror(errno), __func__);
+        return 1;
+    }
+
+    /* the new name is flushed as well, Windows writes moves through */
+    if (flush_directory(to))
+        return 1;
+#endif
+    return 0;
+}
+
+static char* get_replaced_path(const char* path, int index) {
+    size_t path_size = strlen(path) + sizeof(".00.old");
+    char* replaced_path = malloc(path_size);
+    if (replaced_path == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+    snprintf(replaced_path, path_size, "%s.%d.old", path, index);
+    return replaced_path;
+}
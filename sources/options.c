@@ -0,0 +1,142 @@
+#include "../headers/options.h"
+
+static int parse_option(options_t* options,
+                        const char* option,
+                        const char* value);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int options_parse(options_t* options, int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--headless")) {
+            options->headless = 1;
+            continue;
+        }
+        if (!strcmp(argv[i], "--bench")) {
+            options->bench = 1;
+            continue;
+        }
+        if (!strcmp(argv[i], "--tile-files")) {
+            options->tilesource.hostname = NULL;
+            continue;
+        }
+
+        if (i+1 >= argc) {
+            SDL_SetError("%s: value expected\n%s()", argv[i], __func__);
+            return 1;
+        }
+        if (parse_option(options, argv[i], argv[i+1]))
+            return 1;
+        i++;
+    }
+
+    return 0;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int parse_option(options_t* options,
+                        const char* option,
+                        const char* value) {
+    int is_valid = 1;
+
+    if (!strcmp(option, "--center")) {
+        geo_pos_t center;
+        is_valid = sscanf(value, "%lf,%lf", &center.lat, &center.lon) == 2
+            && fabs(center.lat) <= 85 && fabs(center.lon) <= 180;
+        if (is_valid)
+            options->center = center;
+    }
+
+    else if (!strcmp(option, "--export")) {
+        geo_pos_t begin, end;
+        is_valid = sscanf(
+            value,
+            "%lf,%lf,%lf,%lf",
+            &begin.lat, &begin.lon, &end.lat, &end.lon
+        ) == 4;
+        is_valid = is_valid
+            && fabs(begin.lat) <= 85 && fabs(begin.lon) <= 180
+            && fabs(end.lat) <= 85 && fabs(end.lon) <= 180;
+        if (is_valid) {
+            options->export = 1;
+            options->export_begin = begin;
+            options->export_end = end;
+        }
+    }
+
+    else if (!strcmp(option, "--export-markers-area")) {
+        geo_pos_t begin, end;
+        is_valid = sscanf(
+            value,
+            "%lf,%lf,%lf,%lf",
+            &begin.lat, &begin.lon, &end.lat, &end.lon
+        ) == 4;
+        is_valid = is_valid
+            && fabs(begin.lat) <= 85 && fabs(begin.lon) <= 180
+            && fabs(end.lat) <= 85 && fabs(end.lon) <= 180;
+        if (is_valid) {
+            options->has_export_markers_area = 1;
+            options->export_markers_begin = begin;
+            options->export_markers_end = end;
+        }
+    }
+
+    else if (!strcmp(option, "--zoom")) {
+        int zoom;
+        is_valid = sscanf(value, "%d", &zoom) == 1
+            && zoom >= MAP_MIN_ZOOM && zoom <= MAP_MAX_ZOOM;
+        if (is_valid)
+            options->zoom = zoom;
+    }
+
+    else if (!strcmp(option, "--size")) {
+        int width, height;
+        is_valid = sscanf(value, "%dx%d", &width, &height) == 2
+            && width > 0 && height > 0;
+        if (is_valid) {
+            options->width = width;
+            options->height = height;
+        }
+    }
+
+    else if (!strcmp(option, "--tile-size")) {
+        tilesource_t tilesource = options->tilesource;
+        is_valid = sscanf(value, "%d", &tilesource.tile_size) == 1
+            && tilesource_get_zoom_shift(&tilesource) >= 0;
+        if (is_valid)
+            options->tilesource.tile_size = tilesource.tile_size;
+    }
+
+    else if (!strcmp(option, "--output"))
+        options->output_path = value;
+    else if (!strcmp(option, "--import"))
+        options->import_path = value;
+    else if (!strcmp(option, "--snapshot"))
+        options->snapshot_path = value;
+    else if (!strcmp(option, "--store"))
+        options->store_path = value;
+    else if (!strcmp(option, "--write-store"))
+        options->write_store_path = value;
+    else if (!strcmp(option, "--export-markers"))
+        options->export_markers_path = value;
+    else if (!strcmp(option, "--tile-host"))
+        options->tilesource.hostname = value;
+    else if (!strcmp(option, "--tile-path"))
+        options->tilesource.path = value;
+    else if (!strcmp(option, "--tile-token"))
+        options->tilesource.token = value;
+    else if (!strcmp(option, "--tile-type"))
+        options->tilesource.image_type = value;
+
+    else {
+        SDL_SetError("%s: unknown option\n%s()", option, __func__);
+        return 1;
+    }
+
+    if (!is_valid) {
+        SDL_SetError("%s: invalid value %s\n%s()", option, value, __func__);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "../headers/perf.h"
+
+static const char* COUNTER_NAMES[PERF_COUNTER_COUNT] = {
+    "frames",
+    "dropped frames",
+    "events",
+    "coalesced events",
+    "label rasterizations",
+    "tile requests",
+    "tile bytes"
+};
+
+static SDL_atomic_t counters[PERF_COUNTER_COUNT];
+static Uint64 totals[PERF_COUNTER_COUNT];
+static Uint32 last_report_time = 0;
+
+/* ---------------------- header functions definition ---------------------- */
+
+void perf_count(int counter, int value) {
+    SDL_AtomicAdd(&counters[counter], value);
+}
+
+Uint64 perf_get_total(int counter) {
+    return totals[counter];
+}
+
+Uint64 perf_read(int counter) {
+    return totals[counter] + SDL_AtomicGet(&counters[counter]);
+}
+
+Uint64 perf_now(void) {
+    return SDL_GetPerformanceCounter();
+}
+
+double perf_elapsed_ms(Uint64 start) {
+    Uint64 delta = SDL_GetPerformanceCounter() - start;
+    return delta * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+void perf_log_time(const char* name, Uint64 start) {
+#if CONFIG_PERF_LOG
+    SDL_Log("%s took %.2f ms", name, perf_elapsed_ms(start));
+#endif
+}
+
+void perf_report(void) {
+    Uint32 now = SDL_GetTicks();
+    if (!last_report_time) {
+        last_report_time = now;
+        return;
+    }
+    Uint32 elapsed = now - last_report_time;
+    if (elapsed < PERF_REPORT_INTERVAL)
+        return;
+    last_report_time = now;
+
+    char report[512];
+    size_t length = 0;
+    report[0] = '\0';
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        int value = SDL_AtomicSet(&counters[i], 0);
+        totals[i] += value;
+        if (!value || length >= sizeof(report))
+            continue;
+        length += snprintf(
+            report + length,
+            sizeof(report) - length,
+            "%s%s %.1f/s",
+            length ? ", " : "",
+            COUNTER_NAMES[i],
+            value * 1000.0 / elapsed
+        );
+    }
+
+#if CONFIG_PERF_LOG
+    if (length)
+        SDL_Log("%s", report);
+#endif
+}
@@ -0,0 +1,171 @@
+#include "../headers/pngwriter.h"
+
+static int write_chunk(FILE* file,
+                       const char* type,
+                       const Uint8* data,
+                       Uint32 size);
+static int deflate_data(pngwriter_t* pngwriter,
+                        const Uint8* data,
+                        Uint32 size,
+                        int flush);
+static void put_uint32(Uint8* destination, Uint32 value);
+
+/* ---------------------- header functions definition ---------------------- */
+
+pngwriter_t* pngwriter_open(const char* path, Uint32 width, Uint32 height) {
+    static const Uint8 SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+    pngwriter_t* pngwriter = malloc(sizeof(pngwriter_t));
+    if (pngwriter == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+    pngwriter->buffer = malloc(PNGWRITER_BUFFER_SIZE);
+    if (pngwriter->buffer == NULL) {
+        free(pngwriter);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+
+    memset(&pngwriter->stream, 0, sizeof(z_stream));
+    if (deflateInit(&pngwriter->stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        free(pngwriter->buffer);
+        free(pngwriter);
+        SDL_SetError("deflate initialization failed\n%s()", __func__);
+        return NULL;
+    }
+    pngwriter->stream.next_out = pngwriter->buffer;
+    pngwriter->stream.avail_out = PNGWRITER_BUFFER_SIZE;
+
+    pngwriter->width = width;
+    pngwriter->height = height;
+    pngwriter->written_rows = 0;
+    pngwriter->file = fopen(path, "wb");
+    if (pngwriter->file == NULL) {
+        deflateEnd(&pngwriter->stream);
+        free(pngwriter->buffer);
+        free(pngwriter);
+        SDL_SetError("can not open %s\n%s()", path, __func__);
+        return NULL;
+    }
+
+    Uint8 header[13];
+    put_uint32(header, width);
+    put_uint32(header + 4, height);
+    header[8] = 8;  /* bit depth */
+    header[9] = 2;  /* color type RGB */
+    header[10] = 0; /* deflate */
+    header[11] = 0; /* adaptive filtering */
+    header[12] = 0; /* no interlace */
+
+    int is_written = fwrite(SIGNATURE, sizeof(SIGNATURE), 1, pngwriter->file)
+        && !write_chunk(pngwriter->file, "IHDR", header, sizeof(header));
+    if (!is_written) {
+        pngwriter_close(pngwriter);
+        SDL_SetError("can not write %s\n%s()", path, __func__);
+        return NULL;
+    }
+
+    return pngwriter;
+}
+
+int pngwriter_write_row(pngwriter_t* pngwriter, const Uint8* row) {
+    if (pngwriter->written_rows >= pngwriter->height) {
+        SDL_SetError("all rows are written\n%s()", __func__);
+        return 1;
+    }
+
+    const Uint8 FILTER_NONE = 0;
+    if (deflate_data(pngwriter, &FILTER_NONE, 1, Z_NO_FLUSH))
+        return 1;
+    if (deflate_data(pngwriter, row, pngwriter->width*3, Z_NO_FLUSH))
+        return 1;
+    pngwriter->written_rows++;
+    return 0;
+}
+
+int pngwriter_close(pngwriter_t* pngwriter) {
+    int error = pngwriter->written_rows != pngwriter->height;
+    if (error)
+        SDL_SetError("image is not complete\n%s()", __func__);
+    else
+        error = deflate_data(pngwriter, NULL, 0, Z_FINISH)
+            || write_chunk(pngwriter->file, "IEND", NULL, 0);
+
+    deflateEnd(&pngwriter->stream);
+    if (fclose(pngwriter->file) && !error) {
+        SDL_SetError("can not write file\n%s()", __func__);
+        error = 1;
+    }
+    free(pngwriter->buffer);
+    free(pngwriter);
+    return error;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static int write_chunk(FILE* file,
+                       const char* type,
+                       const Uint8* data,
+                       Uint32 size) {
+    Uint8 size_bytes[4], crc_bytes[4];
+    put_uint32(size_bytes, size);
+    uLong crc = crc32(0, (const Bytef*)type, 4);
+    if (size)
+        crc = crc32(crc, data, size);
+    put_uint32(crc_bytes, crc);
+
+    int is_written = fwrite(size_bytes, 4, 1, file)
+        && fwrite(type, 4, 1, file)
+        && (!size || fwrite(data, size, 1, file))
+        && fwrite(crc_bytes, 4, 1, file);
+    if (!is_written) {
+        SDL_SetError("can not write file\n%s()", __func__);
+        return 1;
+    }
+    return 0;
+}
+
+static int deflate_data(pngwriter_t* pngwriter,
+                        const Uint8* data,
+                        Uint32 size,
+                        int flush) {
+    z_stream* stream = &pngwriter->stream;
+    stream->next_in = (Bytef*)data;
+    stream->avail_in = size;
+
+    /* every full buffer becomes one IDAT chunk */
+    for (;;) {
+        int status = deflate(stream, flush);
+        if (status == Z_STREAM_ERROR) {
+            SDL_SetError("deflate failed\n%s()", __func__);
+            return 1;
+        }
+
+        int is_full = !stream->avail_out;
+        int is_finished = status == Z_STREAM_END;
+        if (is_full || is_finished) {
+            Uint32 chunk_size = PNGWRITER_BUFFER_SIZE - stream->avail_out;
+            if (chunk_size) {
+                int error = write_chunk(
+                    pngwriter->file, "IDAT", pngwriter->buffer, chunk_size);
+                if (error)
+                    return 1;
+            }
+            stream->next_out = pngwriter->buffer;
+            stream->avail_out = PNGWRITER_BUFFER_SIZE;
+        }
+
+        if (is_finished)
+            return 0;
+        if (flush != Z_FINISH && !stream->avail_in && !is_full)
+            return 0;
+    }
+}
+
+static void put_uint32(Uint8* destination, Uint32 value) {
+    destination[0] = value >> 24;
+    destination[1] = value >> 16;
+    destination[2] = value >> 8;
+    destination[3] = value;
+}
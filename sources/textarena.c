@@ -0,0 +1,116 @@
+#include "../headers/textarena.h"
+
+#define RETIRED_LIST_ALLOCATION_PORTION (16*sizeof(char*))
+
+/* ---------------------- header functions definition ---------------------- */
+
+void textarena_init(textarena_t* textarena) {
+    textarena->data = NULL;
+    textarena->size = 0;
+    textarena->allocated_size = 0;
+    textarena->released_size = 0;
+    textarena->is_shared = 0;
+    list_init(&textarena->retired_blocks, RETIRED_LIST_ALLOCATION_PORTION);
+}
+
+void textarena_init_borrowed(textarena_t* textarena,
+                             char* data,
+                             Uint32 size,
+                             Uint32 released_size) {
+    textarena->data = data;
+    textarena->size = size;
+    textarena->allocated_size = 0;
+    textarena->released_size = released_size;
+    textarena->is_shared = 0;
+    list_init(&textarena->retired_blocks, RETIRED_LIST_ALLOCATION_PORTION);
+}
+
+void textarena_free(textarena_t* textarena) {
+    if (textarena->allocated_size)
+        free(textarena->data);
+    list_t* retired = &textarena->retired_blocks;
+    for (size_t i = 0; i < retired->size; i += sizeof(char*))
+        free(*(char**)list_get(retired, i));
+    list_free(retired);
+    textarena_init(textarena);
+}
+
+void textarena_clear(textarena_t* textarena) {
+    textarena->size = 0;
+    textarena->released_size = 0;
+}
+
+int textarena_add(textarena_t* textarena,
+                  const char* text,
+                  size_t length,
+                  Uint32* offset) {
+    if (!length) {
+        *offset = TEXTARENA_EMPTY;
+        return 0;
+    }
+
+    /* offsets are 32-bit, TEXTARENA_EMPTY is never a real one */
+    Uint64 required_size = (Uint64)textarena->size + length + 1;
+    if (required_size >= TEXTARENA_EMPTY) {
+        SDL_SetError("text arena is full\n%s()", __func__);
+        return 1;
+    }
+    if (required_size > textarena->allocated_size) {
+        /*
+            borrowed strings are copied into the first allocated block,
+            a shared block is copied as well and kept for its readers
+        */
+        int is_borrowed = !textarena->allocated_size && textarena->data;
+        int is_copied = is_borrowed || textarena->is_shared;
+        Uint64 allocated_size = textarena->allocated_size
+            ? textarena->allocated_size : TEXTARENA_INITIAL_SIZE;
+        while (allocated_size < required_size)
+            allocated_size *= 2;
+        if (allocated_size > TEXTARENA_EMPTY)
+            allocated_size = TEXTARENA_EMPTY;
+        char* data =
+            realloc(is_copied ? NULL : textarena->data, allocated_size);
+        if (data == NULL) {
+            SDL_SetError("memory allocation failed\n%s()", __func__);
+            return 1;
+        }
+        if (is_copied && textarena->data != NULL)
+            memcpy(data, textarena->data, textarena->size);
+        int is_retired = textarena->is_shared && textarena->allocated_size;
+        if (is_retired && list_add(
+                &textarena->retired_blocks,
+                &textarena->data,
+                sizeof(char*))) {
+            free(data);
+            return 1;
+        }
+        textarena->data = data;
+        textarena->is_shared = 0;
+        textarena->allocated_size = allocated_size;
+    }
+
+    *offset = textarena->size;
+    memcpy(textarena->data + textarena->size, text, length);
+    textarena->data[textarena->size + length] = '\0';
+    textarena->size += length + 1;
+    return 0;
+}
+
+const char* textarena_get(const textarena_t* textarena, Uint32 offset) {
+    if (offset == TEXTARENA_EMPTY)
+        return "";
+    return textarena->data + offset;
+}
+
+void textarena_release(textarena_t* textarena, size_t length) {
+    if (length)
+        textarena->released_size += length + 1;
+}
+
+void textarena_share(textarena_t* textarena) {
+    textarena->is_shared = 1;
+}
+
+void textarena_unshare(textarena_t* textarena) {
+    textarena->is_shared = 0;
+}
@@ -0,0 +1,296 @@
+#include "../headers/textblob.h"
+
+static void drop_strings(textblob_t* textblob);
+static int flush(textblob_t* textblob);
+static int read_file(const textblob_t* textblob,
+                     Uint32 offset,
+                     size_t size,
+                     char* data);
+static int read_shared_window(textblob_t* textblob,
+                              Uint32 offset,
+                              size_t length,
+                              char* text);
+static const char* find_text(const textblob_window_t* window, Uint32 offset);
+
+/* ---------------------- header functions definition ---------------------- */
+
+int textblob_init(textblob_t* textblob) {
+    textblob->borrowed = NULL;
+    textblob->borrowed_size = 0;
+    textblob->file_size = 0;
+    textblob->size = 0;
+    textblob->released_size = 0;
+    textblob->file = NULL;
+    textblob->buffer = NULL;
+    for (int i = 0; i < TEXTBLOB_WINDOW_COUNT; i++)
+        textblob->windows[i] = (textblob_window_t){ 0, 0, 0, NULL };
+    textblob->time = 0;
+    textblob->shared_window = (textblob_window_t){ 0, 0, 0, NULL };
+    textblob->mutex = SDL_CreateMutex();
+    return textblob->mutex == NULL;
+}
+
+void textblob_free(textblob_t* textblob) {
+    drop_strings(textblob);
+    SDL_DestroyMutex(textblob->mutex);
+    textblob->mutex = NULL;
+}
+
+void textblob_borrow(textblob_t* textblob,
+                     const char* data,
+                     Uint32 size,
+                     Uint32 released_size) {
+    drop_strings(textblob);
+    textblob->borrowed = data;
+    textblob->borrowed_size = size;
+    textblob->size = size;
+    textblob->released_size = released_size;
+}
+
+int textblob_add(textblob_t* textblob,
+                 const char* text,
+                 size_t length,
+                 Uint32* offset) {
+    if (!length) {
+        *offset = TEXTBLOB_EMPTY;
+        return 0;
+    }
+    if (length > TEXTBLOB_TEXT_MAX) {
+        SDL_SetError("text is too long\n%s()", __func__);
+        return 1;
+    }
+    if ((Uint64)textblob->size + length + 1 >= TEXTBLOB_EMPTY) {
+        SDL_SetError("text blob is full\n%s()", __func__);
+        return 1;
+    }
+    if (textblob->buffer == NULL) {
+        textblob->buffer = malloc(TEXTBLOB_BUFFER_SIZE);
+        if (textblob->buffer == NULL) {
+            SDL_SetError("memory allocation failed\n%s()", __func__);
+            return 1;
+        }
+    }
+
+    /* a string is never split between the file and the buffer */
+    Uint32 buffered_size =
+        textblob->size - textblob->borrowed_size - textblob->file_size;
+    if (buffered_size + length + 1 > TEXTBLOB_BUFFER_SIZE) {
+        if (flush(textblob))
+            return 1;
+        buffered_size = 0;
+    }
+    *offset = textblob->size;
+    memcpy(textblob->buffer + buffered_size, text, length);
+    textblob->buffer[buffered_size + length] = '\0';
+    textblob->size += length + 1;
+    return 0;
+}
+
+const char* textblob_get(textblob_t* textblob, Uint32 offset) {
+    if (offset == TEXTBLOB_EMPTY)
+        return "";
+    if (offset < textblob->borrowed_size)
+        return textblob->borrowed + offset;
+    Uint32 file_end = textblob->borrowed_size + textblob->file_size;
+    if (offset >= file_end)
+        return textblob->buffer + (offset - file_end);
+
+    textblob_window_t* window = &textblob->windows[0];
+    for (int i = 0; i < TEXTBLOB_WINDOW_COUNT; i++) {
+        textblob_window_t* candidate = &textblob->windows[i];
+        const char* text = find_text(candidate, offset);
+        if (text != NULL) {
+            candidate->used_time = ++textblob->time;
+            return text;
+        }
+        if (candidate->used_time < window->used_time)
+            window = candidate;
+    }
+
+    /* the least recently used window is read from the string on */
+    if (window->data == NULL) {
+        window->data = malloc(TEXTBLOB_WINDOW_SIZE);
+        if (window->data == NULL) {
+            SDL_SetError("memory allocation failed\n%s()", __func__);
+            return NULL;
+        }
+    }
+    Uint32 size = file_end - offset;
+    if (size > TEXTBLOB_WINDOW_SIZE)
+        size = TEXTBLOB_WINDOW_SIZE;
+    SDL_LockMutex(textblob->mutex);
+    int error = read_file(textblob, offset, size, window->data);
+    SDL_UnlockMutex(textblob->mutex);
+    window->offset = offset;
+    window->size = error ? 0 : size;
+    window->used_time = ++textblob->time;
+    return error ? NULL : window->data;
+}
+
+int textblob_read(textblob_t* textblob,
+                  Uint32 offset,
+                  size_t length,
+                  char* text) {
+    text[length] = '\0';
+    if (!length)
+        return 0;
+    if (offset < textblob->borrowed_size) {
+        memcpy(text, textblob->borrowed + offset, length);
+        return 0;
+    }
+
+    /* the buffer is written into the file and reused under the mutex */
+    SDL_LockMutex(textblob->mutex);
+    Uint32 file_end = textblob->borrowed_size + textblob->file_size;
+    int error = 0;
+    if (offset < file_end)
+        error = read_shared_window(textblob, offset, length, text);
+    else
+        memcpy(text, textblob->buffer + (offset - file_end), length);
+    SDL_UnlockMutex(textblob->mutex);
+    return error;
+}
+
+void textblob_release(textblob_t* textblob, size_t length) {
+    if (length)
+        textblob->released_size += length + 1;
+}
+
+int textblob_write(const textblob_t* textblob, SDL_RWops* file) {
+    int error = textblob->borrowed_size && SDL_RWwrite(
+        file, textblob->borrowed, textblob->borrowed_size, 1) != 1;
+
+    /* the file is copied through one block */
+    char* block = NULL;
+    if (!error && textblob->file_size) {
+        block = malloc(TEXTBLOB_BUFFER_SIZE);
+        if (block == NULL) {
+            SDL_SetError("memory allocation failed\n%s()", __func__);
+            return 1;
+        }
+    }
+    Uint32 file_end = textblob->borrowed_size + textblob->file_size;
+    for (Uint32 offset = textblob->borrowed_size;
+            !error && offset < file_end;
+            offset += TEXTBLOB_BUFFER_SIZE) {
+        Uint32 size = file_end - offset;
+        if (size > TEXTBLOB_BUFFER_SIZE)
+            size = TEXTBLOB_BUFFER_SIZE;
+        SDL_LockMutex(textblob->mutex);
+        error = read_file(textblob, offset, size, block);
+        SDL_UnlockMutex(textblob->mutex);
+        error = error || SDL_RWwrite(file, block, size, 1) != 1;
+    }
+    free(block);
+
+    Uint32 buffered_size = textblob->size - file_end;
+    error = error || buffered_size && SDL_RWwrite(
+        file, textblob->buffer, buffered_size, 1) != 1;
+    if (error)
+        SDL_SetError("texts can not be written\n%s()", __func__);
+    return error;
+}
+
+size_t textblob_get_memory(const textblob_t* textblob) {
+    size_t memory = textblob->buffer != NULL ? TEXTBLOB_BUFFER_SIZE : 0;
+    for (int i = 0; i < TEXTBLOB_WINDOW_COUNT; i++)
+        memory += textblob->windows[i].data != NULL ? TEXTBLOB_WINDOW_SIZE : 0;
+    if (textblob->shared_window.data != NULL)
+        memory += TEXTBLOB_WINDOW_SIZE;
+    return memory;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static void drop_strings(textblob_t* textblob) {
+    /* the temporary file is removed when it is closed */
+    if (textblob->file != NULL)
+        SDL_RWclose(textblob->file);
+    textblob->file = NULL;
+    free(textblob->buffer);
+    textblob->buffer = NULL;
+    for (int i = 0; i < TEXTBLOB_WINDOW_COUNT; i++) {
+        free(textblob->windows[i].data);
+        textblob->windows[i] = (textblob_window_t){ 0, 0, 0, NULL };
+    }
+    free(textblob->shared_window.data);
+    textblob->shared_window = (textblob_window_t){ 0, 0, 0, NULL };
+    textblob->borrowed = NULL;
+    textblob->borrowed_size = 0;
+    textblob->file_size = 0;
+    textblob->size = 0;
+    textblob->released_size = 0;
+}
+
+static int flush(textblob_t* textblob) {
+    Uint32 buffered_size =
+        textblob->size - textblob->borrowed_size - textblob->file_size;
+    SDL_LockMutex(textblob->mutex);
+    if (textblob->file == NULL) {
+        FILE* file = tmpfile();
+        if (file != NULL)
+            textblob->file = SDL_RWFromFP(file, SDL_TRUE);
+        if (file != NULL && textblob->file == NULL)
+            fclose(file);
+    }
+    int error = textblob->file == NULL
+        || SDL_RWseek(textblob->file, textblob->file_size, RW_SEEK_SET) < 0
+        || SDL_RWwrite(textblob->file, textblob->buffer, buffered_size, 1)
+            != 1;
+    if (!error)
+        textblob->file_size += buffered_size;
+    SDL_UnlockMutex(textblob->mutex);
+    if (error)
+        SDL_SetError("temporary file can not be written\n%s()", __func__);
+    return error;
+}
+
+static int read_file(const textblob_t* textblob,
+                     Uint32 offset,
+                     size_t size,
+                     char* data) {
+    /* the caller holds the mutex, the position of the file is shared */
+    Sint64 position = offset - textblob->borrowed_size;
+    int error = SDL_RWseek(textblob->file, position, RW_SEEK_SET) < 0
+        || SDL_RWread(textblob->file, data, size, 1) != 1;
+    if (error)
+        SDL_SetError("temporary file can not be read\n%s()", __func__);
+    return error;
+}
+
+static int read_shared_window(textblob_t* textblob,
+                              Uint32 offset,
+                              size_t length,
+                              char* text) {
+    /* the caller holds the mutex, so strings read in order cost one read */
+    textblob_window_t* window = &textblob->shared_window;
+    int is_inside = offset >= window->offset
+        && (Uint64)offset - window->offset + length <= window->size;
+    if (!is_inside) {
+        if (window->data == NULL) {
+            window->data = malloc(TEXTBLOB_WINDOW_SIZE);
+            if (window->data == NULL) {
+                SDL_SetError("memory allocation failed\n%s()", __func__);
+                return 1;
+            }
+        }
+        Uint32 size = textblob->borrowed_size + textblob->file_size - offset;
+        if (size > TEXTBLOB_WINDOW_SIZE)
+            size = TEXTBLOB_WINDOW_SIZE;
+        window->offset = offset;
+        window->size = 0;
+        if (read_file(textblob, offset, size, window->data))
+            return 1;
+        window->size = size;
+    }
+    memcpy(text, window->data + (offset - window->offset), length);
+    return 0;
+}
+
+static const char* find_text(const textblob_window_t* window, Uint32 offset) {
+    if (offset < window->offset || offset - window->offset >= window->size)
+        return NULL;
+    const char* text = window->data + (offset - window->offset);
+    size_t size = window->offset + window->size - offset;
+    return memchr(text, '\0', size) != NULL ? text : NULL;
+}
@@ -0,0 +1,97 @@
+#include "../headers/tilesource.h"
+
+#define PATH_LIST_ALLOCATION_PORTION (128*sizeof(char))
+
+static const tilesource_t DEFAULT_TILESOURCE = {
+    .hostname   = CONFIG_TILE_HOSTNAME,
+    .path       = CONFIG_TILE_PATH,
+    .token      = CONFIG_MAPBOX_ACCESS_TOKEN,
+    .image_type = CONFIG_TILE_IMAGE_TYPE,
+    .tile_size  = CONFIG_TILE_SIZE
+};
+
+/* ---------------------- header functions definition ---------------------- */
+
+const tilesource_t* tilesource_get_default(void) {
+    return &DEFAULT_TILESOURCE;
+}
+
+int tilesource_get_zoom_shift(const tilesource_t* tilesource) {
+    if (tilesource->tile_size == 256)
+        return 0;
+    if (tilesource->tile_size == 512)
+        return 1;
+    return -1;
+}
+
+char* tilesource_make_path(const tilesource_t* tilesource,
+                           Uint8 zoom,
+                           Uint32 x,
+                           Uint32 y) {
+    char zoom_text[4], x_text[11], y_text[11];
+    snprintf(zoom_text, sizeof(zoom_text), "%u", zoom);
+    snprintf(x_text, sizeof(x_text), "%u", x);
+    snprintf(y_text, sizeof(y_text), "%u", y);
+
+    const char* token = tilesource->token != NULL ? tilesource->token : "";
+    const char* scale = tilesource->tile_size == 512 ? "@2x" : "";
+    const char* NAMES[] = { "{z}", "{x}", "{y}", "{token}", "{scale}" };
+    const char* VALUES[] = { zoom_text, x_text, y_text, token, scale };
+    const size_t PARAMETER_COUNT = 5;
+
+    list_t path;
+    list_init(&path, PATH_LIST_ALLOCATION_PORTION);
+    for (const char* c = tilesource->path; *c; c++) {
+        int is_parameter = 0;
+        for (size_t i = 0; !is_parameter && i < PARAMETER_COUNT; i++) {
+            if (strncmp(c, NAMES[i], strlen(NAMES[i])))
+                continue;
+            if (list_add(&path, VALUES[i], strlen(VALUES[i]))) {
+                list_free(&path);
+                return NULL;
+            }
+            c += strlen(NAMES[i]) - 1;
+            is_parameter = 1;
+        }
+        if (!is_parameter && list_add(&path, c, sizeof(char))) {
+            list_free(&path);
+            return NULL;
+        }
+    }
+    if (list_add(&path, "\0", sizeof(char))) {
+        list_free(&path);
+        return NULL;
+    }
+
+    return path.begin;
+}
+
+SDL_Surface* tilesource_load(const tilesource_t* tilesource,
+                             Uint8 zoom,
+                             Uint32 x,
+                             Uint32 y) {
+    char* path = tilesource_make_path(tilesource, zoom, x, y);
+    if (path == NULL)
+        return NULL;
+
+    SDL_Surface* surface = NULL;
+    perf_count(PERF_TILE_REQUESTS, 1);
+    if (tilesource->hostname == NULL) {
+        SDL_RWops* rw = SDL_RWFromFile(path, "rb");
+        if (rw != NULL) {
+            perf_count(PERF_TILE_BYTES, SDL_RWsize(rw));
+            surface = IMG_LoadTyped_RW(rw, 1, tilesource->image_type);
+        }
+    } else {
+        response_t response = http_get(tilesource->hostname, path);
+        perf_count(PERF_TILE_BYTES, response.size);
+        if (response.size) {
+            SDL_RWops* rw = SDL_RWFromMem(response.data, response.size);
+            surface = IMG_LoadTyped_RW(rw, 1, tilesource->image_type);
+        }
+        free(response.data);
+    }
+
+    free(path);
+    return surface;
+}
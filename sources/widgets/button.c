@@ -59,11 +59,12 @@ void button_draw(const button_t* button, SDL_Renderer* renderer, int x, int y) {
     SDL_RenderCopy(renderer, button->text_texture, NULL, &button_area);
 }
 
-void button_handle_event(button_t* button,
-                         const SDL_Event* event,
-                         int x,
-                         int y) {
+int button_handle_event(button_t* button,
+                        const SDL_Event* event,
+                        int x,
+                        int y) {
     SDL_Rect button_area = { x, y, CONFIG_BUTTON_WIDTH, CONFIG_BUTTON_HEIGHT };
+    Uint8 status = button->status;
 
     if (event->type == SDL_MOUSEMOTION) {
         if (!is_belong(event->motion.x, event->motion.y, &button_area))
@@ -79,13 +80,17 @@ void button_handle_event(button_t* button,
 
     else if (event->type == SDL_MOUSEBUTTONUP) {
         _Bool has_on_clicked_function = button->on_clicked != NULL;
-        if (button->status == BUTTON_STATUS_DOWN && has_on_clicked_function)
+        if (button->status == BUTTON_STATUS_DOWN && has_on_clicked_function) {
             button->on_clicked(button->data);
+            return 1; /* on_clicked() may free the button */
+        }
         else if (is_belong(event->button.x, event->button.y, &button_area))
             button->status = BUTTON_STATUS_CONTAINS_NOUSE;
         else
             button->status = BUTTON_STATUS_NORMAL;
     }
+
+    return button->status != status;
 }
 
 /* ---------------------- static functions definition ---------------------- */
@@ -122,23 +127,20 @@ static SDL_Texture* render_text_texture(SDL_Renderer* renderer,
     if (texture == NULL)
         return NULL;
 
-    TTF_Font* font = TTF_OpenFont(CONFIG_FONT_PATH, height - 8);
+    TTF_Font* font = fonts_get(CONFIG_FONT_PATH, height - 8);
     if (font == NULL) {
         SDL_DestroyTexture(texture);
-        SDL_SetError("can not open %s\n%s()", CONFIG_FONT_PATH, __func__);
         return NULL;
     }
     SDL_Surface* surface =
         TTF_RenderUTF8_Blended(font, text, (SDL_Color){ CONFIG_COLOR_TEXT });
     if (surface == NULL) {
-        TTF_CloseFont(font);
         SDL_DestroyTexture(texture);
         SDL_SetError("text rendering failed\n%s()", __func__);
         return NULL;
     }
     SDL_Texture* text_texture = SDL_CreateTextureFromSurface(renderer, surface);
     if (text_texture == NULL) {
-        TTF_CloseFont(font);
         SDL_FreeSurface(surface);
         SDL_DestroyTexture(texture);
         return NULL;
@@ -154,7 +156,6 @@ static SDL_Texture* render_text_texture(SDL_Renderer* renderer,
     SDL_RenderCopy(renderer, text_texture, NULL, &dstrect);
     SDL_SetRenderTarget(renderer, NULL);
 
-    TTF_CloseFont(font);
     SDL_DestroyTexture(text_texture);
     SDL_FreeSurface(surface);
 
@@ -50,11 +50,11 @@ void colorpicker_draw(const colorpicker_t* colorpicker,
     }
 }
 
-void colorpicker_handle_event(colorpicker_t* colorpicker,
-                              const SDL_Event* event,
-                              int x,
-                              int y,
-                              int w) {
+int colorpicker_handle_event(colorpicker_t* colorpicker,
+                             const SDL_Event* event,
+                             int x,
+                             int y,
+                             int w) {
     int colorpicker_width =
         (2*COLORPICKER_COLOR_COUNT - 1) * CONFIG_COLORPICKER_HEIGHT;
     int colorpicker_height = CONFIG_COLORPICKER_HEIGHT;
@@ -69,12 +69,15 @@ void colorpicker_handle_event(colorpicker_t* colorpicker,
 
     if (event->type == SDL_MOUSEBUTTONDOWN) {
         if (!is_belong(event->button.x, event->button.y, &area))
-            return;
+            return 0;
         int item = (event->button.x - x) / colorpicker_height;
-        if (item % 2)
-            return;
+        if (item % 2 || colorpicker->color == item/2)
+            return 0;
         colorpicker->color = item/2;
+        return 1;
     }
+
+    return 0;
 }
 
 SDL_Color colorpicker_get_color(const colorpicker_t* colorpicker) {
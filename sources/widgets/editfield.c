@@ -3,13 +3,7 @@
 #define TEXT_LIST_ALLOCATION_PORTION (128*sizeof(char))
 #define TEXT_CHARACTERS_SIZES_LIST_ALLOCATION_PORTION (128*sizeof(Uint32))
 
-static SDL_Texture* render_text(SDL_Renderer* renderer,
-                                TTF_Font* font,
-                                const char* text,
-                                const SDL_Color* color,
-                                int max_width,
-                                int* width,
-                                int* height);
+static void measure_text(editfield_t* editfield);
 
 /* ---------------------- header functions definition ---------------------- */
 
@@ -24,24 +18,20 @@ editfield_t* editfield_init(const char* hint_text,
     }
 
     int font_size = CONFIG_EDITLINE_HEIGHT - 2*EDITFIELD_VERTICAL_INDENT;
-    editfield->font =
-        TTF_OpenFont(CONFIG_FONT_PATH, font_size);
-    if (editfield->font == NULL) {
+    editfield->glyphcache =
+        glyphcache_get(renderer, CONFIG_FONT_PATH, font_size);
+    if (editfield->glyphcache == NULL) {
         free(editfield);
-        SDL_SetError("can not open %s\n%s()", CONFIG_FONT_PATH, __func__);
         return NULL;
     }
 
-    editfield->hint_texture = render_text(
-        renderer,
-        editfield->font,
-        hint_text,
-        &(SDL_Color){ CONFIG_COLOR_BORDER },
-        width - 2*EDITFIELD_HORIZONTAL_INDENT,
-        &editfield->hint_texture_width,
-        &editfield->hint_texture_height
-    );
-    editfield->text_texture = NULL;
+    editfield->hint_text = malloc(strlen(hint_text) + 1);
+    if (editfield->hint_text == NULL) {
+        free(editfield);
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+    strcpy(editfield->hint_text, hint_text);
 
     list_init(&editfield->text, TEXT_LIST_ALLOCATION_PORTION);
     list_add(&editfield->text, "\0", sizeof(char));
@@ -50,8 +40,8 @@ editfield_t* editfield_init(const char* hint_text,
         TEXT_CHARACTERS_SIZES_LIST_ALLOCATION_PORTION
     );
 
-    editfield->text_texture_width = 0;
-    editfield->text_texture_height = 0;
+    editfield->wrap_width = width - 2*EDITFIELD_HORIZONTAL_INDENT;
+    editfield->text_height = 0;
     editfield->max_text_char_size = max_text_char_size;
     editfield->active = 0;
 
@@ -59,9 +49,7 @@ editfield_t* editfield_init(const char* hint_text,
 }
 
 void editfield_deinit(editfield_t* editfield) {
-    TTF_CloseFont(editfield->font);
-    SDL_DestroyTexture(editfield->hint_texture);
-    SDL_DestroyTexture(editfield->text_texture);
+    free(editfield->hint_text);
     list_free(&editfield->text);
     list_free(&editfield->text_characters_sizes);
     free(editfield);
@@ -80,53 +68,56 @@ void editfield_draw(const editfield_t* editfield,
     SDL_Rect border = { x, y, w, h };
     SDL_RenderDrawRect(renderer, &border);
 
-    if (editfield->text.size <= 1) {
-        SDL_Rect dstrect = {
-            .x = x + EDITFIELD_HORIZONTAL_INDENT,
-            .y = y + EDITFIELD_VERTICAL_INDENT,
-            .w = editfield->hint_texture_width,
-            .h = editfield->hint_texture_height
-        };
-        SDL_RenderCopy(renderer, editfield->hint_texture, NULL, &dstrect);
-    }
-
-    SDL_Rect srcrect = {
-        .x = 0,
-        .y = 0,
-        .w = editfield->text_texture_width,
-        .h = editfield->text_texture_height
-    };
-
-    SDL_Rect dstrect = {
+    SDL_Rect clip = {
         .x = x + EDITFIELD_HORIZONTAL_INDENT,
         .y = y + EDITFIELD_VERTICAL_INDENT,
-        .w = editfield->text_texture_width,
-        .h = editfield->text_texture_height,
+        .w = w - 2*EDITFIELD_HORIZONTAL_INDENT,
+        .h = h - 2*EDITFIELD_VERTICAL_INDENT
     };
 
-    int max_height = h - 2*EDITFIELD_VERTICAL_INDENT;
-    if (dstrect.h > max_height) {
-        srcrect.y = srcrect.h - max_height;
-        srcrect.h = max_height;
-        dstrect.h = max_height;
+    if (editfield->text.size <= 1) {
+        glyphcache_draw(
+            editfield->glyphcache,
+            editfield->hint_text,
+            (SDL_Color){ CONFIG_COLOR_BORDER },
+            clip.x,
+            clip.y,
+            editfield->wrap_width,
+            &clip
+        );
+        return;
     }
 
-    SDL_RenderCopy(renderer, editfield->text_texture, &srcrect, &dstrect);
+    /* the last lines of the text are kept visible */
+    int offset = 0;
+    if (editfield->text_height > clip.h)
+        offset = editfield->text_height - clip.h;
+
+    glyphcache_draw(
+        editfield->glyphcache,
+        editfield->text.begin,
+        (SDL_Color){ CONFIG_COLOR_TEXT },
+        clip.x,
+        clip.y - offset,
+        editfield->wrap_width,
+        &clip
+    );
 }
 
-void editfield_handle_event(editfield_t* editfield,
-                            const SDL_Event* event,
-                            SDL_Renderer* renderer,
-                            int x,
-                            int y,
-                            int w,
-                            int h) {
+int editfield_handle_event(editfield_t* editfield,
+                           const SDL_Event* event,
+                           int x,
+                           int y,
+                           int w,
+                           int h) {
     if (event->type == SDL_MOUSEBUTTONDOWN) {
         if (event->button.button == SDL_BUTTON_LEFT) {
             int mouse_x = event->button.x;
             int mouse_y = event->button.y;
             SDL_Rect area = { x, y, w, h };
+            Uint8 active = editfield->active;
             editfield->active = is_belong(mouse_x, mouse_y, &area);
+            return editfield->active != active;
         }
     }
 
@@ -134,27 +125,18 @@ void editfield_handle_event(editfield_t* editfield,
         const char* text = event->text.text;
         Uint32 text_size = strlen(text);
         if (editfield->text.size-1 + text_size > editfield->max_text_char_size)
-            return;
+            return 0;
         list_insert(&editfield->text, editfield->text.size-1, text, text_size);
         list_add(&editfield->text_characters_sizes, &text_size, sizeof(Uint32));
-        if (editfield->text_texture != NULL)
-            SDL_DestroyTexture(editfield->text_texture);
-        editfield->text_texture = render_text(
-            renderer,
-            editfield->font,
-            editfield->text.begin,
-            &(SDL_Color){ CONFIG_COLOR_TEXT },
-            w - 2*EDITFIELD_HORIZONTAL_INDENT,
-            &editfield->text_texture_width,
-            &editfield->text_texture_height
-        );
+        measure_text(editfield);
+        return 1;
     }
 
     else if (editfield->active && event->type == SDL_KEYDOWN) {
         if (event->key.keysym.sym == SDLK_BACKSPACE) {
             list_t* list = &editfield->text_characters_sizes;
             if (!list->size)
-                return;
+                return 0;
             size_t index = list->size - sizeof(Uint32);
             Uint32 character_size = *(Uint32*)list_get(list, index);
             list_erase(list, index, sizeof(Uint32));
@@ -163,15 +145,8 @@ void editfield_handle_event(editfield_t* editfield,
                 editfield->text.size - 1 - character_size,
                 character_size
             );
-            editfield->text_texture = render_text(
-                renderer,
-                editfield->font,
-                editfield->text.begin,
-                &(SDL_Color){ CONFIG_COLOR_TEXT },
-                w - 2*EDITFIELD_HORIZONTAL_INDENT,
-                &editfield->text_texture_width,
-                &editfield->text_texture_height
-            );
+            measure_text(editfield);
+            return 1;
         }
         else {
             char* symbol = NULL;
@@ -181,7 +156,7 @@ void editfield_handle_event(editfield_t* editfield,
                 symbol = "    ";
 
             if (symbol == NULL)
-                return;
+                return 0;
 
             SDL_Event event;
             event.type = SDL_TEXTINPUT;
@@ -189,6 +164,8 @@ void editfield_handle_event(editfield_t* editfield,
             SDL_PushEvent(&event);
         }
     }
+
+    return 0;
 }
 
 const char* editfield_get_text(const editfield_t* editfield) {
@@ -197,29 +174,12 @@ const char* editfield_get_text(const editfield_t* editfield) {
 
 /* ---------------------- static functions definition ---------------------- */
 
-static SDL_Texture* render_text(SDL_Renderer* renderer,
-                                TTF_Font* font,
-                                const char* text,
-                                const SDL_Color* color,
-                                int max_width,
-                                int* width,
-                                int* height) {
-    SDL_Surface* surface =
-        TTF_RenderUTF8_Blended_Wrapped(font, text, *color, max_width);
-    if (surface == NULL)
-        return NULL;
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture == NULL) {
-        SDL_FreeSurface(surface);
-        return NULL;
-    }
-
-    if (width != NULL)
-        *width = surface->w;
-    if (height != NULL)
-        *height = surface->h;
-    SDL_FreeSurface(surface);
-
-    return texture;
+static void measure_text(editfield_t* editfield) {
+    glyphcache_measure(
+        editfield->glyphcache,
+        editfield->text.begin,
+        editfield->wrap_width,
+        NULL,
+        &editfield->text_height
+    );
 }
@@ -0,0 +1,149 @@
+#include "../../headers/widgets/labelcache.h"
+
+static label_t* find_slot(labelcache_t* labelcache, const void* key);
+static int rasterize_label(labelcache_t* labelcache,
+                           label_t* label,
+                           const char* text,
+                           int wrap_width);
+static void free_label(label_t* label);
+
+/* ---------------------- header functions definition ---------------------- */
+
+labelcache_t* labelcache_init(SDL_Renderer* renderer,
+                              const char* font_path,
+                              int font_size) {
+    labelcache_t* labelcache = malloc(sizeof(labelcache_t));
+    if (labelcache == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return NULL;
+    }
+
+    labelcache->glyphcache =
+        glyphcache_get(renderer, font_path, font_size);
+    if (labelcache->glyphcache == NULL) {
+        free(labelcache);
+        return NULL;
+    }
+    labelcache->renderer = renderer;
+    labelcache->label_count = 0;
+    labelcache->use_counter = 0;
+
+    return labelcache;
+}
+
+void labelcache_deinit(labelcache_t* labelcache) {
+    labelcache_clear(labelcache);
+    free(labelcache);
+}
+
+const label_t* labelcache_get(labelcache_t* labelcache,
+                              const void* key,
+                              const char* text,
+                              int wrap_width) {
+    label_t* label = find_slot(labelcache, key);
+    label->last_use = ++labelcache->use_counter;
+
+    int is_valid = label->key == key
+        && label->texture != NULL
+        && label->wrap_width == wrap_width
+        && !strcmp(label->text, text);
+    if (is_valid)
+        return label;
+
+    free_label(label);
+    label->key = key;
+    if (rasterize_label(labelcache, label, text, wrap_width)) {
+        free_label(label);
+        return NULL;
+    }
+    return label;
+}
+
+void labelcache_clear(labelcache_t* labelcache) {
+    for (int i = 0; i < labelcache->label_count; i++)
+        free_label(&labelcache->labels[i]);
+    labelcache->label_count = 0;
+}
+
+/* ---------------------- static functions definition ---------------------- */
+
+static label_t* find_slot(labelcache_t* labelcache, const void* key) {
+    label_t* least_recently_used = NULL;
+    for (int i = 0; i < labelcache->label_count; i++) {
+        label_t* label = &labelcache->labels[i];
+        if (label->key == key)
+            return label;
+        if (least_recently_used == NULL
+                || label->last_use < least_recently_used->last_use)
+            least_recently_used = label;
+    }
+
+    if (labelcache->label_count < LABELCACHE_CAPACITY) {
+        label_t* label = &labelcache->labels[labelcache->label_count++];
+        label->key = NULL;
+        label->text = NULL;
+        label->texture = NULL;
+        return label;
+    }
+    return least_recently_used;
+}
+
+static int rasterize_label(labelcache_t* labelcache,
+                           label_t* label,
+                           const char* text,
+                           int wrap_width) {
+    SDL_Renderer* renderer = labelcache->renderer;
+    int text_w, text_h;
+    glyphcache_measure(
+        labelcache->glyphcache, text, wrap_width, &text_w, &text_h);
+
+    label->wrap_width = wrap_width;
+    label->w = text_w + 2*CONFIG_MARKER_NAME_HORIZONTAL_INDENT;
+    label->h = text_h + 2*CONFIG_MARKER_NAME_VERTICAL_INDENT;
+    label->text = malloc(strlen(text) + 1);
+    if (label->text == NULL) {
+        SDL_SetError("memory allocation failed\n%s()", __func__);
+        return 1;
+    }
+    strcpy(label->text, text);
+
+    label->texture = SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_RGBA8888,
+        SDL_TEXTUREACCESS_TARGET,
+        label->w,
+        label->h
+    );
+    if (label->texture == NULL)
+        return 1;
+
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    if (SDL_SetRenderTarget(renderer, label->texture))
+        return 1;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, CONFIG_COLOR_BORDER);
+    SDL_RenderDrawRect(renderer, NULL);
+    glyphcache_draw(
+        labelcache->glyphcache,
+        text,
+        (SDL_Color){ CONFIG_COLOR_TEXT },
+        CONFIG_MARKER_NAME_HORIZONTAL_INDENT,
+        CONFIG_MARKER_NAME_VERTICAL_INDENT,
+        wrap_width,
+        NULL
+    );
+    SDL_SetRenderTarget(renderer, target);
+
+    perf_count(PERF_LABEL_RASTERIZATIONS, 1);
+    return 0;
+}
+
+static void free_label(label_t* label) {
+    if (label->texture != NULL)
+        SDL_DestroyTexture(label->texture);
+    free(label->text);
+    label->key = NULL;
+    label->text = NULL;
+    label->texture = NULL;
+}
@@ -1,65 +1,75 @@
 #include "../../headers/widgets/textarea.h"
 
-textarea_t* textarea_init(void) {
+#define TEXT_LIST_ALLOCATION_PORTION (128*sizeof(char))
+
+textarea_t* textarea_init(SDL_Renderer* renderer) {
     textarea_t* textarea = malloc(sizeof(textarea_t));
     if (textarea == NULL) {
         SDL_SetError("memory allocation failed\n%s()", __func__);
         return NULL;
     }
 
-    textarea->font = TTF_OpenFont(CONFIG_FONT_PATH, CONFIG_FONT_SIZE);
-    if (textarea->font == NULL) {
+    textarea->glyphcache =
+        glyphcache_get(renderer, CONFIG_FONT_PATH, CONFIG_FONT_SIZE);
+    if (textarea->glyphcache == NULL) {
         free(textarea);
-        SDL_SetError("can not open %s\n%s()", CONFIG_FONT_PATH, __func__);
         return NULL;
     }
-    textarea->text_texture = NULL;
+
+    list_init(&textarea->text, TEXT_LIST_ALLOCATION_PORTION);
+    if (list_add(&textarea->text, "\0", sizeof(char))) {
+        textarea_deinit(textarea);
+        return NULL;
+    }
+    textarea->wrap_width = 0;
+    textarea->w = 0;
+    textarea->h = 0;
 
     return textarea;
 }
 
 void textarea_deinit(textarea_t* textarea) {
-    TTF_CloseFont(textarea->font);
-    SDL_DestroyTexture(textarea->text_texture);
+    list_free(&textarea->text);
     free(textarea);
 }
 
-void textarea_draw(const textarea_t* textarea,
-                   SDL_Renderer* renderer,
-                   int x,
-                   int y,
-                   int h) {
-    SDL_Rect srcrect = {
-        .x = 0,
-        .y = 0,
-        .w = textarea->w,
-        .h = textarea->h <= h ? textarea->h : h
-    };
-    SDL_Rect dstrect = {
+void textarea_draw(const textarea_t* textarea, int x, int y, int h) {
+    SDL_Rect clip = {
         .x = x,
         .y = y,
-        .w = srcrect.w,
-        .h = srcrect.h
+        .w = textarea->w,
+        .h = textarea->h <= h ? textarea->h : h
     };
-    SDL_RenderCopy(renderer, textarea->text_texture, &srcrect, &dstrect);
+    glyphcache_draw(
+        textarea->glyphcache,
+        textarea->text.begin,
+        (SDL_Color){ CONFIG_COLOR_TEXT },
+        x,
+        y,
+        textarea->wrap_width,
+        &clip
+    );
 }
 
-void textarea_set_text(textarea_t* textarea,
-                       SDL_Renderer* renderer,
-                       const char* text,
-                       int w) {
-    SDL_Surface* surface = TTF_RenderUTF8_Blended_Wrapped(
-        textarea->font,
+void textarea_set_text(textarea_t* textarea, const char* text, int w) {
+    if (w == textarea->wrap_width && !strcmp(textarea->text.begin, text))
+        return;
+
+    list_t* list = &textarea->text;
+    list_clear(list);
+    if (list_add(list, text, strlen(text) + 1)) {
+        list_add(list, "\0", sizeof(char));
+        textarea->w = 0;
+        textarea->h = 0;
+        return;
+    }
+
+    textarea->wrap_width = w;
+    glyphcache_measure(
+        textarea->glyphcache,
         text,
-        (SDL_Color){ CONFIG_COLOR_TEXT },
-        w
+        w,
+        &textarea->w,
+        &textarea->h
     );
-    if (surface == NULL)
-        return;
-    textarea->w = surface->w;
-    textarea->h = surface->h;
-    if (textarea->text_texture != NULL)
-        SDL_DestroyTexture(textarea->text_texture);
-    textarea->text_texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
 }